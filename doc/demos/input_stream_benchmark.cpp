@@ -0,0 +1,157 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * This is the demo "Input Stream Benchmark". It measures the throughput of InputStream for
+ * different block lengths and read-ahead depths.
+ */
+
+#include "genesis/genesis.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace genesis;
+using namespace genesis::utils;
+
+/**
+ * @brief Input source that wraps a FileInputSource and adds a fixed latency to every read.
+ *
+ * This simulates slow or network-mounted storage, where each request takes some time
+ * independently of its size.
+ */
+class ThrottledInputSource : public BaseInputSource
+{
+public:
+
+    ThrottledInputSource( std::string const& file_name, std::chrono::microseconds latency )
+        : file_( file_name )
+        , latency_( latency )
+    {}
+
+private:
+
+    size_t read_( char* buffer, size_t size ) override
+    {
+        std::this_thread::sleep_for( latency_ );
+        return file_.read( buffer, size );
+    }
+
+    std::string source_name_() const override
+    {
+        return file_.source_name();
+    }
+
+    FileInputSource           file_;
+    std::chrono::microseconds latency_;
+};
+
+/**
+ * @brief Read the whole input char by char, as a parser would do, and return the number of lines.
+ *
+ * Every `work` chars, the function spins for a bit, in order to simulate a parser that does
+ * some actual work with the data.
+ */
+size_t consume( InputStream& instr, size_t work )
+{
+    size_t lines = 0;
+    size_t count = 0;
+    volatile size_t sink = 0;
+    while( instr ) {
+        if( *instr == '\n' ) {
+            ++lines;
+        }
+        if( work > 0 && ++count % work == 0 ) {
+            for( size_t i = 0; i < 100; ++i ) {
+                sink = sink + i;
+            }
+        }
+        ++instr;
+    }
+    return lines;
+}
+
+/**
+ * @brief Main function that runs the benchmark on a given file.
+ *
+ * Usage:
+ *
+ *     input_stream_benchmark <file> [latency in microseconds] [parser work interval]
+ *
+ * For each combination of block length and read-ahead depth, the file is read once via an
+ * InputStream, and the throughput in MB/s is printed. With a latency, each read request to the
+ * file sleeps for that long first, which simulates slow storage. Deeper read-ahead then allows
+ * the reader thread to keep requesting data while the parser is busy.
+ */
+int main( int argc, const char* argv[] )
+{
+    // Activate logging, print genesis header.
+    utils::Logging::log_to_stdout();
+    LOG_BOLD << genesis_header();
+
+    // Check if the command line contains the right number of arguments.
+    if( argc < 2 || argc > 4 ) {
+        LOG_ERR << "Usage: input_stream_benchmark <file> [latency in microseconds] [work interval]";
+        return 1;
+    }
+    auto const file_name = std::string( argv[1] );
+    auto const latency   = std::chrono::microseconds( argc > 2 ? std::stoul( argv[2] ) : 0 );
+    auto const work      = static_cast< size_t >( argc > 3 ? std::stoul( argv[3] ) : 0 );
+    auto const mb        = static_cast< double >( file_size( file_name )) / ( 1024.0 * 1024.0 );
+
+    std::cout << "File: " << file_name << " (" << mb << " MB)\n";
+    std::cout << "Latency per read: " << latency.count() << " us\n\n";
+
+    std::cout << std::setw( 12 ) << "block [KB]" << std::setw( 12 ) << "read ahead";
+    std::cout << std::setw( 12 ) << "time [s]"   << std::setw( 12 ) << "MB/s" << "\n";
+
+    std::vector< size_t > const block_lengths = { 1 << 16, 1 << 20, 1 << 22, 1 << 24 };
+    std::vector< size_t > const read_aheads   = { 1, 2, 4, 8 };
+
+    for( auto const block_length : block_lengths ) {
+        for( auto const read_ahead : read_aheads ) {
+            auto const start = std::chrono::steady_clock::now();
+
+            InputStream instr(
+                utils::make_unique< ThrottledInputSource >( file_name, latency ),
+                block_length, read_ahead
+            );
+            consume( instr, work );
+
+            auto const end  = std::chrono::steady_clock::now();
+            auto const secs = std::chrono::duration< double >( end - start ).count();
+
+            std::cout << std::setw( 12 ) << ( block_length / 1024 );
+            std::cout << std::setw( 12 ) << read_ahead;
+            std::cout << std::setw( 12 ) << std::fixed << std::setprecision( 3 ) << secs;
+            std::cout << std::setw( 12 ) << std::fixed << std::setprecision( 1 ) << ( mb / secs );
+            std::cout << "\n";
+        }
+    }
+
+    return 0;
+}
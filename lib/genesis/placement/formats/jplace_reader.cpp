@@ -30,7 +30,9 @@
 
 #include "genesis/placement/formats/jplace_reader.hpp"
 
+#include "genesis/placement/function/accumulators.hpp"
 #include "genesis/placement/function/helper.hpp"
+#include "genesis/placement/function/operators.hpp"
 #include "genesis/placement/formats/newick_reader.hpp"
 #include "genesis/placement/sample_set.hpp"
 #include "genesis/placement/sample.hpp"
@@ -42,6 +44,9 @@
 #include "genesis/utils/formats/json/document.hpp"
 #include "genesis/utils/formats/json/iterator.hpp"
 #include "genesis/utils/formats/json/reader.hpp"
+#include "genesis/utils/formats/json/sax_reader.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
+#include "genesis/utils/io/input_source.hpp"
 #include "genesis/utils/io/input_stream.hpp"
 #include "genesis/utils/io/parser.hpp"
 #include "genesis/utils/io/scanner.hpp"
@@ -51,16 +56,23 @@
 #include <algorithm>
 #include <assert.h>
 #include <cctype>
+#include <cmath>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
-// #ifdef GENESIS_OPENMP
-// #   include <omp.h>
-// #endif
+#ifdef GENESIS_PTHREADS
+#   include "genesis/utils/core/thread_pool.hpp"
+
+#   include <deque>
+#   include <future>
+#endif
 
 namespace genesis {
 namespace placement {
@@ -75,8 +87,8 @@ namespace placement {
 
 Sample JplaceReader::from_stream( std::istream& is ) const
 {
-    auto doc = utils::JsonReader().from_stream( is );
-    return from_document( doc );
+    utils::InputStream input_stream( utils::make_unique< utils::StreamInputSource >( is ));
+    return process_stream( input_stream );
 }
 
 // -------------------------------------------------------------------------
@@ -85,8 +97,8 @@ Sample JplaceReader::from_stream( std::istream& is ) const
 
 Sample JplaceReader::from_file( std::string const& fn ) const
 {
-    auto doc = utils::JsonReader().from_file( fn );
-    return from_document( doc );
+    utils::InputStream input_stream( utils::from_file( fn ));
+    return process_stream( input_stream );
 }
 
 // -------------------------------------------------------------------------
@@ -95,8 +107,31 @@ Sample JplaceReader::from_file( std::string const& fn ) const
 
 Sample JplaceReader::from_string( std::string const& jplace ) const
 {
-    auto doc = utils::JsonReader().from_string( jplace );
-    return from_document( doc );
+    utils::InputStream input_stream( utils::make_unique< utils::StringInputSource >( jplace ));
+    return process_stream( input_stream );
+}
+
+// -------------------------------------------------------------------------
+//     Reading into Accumulator
+// -------------------------------------------------------------------------
+
+void JplaceReader::from_stream( std::istream& is, BasePqueryAccumulator& accumulator ) const
+{
+    utils::InputStream input_stream( utils::make_unique< utils::StreamInputSource >( is ));
+    process_stream( input_stream, &accumulator );
+}
+
+void JplaceReader::from_file( std::string const& fn, BasePqueryAccumulator& accumulator ) const
+{
+    utils::InputStream input_stream( utils::from_file( fn ));
+    process_stream( input_stream, &accumulator );
+}
+
+void JplaceReader::from_string(
+    std::string const& jplace, BasePqueryAccumulator& accumulator
+) const {
+    utils::InputStream input_stream( utils::make_unique< utils::StringInputSource >( jplace ));
+    process_stream( input_stream, &accumulator );
 }
 
 // -------------------------------------------------------------------------
@@ -139,7 +174,7 @@ SampleSet JplaceReader::from_files (const std::vector<std::string>& fns ) const
 SampleSet JplaceReader::from_strings (const std::vector<std::string>& jps ) const
 {
     SampleSet set;
-    from_files( jps, set );
+    from_strings( jps, set );
     return set;
 }
 
@@ -149,31 +184,90 @@ SampleSet JplaceReader::from_strings (const std::vector<std::string>& jps ) cons
 
 void JplaceReader::from_files (const std::vector<std::string>& fns, SampleSet& set) const
 {
-    // #if defined( GENESIS_OPENMP )
-    //
-    //     // Make a vector of default-constructored Samples of the needed size.
-    //     auto tmp = std::vector<Sample>( fns.size() );
-    //
-    //     // Parallel parsing.
-    //     #pragma omp parallel for
-    //     for( size_t i = 0; i < fns.size(); ++i ) {
-    //         tmp[ i ] = from_file( fns[i] );
-    //     }
-    //
-    //     // Move to target SampleSet.
-    //     for( size_t i = 0; i < fns.size(); ++i ) {
-    //         std::string name = utils::file_filename( utils::file_basename( fns[i] ) );
-    //         set.add( std::move( tmp[i] ), name );
-    //     }
-    //
-    // #else
-
-        for (auto fn : fns) {
-            std::string name = utils::file_filename( utils::file_basename(fn) );
-            set.add( from_file( fn ), name );
-        }
-
-    // #endif
+    std::vector<FileError> errors;
+    from_files( fns, set, errors );
+    if( errors.empty() ) {
+        return;
+    }
+
+    std::string message = "Cannot read " + std::to_string( errors.size() ) + " of "
+                        + std::to_string( fns.size() ) + " jplace files:";
+    for( auto const& error : errors ) {
+        message += "\n" + error.file_name + ": " + error.message;
+    }
+    throw std::runtime_error( message );
+}
+
+void JplaceReader::from_files(
+    std::vector<std::string> const& fns,
+    SampleSet&                      set,
+    std::vector<FileError>&         errors
+) const {
+    // Add the result of one file to the set, or record its error. Samples with the same reference
+    // tree as the one before share that tree, so that it is only kept once.
+    std::shared_ptr<PlacementTree const> last_tree;
+    auto consume = [&]( size_t index, std::function<Sample()> const& result ){
+        try {
+            auto smp = result();
+            if( last_tree && identical_trees( *last_tree, smp.tree() )) {
+                smp.share_tree( last_tree );
+            } else {
+                last_tree = smp.shared_tree();
+            }
+            std::string name = utils::file_filename( utils::file_basename( fns[index] ));
+            set.add( std::move( smp ), name );
+        } catch( std::exception const& ex ) {
+            errors.push_back({ index, fns[index], ex.what() });
+        } catch( ... ) {
+            errors.push_back({ index, fns[index], "Unknown error." });
+        }
+    };
+
+    #ifdef GENESIS_PTHREADS
+
+    // If we are run by a task of the pool ourselves, waiting for other tasks of the pool could
+    // dead-lock it. Read the files in this thread instead.
+    if( ! thread_pool().is_worker_thread() ) {
+
+        // Keep a limited number of files in flight. The oldest one is added to the set first,
+        // so that the order of the input is kept.
+        auto& pool = thread_pool();
+        size_t const max_pending = files_in_flight_ > 0 ? files_in_flight_ : 2 * pool.size();
+        std::deque<std::pair<size_t, std::future<Sample>>> pending;
+
+        auto consume_front = [&](){
+            auto& front = pending.front();
+            consume( front.first, [&](){
+                return front.second.get();
+            });
+            pending.pop_front();
+        };
+
+        for( size_t i = 0; i < fns.size(); ++i ) {
+            if( pending.size() >= max_pending ) {
+                consume_front();
+            }
+
+            // The reader is copied into the task, so that it does not depend on this object.
+            auto const reader = *this;
+            auto const& fn = fns[i];
+            pending.emplace_back( i, pool.enqueue( [reader, fn](){
+                return reader.from_file( fn );
+            }));
+        }
+        while( ! pending.empty() ) {
+            consume_front();
+        }
+        return;
+    }
+
+    #endif
+
+    for( size_t i = 0; i < fns.size(); ++i ) {
+        consume( i, [&](){
+            return from_file( fns[i] );
+        });
+    }
 }
 
 // -------------------------------------------------------------------------
@@ -189,14 +283,809 @@ void JplaceReader::from_strings (const std::vector<std::string>& jps, SampleSet&
     }
 }
 
+// -------------------------------------------------------------------------
+//     Thread Pool
+// -------------------------------------------------------------------------
+
+#ifdef GENESIS_PTHREADS
+
+utils::ThreadPool& JplaceReader::thread_pool()
+{
+    return utils::Options::get().thread_pool();
+}
+
+#endif
+
+// =================================================================================================
+//     Local Helpers
+// =================================================================================================
+
+/**
+ * @brief Create a map from edge nums to the edges of a tree.
+ *
+ * We do not use Sample::EdgeNumMap() here, because we need to do extra checking for validity.
+ */
+static std::unordered_map<size_t, PlacementTreeEdge*> jplace_edge_num_map_( PlacementTree& tree )
+{
+    std::unordered_map<size_t, PlacementTreeEdge*> edge_num_map;
+    for( auto it = tree.begin_edges(); it != tree.end_edges(); ++it ) {
+        auto& edge = *it;
+        auto& edge_data = edge->data<PlacementEdgeData>();
+        if( edge_num_map.count( edge_data.edge_num() ) > 0 ) {
+            throw std::runtime_error(
+                "Jplace document contains a tree where the edge_num tag '"
+                + std::to_string( edge_data.edge_num() ) + "' is used more than once."
+            );
+        }
+        edge_num_map.emplace( edge_data.edge_num(), edge.get() );
+    }
+    return edge_num_map;
+}
+
+/**
+ * @brief Apply the InvalidNumberBehaviour to a value, if it is @p invalid.
+ */
+static void jplace_invalid_number_(
+    JplaceReader::InvalidNumberBehaviour behaviour,
+    bool                                 invalid,
+    double&                              actual,
+    double                               expected,
+    char const*                          error_message
+) {
+    using InvalidNumberBehaviour = JplaceReader::InvalidNumberBehaviour;
+    if( ! invalid ) {
+        return;
+    }
+    if(
+        behaviour == InvalidNumberBehaviour::kLog ||
+        behaviour == InvalidNumberBehaviour::kLogAndCorrect
+    ) {
+        LOG_WARN << error_message;
+    }
+    if(
+        behaviour == InvalidNumberBehaviour::kCorrect ||
+        behaviour == InvalidNumberBehaviour::kLogAndCorrect
+    ) {
+        actual = expected;
+    }
+    if( behaviour == InvalidNumberBehaviour::kThrow ) {
+        throw std::runtime_error( error_message );
+    }
+}
+
+// =================================================================================================
+//     Sax Handler
+// =================================================================================================
+
+/**
+ * @brief Fill a Sample with the events of a utils::JsonSaxReader.
+ *
+ * The handler keeps a stack with the meaning of each open Json container, and uses it to decide
+ * what to do with the values. Pqueries are added to the Sample as soon as they begin. If the tree
+ * and the fields are already known at that point, their placements are created directly. Otherwise,
+ * the numbers of the placements are kept in a buffer, and turned into placements in finish().
+ *
+ * If an accumulator is given, each complete Pquery is handed to it and then removed from the
+ * Sample again. Buffered Pqueries are handed over, in order, as soon as the tree and the fields
+ * are known, that is, before the next direct Pquery, or in finish().
+ */
+class JplaceReader::SaxHandler : public utils::JsonSaxHandler
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Constructor
+    // -------------------------------------------------------------------------
+
+    SaxHandler(
+        JplaceReader const& reader, Sample& smp, BasePqueryAccumulator* accumulator = nullptr
+    )
+        : reader_( reader )
+        , smp_( smp )
+        , accumulator_( accumulator )
+    {}
+
+    // -------------------------------------------------------------------------
+    //     Events
+    // -------------------------------------------------------------------------
+
+    void start_object() override
+    {
+        start_container_( true );
+    }
+
+    void end_object() override
+    {
+        end_container_();
+    }
+
+    void start_array() override
+    {
+        start_container_( false );
+    }
+
+    void end_array() override
+    {
+        end_container_();
+    }
+
+    void key( std::string& name ) override
+    {
+        key_.swap( name );
+    }
+
+    void string_value( std::string& value ) override
+    {
+        switch( context_() ) {
+            case Context::kRoot: {
+                if( key_ == "version" ) {
+                    has_version_ = true;
+                    reader_.process_version( value );
+                } else if( key_ == "tree" ) {
+                    process_tree_( value );
+                } else {
+                    root_scalar_();
+                }
+                break;
+            }
+            case Context::kMetadata: {
+                // Only use metadata that is a string. Everything else is ignored.
+                smp_.metadata[ key_ ] = value;
+                break;
+            }
+            case Context::kFields: {
+                field_names_.push_back( value );
+                break;
+            }
+            case Context::kNames: {
+                // Add the name with a default multiplicity. The name is copied instead of moved,
+                // so that it gets a buffer of exactly its size, while the (larger) buffer of the
+                // value is reused for the next string.
+                pquery_().add_name( value );
+                break;
+            }
+            case Context::kNamedMultiplicity: {
+                if( position_ != 0 ) {
+                    throw std::runtime_error(
+                        std::string( "Jplace document contains a pquery where key 'nm' has an " )
+                        + "array whose second value is not a number for the multiplicity."
+                    );
+                }
+                name_.swap( value );
+                ++position_;
+                break;
+            }
+            default: {
+                other_scalar_( "string" );
+            }
+        }
+    }
+
+    void number_unsigned( std::uint64_t value ) override
+    {
+        if( context_() == Context::kRoot && key_ == "version" ) {
+            has_version_ = true;
+            reader_.process_version( std::to_string( value ));
+            return;
+        }
+        number_( static_cast<double>( value ));
+    }
+
+    void number_signed( std::int64_t value ) override
+    {
+        if( context_() == Context::kRoot && key_ == "version" ) {
+            has_version_ = true;
+            reader_.process_version( std::to_string( value ));
+            return;
+        }
+        number_( static_cast<double>( value ));
+    }
+
+    void number_float( double value ) override
+    {
+        if( context_() == Context::kRoot && key_ == "version" ) {
+            has_version_ = true;
+            reader_.process_version( std::to_string( value ));
+            return;
+        }
+        number_( value );
+    }
+
+    void boolean( bool ) override
+    {
+        other_scalar_( "boolean" );
+    }
+
+    void null() override
+    {
+        other_scalar_( "null" );
+    }
+
+    // -------------------------------------------------------------------------
+    //     Finish
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Check that all necessary parts of the document were found, and process the
+     * buffered placements.
+     */
+    void finish()
+    {
+        if( ! has_root_ ) {
+            throw std::runtime_error( "Json value is not a Json document." );
+        }
+        if( ! has_version_ ) {
+            LOG_WARN << "Jplace document does not contain a valid version number at key 'version'. "
+                     << "Now continuing to parse in the hope that it still works.";
+        }
+        if( ! has_tree_ ) {
+            throw std::runtime_error(
+                "Jplace document does not contain a valid Newick tree at key 'tree'."
+            );
+        }
+        if( ! has_fields_ ) {
+            throw std::runtime_error(
+                "Jplace document does not contain field names at key 'fields'."
+            );
+        }
+        if( ! has_placements_ ) {
+            throw std::runtime_error(
+                "Jplace document does not contain pqueries at key 'placements'."
+            );
+        }
+
+        process_pending_();
+
+        // Hand the remaining Pqueries to the accumulator. If there were none at all,
+        // it still needs to be started before it is finished.
+        if( accumulator_ ) {
+            accumulate_all_();
+            begin_accumulator_();
+            accumulator_->finish();
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    //     Internal Functions
+    // -------------------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Turn the buffered values into placements, once the tree and fields are known.
+     */
+    void process_pending_()
+    {
+        size_t offset = 0;
+        for( auto const& pending : pending_placements_ ) {
+            check_placement_size_( pending.size );
+            reader_.process_placement(
+                fields_, pending_values_.data() + offset, edge_num_map_, smp_.at( pending.pquery )
+            );
+            offset += pending.size;
+        }
+        assert( offset == pending_values_.size() );
+        pending_placements_.clear();
+        pending_values_.clear();
+    }
+
+    void begin_accumulator_()
+    {
+        assert( accumulator_ );
+        if( ! accumulator_begun_ ) {
+            accumulator_->begin( smp_.tree() );
+            accumulator_begun_ = true;
+        }
+    }
+
+    /**
+     * @brief Hand all Pqueries that are currently in the Sample to the accumulator,
+     * and remove them.
+     */
+    void accumulate_all_()
+    {
+        assert( accumulator_ );
+        if( smp_.size() == 0 ) {
+            return;
+        }
+        begin_accumulator_();
+        for( auto const& pqry : smp_ ) {
+            accumulator_->accumulate( pqry );
+        }
+        smp_.clear_pqueries();
+    }
+
+    /**
+     * @brief Meaning of an open Json object or array.
+     */
+    enum class Context
+    {
+        kNone,
+        kRoot,
+        kMetadata,
+        kFields,
+        kPlacements,
+        kPquery,
+        kPlacementList,
+        kPlacement,
+        kNames,
+        kNamedMultiplicityList,
+        kNamedMultiplicity,
+        kSkip
+    };
+
+    /**
+     * @brief Placement values that were read before the tree and fields were known.
+     */
+    struct PendingPlacement
+    {
+        size_t pquery;
+        size_t size;
+    };
+
+    Context context_() const
+    {
+        return stack_.empty() ? Context::kNone : stack_.back();
+    }
+
+    Pquery& pquery_()
+    {
+        return smp_.at( smp_.size() - 1 );
+    }
+
+    void start_container_( bool is_object )
+    {
+        auto const type_name = std::string( is_object ? "object" : "array" );
+        auto next = Context::kSkip;
+
+        switch( context_() ) {
+            case Context::kNone: {
+                if( ! is_object || has_root_ ) {
+                    throw std::runtime_error( "Json value is not a Json document." );
+                }
+                has_root_ = true;
+                next = Context::kRoot;
+                break;
+            }
+            case Context::kRoot: {
+                if( key_ == "metadata" && is_object ) {
+                    next = Context::kMetadata;
+                } else if( key_ == "fields" ) {
+                    if( is_object ) {
+                        throw std::runtime_error(
+                            "Jplace document does not contain field names at key 'fields'."
+                        );
+                    }
+                    field_names_.clear();
+                    next = Context::kFields;
+                } else if( key_ == "placements" ) {
+                    if( is_object ) {
+                        throw std::runtime_error(
+                            "Jplace document does not contain pqueries at key 'placements'."
+                        );
+                    }
+                    has_placements_ = true;
+                    next = Context::kPlacements;
+                } else {
+                    root_scalar_();
+                }
+                break;
+            }
+            case Context::kFields: {
+                throw std::runtime_error(
+                    "Jplace document contains a value of type '" + type_name
+                    + "' instead of a string with a field name at key 'fields'."
+                );
+            }
+            case Context::kPlacements: {
+                if( ! is_object ) {
+                    throw std::runtime_error(
+                        "Jplace document contains a value of type '" + type_name
+                        + "' instead of an object with a pquery at key 'placements'."
+                    );
+                }
+                direct_ = has_tree_ && has_fields_;
+
+                // When streaming, the buffered Pqueries have to be handed over before this one,
+                // in order to keep the order of the document.
+                if( accumulator_ && direct_ && smp_.size() > 0 ) {
+                    process_pending_();
+                    accumulate_all_();
+                }
+                smp_.add();
+                has_p_  = false;
+                has_n_  = false;
+                has_nm_ = false;
+                next = Context::kPquery;
+                break;
+            }
+            case Context::kPquery: {
+                if( key_ == "p" ) {
+                    if( is_object ) {
+                        throw std::runtime_error(
+                            "Jplace document contains a pquery at key 'placements' that does not "
+                            "contain an array of placements at sub-key 'p'."
+                        );
+                    }
+                    has_p_ = true;
+                    next = Context::kPlacementList;
+                } else if( key_ == "n" ) {
+                    if( is_object ) {
+                        throw std::runtime_error(
+                            "Jplace document contains a pquery with key 'n' that is not array."
+                        );
+                    }
+                    has_n_ = true;
+                    next = Context::kNames;
+                } else if( key_ == "nm" ) {
+                    if( is_object ) {
+                        throw std::runtime_error(
+                            "Jplace document contains a pquery with key 'nm' that is not array."
+                        );
+                    }
+                    has_nm_ = true;
+                    next = Context::kNamedMultiplicityList;
+                }
+                break;
+            }
+            case Context::kPlacementList: {
+                if( is_object ) {
+                    throw std::runtime_error(
+                        "Jplace document contains a pquery with invalid placement at key 'p'."
+                    );
+                }
+                values_.clear();
+                next = Context::kPlacement;
+                break;
+            }
+            case Context::kPlacement: {
+                throw_not_a_number_( type_name );
+            }
+            case Context::kNames: {
+                throw std::runtime_error(
+                    "Jplace document contains a pquery where key 'n' has a non-string field."
+                );
+            }
+            case Context::kNamedMultiplicityList: {
+                if( is_object ) {
+                    throw std::runtime_error(
+                        "Jplace document contains a pquery where key 'nm' has a non-array field."
+                    );
+                }
+                position_ = 0;
+                next = Context::kNamedMultiplicity;
+                break;
+            }
+            case Context::kNamedMultiplicity: {
+                other_scalar_( type_name );
+                break;
+            }
+            case Context::kMetadata:
+            case Context::kSkip: {
+                break;
+            }
+        }
+
+        stack_.push_back( next );
+    }
+
+    void end_container_()
+    {
+        assert( ! stack_.empty() );
+        auto const context = stack_.back();
+        stack_.pop_back();
+
+        switch( context ) {
+            case Context::kFields: {
+                fields_ = reader_.process_fields( field_names_ );
+                has_fields_ = true;
+                break;
+            }
+            case Context::kPquery: {
+                finish_pquery_();
+                break;
+            }
+            case Context::kPlacement: {
+                if( direct_ ) {
+                    check_placement_size_( values_.size() );
+                    reader_.process_placement( fields_, values_.data(), edge_num_map_, pquery_() );
+                } else {
+                    pending_placements_.push_back({ smp_.size() - 1, values_.size() });
+                    pending_values_.insert( pending_values_.end(), values_.begin(), values_.end() );
+                }
+                break;
+            }
+            case Context::kNamedMultiplicity: {
+                if( position_ != 2 ) {
+                    throw std::runtime_error(
+                        std::string( "Jplace document contains a pquery where key 'nm' has an " )
+                        + "array field with size != 2 (one for the name, one for the multiplicity)."
+                    );
+                }
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+
+    void number_( double value )
+    {
+        switch( context_() ) {
+            case Context::kPlacement: {
+                values_.push_back( value );
+                break;
+            }
+            case Context::kNamedMultiplicity: {
+                if( position_ != 1 ) {
+                    other_scalar_( "number" );
+                }
+                if( value < 0.0 ) {
+                    LOG_WARN << "Jplace document contains pquery with negative multiplicity at "
+                             << "name '" << name_ << "'.";
+                }
+                pquery_().add_name( name_, value );
+                name_.clear();
+                ++position_;
+                break;
+            }
+            case Context::kRoot: {
+                root_scalar_();
+                break;
+            }
+            default: {
+                other_scalar_( "number" );
+            }
+        }
+    }
+
+    /**
+     * @brief Process a value other than a number or string, or one in an unexpected place.
+     */
+    void other_scalar_( std::string const& type_name )
+    {
+        switch( context_() ) {
+            case Context::kNone: {
+                throw std::runtime_error( "Json value is not a Json document." );
+            }
+            case Context::kRoot: {
+                if( key_ == "version" ) {
+                    has_version_ = true;
+                    LOG_WARN << "Jplace document does not contain a valid version number at key "
+                             << "'version'. Now continuing to parse in the hope that it still "
+                             << "works.";
+                    break;
+                }
+                root_scalar_();
+                break;
+            }
+            case Context::kFields: {
+                throw std::runtime_error(
+                    "Jplace document contains a value of type '" + type_name
+                    + "' instead of a string with a field name at key 'fields'."
+                );
+            }
+            case Context::kPlacements: {
+                throw std::runtime_error(
+                    "Jplace document contains a value of type '" + type_name
+                    + "' instead of an object with a pquery at key 'placements'."
+                );
+            }
+            case Context::kPquery: {
+                if( key_ == "p" ) {
+                    throw std::runtime_error(
+                        "Jplace document contains a pquery at key 'placements' that does not "
+                        "contain an array of placements at sub-key 'p'."
+                    );
+                }
+                if( key_ == "n" || key_ == "nm" ) {
+                    throw std::runtime_error(
+                        "Jplace document contains a pquery with key '" + key_
+                        + "' that is not array."
+                    );
+                }
+                break;
+            }
+            case Context::kPlacementList: {
+                throw std::runtime_error(
+                    "Jplace document contains a pquery with invalid placement at key 'p'."
+                );
+            }
+            case Context::kPlacement: {
+                throw_not_a_number_( type_name );
+            }
+            case Context::kNames: {
+                throw std::runtime_error(
+                    "Jplace document contains a pquery where key 'n' has a non-string field."
+                );
+            }
+            case Context::kNamedMultiplicityList: {
+                throw std::runtime_error(
+                    "Jplace document contains a pquery where key 'nm' has a non-array field."
+                );
+            }
+            case Context::kNamedMultiplicity: {
+                if( position_ == 0 ) {
+                    throw std::runtime_error(
+                        std::string( "Jplace document contains a pquery where key 'nm' has an " )
+                        + "array whose first value is not a string for the name."
+                    );
+                }
+                if( position_ == 1 ) {
+                    throw std::runtime_error(
+                        std::string( "Jplace document contains a pquery where key 'nm' has an " )
+                        + "array whose second value is not a number for the multiplicity."
+                    );
+                }
+                throw std::runtime_error(
+                    std::string( "Jplace document contains a pquery where key 'nm' has an " )
+                    + "array field with size != 2 (one for the name, one for the multiplicity)."
+                );
+            }
+            case Context::kMetadata:
+            case Context::kSkip: {
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Check a value of the root object that is not a container, and not one of the
+     * valid string or number values.
+     */
+    void root_scalar_()
+    {
+        if( key_ == "tree" ) {
+            throw std::runtime_error(
+                "Jplace document does not contain a valid Newick tree at key 'tree'."
+            );
+        }
+        if( key_ == "fields" ) {
+            throw std::runtime_error(
+                "Jplace document does not contain field names at key 'fields'."
+            );
+        }
+        if( key_ == "placements" ) {
+            throw std::runtime_error(
+                "Jplace document does not contain pqueries at key 'placements'."
+            );
+        }
+    }
+
+    void process_tree_( std::string const& newick )
+    {
+        if( has_tree_ ) {
+            throw std::runtime_error( "Jplace document contains more than one key 'tree'." );
+        }
+        reader_.process_tree( newick, smp_ );
+        edge_num_map_ = jplace_edge_num_map_( smp_.tree() );
+        has_tree_ = true;
+    }
+
+    void finish_pquery_()
+    {
+        // Check name/named multiplicity validity.
+        if( ! has_p_ ) {
+            throw std::runtime_error(
+                "Jplace document contains a pquery at key 'placements' that does not contain an "
+                "array of placements at sub-key 'p'."
+            );
+        }
+        if( has_n_ && has_nm_ ) {
+            throw std::runtime_error(
+                "Jplace document contains a pquery with both an 'n' and an 'nm' key."
+            );
+        }
+        if( ! has_n_ && ! has_nm_ ) {
+            throw std::runtime_error(
+                "Jplace document contains a pquery with neither an 'n' nor an 'nm' key."
+            );
+        }
+
+        // When streaming, the Pquery is not needed any more once the accumulator has seen it.
+        if( accumulator_ && direct_ ) {
+            assert( smp_.size() == 1 );
+            accumulate_all_();
+        }
+    }
+
+    void check_placement_size_( size_t size ) const
+    {
+        if( size != fields_.size() ) {
+            throw std::runtime_error(
+                "Jplace document contains a placement fields array with different size "
+                + std::string( "than the fields name array." )
+            );
+        }
+    }
+
+    [[noreturn]] void throw_not_a_number_( std::string const& type_name ) const
+    {
+        auto const index = values_.size();
+        auto const field = ( has_fields_ && index < field_names_.size() )
+            ? field_names_[ index ]
+            : "at position " + std::to_string( index )
+        ;
+        throw std::runtime_error(
+            "Jplace document contains pquery where field " + field
+            + " is of type '" + type_name + "' instead of a number."
+        );
+    }
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    JplaceReader const&    reader_;
+    Sample&                smp_;
+    BasePqueryAccumulator* accumulator_       = nullptr;
+    bool                   accumulator_begun_ = false;
+
+    // Meaning of the open containers, and the last key of an object.
+    std::vector<Context> stack_;
+    std::string          key_;
+
+    // Which parts of the document we have seen.
+    bool has_root_       = false;
+    bool has_version_    = false;
+    bool has_tree_       = false;
+    bool has_fields_     = false;
+    bool has_placements_ = false;
+
+    // Fields and edges, for processing the placements.
+    std::vector<std::string>                       field_names_;
+    std::vector<PlacementField>                    fields_;
+    std::unordered_map<size_t, PlacementTreeEdge*> edge_num_map_;
+
+    // State of the current pquery.
+    bool                direct_ = false;
+    bool                has_p_  = false;
+    bool                has_n_  = false;
+    bool                has_nm_ = false;
+    std::vector<double> values_;
+    std::string         name_;
+    size_t              position_ = 0;
+
+    // Placements that need to wait for the tree and fields.
+    std::vector<PendingPlacement> pending_placements_;
+    std::vector<double>           pending_values_;
+};
+
 // =================================================================================================
 //     Processing
 // =================================================================================================
 
+// -------------------------------------------------------------------------
+//     Processing Stream
+// -------------------------------------------------------------------------
+
+Sample JplaceReader::process_stream(
+    utils::InputStream&    input_stream,
+    BasePqueryAccumulator* accumulator
+) const {
+    Sample smp;
+    SaxHandler handler( *this, smp, accumulator );
+    utils::JsonSaxReader().parse( input_stream, handler );
+    handler.finish();
+    return smp;
+}
+
 // -------------------------------------------------------------------------
 //     Processing Version
 // -------------------------------------------------------------------------
 
+void JplaceReader::process_version( std::string const& doc_version ) const
+{
+    if( ! check_version( doc_version )) {
+        LOG_WARN << "Jplace document has version '" << doc_version << "', however this parser "
+                 << "is written for version " << version() << " of the Jplace format. "
+                 << "Now continuing to parse in the hope that it still works.";
+    }
+}
+
 void JplaceReader::process_json_version( utils::JsonDocument const& doc ) const
 {
     // Check if there is a version key.
@@ -221,11 +1110,7 @@ void JplaceReader::process_json_version( utils::JsonDocument const& doc ) const
     }
 
     // Check if the version is correct.
-    if( ! check_version( doc_version )) {
-        LOG_WARN << "Jplace document has version '" << doc_version << "', however this parser "
-                 << "is written for version " << version() << " of the Jplace format. "
-                 << "Now continuing to parse in the hope that it still works.";
-    }
+    process_version( doc_version );
 }
 
 // -------------------------------------------------------------------------
@@ -251,6 +1136,16 @@ void JplaceReader::process_json_metadata( utils::JsonDocument const& doc, Sample
 //     Processing Tree
 // -------------------------------------------------------------------------
 
+void JplaceReader::process_tree( std::string const& newick, Sample& smp ) const
+{
+    smp.tree() = PlacementTreeNewickReader().from_string( newick );
+    if( ! has_correct_edge_nums( smp.tree() )) {
+        LOG_WARN << "Jplace document has a Newick tree where the edge_num tags are non standard. "
+                 << "They are expected to be assigned in ascending order via postorder traversal. "
+                 << "Now continuing to parse, as we can cope with this.";
+    }
+}
+
 void JplaceReader::process_json_tree( utils::JsonDocument const& doc, Sample& smp ) const
 {
     // Find and process the reference tree.
@@ -261,103 +1156,210 @@ void JplaceReader::process_json_tree( utils::JsonDocument const& doc, Sample& sm
             "Jplace document does not contain a valid Newick tree at key 'tree'."
         );
     }
-    smp.tree() = PlacementTreeNewickReader().from_string( tree_it->get_string() );
-    if( ! has_correct_edge_nums( smp.tree() )) {
-        LOG_WARN << "Jplace document has a Newick tree where the edge_num tags are non standard. "
-                 << "They are expected to be assigned in ascending order via postorder traversal. "
-                 << "Now continuing to parse, as we can cope with this.";
-    }
+    process_tree( tree_it->get_string(), smp );
 }
 
 // -------------------------------------------------------------------------
 //     Processing Fields
 // -------------------------------------------------------------------------
 
-std::vector<std::string> JplaceReader::process_json_fields( utils::JsonDocument const& doc ) const
-{
-    // get the field names and store them in array fields
-    auto fields_it = doc.find( "fields" );
-
-    if( fields_it == doc.end() || ! fields_it->is_array() ) {
-        throw std::runtime_error( "Jplace document does not contain field names at key 'fields'." );
-    }
-    std::vector<std::string> fields;
+std::vector<JplaceReader::PlacementField> JplaceReader::process_fields(
+    std::vector<std::string> const& fields
+) const {
+    std::vector<PlacementField> result;
     bool has_edge_num = false;
-    for( auto const& fields_val : *fields_it ) {
-        if( ! fields_val.is_string() ) {
-            throw std::runtime_error(
-                "Jplace document contains a value of type '" + fields_val.type_name()
-                + "' instead of a string with a field name at key 'fields'."
-            );
-        }
+    for( size_t i = 0; i < fields.size(); ++i ) {
+        std::string const& field = fields[i];
 
         // check field validity
-        std::string const& field = fields_val.get_string();
-        if (field == "edge_num"      || field == "likelihood"     || field == "like_weight_ratio" ||
-            field == "distal_length" || field == "pendant_length" || field == "proximal_length"   ||
-            field == "parsimony"
-        ) {
-            for (std::string fn : fields) {
-                if (fn == field) {
-                    throw std::runtime_error(
-                        "Jplace document contains field name '" + field
-                        + "' more than once at key 'fields'."
-                    );
-                }
-            }
+        auto value = PlacementField::kIgnored;
+        if( field == "edge_num" ) {
+            value = PlacementField::kEdgeNum;
+        } else if( field == "likelihood" ) {
+            value = PlacementField::kLikelihood;
+        } else if( field == "like_weight_ratio" ) {
+            value = PlacementField::kLikeWeightRatio;
+        } else if( field == "distal_length" ) {
+            value = PlacementField::kDistalLength;
+        } else if( field == "proximal_length" ) {
+            value = PlacementField::kProximalLength;
+        } else if( field == "pendant_length" ) {
+            value = PlacementField::kPendantLength;
+        } else if( field == "parsimony" ) {
+            value = PlacementField::kParsimony;
         } else {
             LOG_WARN << "Jplace document contains a field name '" << field << "' "
                      << "at key 'fields', which is not used by this parser and thus ignored.";
         }
-        fields.push_back(field);
-        has_edge_num |= (field == "edge_num");
+        if(
+            value != PlacementField::kIgnored &&
+            std::find( result.begin(), result.end(), value ) != result.end()
+        ) {
+            throw std::runtime_error(
+                "Jplace document contains field name '" + field
+                + "' more than once at key 'fields'."
+            );
+        }
+        result.push_back( value );
+        has_edge_num |= ( value == PlacementField::kEdgeNum );
     }
     if (!has_edge_num) {
         throw std::runtime_error(
             "Jplace document does not contain necessary field 'edge_num' at key 'fields'."
         );
     }
-    if (
-        std::end(fields) != std::find(std::begin(fields), std::end(fields), "distal_length") &&
-        std::end(fields) != std::find(std::begin(fields), std::end(fields), "proximal_length")
+    auto const has_field = [&]( PlacementField field ){
+        return std::find( result.begin(), result.end(), field ) != result.end();
+    };
+    if(
+        has_field( PlacementField::kDistalLength ) &&
+        has_field( PlacementField::kProximalLength )
     ) {
         LOG_WARN << "Jplace document contains both fields 'distal_length', and 'proximal_length'. "
                  << "Currently, only one value is used internally to represent both, which might "
                  << "lead to inconsistency if the sum of both is not equal to the branch length.";
     }
 
-    return fields;
+    return result;
+}
+
+std::vector<JplaceReader::PlacementField> JplaceReader::process_json_fields(
+    utils::JsonDocument const& doc
+) const {
+    // get the field names and store them in array fields
+    auto fields_it = doc.find( "fields" );
+
+    if( fields_it == doc.end() || ! fields_it->is_array() ) {
+        throw std::runtime_error( "Jplace document does not contain field names at key 'fields'." );
+    }
+    std::vector<std::string> fields;
+    for( auto const& fields_val : *fields_it ) {
+        if( ! fields_val.is_string() ) {
+            throw std::runtime_error(
+                "Jplace document contains a value of type '" + fields_val.type_name()
+                + "' instead of a string with a field name at key 'fields'."
+            );
+        }
+        fields.push_back( fields_val.get_string() );
+    }
+    return process_fields( fields );
 }
 
 // -------------------------------------------------------------------------
 //     Processing Placements
 // -------------------------------------------------------------------------
 
-void JplaceReader::process_json_placements(
-    utils::JsonDocument&      doc,
-    Sample&                   smp,
-    std::vector<std::string>  fields
+void JplaceReader::process_placement(
+    std::vector<PlacementField> const&                    fields,
+    double const*                                         values,
+    std::unordered_map<size_t, PlacementTreeEdge*> const& edge_num_map,
+    Pquery&                                               pqry
 ) const {
-    // create a map from edge nums to the actual edge pointers, for later use when processing
-    // the pqueries. we do not use Sample::EdgeNumMap() here, because we need to do extra
-    // checking for validity first!
-    std::unordered_map<size_t, PlacementTreeEdge*> edge_num_map;
-    for (
-        PlacementTree::ConstIteratorEdges it = smp.tree().begin_edges();
-        it != smp.tree().end_edges();
-        ++it
-    ) {
-        auto& edge = *it;
-        auto& edge_data = edge->data<PlacementEdgeData>();
-        if (edge_num_map.count( edge_data.edge_num()) > 0) {
-            throw std::runtime_error(
-                "Jplace document contains a tree where the edge_num tag '"
-                + std::to_string( edge_data.edge_num() ) + "' is used more than once."
-            );
+    // Process all fields of the placement.
+    auto pqry_place = PqueryPlacement();
+    double distal_length = -1.0;
+    for( size_t i = 0; i < fields.size(); ++i ) {
+
+        // Switch on the field to set the correct value.
+        double const pqry_place_val = values[i];
+        switch( fields[i] ) {
+            case PlacementField::kEdgeNum: {
+                // Only cast integral values that fit into a size_t. This excludes NaN and infinity,
+                // as comparisons with NaN are false. The maximum is rounded up to a power of two
+                // when converted to double, hence the `<`.
+                auto const max_val = static_cast<double>( std::numeric_limits<size_t>::max() );
+                auto edge_it = edge_num_map.end();
+                if(
+                    pqry_place_val >= 0.0 && pqry_place_val < max_val &&
+                    std::trunc( pqry_place_val ) == pqry_place_val
+                ) {
+                    edge_it = edge_num_map.find( static_cast<size_t>( pqry_place_val ));
+                }
+                if( edge_it == edge_num_map.end() ) {
+                    throw std::runtime_error(
+                        "Jplace document contains a pquery where field 'edge_num' has value '"
+                        + utils::to_string( pqry_place_val ) + "', which is not marked in the "
+                        + "given tree as an edge_num."
+                    );
+                }
+                pqry_place.reset_edge( *edge_it->second );
+                break;
+            }
+            case PlacementField::kLikelihood: {
+                pqry_place.likelihood = pqry_place_val;
+                break;
+            }
+            case PlacementField::kLikeWeightRatio: {
+                pqry_place.like_weight_ratio = pqry_place_val;
+                break;
+            }
+            case PlacementField::kDistalLength: {
+                distal_length = pqry_place_val;
+                break;
+            }
+            case PlacementField::kProximalLength: {
+                pqry_place.proximal_length = pqry_place_val;
+                break;
+            }
+            case PlacementField::kPendantLength: {
+                pqry_place.pendant_length = pqry_place_val;
+                break;
+            }
+            case PlacementField::kParsimony: {
+                pqry_place.parsimony = pqry_place_val;
+                break;
+            }
+            case PlacementField::kIgnored: {
+                break;
+            }
         }
-        edge_num_map.emplace( edge_data.edge_num(), edge.get() );
     }
 
+    // The jplace format uses distal length, but we use proximal, so we need to convert here.
+    // We have to do this here (unlike all the other values, which are set in the loop
+    // above), because it may happen that the edge_num field was not yet set while
+    // processing. Also, we only set it if it was actually available in the fields and not
+    // overwritten by the (more appropriate) field for the proximal length.
+    auto const& edge_data = pqry_place.edge().data<PlacementEdgeData>();
+    if (distal_length >= 0.0 && pqry_place.proximal_length == 0.0) {
+        pqry_place.proximal_length = edge_data.branch_length - distal_length;
+    }
+
+    // Check validity of placement values.
+    auto const behaviour = invalid_number_behaviour();
+    jplace_invalid_number_(
+        behaviour, pqry_place.like_weight_ratio < 0.0, pqry_place.like_weight_ratio, 0.0,
+        "Invalid placement with like_weight_ratio < 0.0."
+    );
+    jplace_invalid_number_(
+        behaviour, pqry_place.like_weight_ratio > 1.0, pqry_place.like_weight_ratio, 1.0,
+        "Invalid placement with like_weight_ratio > 1.0."
+    );
+    jplace_invalid_number_(
+        behaviour, pqry_place.pendant_length < 0.0, pqry_place.pendant_length, 0.0,
+        "Invalid placement with pendant_length < 0.0."
+    );
+    jplace_invalid_number_(
+        behaviour, pqry_place.proximal_length < 0.0, pqry_place.proximal_length, 0.0,
+        "Invalid placement with proximal_length < 0.0."
+    );
+    jplace_invalid_number_(
+        behaviour, pqry_place.proximal_length > edge_data.branch_length,
+        pqry_place.proximal_length, edge_data.branch_length,
+        "Invalid placement with proximal_length > branch_length."
+    );
+
+    // Add the placement to the query and vice versa.
+    pqry.add_placement( pqry_place );
+}
+
+void JplaceReader::process_json_placements(
+    utils::JsonDocument&               doc,
+    Sample&                            smp,
+    std::vector<PlacementField> const& fields
+) const {
+    auto const edge_num_map = jplace_edge_num_map_( smp.tree() );
+
     // Find and process the pqueries.
     auto place_it = doc.find( "placements" );
     if( place_it == doc.end() || ! place_it->is_array() ) {
@@ -365,6 +1367,7 @@ void JplaceReader::process_json_placements(
             "Jplace document does not contain pqueries at key 'placements'."
         );
     }
+    std::vector<double> values;
     for( auto& pqry_obj : *place_it ) {
         if( ! pqry_obj.is_object() ) {
             throw std::runtime_error(
@@ -398,130 +1401,22 @@ void JplaceReader::process_json_placements(
                 );
             }
 
-            // Process all fields of the placement.
-            auto pqry_place = PqueryPlacement();
-            double distal_length = -1.0;
+            // Up to version 3 of the jplace specification, the p-fields in a jplace document
+            // only contain numbers (float or int), so we can do this check here once for all
+            // fields, instead of repetition for every field. If in the future there are fields
+            // with non-number type, this check has to go into the single field assignments.
+            values.clear();
             for (size_t i = 0; i < pqry_fields.size(); ++i) {
-                // Up to version 3 of the jplace specification, the p-fields in a jplace document
-                // only contain numbers (float or int), so we can do this check here once for all
-                // fields, instead of repetition for every field. If in the future there are fields
-                // with non-number type, this check has to go into the single field assignments.
                 if (!pqry_fields.at(i).is_number()) {
                     throw std::runtime_error(
-                        "Jplace document contains pquery where field " + fields[i]
-                        + " is of type '" + pqry_fields.at(i).type_name()
+                        "Jplace document contains pquery where field at position "
+                        + std::to_string( i ) + " is of type '" + pqry_fields.at(i).type_name()
                         + "' instead of a number."
                     );
                 }
-
-                // Switch on the field name to set the correct value.
-                double pqry_place_val = pqry_fields.at(i).get_number<double>();
-                if (fields[i] == "edge_num") {
-                    size_t val_int = pqry_fields.at(i).get_number<size_t>();
-
-                    if (edge_num_map.count( val_int ) == 0) {
-                        throw std::runtime_error(
-                            "Jplace document contains a pquery where field 'edge_num' has value '"
-                            + std::to_string( val_int ) + "', which is not marked in the "
-                            + "given tree as an edge_num."
-                        );
-                    }
-                    pqry_place.reset_edge( *edge_num_map.at( val_int ) );
-
-                } else if (fields[i] == "likelihood") {
-                    pqry_place.likelihood = pqry_place_val;
-
-                } else if (fields[i] == "like_weight_ratio") {
-                    pqry_place.like_weight_ratio = pqry_place_val;
-
-                } else if (fields[i] == "distal_length") {
-                    distal_length = pqry_place_val;
-
-                } else if (fields[i] == "proximal_length") {
-                    pqry_place.proximal_length = pqry_place_val;
-
-                } else if (fields[i] == "pendant_length") {
-                    pqry_place.pendant_length = pqry_place_val;
-
-                } else if (fields[i] == "parsimony") {
-                    pqry_place.parsimony = pqry_place_val;
-                }
+                values.push_back( pqry_fields.at(i).get_number<double>() );
             }
-
-            // The jplace format uses distal length, but we use proximal, so we need to convert here.
-            // We have to do this here (unlike all the other values, which are set in the loop
-            // above), because it may happen that the edge_num field was not yet set while
-            // processing. Also, we only set it if it was actually available in the fields and not
-            // overwritten by the (more appropriate) field for the proximal length.
-            if (distal_length >= 0.0 && pqry_place.proximal_length == 0.0) {
-                auto const& edge_data = pqry_place.edge().data<PlacementEdgeData>();
-                pqry_place.proximal_length = edge_data.branch_length - distal_length;
-            }
-
-            auto invalid_number_checker = [this] (
-                double&                              actual,
-                std::function<bool (double, double)> comparator,
-                double                               expected,
-                std::string                          error_message
-            ) {
-                if(
-                    comparator( actual, expected ) && (
-                    invalid_number_behaviour() == InvalidNumberBehaviour::kLog ||
-                    invalid_number_behaviour() == InvalidNumberBehaviour::kLogAndCorrect
-                )) {
-                    LOG_WARN << error_message;
-                }
-
-                if(
-                    comparator( actual, expected ) && (
-                    invalid_number_behaviour() == InvalidNumberBehaviour::kCorrect ||
-                    invalid_number_behaviour() == InvalidNumberBehaviour::kLogAndCorrect
-                )) {
-                    actual = expected;
-                }
-
-                if(
-                    comparator( actual, expected ) && (
-                    invalid_number_behaviour() == InvalidNumberBehaviour::kThrow
-                )) {
-                    throw std::runtime_error( error_message );
-                }
-            };
-
-            // Check validity of placement values.
-            invalid_number_checker(
-                pqry_place.like_weight_ratio,
-                std::less<double>(),
-                0.0,
-                "Invalid placement with like_weight_ratio < 0.0."
-            );
-            invalid_number_checker(
-                pqry_place.like_weight_ratio,
-                std::greater<double>(),
-                1.0,
-                "Invalid placement with like_weight_ratio > 1.0."
-            );
-            invalid_number_checker(
-                pqry_place.pendant_length,
-                std::less<double>(),
-                0.0,
-                "Invalid placement with pendant_length < 0.0."
-            );
-            invalid_number_checker(
-                pqry_place.proximal_length,
-                std::less<double>(),
-                0.0,
-                "Invalid placement with proximal_length < 0.0."
-            );
-            invalid_number_checker(
-                pqry_place.proximal_length,
-                std::greater<double>(),
-                pqry_place.edge().data<PlacementEdgeData>().branch_length,
-                "Invalid placement with proximal_length > branch_length."
-            );
-
-            // Add the placement to the query and vice versa.
-            pqry.add_placement( pqry_place );
+            process_placement( fields, values.data(), edge_num_map, pqry );
         }
 
         // Check name/named multiplicity validity.
@@ -643,5 +1538,16 @@ JplaceReader& JplaceReader::invalid_number_behaviour( InvalidNumberBehaviour val
     return *this;
 }
 
+size_t JplaceReader::files_in_flight() const
+{
+    return files_in_flight_;
+}
+
+JplaceReader& JplaceReader::files_in_flight( size_t val )
+{
+    files_in_flight_ = val;
+    return *this;
+}
+
 } // namespace placement
 } // namespace genesis
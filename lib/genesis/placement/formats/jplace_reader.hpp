@@ -41,12 +41,24 @@ namespace genesis {
 //     Forward Declarations
 // =================================================================================================
 
+namespace tree {
+    class TreeEdge;
+}
+
 namespace utils {
     class InputStream;
     class JsonDocument;
+
+    #ifdef GENESIS_PTHREADS
+        class ThreadPool;
+    #endif
 }
 
 namespace placement {
+    using PlacementTreeEdge = tree::TreeEdge;
+
+    class BasePqueryAccumulator;
+    class Pquery;
     class Sample;
     class SampleSet;
 }
@@ -74,6 +86,23 @@ namespace placement {
  *         .invalid_number_behaviour( InvalidNumberBehaviour::kCorrect )
  *         .from_file( infile );
  *
+ * Reading from files, strings and streams does not build a JsonDocument first. Instead, the Json
+ * input is tokenized and the @link Pquery Pqueries@endlink are filled directly, so that the memory
+ * needed for reading is about the size of the resulting Sample. The columns of the `fields` array
+ * are mapped once, and then used for all placements. As the Jplace standard does not specify an
+ * order of the keys, and many programs write the `fields` and sometimes even the `tree` after the
+ * `placements`, placement values that are read before both are known are kept in a compact
+ * buffer of numbers, and are processed at the end.
+ *
+ * When only a summary of the placements is needed, such as the mass per edge of the tree, the
+ * overloads that take a BasePqueryAccumulator can be used instead, for example
+ * from_file( std::string const&, BasePqueryAccumulator& ) const. They hand each Pquery to the
+ * accumulator as soon as it is complete, and then discard it, so that the memory needed for
+ * reading does not grow with the number of Pqueries.
+ *
+ * Lists of files are read in parallel, see
+ * from_files( std::vector<std::string> const&, SampleSet&, std::vector<FileError>& ).
+ *
  * Using @link invalid_number_behaviour( InvalidNumberBehaviour ) invalid_number_behaviour()@endlink,
  * it is possible to change how the reader reacts to malformed jplace files.
  * See InvalidNumberBehaviour for the valid options.
@@ -89,6 +118,33 @@ namespace placement {
  */
 class JplaceReader
 {
+    // ---------------------------------------------------------------------
+    //     Member Types
+    // ---------------------------------------------------------------------
+
+public:
+
+    /**
+     * @brief Error that occurred while reading one of the files in from_files().
+     */
+    struct FileError
+    {
+        /**
+         * @brief Index of the file in the list of files.
+         */
+        size_t      index;
+
+        /**
+         * @brief Name of the file, as given in the list of files.
+         */
+        std::string file_name;
+
+        /**
+         * @brief Message of the exception that was thrown while reading the file.
+         */
+        std::string message;
+    };
+
     // ---------------------------------------------------------------------
     //     Constructor and Rule of Five
     // ---------------------------------------------------------------------
@@ -117,6 +173,9 @@ public:
 
     /**
      * @brief Read a file and parse it as a Jplace document into a Sample.
+     *
+     * Files that are compressed with gzip or zstd are transparently decompressed,
+     * see @link utils::from_file() from_file()@endlink.
      */
     Sample from_file( std::string const& fn ) const;
 
@@ -130,8 +189,43 @@ public:
      */
     Sample from_document( utils::JsonDocument& doc ) const;
 
+    /**
+     * @brief Read `jplace` data from a stream, and hand each Pquery to an accumulator.
+     *
+     * See from_file( std::string const&, BasePqueryAccumulator& ) const for details.
+     */
+    void from_stream( std::istream& is, BasePqueryAccumulator& accumulator ) const;
+
+    /**
+     * @brief Read a Jplace file, and hand each Pquery to an accumulator, without keeping
+     * the Pqueries.
+     *
+     * The @link BasePqueryAccumulator::begin() begin()@endlink function of the accumulator is
+     * called with the reference tree once it is known, then each Pquery is passed to
+     * @link BasePqueryAccumulator::accumulate() accumulate()@endlink in the order of the file,
+     * and is discarded afterwards. At the end, @link BasePqueryAccumulator::finish()
+     * finish()@endlink is called.
+     *
+     * The Pqueries that are read before both the `tree` and the `fields` are known cannot be
+     * processed right away; they are kept until then, as in from_file( std::string const& ).
+     * For files that have the `tree` and `fields` keys before the `placements`, as most programs
+     * write them, the memory needed for reading thus only depends on the size of the tree.
+     */
+    void from_file( std::string const& fn, BasePqueryAccumulator& accumulator ) const;
+
+    /**
+     * @brief Parse a string as a Jplace document, and hand each Pquery to an accumulator.
+     *
+     * See from_file( std::string const&, BasePqueryAccumulator& ) const for details.
+     */
+    void from_string( std::string const& jplace, BasePqueryAccumulator& accumulator ) const;
+
     /**
      * @brief Read a list of files and parse them as a Jplace document into a SampleSet.
+     *
+     * See from_files( std::vector<std::string> const&, SampleSet&, std::vector<FileError>& )
+     * for details. If any of the files cannot be read, the function throws an
+     * `std::runtime_error` that lists all failed files, after all files have been processed.
      */
     SampleSet from_files( std::vector<std::string> const& fns ) const;
 
@@ -144,9 +238,35 @@ public:
      * @brief Read a list of files and parse them as a Jplace document into a SampleSet.
      *
      * The Sample%s are added to the SampleSet, so that existing Samples in the SampleSet are kept.
+     * If any of the files cannot be read, the others are still added, and the function then
+     * throws an `std::runtime_error` that lists all failed files.
      */
     void from_files    ( std::vector<std::string> const& fns, SampleSet& set ) const;
 
+    /**
+     * @brief Read a list of files and parse them as a Jplace document into a SampleSet,
+     * and report the files that cannot be read.
+     *
+     * The files are parsed in parallel on the thread_pool(). The Sample%s are added to the
+     * SampleSet in the order of the input list, named by their file names without directory and
+     * extension. Existing Samples in the SampleSet are kept. Sample%s whose tree is identical
+     * to the tree of the file before share that tree, see Sample::share_tree(), so that a set of
+     * files that were placed on the same reference tree only keeps one copy of it.
+     *
+     * A file that cannot be read (because it does not exist, or is not a valid Jplace document)
+     * does not stop the other files from being read. Instead, it is not added to the set, and a
+     * FileError for it is appended to @p errors, again in the order of the input list.
+     *
+     * In order to limit the memory that is used while reading, at most files_in_flight() files
+     * are parsed or waiting to be added to the set at the same time. Hence, when one file takes
+     * long, the reading does not run ahead too far.
+     */
+    void from_files(
+        std::vector<std::string> const& fns,
+        SampleSet&                      set,
+        std::vector<FileError>&         errors
+    ) const;
+
     /**
      * @brief Parse a list of strings as a Jplace document into a SampleSet.
      *
@@ -154,12 +274,90 @@ public:
      */
     void from_strings  ( std::vector<std::string> const& jps, SampleSet& set ) const;
 
+#ifdef GENESIS_PTHREADS
+
+    /**
+     * @brief Return the thread pool that is used for reading multiple files.
+     *
+     * This is the process-wide @link utils::Options::thread_pool() Options::get().thread_pool()
+     * @endlink, with @link utils::Options::number_of_threads()
+     * Options::get().number_of_threads()@endlink many threads.
+     */
+    static utils::ThreadPool& thread_pool();
+
+#endif
+
     // ---------------------------------------------------------------------
     //     Processing
     // ---------------------------------------------------------------------
 
 private:
 
+    /**
+     * @brief The PqueryPlacement property that a column of the `fields` array sets.
+     */
+    enum class PlacementField
+    {
+        kEdgeNum,
+        kLikelihood,
+        kLikeWeightRatio,
+        kDistalLength,
+        kProximalLength,
+        kPendantLength,
+        kParsimony,
+        kIgnored
+    };
+
+    /**
+     * @brief Streaming parser that fills a Sample while tokenizing the Json input.
+     */
+    class SaxHandler;
+
+    /**
+     * @brief Internal helper function that reads a Jplace document from an input stream,
+     * without building a JsonDocument first.
+     *
+     * If an @p accumulator is given, the Pqueries are handed to it and removed from the Sample,
+     * so that the returned Sample only contains the tree and the metadata.
+     */
+    Sample process_stream(
+        utils::InputStream&    input_stream,
+        BasePqueryAccumulator* accumulator = nullptr
+    ) const;
+
+    /**
+     * @brief Internal helper function that checks whether a version number of a document
+     * is valid for the JplaceReader.
+     */
+    void process_version( std::string const& doc_version ) const;
+
+    /**
+     * @brief Internal helper function that parses a Newick tree and stores it as the Tree of
+     * a Sample.
+     */
+    void process_tree( std::string const& newick, Sample& smp ) const;
+
+    /**
+     * @brief Internal helper function that checks the field names of a document and maps them to
+     * the properties of a PqueryPlacement.
+     *
+     * Unknown field names are ignored, and may occur several times. Each known field name may
+     * only occur once, as otherwise it would be ambiguous which of the values to use, and an
+     * exception is thrown. This is the same behaviour as that of earlier versions of this reader.
+     */
+    std::vector<PlacementField> process_fields( std::vector<std::string> const& fields ) const;
+
+    /**
+     * @brief Internal helper function that adds a placement to a Pquery, using the values of
+     * one `p` array, in the order given by the `fields`.
+     */
+    void process_placement(
+        std::vector<PlacementField> const&                    fields,
+        double const*                                         values,
+        std::unordered_map<size_t, PlacementTreeEdge*> const& edge_num_map,
+        Pquery&                                               pqry
+    ) const;
+
     /**
      * @brief Internal helper function that checks whether the `version` key in a JsonDocument
      * corresponds to a valid version number for the JplaceReader.
@@ -182,16 +380,16 @@ private:
      * @brief Internal helper function that processes the `fields` key of a JsonDocument and returns
      * its values.
      */
-    std::vector<std::string> process_json_fields( utils::JsonDocument const& doc ) const;
+    std::vector<PlacementField> process_json_fields( utils::JsonDocument const& doc ) const;
 
     /**
      * @brief Internal helper function that processes the `placements` key of a JsonDocument and stores
      * the contained pqueries in the Sample.
      */
     void process_json_placements(
-        utils::JsonDocument&       doc,
-        Sample&                    smp,
-        std::vector<std::string>   fields
+        utils::JsonDocument&               doc,
+        Sample&                            smp,
+        std::vector<PlacementField> const& fields
     ) const;
 
     // ---------------------------------------------------------------------
@@ -293,6 +491,22 @@ public:
      */
     JplaceReader&          invalid_number_behaviour( InvalidNumberBehaviour val );
 
+    /**
+     * @brief Return the maximal number of files that from_files() keeps in memory at a time.
+     */
+    size_t files_in_flight() const;
+
+    /**
+     * @brief Set the maximal number of files that from_files() keeps in memory at a time.
+     *
+     * This counts the files that are being parsed, as well as the finished ones that wait for
+     * earlier files to be done, so that they can be added to the SampleSet in order.
+     * The default of `0` uses twice the number of threads of the thread_pool().
+     *
+     * The function returns the JplaceReader object to allow for a fluent interface.
+     */
+    JplaceReader&          files_in_flight( size_t val );
+
     // ---------------------------------------------------------------------
     //     Members
     // ---------------------------------------------------------------------
@@ -300,6 +514,7 @@ public:
 private:
 
     InvalidNumberBehaviour invalid_number_behaviour_ = InvalidNumberBehaviour::kIgnore;
+    size_t                 files_in_flight_          = 0;
 
 };
 
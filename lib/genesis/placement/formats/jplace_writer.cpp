@@ -30,6 +30,7 @@
 
 #include "genesis/placement/formats/jplace_writer.hpp"
 
+#include <cmath>
 #include <fstream>
 #include <memory>
 #include <sstream>
@@ -50,7 +51,9 @@
 #include "genesis/utils/core/std.hpp"
 #include "genesis/utils/core/version.hpp"
 #include "genesis/utils/formats/json/document.hpp"
+#include "genesis/utils/formats/json/stream_writer.hpp"
 #include "genesis/utils/formats/json/writer.hpp"
+#include "genesis/utils/io/compressed_output_target.hpp"
 #include "genesis/utils/io/output_stream.hpp"
 
 namespace genesis {
@@ -62,62 +65,84 @@ namespace placement {
 
 /**
  * @brief Write a Sample to a stream, using the Jplace format.
+ *
+ * The placements are written one by one via a utils::JsonStreamWriter, without building a
+ * JsonDocument first. Numbers are written in their shortest form that reads back to exactly the
+ * same value, and pquery names are escaped as needed.
+ *
+ * Json cannot represent infinity and NaN. Hence, if any placement value or multiplicity is not
+ * finite, an `std::invalid_argument` is thrown before anything is written.
  */
 void JplaceWriter::to_stream( Sample const& sample, std::ostream& os ) const
 {
-    // Indent. Might be replaced by some setting for the class in the future.
-    std::string in = "    ";
-
-    // Open json document.
-    os << "{\n";
+    // Check all numbers first, so that we do not write half a file that cannot be read again.
+    for( auto const& pquery : sample.pqueries() ) {
+        for( auto const& placement : pquery.placements() ) {
+            if(
+                ! std::isfinite( placement.likelihood ) ||
+                ! std::isfinite( placement.like_weight_ratio ) ||
+                ! std::isfinite( placement.proximal_length ) ||
+                ! std::isfinite( placement.pendant_length )
+            ) {
+                throw std::invalid_argument(
+                    "Cannot write Sample to Jplace, as it contains a placement with "
+                    "non-finite values on edge " + std::to_string( placement.edge_num() ) + "."
+                );
+            }
+        }
+        for( auto const& pqry_name : pquery.names() ) {
+            if( ! std::isfinite( pqry_name.multiplicity )) {
+                throw std::invalid_argument(
+                    "Cannot write Sample to Jplace, as it contains a pquery with non-finite "
+                    "multiplicity at name '" + pqry_name.name + "'."
+                );
+            }
+        }
+    }
 
-    // Write version.
-    os << in << "\"version\": 3,\n";
+    utils::JsonStreamWriter json( os );
+    json.indent( 4 );
+    json.begin_object();
 
-    // Write metadata.
-    os << in << "\"metadata\": {\n";
-    os << in << in << "\"program\": \"" << "genesis " << genesis_version() << "\",\n";
-    os << in << in << "\"invocation\": \"" << utils::Options::get().command_line_string() << "\"\n";
-    os << in << "},\n";
+    // Write version and metadata.
+    json.key( "version" ).value( 3 );
+    json.key( "metadata" ).begin_object();
+    json.key( "program" ).value( "genesis " + genesis_version() );
+    json.key( "invocation" ).value( utils::Options::get().command_line_string() );
+    json.end_object();
 
     // Write tree.
     auto newick_writer = PlacementTreeNewickWriter();
     newick_writer.enable_names(true);
     newick_writer.enable_branch_lengths(true);
     newick_writer.branch_length_precision( branch_length_precision_ );
-    os << in << "\"tree\": \"" << newick_writer.to_string( sample.tree() ) << "\",\n";
+    json.key( "tree" ).value( newick_writer.to_string( sample.tree() ));
 
     // Write field names.
-    os << in << "\"fields\": [ \"edge_num\", \"likelihood\", \"like_weight_ratio\", "
-    << "\"distal_length\", \"pendant_length\" ],\n";
+    json.key( "fields" ).begin_array( true );
+    json.value( "edge_num" ).value( "likelihood" ).value( "like_weight_ratio" );
+    json.value( "distal_length" ).value( "pendant_length" );
+    json.end_array();
 
     // Write pqueries.
-    os << in << "\"placements\": [\n";
-    for( size_t i = 0; i < sample.size(); ++i ) {
-        auto const& pquery = sample.at(i);
-        os << in << in << "{\n";
+    json.key( "placements" ).begin_array();
+    for( auto const& pquery : sample.pqueries() ) {
+        json.begin_object();
 
         // Write placements.
-        os << in << in << in << "\"p\": [\n";
-        for( size_t j = 0; j < pquery.placement_size(); ++j ) {
-            auto const& placement = pquery.placement_at(j);
-            os << in << in << in << in << "[ ";
-
-            os << placement.edge_num() << ", ";
-            os << placement.likelihood << ", ";
-            os << placement.like_weight_ratio << ", ";
-
+        json.key( "p" ).begin_array();
+        for( auto const& placement : pquery.placements() ) {
             auto const& edge_data = placement.edge().data<PlacementEdgeData>();
-            os << edge_data.branch_length - placement.proximal_length << ", ";
-            os << placement.pendant_length;
 
-            os << " ]";
-            if( j < pquery.placement_size() - 1 ) {
-                os << ",";
-            }
-            os << "\n";
+            json.begin_array( true );
+            json.value( placement.edge_num() );
+            json.value( placement.likelihood );
+            json.value( placement.like_weight_ratio );
+            json.value( edge_data.branch_length - placement.proximal_length );
+            json.value( placement.pendant_length );
+            json.end_array();
         }
-        os << in << in << in << "],\n";
+        json.end_array();
 
         // Find out whether names have multiplicity.
         bool has_nm = false;
@@ -125,48 +150,31 @@ void JplaceWriter::to_stream( Sample const& sample, std::ostream& os ) const
             has_nm |= ( pqry_name.multiplicity != 1.0 );
         }
 
-        // Write names.
+        // Write names, with or without multiplicity.
         if( has_nm ) {
-
-            // With multiplicity.
-            os << in << in << in << "\"nm\": [\n";
-            for( size_t j = 0; j < pquery.name_size(); ++j ) {
-                os << in << in << in << in << "[ \"" << pquery.name_at(j).name << "\", ";
-                os << pquery.name_at(j).multiplicity << " ]";
-
-                if( j < pquery.name_size() - 1 ) {
-                    os << ", ";
-                }
-                os << "\n";
+            json.key( "nm" ).begin_array();
+            for( auto const& pqry_name : pquery.names() ) {
+                json.begin_array( true );
+                json.value( pqry_name.name ).value( pqry_name.multiplicity );
+                json.end_array();
             }
-            os << in << in << in << "]\n";
-
+            json.end_array();
         } else {
-
-            // Without multiplicity.
-            os << in << in << in << "\"n\": [ ";
-            for( size_t j = 0; j < pquery.name_size(); ++j ) {
-                os << "\"" << pquery.name_at(j).name << "\"";
-
-                if( j < pquery.name_size() - 1 ) {
-                    os << ", ";
-                }
+            json.key( "n" ).begin_array( true );
+            for( auto const& pqry_name : pquery.names() ) {
+                json.value( pqry_name.name );
             }
-            os << " ]\n";
-
+            json.end_array();
         }
 
-        // Write end of placement stuff.
-        os << in << in << "}";
-        if( i < sample.size() - 1 ) {
-            os << ",";
-        }
-        os << "\n";
+        json.end_object();
     }
-    os << in << "]\n";
+    json.end_array();
 
     // Close json document.
-    os << "}\n";
+    json.end_object();
+    json.finish();
+    os << "\n";
 }
 
 /**
@@ -176,12 +184,16 @@ void JplaceWriter::to_stream( Sample const& sample, std::ostream& os ) const
  * already exists, an exception is thrown.
  * See @link utils::Options::allow_file_overwriting( bool ) Options::allow_file_overwriting()@endlink to
  * change this behaviour.
+ *
+ * The file is written uncompressed, unless a `compression` format is given. The format is
+ * not inferred from the file name.
  */
-void JplaceWriter::to_file( Sample const& sample, std::string const& filename ) const
-{
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    to_stream( sample, ofs );
+void JplaceWriter::to_file(
+    Sample const& sample, std::string const& filename, utils::CompressionFormat compression
+) const {
+    utils::OutputStream os( utils::to_file( filename, compression ));
+    to_stream( sample, os );
+    os.close();
 }
 
 /**
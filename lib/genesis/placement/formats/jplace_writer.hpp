@@ -31,6 +31,8 @@
  * @ingroup placement
  */
 
+#include "genesis/utils/io/compressed_input_source.hpp"
+
 #include <string>
 #include <vector>
 
@@ -85,7 +87,10 @@ public:
     // ---------------------------------------------------------------------
 
     void        to_stream   ( Sample const& smp, std::ostream& os ) const;
-    void        to_file     ( Sample const& smp, std::string const& filename) const;
+    void        to_file     (
+        Sample const& smp, std::string const& filename,
+        utils::CompressionFormat compression = utils::CompressionFormat::kNone
+    ) const;
 
     void        to_string   ( Sample const& smp, std::string&       output) const;
     std::string to_string   ( Sample const& smp) const;
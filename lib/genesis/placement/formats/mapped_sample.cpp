@@ -0,0 +1,199 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include "genesis/placement/formats/mapped_sample.hpp"
+
+#include "genesis/placement/pquery.hpp"
+#include "genesis/placement/sample.hpp"
+#include "genesis/utils/io/serializer.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Constructors and Rule of Five
+// =================================================================================================
+
+MappedSample::MappedSample(
+    std::unique_ptr< utils::Deserializer > deserializer,
+    PlacementTree&&                        tree
+)
+    : MappedSample(
+        std::move( deserializer ),
+        std::make_shared< PlacementTree const >( std::move( tree ))
+    )
+{}
+
+MappedSample::MappedSample(
+    std::unique_ptr< utils::Deserializer > deserializer,
+    std::shared_ptr< PlacementTree const > tree
+)
+    : deserializer_( std::move( deserializer ))
+{
+    if( ! tree ) {
+        throw std::invalid_argument( "Tree for constructing the MappedSample is a null pointer." );
+    }
+
+    // The tree is never changed, but the placements need non-const edges, see Sample.
+    tree_ = std::const_pointer_cast< PlacementTree >( tree );
+
+    auto& des = *deserializer_;
+    pquery_count_    = des.get_varint<size_t>();
+    placement_count_ = des.get_varint<size_t>();
+    name_count_      = des.get_varint<size_t>();
+
+    read_column_( placement_offsets_,   pquery_count_ + 1 );
+    read_column_( edge_indices_,        placement_count_ );
+    read_column_( likelihoods_,         placement_count_ );
+    read_column_( like_weight_ratios_,  placement_count_ );
+    read_column_( proximal_lengths_,    placement_count_ );
+    read_column_( pendant_lengths_,     placement_count_ );
+    read_column_( parsimonies_,         placement_count_ );
+
+    read_column_( name_offsets_,        pquery_count_ + 1 );
+    read_column_( multiplicities_,      name_count_ );
+    read_column_( name_string_offsets_, name_count_ + 1 );
+    read_column_( name_chars_,          name_string_offsets_[ name_count_ ] );
+
+    if( ! des.finished() ) {
+        throw std::invalid_argument( "Deserialization failed: File longer than expected." );
+    }
+    if(
+        placement_offsets_[ 0 ] != 0 || placement_offsets_[ pquery_count_ ] != placement_count_ ||
+        name_offsets_[ 0 ] != 0      || name_offsets_[ pquery_count_ ] != name_count_ ||
+        name_string_offsets_[ 0 ] != 0
+    ) {
+        throw std::invalid_argument( "Deserialization failed: Invalid pquery offsets." );
+    }
+}
+
+MappedSample::~MappedSample() = default;
+
+MappedSample::MappedSample( MappedSample&& )              = default;
+MappedSample& MappedSample::operator= ( MappedSample&& ) = default;
+
+// =================================================================================================
+//     Accessors
+// =================================================================================================
+
+Pquery MappedSample::pquery_at( size_t index ) const
+{
+    if( index >= pquery_count_ ) {
+        throw std::out_of_range(
+            "Index " + std::to_string( index ) + " out of range for MappedSample of size " +
+            std::to_string( pquery_count_ ) + "."
+        );
+    }
+
+    Pquery pquery;
+    add_pquery_to_( pquery, index, *tree_ );
+    return pquery;
+}
+
+Sample MappedSample::to_sample() const
+{
+    // Use our tree directly, instead of the non-const Sample::tree(), which would copy it.
+    auto sample = Sample( std::shared_ptr< PlacementTree const >( tree_ ));
+    for( size_t i = 0; i < pquery_count_; ++i ) {
+        add_pquery_to_( sample.add(), i, *tree_ );
+    }
+    return sample;
+}
+
+// =================================================================================================
+//     Internal Members
+// =================================================================================================
+
+template< typename T >
+void MappedSample::read_column_( Column<T>& column, size_t expected_size )
+{
+    // Use the mapped memory if possible, and otherwise read the whole array at once.
+    auto& des = *deserializer_;
+    if( des.is_mapped() ) {
+        auto const view = des.get_array_view<T>();
+        column.data = view.first;
+        column.size = view.second;
+    } else {
+        des.get_array( column.storage );
+        column.data = column.storage.data();
+        column.size = column.storage.size();
+    }
+
+    if( column.size != expected_size ) {
+        throw std::invalid_argument(
+            "Deserialization failed: Array of size " + std::to_string( column.size ) +
+            " instead of expected size " + std::to_string( expected_size ) + "."
+        );
+    }
+}
+
+void MappedSample::add_pquery_to_( Pquery& pquery, size_t index, PlacementTree& tree ) const
+{
+    auto const place_begin = placement_offsets_[ index ];
+    auto const place_end   = placement_offsets_[ index + 1 ];
+    if( place_begin > place_end || place_end > placement_count_ ) {
+        throw std::invalid_argument( "Deserialization failed: Invalid pquery offsets." );
+    }
+    for( auto p = place_begin; p < place_end; ++p ) {
+        if( edge_indices_[p] >= tree.edge_count() ) {
+            throw std::invalid_argument( "Deserialization failed: Invalid edge index." );
+        }
+        auto& place = pquery.add_placement( tree.edge_at( edge_indices_[p] ));
+        place.likelihood        = likelihoods_[p];
+        place.like_weight_ratio = like_weight_ratios_[p];
+        place.proximal_length   = proximal_lengths_[p];
+        place.pendant_length    = pendant_lengths_[p];
+        place.parsimony         = parsimonies_[p];
+    }
+
+    auto const name_begin = name_offsets_[ index ];
+    auto const name_end   = name_offsets_[ index + 1 ];
+    if( name_begin > name_end || name_end > name_count_ ) {
+        throw std::invalid_argument( "Deserialization failed: Invalid pquery offsets." );
+    }
+    for( auto n = name_begin; n < name_end; ++n ) {
+        auto const str_begin = name_string_offsets_[ n ];
+        auto const str_end   = name_string_offsets_[ n + 1 ];
+        if( str_begin > str_end || str_end > name_chars_.size ) {
+            throw std::invalid_argument( "Deserialization failed: Invalid pquery names." );
+        }
+        pquery.add_name(
+            std::string( name_chars_.data + str_begin, name_chars_.data + str_end ),
+            multiplicities_[n]
+        );
+    }
+}
+
+} // namespace placement
+} // namespace genesis
@@ -0,0 +1,219 @@
+#ifndef GENESIS_PLACEMENT_FORMATS_MAPPED_SAMPLE_H_
+#define GENESIS_PLACEMENT_FORMATS_MAPPED_SAMPLE_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include "genesis/placement/placement_tree.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace genesis {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+namespace utils {
+
+class Deserializer;
+
+}
+
+namespace placement {
+
+class Pquery;
+class Sample;
+
+// =================================================================================================
+//     Mapped Sample
+// =================================================================================================
+
+/**
+ * @brief Random access to the @link Pquery Pqueries@endlink of a binary `bplace` file.
+ *
+ * Objects of this class are obtained from SampleSerializer::open(). Opening only reads the tree
+ * of the file. The columns of the Pqueries are used directly from the memory mapped file (or,
+ * on systems without memory mapping, copied as a whole, without creating any objects). Single
+ * Pqueries are then created on demand by pquery_at(), and to_sample() creates the whole Sample.
+ *
+ * The Pqueries returned by pquery_at() point to the edges of tree(), and hence are only valid as
+ * long as the MappedSample exists. Use Sample::add( Pquery const& ) to copy them to a Sample with
+ * the same tree topology.
+ *
+ * The tree is held via a shared pointer, so that it can be shared with other owners, for example
+ * by several MappedSample%s of a SampleSetSerializer file with the same branch lengths, and by the
+ * Sample%s created with to_sample(). The tree is never changed by this class.
+ */
+class MappedSample
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Read a pquery section, as written by SampleSerializer::write_pqueries(), from the
+     * given Deserializer, using the given tree, which has to be the tree of the written Sample.
+     *
+     * Usually, SampleSerializer::open() is used instead.
+     */
+    MappedSample(
+        std::unique_ptr< utils::Deserializer > deserializer,
+        PlacementTree&&                        tree
+    );
+
+    /**
+     * @brief Read a pquery section from the given Deserializer, using a tree that is shared with
+     * other owners.
+     *
+     * Same as MappedSample( std::unique_ptr< utils::Deserializer >, PlacementTree&& ), but the tree
+     * is not copied.
+     */
+    MappedSample(
+        std::unique_ptr< utils::Deserializer > deserializer,
+        std::shared_ptr< PlacementTree const > tree
+    );
+
+    ~MappedSample();
+
+    MappedSample( MappedSample const& ) = delete;
+    MappedSample( MappedSample&& );
+
+    MappedSample& operator= ( MappedSample const& ) = delete;
+    MappedSample& operator= ( MappedSample&& );
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the number of @link Pquery Pqueries@endlink in the file.
+     */
+    size_t size() const
+    {
+        return pquery_count_;
+    }
+
+    bool empty() const
+    {
+        return pquery_count_ == 0;
+    }
+
+    /**
+     * @brief Return the total number of PqueryPlacement%s in the file.
+     */
+    size_t placement_size() const
+    {
+        return placement_count_;
+    }
+
+    PlacementTree const& tree() const
+    {
+        return *tree_;
+    }
+
+    /**
+     * @brief Create the Pquery at the given index, with placements on the edges of tree().
+     */
+    Pquery pquery_at( size_t index ) const;
+
+    /**
+     * @brief Create a Sample with all Pqueries.
+     *
+     * The Sample shares the tree with this MappedSample, see Sample::shared_tree(), so that the
+     * tree is not copied unless it is changed later.
+     */
+    Sample to_sample() const;
+
+    // -------------------------------------------------------------------------
+    //     Internal Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Array of the file, either pointing into the mapped memory, or to its own storage.
+     */
+    template< typename T >
+    struct Column
+    {
+        T const&  operator[] ( size_t index ) const
+        {
+            return data[ index ];
+        }
+
+        T const*       data = nullptr;
+        size_t         size = 0;
+        std::vector<T> storage;
+    };
+
+    template< typename T >
+    void read_column_( Column<T>& column, size_t expected_size );
+
+    void add_pquery_to_( Pquery& pquery, size_t index, PlacementTree& tree ) const;
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+    std::unique_ptr< utils::Deserializer > deserializer_;
+
+    // Non-const, so that Pqueries created by the const accessors can point to its edges.
+    // The tree itself is never changed after construction.
+    std::shared_ptr< PlacementTree > tree_;
+
+    size_t pquery_count_    = 0;
+    size_t placement_count_ = 0;
+    size_t name_count_      = 0;
+
+    Column< uint64_t > placement_offsets_;
+    Column< uint32_t > edge_indices_;
+    Column< double >   likelihoods_;
+    Column< double >   like_weight_ratios_;
+    Column< double >   proximal_lengths_;
+    Column< double >   pendant_lengths_;
+    Column< int32_t >  parsimonies_;
+
+    Column< uint64_t > name_offsets_;
+    Column< double >   multiplicities_;
+    Column< uint64_t > name_string_offsets_;
+    Column< char >     name_chars_;
+};
+
+} // namespace placement
+} // namespace genesis
+
+#endif // include guard
@@ -0,0 +1,271 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include "genesis/placement/formats/mapped_sample_set.hpp"
+
+#include "genesis/placement/formats/mapped_sample.hpp"
+#include "genesis/placement/formats/sample_set_serializer.hpp"
+#include "genesis/placement/formats/serializer.hpp"
+#include "genesis/placement/sample_set.hpp"
+#include "genesis/placement/sample.hpp"
+#include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
+#include "genesis/utils/io/input_source.hpp"
+#include "genesis/utils/io/serializer.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Constructors and Rule of Five
+// =================================================================================================
+
+MappedSampleSet::MappedSampleSet( std::string const& file_name )
+    : file_name_( file_name )
+{
+    // Read the header and the tree from the beginning of the file.
+    {
+        utils::Deserializer des( file_name );
+        if( ! des ) {
+            throw std::invalid_argument( "Deserialization failed: Cannot open file." );
+        }
+        std::string magic = des.get_raw_string(8);
+        if( strncmp( magic.c_str(), "BPLSET\0\0", 8 ) != 0 ) {
+            throw std::invalid_argument("Wrong file format: \"" + magic + "\".");
+        }
+        auto ver = des.get_int<unsigned char>();
+        if( ver != SampleSetSerializer::version ) {
+            throw std::invalid_argument("Wrong serialization version: " + std::to_string(ver));
+        }
+        tree_ = SampleSerializer::read_tree( des );
+    }
+
+    // The last eight bytes contain the position of the index.
+    file_.open( file_name, std::ios::binary | std::ios::ate );
+    auto const file_size = static_cast< uint64_t >( file_.tellg() );
+    if( ! file_ || file_size < 8 ) {
+        throw std::invalid_argument( "Deserialization failed: Cannot read file " + file_name );
+    }
+    auto const trailer = read_bytes_( file_size - 8, 8 );
+    auto const index_offset = utils::Deserializer(
+        utils::make_unique< utils::StringInputSource >( trailer )
+    ).get_int<uint64_t>();
+    if( index_offset > file_size - 8 ) {
+        throw std::invalid_argument( "Deserialization failed: Invalid index position." );
+    }
+
+    // Read the index.
+    auto const index = read_bytes_( index_offset, file_size - 8 - index_offset );
+    utils::Deserializer des( utils::make_unique< utils::StringInputSource >( index ));
+    auto const count = des.get_varint<size_t>();
+    for( size_t i = 0; i < count; ++i ) {
+        Entry entry;
+        entry.name        = des.get_string();
+        entry.offset      = des.get_varint<uint64_t>();
+        entry.size        = des.get_varint<uint64_t>();
+        entry.compression = des.get_int<unsigned char>();
+        if( entry.offset > index_offset || entry.size > index_offset - entry.offset ) {
+            throw std::invalid_argument( "Deserialization failed: Invalid sample position." );
+        }
+
+        // Only keep the first occurence of each name.
+        name_map_.emplace( entry.name, entries_.size() );
+        entries_.push_back( std::move( entry ));
+    }
+    if( ! des.finished() ) {
+        throw std::invalid_argument( "Deserialization failed: Invalid index." );
+    }
+}
+
+MappedSampleSet::~MappedSampleSet() = default;
+
+MappedSampleSet::MappedSampleSet( MappedSampleSet&& )              = default;
+MappedSampleSet& MappedSampleSet::operator= ( MappedSampleSet&& ) = default;
+
+// =================================================================================================
+//     Accessors
+// =================================================================================================
+
+std::string const& MappedSampleSet::name_at( size_t index ) const
+{
+    return entries_.at( index ).name;
+}
+
+std::vector<std::string> MappedSampleSet::names() const
+{
+    std::vector<std::string> result;
+    result.reserve( entries_.size() );
+    for( auto const& entry : entries_ ) {
+        result.push_back( entry.name );
+    }
+    return result;
+}
+
+bool MappedSampleSet::has_sample( std::string const& name ) const
+{
+    return name_map_.count( name ) > 0;
+}
+
+// =================================================================================================
+//     Loading
+// =================================================================================================
+
+Sample MappedSampleSet::sample_at( size_t index )
+{
+    if( index >= entries_.size() ) {
+        throw std::out_of_range(
+            "Index " + std::to_string( index ) + " out of range for MappedSampleSet of size " +
+            std::to_string( entries_.size() ) + "."
+        );
+    }
+    auto const& entry = entries_[ index ];
+    auto const block = read_bytes_( entry.offset, entry.size );
+
+    // Prepare the input, decompressing it if needed.
+    std::unique_ptr< utils::BaseInputSource > source
+        = utils::make_unique< utils::StringInputSource >( block );
+    switch( static_cast< utils::CompressionFormat >( entry.compression )) {
+        case utils::CompressionFormat::kNone: {
+            break;
+        }
+        case utils::CompressionFormat::kGzip: {
+            source = utils::make_unique< utils::GzipInputSource >( std::move( source ));
+            break;
+        }
+        case utils::CompressionFormat::kZstd: {
+            source = utils::make_unique< utils::ZstdInputSource >( std::move( source ));
+            break;
+        }
+        default: {
+            throw std::invalid_argument( "Deserialization failed: Invalid compression format." );
+        }
+    }
+    auto des = utils::make_unique< utils::Deserializer >( std::move( source ));
+
+    // The placements are created directly on the tree with the branch lengths of this sample,
+    // which is shared with all other samples with the same branch lengths.
+    auto tree = tree_with_branch_lengths_( des->get_array<double>() );
+    return MappedSample( std::move( des ), std::move( tree )).to_sample();
+}
+
+Sample MappedSampleSet::load_sample( std::string const& name )
+{
+    return sample_at( index_of_( name ));
+}
+
+SampleSet MappedSampleSet::load_samples( std::vector<std::string> const& names )
+{
+    SampleSet result;
+    for( auto const& name : names ) {
+        auto const index = index_of_( name );
+        result.add( sample_at( index ), entries_[ index ].name );
+    }
+    return result;
+}
+
+SampleSet MappedSampleSet::to_sample_set()
+{
+    SampleSet result;
+    for( size_t i = 0; i < entries_.size(); ++i ) {
+        result.add( sample_at( i ), entries_[ i ].name );
+    }
+    return result;
+}
+
+// =================================================================================================
+//     Internal Members
+// =================================================================================================
+
+size_t MappedSampleSet::index_of_( std::string const& name ) const
+{
+    auto const it = name_map_.find( name );
+    if( it == name_map_.end() ) {
+        throw std::invalid_argument( "No sample named \"" + name + "\" in " + file_name_ );
+    }
+    return it->second;
+}
+
+std::string MappedSampleSet::read_bytes_( uint64_t offset, uint64_t size )
+{
+    std::string result( size, '\0' );
+    file_.clear();
+    file_.seekg( static_cast< std::streamoff >( offset ));
+    if( size > 0 ) {
+        file_.read( &result[0], static_cast< std::streamsize >( size ));
+    }
+    if( ! file_ ) {
+        throw std::invalid_argument( "Deserialization failed: Cannot read file " + file_name_ );
+    }
+    return result;
+}
+
+std::shared_ptr< PlacementTree const > MappedSampleSet::tree_with_branch_lengths_(
+    std::vector<double> const& branch_lengths
+) {
+    if( branch_lengths.size() != tree_.edge_count() ) {
+        throw std::invalid_argument( "Deserialization failed: Invalid branch lengths." );
+    }
+
+    // Use the exact bytes as key, so that only bitwise identical branch lengths share a tree.
+    auto key = std::string(
+        reinterpret_cast< char const* >( branch_lengths.data() ),
+        branch_lengths.size() * sizeof( double )
+    );
+    auto const it = trees_.find( key );
+    if( it != trees_.end() ) {
+        if( auto tree = it->second.lock() ) {
+            return tree;
+        }
+    }
+
+    // Before adding a new tree, remove the ones of Samples that no longer exist, so that loading
+    // many Samples one after another does not grow the cache.
+    for( auto cur = trees_.begin(); cur != trees_.end(); ) {
+        if( cur->second.expired() ) {
+            cur = trees_.erase( cur );
+        } else {
+            ++cur;
+        }
+    }
+
+    auto tree = std::make_shared< PlacementTree >( tree_ );
+    for( size_t i = 0; i < branch_lengths.size(); ++i ) {
+        tree->edge_at(i).data<PlacementEdgeData>().branch_length = branch_lengths[i];
+    }
+    trees_[ std::move( key ) ] = tree;
+    return tree;
+}
+
+} // namespace placement
+} // namespace genesis
@@ -0,0 +1,224 @@
+#ifndef GENESIS_PLACEMENT_FORMATS_MAPPED_SAMPLE_SET_H_
+#define GENESIS_PLACEMENT_FORMATS_MAPPED_SAMPLE_SET_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include "genesis/placement/placement_tree.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class Sample;
+class SampleSet;
+
+// =================================================================================================
+//     Mapped Sample Set
+// =================================================================================================
+
+/**
+ * @brief Lazy access to the Sample%s of a file that was written by SampleSetSerializer::save().
+ *
+ * Objects of this class are obtained from SampleSetSerializer::open(). Opening reads the reference
+ * tree and the index of the file once. Single Sample%s are then loaded by name or index via
+ * load_sample() and sample_at(), which only read the block of the respective Sample, and
+ * load_samples() and to_sample_set() fill a SampleSet with several of them.
+ *
+ * Loaded Sample%s with the same branch lengths share their tree, see Sample::shared_tree(), as long
+ * as at least one of them exists. Hence, loading Sample%s one by one needs neither to parse the
+ * reference tree again, nor to copy it for every Sample.
+ *
+ * The file is kept open while this object exists. As loading reads from it, the loading functions
+ * are not const, and must not be called from several threads at the same time.
+ */
+class MappedSampleSet
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Open a file that was written by SampleSetSerializer::save().
+     *
+     * Usually, SampleSetSerializer::open() is used instead.
+     */
+    explicit MappedSampleSet( std::string const& file_name );
+
+    ~MappedSampleSet();
+
+    MappedSampleSet( MappedSampleSet const& ) = delete;
+    MappedSampleSet( MappedSampleSet&& );
+
+    MappedSampleSet& operator= ( MappedSampleSet const& ) = delete;
+    MappedSampleSet& operator= ( MappedSampleSet&& );
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the number of Sample%s in the file.
+     */
+    size_t size() const
+    {
+        return entries_.size();
+    }
+
+    bool empty() const
+    {
+        return entries_.empty();
+    }
+
+    /**
+     * @brief Return the name of the Sample at the given index.
+     */
+    std::string const& name_at( size_t index ) const;
+
+    /**
+     * @brief Return the names of all Sample%s in the file, in the order in which they were saved.
+     */
+    std::vector<std::string> names() const;
+
+    /**
+     * @brief Return whether the file contains a Sample with the given name.
+     */
+    bool has_sample( std::string const& name ) const;
+
+    /**
+     * @brief Return the reference tree of the file.
+     *
+     * It has the branch lengths of the first Sample that was saved.
+     */
+    PlacementTree const& tree() const
+    {
+        return tree_;
+    }
+
+    /**
+     * @brief Return the number of trees that are kept for sharing them between loaded Sample%s.
+     *
+     * The trees of Sample%s that no longer exist are removed when the next new tree is created.
+     */
+    size_t cached_tree_count() const
+    {
+        return trees_.size();
+    }
+
+    // -------------------------------------------------------------------------
+    //     Loading
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Load the Sample at the given index.
+     */
+    Sample sample_at( size_t index );
+
+    /**
+     * @brief Load the Sample with the given name.
+     *
+     * If several Sample%s have the same name, the first one is returned.
+     * Throws if the name is not found in the file.
+     */
+    Sample load_sample( std::string const& name );
+
+    /**
+     * @brief Load the Sample%s with the given names into a SampleSet.
+     *
+     * The Sample%s are added in the order of the given names.
+     * Throws if a name is not found in the file.
+     */
+    SampleSet load_samples( std::vector<std::string> const& names );
+
+    /**
+     * @brief Load all Sample%s of the file into a SampleSet.
+     */
+    SampleSet to_sample_set();
+
+    // -------------------------------------------------------------------------
+    //     Internal Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Position of one Sample in the file.
+     */
+    struct Entry
+    {
+        std::string   name;
+        uint64_t      offset;
+        uint64_t      size;
+        unsigned char compression;
+    };
+
+    size_t index_of_( std::string const& name ) const;
+
+    std::string read_bytes_( uint64_t offset, uint64_t size );
+
+    /**
+     * @brief Return a tree with the given branch lengths, sharing it with earlier loaded Sample%s
+     * with the same branch lengths if they still exist.
+     */
+    std::shared_ptr< PlacementTree const > tree_with_branch_lengths_(
+        std::vector<double> const& branch_lengths
+    );
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+    std::string   file_name_;
+    std::ifstream file_;
+
+    PlacementTree                             tree_;
+    std::vector< Entry >                      entries_;
+    std::unordered_map< std::string, size_t > name_map_;
+
+    // Trees of loaded Samples, by the raw bytes of their branch lengths.
+    std::unordered_map< std::string, std::weak_ptr< PlacementTree const >> trees_;
+};
+
+} // namespace placement
+} // namespace genesis
+
+#endif // include guard
@@ -0,0 +1,187 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include "genesis/placement/formats/sample_set_serializer.hpp"
+
+#include "genesis/placement/formats/mapped_sample_set.hpp"
+#include "genesis/placement/formats/serializer.hpp"
+#include "genesis/placement/function/operators.hpp"
+#include "genesis/placement/sample_set.hpp"
+#include "genesis/placement/sample.hpp"
+#include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/compressed_output_target.hpp"
+#include "genesis/utils/io/output_target.hpp"
+#include "genesis/utils/io/serializer.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Version
+// =================================================================================================
+
+/**
+ * @brief Version of the SampleSet file format. Is written to the file and checked when reading.
+ */
+unsigned char SampleSetSerializer::version = 1;
+
+// =================================================================================================
+//     Local Helpers
+// =================================================================================================
+
+/**
+ * @brief Local helper that stores the position of one Sample in the file.
+ */
+struct BplaceSetEntry
+{
+    std::string name;
+    uint64_t    offset;
+    uint64_t    size;
+    unsigned char compression;
+};
+
+// =================================================================================================
+//     Save
+// =================================================================================================
+
+void SampleSetSerializer::save(
+    SampleSet const&         sample_set,
+    std::string const&       file_name,
+    utils::CompressionFormat compression
+) {
+    // Check trees first, so that we do not write an incomplete file.
+    PlacementTree reference;
+    if( ! sample_set.empty() ) {
+        reference = sample_set[0].sample.tree();
+    }
+    for( auto const& named_sample : sample_set ) {
+        if( ! compatible_trees( reference, named_sample.sample.tree() )) {
+            throw std::invalid_argument(
+                "Cannot save SampleSet with different reference trees in one file."
+            );
+        }
+    }
+
+    // Prepare.
+    utils::Serializer ser( file_name );
+    if( ! ser ) {
+        throw std::invalid_argument("Serialization failed.");
+    }
+
+    // Write header and shared tree.
+    char magic[] = "BPLSET\0\0";
+    ser.put_raw( magic, 8 );
+    ser.put_int<unsigned char>( version );
+    SampleSerializer::write_tree( ser, reference );
+
+    // Write one block per sample.
+    std::vector< BplaceSetEntry > entries;
+    for( auto const& named_sample : sample_set ) {
+        auto const& smp = named_sample.sample;
+
+        std::string block;
+        {
+            std::unique_ptr< utils::BaseOutputTarget > target
+                = utils::make_unique< utils::StringOutputTarget >( block );
+            if( compression == utils::CompressionFormat::kGzip ) {
+                target = utils::make_unique< utils::GzipOutputTarget >( std::move( target ));
+            } else if( compression == utils::CompressionFormat::kZstd ) {
+                target = utils::make_unique< utils::ZstdOutputTarget >( std::move( target ));
+            }
+
+            std::vector<double> branch_lengths;
+            for( auto const& edge : smp.tree().edges() ) {
+                branch_lengths.push_back( edge->data<PlacementEdgeData>().branch_length );
+            }
+
+            utils::Serializer block_ser( std::move( target ));
+            block_ser.put_array( branch_lengths );
+            SampleSerializer::write_pqueries( block_ser, smp );
+            block_ser.close();
+        }
+
+        BplaceSetEntry entry;
+        entry.name        = named_sample.name;
+        entry.offset      = ser.bytes_written();
+        entry.size        = block.size();
+        entry.compression = static_cast< unsigned char >( compression );
+        entries.push_back( std::move( entry ));
+        ser.put_raw_string( block );
+    }
+
+    // Write the index, and its position as the last eight bytes.
+    uint64_t const index_offset = ser.bytes_written();
+    ser.put_varint( entries.size() );
+    for( auto const& entry : entries ) {
+        ser.put_string( entry.name );
+        ser.put_varint( entry.offset );
+        ser.put_varint( entry.size );
+        ser.put_int( entry.compression );
+    }
+    ser.put_int( index_offset );
+    ser.close();
+}
+
+// =================================================================================================
+//     Load
+// =================================================================================================
+
+MappedSampleSet SampleSetSerializer::open( std::string const& file_name )
+{
+    return MappedSampleSet( file_name );
+}
+
+SampleSet SampleSetSerializer::load( std::string const& file_name )
+{
+    return open( file_name ).to_sample_set();
+}
+
+SampleSet SampleSetSerializer::load(
+    std::string const& file_name, std::vector<std::string> const& names
+) {
+    return open( file_name ).load_samples( names );
+}
+
+Sample SampleSetSerializer::load_sample( std::string const& file_name, std::string const& name )
+{
+    return open( file_name ).load_sample( name );
+}
+
+std::vector<std::string> SampleSetSerializer::sample_names( std::string const& file_name )
+{
+    return open( file_name ).names();
+}
+
+} // namespace placement
+} // namespace genesis
@@ -0,0 +1,130 @@
+#ifndef GENESIS_PLACEMENT_FORMATS_SAMPLE_SET_SERIALIZER_H_
+#define GENESIS_PLACEMENT_FORMATS_SAMPLE_SET_SERIALIZER_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include "genesis/utils/io/compressed_input_source.hpp"
+
+#include <string>
+#include <vector>
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class MappedSampleSet;
+class Sample;
+class SampleSet;
+
+// =================================================================================================
+//     SampleSetSerializer
+// =================================================================================================
+
+/**
+ * @brief Store a whole SampleSet in one binary file, and read all or some of its Sample%s again.
+ *
+ * All Sample%s of the set have to share the same reference tree, that is, their trees have to
+ * be compatible, see compatible_trees( PlacementTree const&, PlacementTree const& ); only the
+ * branch lengths may differ.
+ * The tree is stored only once, using SampleSerializer::write_tree(). Each Sample is then stored
+ * as a separate block, consisting of its branch lengths and its pquery section as written by
+ * SampleSerializer::write_pqueries(). The blocks can optionally be compressed. At the end of the
+ * file, an index lists the names of the Sample%s and the positions of their blocks. Hence, single
+ * Sample%s can be loaded by name, without reading the rest of the file.
+ *
+ * Use open() to load several Sample%s lazily one after another, see MappedSampleSet. It reads the
+ * tree and the index only once. The static load functions are shortcuts that open the file for
+ * a single call.
+ */
+class SampleSetSerializer
+{
+public:
+
+    /**
+     * @brief Save a SampleSet to a file.
+     *
+     * Each Sample is compressed with the given @p compression format, which needs the respective
+     * library to be available. Throws if the trees of the Sample%s are not
+     * @link compatible_trees( PlacementTree const&, PlacementTree const& ) compatible@endlink,
+     * that is, if they differ in more than their branch lengths.
+     */
+    static void save(
+        SampleSet const&         sample_set,
+        std::string const&       file_name,
+        utils::CompressionFormat compression = utils::CompressionFormat::kNone
+    );
+
+    /**
+     * @brief Open a file that was written by save() for lazy loading of its Sample%s.
+     */
+    static MappedSampleSet open( std::string const& file_name );
+
+    /**
+     * @brief Load all Sample%s from a file that was written by save().
+     *
+     * Sample%s with the same branch lengths share their tree in memory,
+     * see Sample::shared_tree().
+     */
+    static SampleSet load( std::string const& file_name );
+
+    /**
+     * @brief Load the Sample%s with the given names from a file that was written by save().
+     *
+     * The Sample%s are added to the result in the order of the given names.
+     * Throws if a name is not found in the file.
+     */
+    static SampleSet load( std::string const& file_name, std::vector<std::string> const& names );
+
+    /**
+     * @brief Load the Sample with the given name from a file that was written by save().
+     *
+     * Only the tree, the index and the block of this Sample are read. If several Sample%s have
+     * the same name, the first one is returned. Throws if the name is not found in the file.
+     * To load several Sample%s one by one, use open() instead, which reads the tree only once.
+     */
+    static Sample load_sample( std::string const& file_name, std::string const& name );
+
+    /**
+     * @brief Return the names of the Sample%s in a file that was written by save().
+     */
+    static std::vector<std::string> sample_names( std::string const& file_name );
+
+    static unsigned char version;
+
+};
+
+} // namespace placement
+} // namespace genesis
+
+#endif // include guard
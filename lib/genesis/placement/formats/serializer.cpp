@@ -30,13 +30,19 @@
 
 #include "genesis/placement/formats/serializer.hpp"
 
+#include "genesis/placement/formats/mapped_sample.hpp"
 #include "genesis/placement/formats/newick_reader.hpp"
-#include "genesis/placement/formats/newick_writer.hpp"
 #include "genesis/placement/sample.hpp"
+#include "genesis/tree/function/operators.hpp"
 #include "genesis/utils/core/logging.hpp"
+#include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/input_source.hpp"
 #include "genesis/utils/io/serializer.hpp"
 
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
+#include <vector>
 
 namespace genesis {
 namespace placement {
@@ -49,90 +55,60 @@ namespace placement {
  * @brief Version of this serialization helper. Is written to the stream and read again to make
  * sure that different versions don't crash inexpectedly.
  */
-unsigned char SampleSerializer::version = 1;
+unsigned char SampleSerializer::version = 2;
 
 // =================================================================================================
-//     Save
+//     Local Helpers
 // =================================================================================================
 
 /**
- * @brief Saves the Sample to a binary file that can later be read by using load().
+ * @brief Local helper that appends a string to a string table.
  */
-void SampleSerializer::save( Sample const& map, std::string const& file_name )
-{
-    // Prepare.
-    utils::Serializer ser (file_name);
-    if (!ser) {
-        throw std::invalid_argument("Serialization failed.");
-    }
-
-    // Write header.
-    char magic[] = "BPLACE\0\0";
-    ser.put_raw(magic, 8);
-    ser.put_int<unsigned char>(version);
-
-    // Write tree.
-    // TODO if there is a tree serialization in the future, this one could be used here, and in
-    // addition to edge numbers, the edge indices can be stored, so that deserialization is easier.
-    auto nw = PlacementTreeNewickWriter();
-    nw.enable_names(true);
-    nw.enable_branch_lengths(true);
-    ser.put_string(nw.to_string(map.tree()));
-
-    // Write pqueries.
-    ser.put_int(map.size());
-    for (auto& pqry : map.pqueries()) {
-
-        // Write placements.
-        ser.put_int(pqry.placement_size());
-        for( auto const& place : pqry.placements() ) {
-            // We set the edge index instead of edge num. This is faster, simpler to resorte, and
-            // consinstend with Pquery.add_placement() parameters.
-            ser.put_int   (place.edge().index());
-
-            ser.put_float (place.likelihood);
-            ser.put_float (place.like_weight_ratio);
-            ser.put_float (place.proximal_length);
-            ser.put_float (place.pendant_length);
-            ser.put_int   (place.parsimony);
-        }
-
-        // Write names.
-        ser.put_int(pqry.name_size());
-        for( auto const& name : pqry.names() ) {
-            ser.put_string (name.name);
-            ser.put_float  (name.multiplicity);
-        }
-    }
+static void bplace_add_string_(
+    std::string const& str, std::vector<uint64_t>& offsets, std::vector<char>& chars
+) {
+    chars.insert( chars.end(), str.begin(), str.end() );
+    offsets.push_back( chars.size() );
 }
 
-// =================================================================================================
-//     Load
-// =================================================================================================
-
 /**
- * @brief Loads a Sample from a binary file that was written by using save().
+ * @brief Local helper that opens a file for reading, using a memory map where available.
  */
-Sample SampleSerializer::load( std::string const& file_name )
+static std::unique_ptr< utils::Deserializer > bplace_open_( std::string const& file_name )
 {
-    // Create returned object.
-    Sample map;
+    #if defined( _WIN32 ) || defined(  _WIN64  )
+        auto des = utils::make_unique< utils::Deserializer >( file_name );
+    #else
+        auto des = utils::make_unique< utils::Deserializer >(
+            utils::make_unique< utils::MmapInputSource >( file_name )
+        );
+    #endif
 
-    // Prepare, check stream status.
-    utils::Deserializer des( file_name );
-    if( ! des ) {
+    if( ! *des ) {
         throw std::invalid_argument( "Deserialization failed: Cannot open file." );
     }
+    return des;
+}
 
-    // Read and check header.
+/**
+ * @brief Local helper that reads and checks the magic bytes, and returns the version of the file.
+ */
+static unsigned char bplace_read_header_( utils::Deserializer& des )
+{
     std::string magic = des.get_raw_string(8);
     if (strncmp (magic.c_str(), "BPLACE\0\0", 8) != 0) {
         throw std::invalid_argument("Wrong file format: \"" + magic + "\".");
     }
-    auto ver = des.get_int<unsigned char>();
-    if (ver != version) {
-        throw std::invalid_argument("Wrong serialization version: " + std::to_string(ver));
-    }
+    return des.get_int<unsigned char>();
+}
+
+/**
+ * @brief Local helper that reads the remainder of a version 1 file.
+ */
+static Sample bplace_load_version_1_( utils::Deserializer& des )
+{
+    // Create returned object.
+    Sample map;
 
     // Read and check tree.
     auto tree_string = des.get_string();
@@ -161,7 +137,7 @@ Sample SampleSerializer::load( std::string const& file_name )
         // Read names.
         size_t num_names = des.get_int<size_t>();
         for (size_t n = 0; n < num_names; ++n) {
-            auto name = pqry.add_name( des.get_string() );
+            auto& name = pqry.add_name( des.get_string() );
             name.multiplicity = des.get_float<double>();
         }
     }
@@ -173,5 +149,280 @@ Sample SampleSerializer::load( std::string const& file_name )
     return map;
 }
 
+// =================================================================================================
+//     Save
+// =================================================================================================
+
+/**
+ * @brief Saves the Sample to a binary file that can later be read by using load() or open().
+ */
+void SampleSerializer::save( Sample const& map, std::string const& file_name )
+{
+    // Prepare.
+    utils::Serializer ser (file_name);
+    if (!ser) {
+        throw std::invalid_argument("Serialization failed.");
+    }
+
+    // Write header.
+    char magic[] = "BPLACE\0\0";
+    ser.put_raw(magic, 8);
+    ser.put_int<unsigned char>(version);
+
+    write_tree( ser, map.tree() );
+    write_pqueries( ser, map );
+    ser.close();
+}
+
+void SampleSerializer::write_tree( utils::Serializer& ser, PlacementTree const& tree )
+{
+    // Write tree topology as index arrays, and its data as columns.
+    std::vector<uint64_t> link_next, link_outer, link_node, link_edge;
+    for( auto const& link : tree.links() ) {
+        link_next.push_back(  link->next().index() );
+        link_outer.push_back( link->outer().index() );
+        link_node.push_back(  link->node().index() );
+        link_edge.push_back(  link->edge().index() );
+    }
+    std::vector<uint64_t> node_link;
+    std::vector<uint64_t> node_name_offsets( 1, 0 );
+    std::vector<char>     node_name_chars;
+    for( auto const& node : tree.nodes() ) {
+        node_link.push_back( node->link().index() );
+        bplace_add_string_(
+            node->data<PlacementNodeData>().name, node_name_offsets, node_name_chars
+        );
+    }
+    std::vector<uint64_t> edge_primary, edge_secondary;
+    std::vector<double>   branch_lengths;
+    std::vector<int32_t>  edge_nums;
+    for( auto const& edge : tree.edges() ) {
+        auto const& edge_data = edge->data<PlacementEdgeData>();
+        edge_primary.push_back(   edge->primary_link().index() );
+        edge_secondary.push_back( edge->secondary_link().index() );
+        branch_lengths.push_back( edge_data.branch_length );
+        edge_nums.push_back(      edge_data.edge_num() );
+    }
+
+    ser.put_varint( tree.link_count() );
+    ser.put_varint( tree.node_count() );
+    ser.put_varint( tree.edge_count() );
+    ser.put_varint( tree.empty() ? 0 : tree.root_link().index() );
+    ser.put_array( link_next );
+    ser.put_array( link_outer );
+    ser.put_array( link_node );
+    ser.put_array( link_edge );
+    ser.put_array( node_link );
+    ser.put_array( edge_primary );
+    ser.put_array( edge_secondary );
+    ser.put_array( branch_lengths );
+    ser.put_array( edge_nums );
+    ser.put_array( node_name_offsets );
+    ser.put_array( node_name_chars );
+}
+
+PlacementTree SampleSerializer::read_tree( utils::Deserializer& des )
+{
+    auto const link_count = des.get_varint<size_t>();
+    auto const node_count = des.get_varint<size_t>();
+    auto const edge_count = des.get_varint<size_t>();
+    auto const root_index = des.get_varint<size_t>();
+
+    // The tree is small compared to the pqueries, so we simply copy its arrays.
+    auto read_array = [&]( std::vector<uint64_t>& array, size_t size ){
+        des.get_array( array );
+        if( array.size() != size ) {
+            throw std::invalid_argument( "Deserialization failed: Invalid tree topology." );
+        }
+    };
+    std::vector<uint64_t> link_next, link_outer, link_node, link_edge;
+    std::vector<uint64_t> node_link, edge_primary, edge_secondary, name_offsets;
+    read_array( link_next,      link_count );
+    read_array( link_outer,     link_count );
+    read_array( link_node,      link_count );
+    read_array( link_edge,      link_count );
+    read_array( node_link,      node_count );
+    read_array( edge_primary,   edge_count );
+    read_array( edge_secondary, edge_count );
+    auto const branch_lengths = des.get_array<double>();
+    auto const edge_nums      = des.get_array<int32_t>();
+    read_array( name_offsets,   node_count + 1 );
+    auto const name_chars     = des.get_array<char>();
+    if(
+        branch_lengths.size() != edge_count || edge_nums.size() != edge_count ||
+        name_offsets[ node_count ] != name_chars.size()
+    ) {
+        throw std::invalid_argument( "Deserialization failed: Invalid tree data." );
+    }
+
+    auto check_index = []( uint64_t index, size_t count ){
+        if( index >= count ) {
+            throw std::invalid_argument( "Deserialization failed: Invalid tree topology." );
+        }
+        return static_cast< size_t >( index );
+    };
+    if( link_count > 0 ) {
+        check_index( root_index, link_count );
+    }
+
+    // Check the name offsets before using any of them to build the names.
+    for( size_t i = 0; i < node_count; ++i ) {
+        if( name_offsets[i] > name_offsets[ i + 1 ] ) {
+            throw std::invalid_argument( "Deserialization failed: Invalid node names." );
+        }
+    }
+
+    // Each link has to be the next link of exactly one link. Otherwise, the next links do not form
+    // cycles, and walking around a node, as done by validate_topology() below, would not end.
+    std::vector<bool> is_next( link_count, false );
+    for( size_t i = 0; i < link_count; ++i ) {
+        auto const next = check_index( link_next[i], link_count );
+        if( is_next[ next ] ) {
+            throw std::invalid_argument( "Deserialization failed: Invalid tree topology." );
+        }
+        is_next[ next ] = true;
+    }
+
+    // Create all objects first, so that they can be linked to each other.
+    PlacementTree tree;
+    auto& links = tree.expose_link_container();
+    auto& nodes = tree.expose_node_container();
+    auto& edges = tree.expose_edge_container();
+    links.resize( link_count );
+    nodes.resize( node_count );
+    edges.resize( edge_count );
+    for( auto& link : links ) {
+        link = utils::make_unique< tree::TreeLink >();
+    }
+    for( auto& node : nodes ) {
+        node = utils::make_unique< tree::TreeNode >();
+    }
+    for( auto& edge : edges ) {
+        edge = utils::make_unique< tree::TreeEdge >();
+    }
+
+    for( size_t i = 0; i < link_count; ++i ) {
+        links[i]->reset_index( i );
+        links[i]->reset_next(  links[ check_index( link_next[i],  link_count ) ].get() );
+        links[i]->reset_outer( links[ check_index( link_outer[i], link_count ) ].get() );
+        links[i]->reset_node(  nodes[ check_index( link_node[i],  node_count ) ].get() );
+        links[i]->reset_edge(  edges[ check_index( link_edge[i],  edge_count ) ].get() );
+    }
+    for( size_t i = 0; i < node_count; ++i ) {
+        auto data = PlacementNodeData::create();
+        data->name = std::string(
+            name_chars.begin() + name_offsets[i], name_chars.begin() + name_offsets[ i + 1 ]
+        );
+
+        nodes[i]->reset_index( i );
+        nodes[i]->reset_primary_link( links[ check_index( node_link[i], link_count ) ].get() );
+        nodes[i]->reset_data( std::move( data ));
+    }
+    for( size_t i = 0; i < edge_count; ++i ) {
+        auto data = PlacementEdgeData::create();
+        data->branch_length = branch_lengths[i];
+        data->reset_edge_num( edge_nums[i] );
+
+        auto const primary   = check_index( edge_primary[i],   link_count );
+        auto const secondary = check_index( edge_secondary[i], link_count );
+
+        edges[i]->reset_index( i );
+        edges[i]->reset_primary_link(   links[ primary ].get() );
+        edges[i]->reset_secondary_link( links[ secondary ].get() );
+        edges[i]->reset_data( std::move( data ));
+    }
+    tree.reset_root_link_index( root_index );
+
+    // The indices are all in range now, but they might still not form a valid tree.
+    if( ! tree::validate_topology( tree )) {
+        throw std::invalid_argument( "Deserialization failed: Invalid tree topology." );
+    }
+
+    return tree;
+}
+
+void SampleSerializer::write_pqueries( utils::Serializer& ser, Sample const& map )
+{
+    // Collect the pqueries in columns.
+    std::vector<uint64_t> placement_offsets( 1, 0 );
+    std::vector<uint32_t> edge_indices;
+    std::vector<double>   likelihoods, like_weight_ratios, proximal_lengths, pendant_lengths;
+    std::vector<int32_t>  parsimonies;
+    std::vector<uint64_t> name_offsets( 1, 0 );
+    std::vector<double>   multiplicities;
+    std::vector<uint64_t> name_string_offsets( 1, 0 );
+    std::vector<char>     name_chars;
+    for( auto const& pqry : map.pqueries() ) {
+        for( auto const& place : pqry.placements() ) {
+            // We store the edge index instead of edge num. This is faster, simpler to restore,
+            // and consistent with Pquery.add_placement() parameters.
+            edge_indices.push_back(       static_cast<uint32_t>( place.edge().index() ));
+            likelihoods.push_back(        place.likelihood );
+            like_weight_ratios.push_back( place.like_weight_ratio );
+            proximal_lengths.push_back(   place.proximal_length );
+            pendant_lengths.push_back(    place.pendant_length );
+            parsimonies.push_back(        place.parsimony );
+        }
+        placement_offsets.push_back( edge_indices.size() );
+
+        for( auto const& name : pqry.names() ) {
+            multiplicities.push_back( name.multiplicity );
+            bplace_add_string_( name.name, name_string_offsets, name_chars );
+        }
+        name_offsets.push_back( multiplicities.size() );
+    }
+
+    // Write pqueries.
+    ser.put_varint( map.size() );
+    ser.put_varint( edge_indices.size() );
+    ser.put_varint( multiplicities.size() );
+    ser.put_array( placement_offsets );
+    ser.put_array( edge_indices );
+    ser.put_array( likelihoods );
+    ser.put_array( like_weight_ratios );
+    ser.put_array( proximal_lengths );
+    ser.put_array( pendant_lengths );
+    ser.put_array( parsimonies );
+    ser.put_array( name_offsets );
+    ser.put_array( multiplicities );
+    ser.put_array( name_string_offsets );
+    ser.put_array( name_chars );
+}
+
+// =================================================================================================
+//     Load
+// =================================================================================================
+
+/**
+ * @brief Loads a Sample from a binary file that was written by using save().
+ */
+Sample SampleSerializer::load( std::string const& file_name )
+{
+    auto des = bplace_open_( file_name );
+    auto ver = bplace_read_header_( *des );
+    if( ver == 1 ) {
+        return bplace_load_version_1_( *des );
+    }
+    if( ver != version ) {
+        throw std::invalid_argument("Wrong serialization version: " + std::to_string(ver));
+    }
+    auto tree = read_tree( *des );
+    return MappedSample( std::move( des ), std::move( tree )).to_sample();
+}
+
+/**
+ * @brief Open a binary file that was written by using save() for random access to its Pqueries.
+ */
+MappedSample SampleSerializer::open( std::string const& file_name )
+{
+    auto des = bplace_open_( file_name );
+    auto ver = bplace_read_header_( *des );
+    if( ver != version ) {
+        throw std::invalid_argument("Wrong serialization version: " + std::to_string(ver));
+    }
+    auto tree = read_tree( *des );
+    return MappedSample( std::move( des ), std::move( tree ));
+}
+
 } // namespace placement
 } // namespace genesis
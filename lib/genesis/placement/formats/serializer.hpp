@@ -31,15 +31,26 @@
  * @ingroup placement
  */
 
+#include "genesis/placement/placement_tree.hpp"
+
 #include <string>
 
 namespace genesis {
-namespace placement {
 
 // =================================================================================================
 //     Forward Declarations
 // =================================================================================================
 
+namespace utils {
+
+class Deserializer;
+class Serializer;
+
+}
+
+namespace placement {
+
+class MappedSample;
 class Sample;
 
 // =================================================================================================
@@ -47,7 +58,29 @@ class Sample;
 // =================================================================================================
 
 /**
- * @brief
+ * @brief Store a Sample in a binary file, and read it again.
+ *
+ * The binary format (`bplace`) is meant for caching Samples between the stages of a pipeline.
+ * Version 2 of the format is written by save(); load() reads versions 1 and 2.
+ *
+ * A version 2 file starts with the magic bytes `BPLACE\0\0` and the version byte, followed by
+ * two sections. All arrays are written with utils::Serializer::put_array(), and hence are aligned
+ * in the file, so that they can be used directly from a memory mapped file.
+ *
+ *  *  Tree section: The numbers of links, nodes and edges, and the index of the root link,
+ *     followed by the topology as index arrays (next, outer, node and edge of each link, primary
+ *     link of each node, and primary and secondary link of each edge), the branch lengths and
+ *     `edge_num`s of the edges, and the node names as a string table.
+ *  *  Pquery section: The numbers of pqueries, placements and names, followed by the pquery offset
+ *     index into the placement columns, the placement columns (edge index, likelihood,
+ *     like_weight_ratio, proximal length, pendant length, parsimony), the pquery offset index into
+ *     the names, the multiplicities of the names, and the names as a string table.
+ *
+ * A string table consists of the offsets of the strings (one more than there are strings),
+ * followed by the concatenated characters.
+ *
+ * Use open() to access the Pqueries of such a file without reading all of it,
+ * see MappedSample for details.
  */
 class SampleSerializer
 {
@@ -56,6 +89,31 @@ public:
     static void save( Sample const& map, std::string const& file_name );
     static Sample load( std::string const& file_name );
 
+    /**
+     * @brief Open a version 2 file for random access to its Pqueries.
+     *
+     * On systems that support it, the file is memory mapped, so that this takes time proportional
+     * to the size of the tree, but independent of the number of Pqueries.
+     */
+    static MappedSample open( std::string const& file_name );
+
+    /**
+     * @brief Write the tree section of the format (without header) to a Serializer.
+     */
+    static void write_tree( utils::Serializer& serializer, PlacementTree const& tree );
+
+    /**
+     * @brief Read a tree section that was written by write_tree().
+     */
+    static PlacementTree read_tree( utils::Deserializer& deserializer );
+
+    /**
+     * @brief Write the pquery section of the format to a Serializer.
+     *
+     * The section can be read with a MappedSample, using the tree of the Sample.
+     */
+    static void write_pqueries( utils::Serializer& serializer, Sample const& sample );
+
     static unsigned char version;
 
 };
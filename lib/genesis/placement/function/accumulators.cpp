@@ -0,0 +1,140 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include "genesis/placement/function/accumulators.hpp"
+
+#include "genesis/placement/function/functions.hpp"
+#include "genesis/placement/pquery.hpp"
+#include "genesis/placement/sample.hpp"
+#include "genesis/tree/mass_tree/functions.hpp"
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Helper Functions
+// =================================================================================================
+
+void accumulate_sample( Sample const& sample, BasePqueryAccumulator& accumulator )
+{
+    accumulator.begin( sample.tree() );
+    for( auto const& pquery : sample ) {
+        accumulator.accumulate( pquery );
+    }
+    accumulator.finish();
+}
+
+// =================================================================================================
+//     Edge Accumulator
+// =================================================================================================
+
+void EdgeAccumulator::begin_( PlacementTree const& tree )
+{
+    counts_.assign(  tree.edge_count(), 0 );
+    weights_.assign( tree.edge_count(), 0.0 );
+    masses_.assign(  tree.edge_count(), 0.0 );
+    pquery_count_ = 0;
+    total_mass_   = 0.0;
+}
+
+void EdgeAccumulator::accumulate_( Pquery const& pquery )
+{
+    double const multiplicity = total_multiplicity( pquery );
+    double lwr_sum = 0.0;
+    for( auto const& place : pquery.placements() ) {
+        auto const edge_index = place.edge().index();
+        ++counts_[ edge_index ];
+        weights_[ edge_index ] += place.like_weight_ratio;
+        masses_[ edge_index ]  += place.like_weight_ratio * multiplicity;
+        lwr_sum += place.like_weight_ratio;
+    }
+    total_mass_ += lwr_sum * multiplicity;
+    ++pquery_count_;
+}
+
+// =================================================================================================
+//     Mass Tree Accumulator
+// =================================================================================================
+
+void MassTreeAccumulator::begin_( PlacementTree const& tree )
+{
+    mass_tree_    = tree::convert_default_tree_to_mass_tree( tree );
+    pendant_work_ = 0.0;
+    total_mass_   = 0.0;
+}
+
+void MassTreeAccumulator::accumulate_( Pquery const& pquery )
+{
+    // Same as add_sample_to_mass_tree(), but the masses are only normalized in finish(),
+    // as the total mass is not known before.
+    double const multiplicity = total_multiplicity( pquery );
+    for( auto const& place : pquery.placements() ) {
+        auto& edge      = mass_tree_.edge_at( place.edge().index() );
+        auto& edge_data = edge.data<tree::MassTreeEdgeData>();
+
+        double const position
+            = place.proximal_length
+            / place.edge().data<PlacementEdgeData>().branch_length
+            * edge_data.branch_length;
+
+        edge_data.masses[ position ] += place.like_weight_ratio * multiplicity;
+        pendant_work_ += place.like_weight_ratio * multiplicity * place.pendant_length;
+        total_mass_   += place.like_weight_ratio * multiplicity;
+    }
+}
+
+void MassTreeAccumulator::finish_()
+{
+    if( total_mass_ > 0.0 ) {
+        tree::mass_tree_scale_masses( mass_tree_, 1.0 / total_mass_ );
+        pendant_work_ /= total_mass_;
+    }
+}
+
+// =================================================================================================
+//     Histogram Accumulator
+// =================================================================================================
+
+void PlacementHistogramAccumulator::begin_( PlacementTree const& )
+{
+    histogram_.clear();
+}
+
+void PlacementHistogramAccumulator::accumulate_( Pquery const& pquery )
+{
+    double const multiplicity = weighted_ ? total_multiplicity( pquery ) : 1.0;
+    for( auto const& place : pquery.placements() ) {
+        auto const weight = weighted_ ? place.like_weight_ratio * multiplicity : 1.0;
+        histogram_.accumulate( value_function_( place ), weight );
+    }
+}
+
+} // namespace placement
+} // namespace genesis
@@ -0,0 +1,291 @@
+#ifndef GENESIS_PLACEMENT_FUNCTION_ACCUMULATORS_H_
+#define GENESIS_PLACEMENT_FUNCTION_ACCUMULATORS_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include "genesis/placement/placement_tree.hpp"
+#include "genesis/tree/mass_tree/tree.hpp"
+#include "genesis/utils/math/histogram.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class Pquery;
+class PqueryPlacement;
+class Sample;
+
+// =================================================================================================
+//     Base Pquery Accumulator
+// =================================================================================================
+
+/**
+ * @brief Base class for computing a summary of the @link Pquery Pqueries@endlink of a Sample,
+ * one Pquery at a time.
+ *
+ * Accumulators can be used with the streaming functions of the JplaceReader, such as
+ * @link JplaceReader::from_file( std::string const&, BasePqueryAccumulator& ) const
+ * JplaceReader::from_file()@endlink, which hand each Pquery to the accumulator as soon as it is
+ * read, and then discard it. This way, the memory needed for a summary that only depends on the
+ * tree (e.g., per edge values) does not grow with the number of Pqueries. Accumulators can also
+ * be used on a Sample in memory, via accumulate_sample().
+ *
+ * The functions are called in the order begin(), accumulate() for each Pquery, and finish().
+ * Calling begin() again resets the accumulator, so that it can be used for another Sample.
+ * Derived classes implement the protected virtual functions.
+ */
+class BasePqueryAccumulator
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    BasePqueryAccumulator() = default;
+    virtual ~BasePqueryAccumulator() = default;
+
+    BasePqueryAccumulator( BasePqueryAccumulator const& ) = default;
+    BasePqueryAccumulator( BasePqueryAccumulator&& )      = default;
+
+    BasePqueryAccumulator& operator= ( BasePqueryAccumulator const& ) = default;
+    BasePqueryAccumulator& operator= ( BasePqueryAccumulator&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Accumulation
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Start a new accumulation for Pqueries that are placed on the given tree.
+     */
+    void begin( PlacementTree const& tree )
+    {
+        begin_( tree );
+    }
+
+    /**
+     * @brief Add a Pquery, whose placements are on the tree given to begin().
+     */
+    void accumulate( Pquery const& pquery )
+    {
+        accumulate_( pquery );
+    }
+
+    /**
+     * @brief Finish the accumulation, after which the results can be used.
+     */
+    void finish()
+    {
+        finish_();
+    }
+
+    // -------------------------------------------------------------------------
+    //     Virtual Functions
+    // -------------------------------------------------------------------------
+
+protected:
+
+    virtual void begin_( PlacementTree const& tree ) = 0;
+
+    virtual void accumulate_( Pquery const& pquery ) = 0;
+
+    virtual void finish_()
+    {}
+
+};
+
+// =================================================================================================
+//     Helper Functions
+// =================================================================================================
+
+/**
+ * @brief Run an accumulator on all @link Pquery Pqueries@endlink of a Sample in memory.
+ */
+void accumulate_sample( Sample const& sample, BasePqueryAccumulator& accumulator );
+
+// =================================================================================================
+//     Edge Accumulator
+// =================================================================================================
+
+/**
+ * @brief Accumulate the number and the weight of the placements per edge.
+ *
+ * The results are the same as those of placement_count_per_edge( Sample const& ) and
+ * placement_weight_per_edge( Sample const& ), that is, vectors indexed by the
+ * @link PlacementTreeEdge::index() index@endlink of the edges. Furthermore, the weight
+ * multiplied by the @link PqueryName::multiplicity multiplicities@endlink is accumulated,
+ * along with the totals.
+ */
+class EdgeAccumulator : public BasePqueryAccumulator
+{
+public:
+
+    std::vector<size_t> const& placement_counts() const
+    {
+        return counts_;
+    }
+
+    std::vector<double> const& placement_weights() const
+    {
+        return weights_;
+    }
+
+    /**
+     * @brief Sum of `like_weight_ratio` times total multiplicity of the Pquery, per edge.
+     */
+    std::vector<double> const& placement_masses() const
+    {
+        return masses_;
+    }
+
+    size_t pquery_count() const
+    {
+        return pquery_count_;
+    }
+
+    /**
+     * @brief Same as total_placement_mass_with_multiplicities( Sample const& ).
+     */
+    double total_mass() const
+    {
+        return total_mass_;
+    }
+
+protected:
+
+    void begin_( PlacementTree const& tree ) override;
+    void accumulate_( Pquery const& pquery ) override;
+
+private:
+
+    std::vector<size_t> counts_;
+    std::vector<double> weights_;
+    std::vector<double> masses_;
+    size_t              pquery_count_ = 0;
+    double              total_mass_   = 0.0;
+};
+
+// =================================================================================================
+//     Mass Tree Accumulator
+// =================================================================================================
+
+/**
+ * @brief Accumulate the placement masses on a @link tree::MassTree MassTree@endlink.
+ *
+ * After finish(), mass_tree() and pendant_work() are the same as the result of
+ * convert_to_mass_tree( Sample const& ), that is, the masses are normalized by the total
+ * placement mass (using multiplicities), up to floating point rounding.
+ */
+class MassTreeAccumulator : public BasePqueryAccumulator
+{
+public:
+
+    tree::MassTree const& mass_tree() const
+    {
+        return mass_tree_;
+    }
+
+    /**
+     * @brief Work needed to move the masses from their pendant positions to the branches.
+     */
+    double pendant_work() const
+    {
+        return pendant_work_;
+    }
+
+protected:
+
+    void begin_( PlacementTree const& tree ) override;
+    void accumulate_( Pquery const& pquery ) override;
+    void finish_() override;
+
+private:
+
+    tree::MassTree mass_tree_;
+    double         pendant_work_ = 0.0;
+    double         total_mass_   = 0.0;
+};
+
+// =================================================================================================
+//     Histogram Accumulator
+// =================================================================================================
+
+/**
+ * @brief Accumulate a value of each placement in a utils::Histogram.
+ *
+ * The histogram with its ranges is given in the constructor, along with a function that yields the
+ * value of a placement, for example its `pendant_length`. Each placement is added with its
+ * `like_weight_ratio` times the total multiplicity of its Pquery as weight, or, if
+ * `weighted == false`, is counted once.
+ */
+class PlacementHistogramAccumulator : public BasePqueryAccumulator
+{
+public:
+
+    using ValueFunction = std::function< double( PqueryPlacement const& ) >;
+
+    PlacementHistogramAccumulator(
+        utils::Histogram const& histogram,
+        ValueFunction           value_function,
+        bool                    weighted = true
+    )
+        : histogram_( histogram )
+        , value_function_( value_function )
+        , weighted_( weighted )
+    {}
+
+    utils::Histogram const& histogram() const
+    {
+        return histogram_;
+    }
+
+protected:
+
+    void begin_( PlacementTree const& tree ) override;
+    void accumulate_( Pquery const& pquery ) override;
+
+private:
+
+    utils::Histogram histogram_;
+    ValueFunction    value_function_;
+    bool             weighted_;
+};
+
+} // namespace placement
+} // namespace genesis
+
+#endif // include guard
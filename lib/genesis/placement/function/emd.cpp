@@ -32,6 +32,7 @@
 
 #include "genesis/placement/function/functions.hpp"
 #include "genesis/placement/function/helper.hpp"
+#include "genesis/placement/sample_columns.hpp"
 #include "genesis/placement/sample_set.hpp"
 #include "genesis/placement/sample.hpp"
 
@@ -45,6 +46,7 @@
 #include "genesis/utils/math/matrix.hpp"
 
 #include <cassert>
+#include <stdexcept>
 
 #ifdef GENESIS_OPENMP
 #   include <omp.h>
@@ -100,6 +102,49 @@ double add_sample_to_mass_tree(
     return pendant_work;
 }
 
+/**
+ * @brief Local helper function to copy masses from a SampleColumns to a
+ * @link tree::MassTree MassTree@endlink.
+ *
+ * Same as add_sample_to_mass_tree( Sample const&, ... ), but streams the placement columns
+ * instead of visiting each Pquery and following the edge pointers of its placements.
+ */
+double add_sample_to_mass_tree(
+    SampleColumns const& columns, double const sign, double const scaler, tree::MassTree& target
+) {
+    if( columns.edge_count() != target.edge_count() ) {
+        throw std::invalid_argument(
+            "Cannot add SampleColumns to a MassTree with a different number of edges."
+        );
+    }
+
+    double pendant_work = 0.0;
+
+    auto const& offsets      = columns.placement_offsets();
+    auto const& mults        = columns.multiplicities();
+    auto const& edge_indices = columns.edge_indices();
+    auto const& lwrs         = columns.like_weight_ratios();
+    auto const& proximals    = columns.proximal_lengths();
+    auto const& pendants     = columns.pendant_lengths();
+    auto const& branches     = columns.branch_lengths();
+
+    for( size_t q = 0; q < columns.size(); ++q ) {
+        double const mass_factor = mults[q] / scaler;
+
+        for( size_t i = offsets[q]; i < offsets[q + 1]; ++i ) {
+            auto& edge_data = target.edge_at( edge_indices[i] ).data<tree::MassTreeEdgeData>();
+
+            double const position
+                = proximals[i] / branches[ edge_indices[i] ] * edge_data.branch_length;
+
+            edge_data.masses[ position ] += sign * lwrs[i] * mass_factor;
+            pendant_work += lwrs[i] * mass_factor * pendants[i];
+        }
+    }
+
+    return pendant_work;
+}
+
 std::pair< tree::MassTree, double > convert_to_mass_tree( Sample const& sample )
 {
     auto mass_tree = tree::convert_default_tree_to_mass_tree( sample.tree() );
@@ -110,6 +155,29 @@ std::pair< tree::MassTree, double > convert_to_mass_tree( Sample const& sample )
     return { std::move( mass_tree ), pend_work };
 }
 
+std::pair< tree::MassTree, double > convert_to_mass_tree(
+    tree::Tree const&    tree,
+    SampleColumns const& columns
+) {
+    // Total mass, using the multiplicities.
+    auto const& offsets = columns.placement_offsets();
+    auto const& lwrs    = columns.like_weight_ratios();
+    double total_mass = 0.0;
+    for( size_t q = 0; q < columns.size(); ++q ) {
+        double pqry_mass = 0.0;
+        for( size_t i = offsets[q]; i < offsets[q + 1]; ++i ) {
+            pqry_mass += lwrs[i];
+        }
+        total_mass += pqry_mass * columns.multiplicities()[q];
+    }
+
+    auto mass_tree = tree::convert_default_tree_to_mass_tree( tree );
+    double const pend_work = add_sample_to_mass_tree(
+        columns, +1.0, total_mass, mass_tree
+    );
+    return { std::move( mass_tree ), pend_work };
+}
+
 std::pair<
     std::vector<tree::MassTree>,
     std::vector<double>
@@ -50,6 +50,7 @@ namespace tree {
 namespace placement {
 
     class Sample;
+    class SampleColumns;
     class SampleSet;
 
 }
@@ -69,6 +70,22 @@ namespace placement {
 
 std::pair< tree::MassTree, double > convert_to_mass_tree( Sample const& sample );
 
+/**
+ * @brief Convert the columnar representation of a Sample to a MassTree, using the given @p tree
+ * for the topology and the branch lengths of the result.
+ *
+ * The @p tree has to be the tree of the Sample that the SampleColumns were built from, or a tree
+ * of the same topology, such as an average branch length tree. The masses are placed at the same
+ * relative position on the edges as in the original tree.
+ *
+ * Returns the MassTree, and the work needed to move the masses from their pendant positions
+ * to the branches.
+ */
+std::pair< tree::MassTree, double > convert_to_mass_tree(
+    tree::Tree const&    tree,
+    SampleColumns const& columns
+);
+
 std::pair< std::vector<tree::MassTree>, std::vector<double> >
 convert_to_mass_trees( SampleSet const& sample_set );
 
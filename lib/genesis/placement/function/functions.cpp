@@ -43,6 +43,7 @@
 #include <cassert>
 #include <cmath>
 #include <exception>
+#include <functional>
 #include <regex>
 #include <string>
 #include <unordered_map>
@@ -52,6 +53,33 @@
 namespace genesis {
 namespace placement {
 
+// =================================================================================================
+//     Local Helper Functions
+// =================================================================================================
+
+/**
+ * @brief Local helper function that removes the Pqueries whose @p marks are set, while keeping
+ * the order of the others.
+ */
+static void remove_marked_pqueries_( Sample& smp, std::vector<bool> const& marks )
+{
+    assert( marks.size() == smp.size() );
+    if( smp.size() == 0 ) {
+        return;
+    }
+
+    // The predicate is called on each element at its original position.
+    auto const first = &*smp.begin();
+    auto new_past_the_end = std::remove_if(
+        smp.begin(),
+        smp.end(),
+        [&] ( Pquery const& pqry ) {
+            return marks[ &pqry - first ];
+        }
+    );
+    smp.remove( new_past_the_end, smp.end() );
+}
+
 // =================================================================================================
 //     Pquery Names
 // =================================================================================================
@@ -279,6 +307,23 @@ void filter_pqueries_keeping_names( Sample& smp, std::unordered_set<std::string>
     smp.remove( new_past_the_end, smp.end() );
 }
 
+void filter_pqueries_keeping_names( Sample& smp, PqueryNameIndex const& keep_index )
+{
+    auto new_past_the_end = std::remove_if(
+        smp.begin(),
+        smp.end(),
+        [&] ( Pquery const& pqry ) {
+            for( auto const& nm : pqry.names() ) {
+                if( keep_index.has_name( nm.name ) ) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    );
+    smp.remove( new_past_the_end, smp.end() );
+}
+
 void filter_pqueries_removing_names( Sample& smp, std::string const& regex )
 {
     std::regex pattern( regex );
@@ -314,44 +359,55 @@ void filter_pqueries_removing_names( Sample& smp, std::unordered_set<std::string
     smp.remove( new_past_the_end, smp.end() );
 }
 
+void filter_pqueries_removing_names( Sample& smp, PqueryNameIndex const& remove_index )
+{
+    auto new_past_the_end = std::remove_if(
+        smp.begin(),
+        smp.end(),
+        [&] ( Pquery const& pqry ) {
+            for( auto const& nm : pqry.names() ) {
+                if( remove_index.has_name( nm.name ) ) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    );
+    smp.remove( new_past_the_end, smp.end() );
+}
+
 void filter_pqueries_intersecting_names( Sample& sample_1, Sample& sample_2 )
 {
     // Remove those pqueries from sample_2 which do not occur in sample_1.
-    auto names = all_pquery_names( sample_1 );
-    filter_pqueries_keeping_names( sample_2, names );
+    filter_pqueries_keeping_names( sample_2, PqueryNameIndex( sample_1 ));
 
     // And vice versa (using the names of the already smaller sample_2).
-    names = all_pquery_names( sample_2 );
-    filter_pqueries_keeping_names( sample_1, names );
+    filter_pqueries_keeping_names( sample_1, PqueryNameIndex( sample_2 ));
 }
 
 void filter_pqueries_differing_names( Sample& sample_1, Sample& sample_2 )
 {
-    // Yep, yep, this is wasteful. But it works for now.
-
-    // Get all sorted names in sample 1 ...
-    auto names_1_u = all_pquery_names( sample_1 );
-    auto names_1   = std::vector< std::string >( names_1_u.begin(), names_1_u.end() );
-    std::sort( names_1.begin(), names_1.end() );
-    names_1_u.clear();
-
-    // ... and in sample 2.
-    auto names_2_u = all_pquery_names( sample_2 );
-    auto names_2   = std::vector< std::string >( names_2_u.begin(), names_2_u.end() );
-    std::sort( names_2.begin(), names_2.end() );
-    names_2_u.clear();
-
-    // Get their intersection.
-    std::unordered_set< std::string > symdiff;
-    std::set_intersection(
-        names_1.begin(), names_1.end(),
-        names_2.begin(), names_2.end(),
-        std::inserter( symdiff, symdiff.end() )
-    );
+    // A Pquery has a name in the intersection of the names of both Samples iff it has a name
+    // that occurs in the other Sample. We first mark those in both Samples, as removing them
+    // from one Sample would change the names that the other one is checked against.
+    auto mark_common = []( Sample const& smp, PqueryNameIndex const& other_index ){
+        std::vector<bool> result( smp.size(), false );
+        for( size_t i = 0; i < smp.size(); ++i ) {
+            for( auto const& nm : smp.at(i).names() ) {
+                if( other_index.has_name( nm.name ) ) {
+                    result[i] = true;
+                    break;
+                }
+            }
+        }
+        return result;
+    };
+    auto const marks_1 = mark_common( sample_1, PqueryNameIndex( sample_2 ));
+    auto const marks_2 = mark_common( sample_2, PqueryNameIndex( sample_1 ));
 
     // Remove all intersecting elements from the sampels.
-    filter_pqueries_removing_names( sample_1, symdiff );
-    filter_pqueries_removing_names( sample_2, symdiff );
+    remove_marked_pqueries_( sample_1, marks_1 );
+    remove_marked_pqueries_( sample_2, marks_2 );
 }
 
 size_t remove_empty_pqueries( Sample& sample )
@@ -410,136 +466,173 @@ void merge_duplicates (Sample& smp)
     merge_duplicate_placements (smp);
 }
 
-void collect_duplicate_pqueries (Sample& smp)
+void collect_duplicate_pqueries( Sample& smp )
 {
     // We are looking for the transitive closure of all Pqueries that pairwise share a common name.
     // In a graph theory setting, this could be depicted as follows:
     // Each Pquery is a node, and it has an edge to other nodes iff they share a common name.
-    // For this, there exist algorithms like Floyd–Warshall. However, they are an overkill for the
-    // problem at hand, in terms of the complexity of both code and runtime requirements.
-    // From the biological data and the way Evolutionary Placement works, we do not expect to have
-    // many edges in this graph. Thus, this function uses a simpler solution: repeated search.
-    // Worst case, this needs as many iterations over all Pqueries as the longest chain of shared
-    // names. Pqueries with shared names like (a,b) (b,c) (c,d) (d,e) might need four iterations,
-    // depending on the order of those Pqueries. This is acceptable, as this case should be rare.
-
-    // Iterate as long as needed to merge all transitive connections between Pqueries that share
-    // names. We need as many iterations as the longest chain of connected Pqueries.
-    bool need_iteration = true;
-    while (need_iteration) {
-        need_iteration = false;
-
-        // A hash smp that contains the already processed names and links them to their pquery.
-        // Whenever the same name is found again, the associated placements will be copied to the
-        // stored Pquery and the then surplus Pquery will be deleted.
-        std::unordered_map<std::string, Pquery*> hash;
-
-        // This is a list of the Pquery indices that we want to delete, because their placements
-        // have been moved to other Pqueries (those, which contain the same name). We need this
-        // list as deleting from a list while iterating it is not a good idea.
-        std::vector<size_t> del;
-
-        for( size_t i = 0; i < smp.size(); ++i ) {
-            auto& pqry = smp.at(i);
-
-            // Collect the Pqueries that can be merged with the current one, because they share
-            // a common name.
-            std::unordered_set<Pquery*> merges;
-            for( auto name_it = pqry.begin_names(); name_it != pqry.end_names(); ++name_it ) {
-                auto& name = *name_it;
+    // We find the connected components of this graph in linear expected time: First, each
+    // occurrence of a name is linked to the first Pquery that has this name. This uses hash tables
+    // that are partitioned by the hash of the names, so that they can be filled in parallel.
+    // Then, a union-find over these links yields the components. Each of them is represented by
+    // its first Pquery, which collects the placements and names of the others.
+
+    auto const pquery_count = smp.size();
+
+    // Offsets of the names of each Pquery in the flat list of all names.
+    std::vector<size_t> name_offsets( pquery_count + 1, 0 );
+    for( size_t i = 0; i < pquery_count; ++i ) {
+        name_offsets[ i + 1 ] = name_offsets[ i ] + smp.at(i).name_size();
+    }
+    auto const name_count = name_offsets.back();
+
+    // Hash all names, and store their Pquery.
+    std::vector<size_t> name_hashes( name_count );
+    std::vector<size_t> name_pqueries( name_count );
+    #pragma omp parallel for
+    for( size_t i = 0; i < pquery_count; ++i ) {
+        auto const& pqry = smp.at(i);
+        std::hash<std::string> hasher;
+        for( size_t j = 0; j < pqry.name_size(); ++j ) {
+            name_hashes[   name_offsets[i] + j ] = hasher( pqry.name_at(j).name );
+            name_pqueries[ name_offsets[i] + j ] = i;
+        }
+    }
+    auto name_at = [&]( size_t k ) -> std::string const& {
+        auto const i = name_pqueries[ k ];
+        return smp.at(i).name_at( k - name_offsets[i] ).name;
+    };
+
+    // Sort the names into partitions by their hash, keeping their order within each partition.
+    size_t const partition_count = 64;
+    std::vector<size_t> partition_offsets( partition_count + 1, 0 );
+    for( auto const hash : name_hashes ) {
+        ++partition_offsets[ hash % partition_count + 1 ];
+    }
+    for( size_t p = 0; p < partition_count; ++p ) {
+        partition_offsets[ p + 1 ] += partition_offsets[ p ];
+    }
+    std::vector<size_t> partitioned_names( name_count );
+    {
+        auto cursors = partition_offsets;
+        for( size_t k = 0; k < name_count; ++k ) {
+            partitioned_names[ cursors[ name_hashes[k] % partition_count ]++ ] = k;
+        }
+    }
 
-                if (hash.count(name.name) > 0) {
-                    merges.insert(hash[name.name]);
+    // For each name, find the first Pquery with that name. Equal names are in the same partition,
+    // and as the names are processed in their order, the first one that we store is the first one
+    // in the Sample.
+    std::vector<size_t> first_pqueries( name_count );
+    #pragma omp parallel for schedule(dynamic)
+    for( size_t p = 0; p < partition_count; ++p ) {
+        std::unordered_multimap<size_t, size_t> first_names;
+        first_names.reserve( partition_offsets[ p + 1 ] - partition_offsets[ p ] );
+
+        for( size_t x = partition_offsets[ p ]; x < partition_offsets[ p + 1 ]; ++x ) {
+            auto const k     = partitioned_names[ x ];
+            auto const range = first_names.equal_range( name_hashes[ k ] );
+            auto found = name_count;
+            for( auto it = range.first; it != range.second; ++it ) {
+                if( name_at( it->second ) == name_at( k )) {
+                    found = it->second;
+                    break;
                 }
             }
-
-            if (merges.size() == 0) {
-                // All names are new, so store them in the hash smp for later.
-                // We don't need to do any merging in this case.
-                for( auto name_it = pqry.begin_names(); name_it != pqry.end_names(); ++name_it ) {
-                    auto& name = *name_it;
-
-                    // We are here because we found no pquery to merge with. This means that the
-                    // name cannot be in the hash smp already.
-                    assert(hash.count(name.name) == 0);
-
-                    // Now add it.
-                    hash[name.name] = &pqry;
-                }
+            if( found == name_count ) {
+                first_names.emplace( name_hashes[ k ], k );
+                first_pqueries[ k ] = name_pqueries[ k ];
             } else {
-                // We need merging. We will merge with only one Pquery in this iteration. If there
-                // are more than one Pqueries that we need to merge with (i.e., merges.size() > 1),
-                // we will mark that we need another iteration and do the other mergings then.
-
-                // Get the Pquery that we will merge into.
-                Pquery* merge_into = *merges.begin();
-
-                // TODO we could use move here instead of copy creating.
-
-                // Add all placements to it.
-                for( auto const& place : pqry.placements() ) {
-                    merge_into->add_placement( place );
-                }
-
-                // Add all names. This will cause doubled names, but they can be reduced later
-                // via merge_duplicate_names().
-                // We could do the check here, but this would increase complexity and gain just a
-                // bit of speed (probably).
-                for( auto const& name : pqry.names() ) {
-                    // Add the name to the Pquery.
-                    merge_into->add_name( name );
-
-                    // Also add it to the hash smp. If this was name that is responsible for the
-                    // merging (the shared name), we will replace the entry by an indentical copy.
-                    // For all other names of the current Pquery, we need this to ensure that the
-                    // next Pqueries in the loop will find it.
-                    hash[name.name] = merge_into;
-                }
-
-                // Mark the Pquery for deletion and delete its content
-                // (this is both to save memory, but also for some assertions later).
-                del.push_back(i);
-                pqry.clear();
-
-                // Check whether we need to merge with more than one Pquery, meaning that we have
-                // transitive connections. This means, we need another iteration to resolve this.
-                if (merges.size() > 1) {
-                    need_iteration = true;
-                }
+                first_pqueries[ k ] = name_pqueries[ found ];
             }
         }
+    }
+
+    // Union-find, where the root of each group is its Pquery with the smallest index.
+    std::vector<size_t> groups( pquery_count );
+    for( size_t i = 0; i < pquery_count; ++i ) {
+        groups[ i ] = i;
+    }
+    auto find_root = [&]( size_t i ){
+        while( groups[ i ] != i ) {
+            groups[ i ] = groups[ groups[ i ]];
+            i = groups[ i ];
+        }
+        return i;
+    };
+    for( size_t k = 0; k < name_count; ++k ) {
+        auto a = find_root( name_pqueries[ k ] );
+        auto b = find_root( first_pqueries[ k ] );
+        if( a < b ) {
+            std::swap( a, b );
+        }
+        groups[ a ] = b;
+    }
 
-        // Delete all Pqueries that were merged to others during this iteration.
-        // We need to do this in reverse order so that the indeces are not messed up while deleting.
-        for( auto it = del.rbegin(); it != del.rend(); ++it ) {
-            // Assert that this is an empty pquery. We cleared the ones that are marked for
-            // deletion, so in case that it is not empty, we are about to delete the wrong one!
-            assert( smp.at( *it ).placement_size() == 0 );
-            assert( smp.at( *it ).name_size()      == 0 );
+    // Move the placements and names of all Pqueries into the first Pquery of their group, in the
+    // order of the Pqueries. This will cause doubled names, but they can be reduced later via
+    // merge_duplicate_names().
+    std::vector<bool> merged( pquery_count, false );
+    for( size_t i = 0; i < pquery_count; ++i ) {
+        auto const root = find_root( i );
+        if( root == i ) {
+            continue;
+        }
 
-            smp.remove( *it );
+        auto& source = smp.at( i );
+        auto& target = smp.at( root );
+        for( auto const& place : source.placements() ) {
+            target.add_placement( place );
+        }
+        for( auto const& name : source.names() ) {
+            target.add_name( name );
         }
+        source.clear();
+        merged[ i ] = true;
     }
+    remove_marked_pqueries_( smp, merged );
 }
 
-void merge_duplicate_placements (Pquery& pquery)
+void merge_duplicate_placements( Pquery& pquery )
 {
-    // Merge the placements into this map, indexed by the edge index they belong to.
+    // Merge the placements into this list, in the order in which their edges first occur.
     // Also, store how many placements have been merged into this one.
-    std::unordered_map< size_t, std::pair< PqueryPlacement, size_t >> merge_units;
+    std::vector< std::pair< PqueryPlacement, size_t >> merge_units;
+
+    // Pqueries usually have only a few placements, for which a linear search is fastest.
+    // Only for many placements, we use a map from edge indices to the positions in the list.
+    bool const use_map = pquery.placement_size() > 16;
+    std::unordered_map< size_t, size_t > unit_positions;
 
     for( auto pit = pquery.begin_placements(); pit != pquery.end_placements(); ++pit ) {
         auto const& place = *pit;
-        auto edge_idx = place.edge().index();
+        auto const edge_idx = place.edge().index();
+
+        auto pos = merge_units.size();
+        if( use_map ) {
+            auto const it = unit_positions.find( edge_idx );
+            if( it != unit_positions.end() ) {
+                pos = it->second;
+            } else {
+                unit_positions[ edge_idx ] = pos;
+            }
+        } else {
+            for( size_t u = 0; u < merge_units.size(); ++u ) {
+                if( merge_units[ u ].first.edge().index() == edge_idx ) {
+                    pos = u;
+                    break;
+                }
+            }
+        }
 
         // For the first placement on each edge, make a copy.
-        if( merge_units.count( edge_idx ) == 0 ) {
-            merge_units[ edge_idx ] = { place, 0 };
+        if( pos == merge_units.size() ) {
+            merge_units.emplace_back( place, 0 );
 
         // For all others, add their values to the stored one.
         } else {
-            auto& merge_into = merge_units[ edge_idx ].first;
-            ++merge_units[ edge_idx ].second;
+            auto& merge_into = merge_units[ pos ].first;
+            ++merge_units[ pos ].second;
 
             merge_into.likelihood        += place.likelihood;
             merge_into.like_weight_ratio += place.like_weight_ratio;
@@ -552,10 +645,10 @@ void merge_duplicate_placements (Pquery& pquery)
     // Clear all previous placements and add back the averaged merged ones.
     pquery.clear_placements();
     for( auto& merge_unit : merge_units ) {
-        auto& place = merge_unit.second.first;
+        auto& place = merge_unit.first;
 
-        if( merge_unit.second.second > 1 ) {
-            double denom = static_cast<double>( merge_unit.second.second );
+        if( merge_unit.second > 1 ) {
+            double denom = static_cast<double>( merge_unit.second );
 
             place.likelihood        /= denom;
             place.like_weight_ratio /= denom;
@@ -570,36 +663,59 @@ void merge_duplicate_placements (Pquery& pquery)
 
 void merge_duplicate_placements( Sample& smp )
 {
-    for( auto pquery_it = smp.begin(); pquery_it != smp.end(); ++pquery_it ) {
-        merge_duplicate_placements( *pquery_it );
+    #pragma omp parallel for
+    for( size_t i = 0; i < smp.size(); ++i ) {
+        merge_duplicate_placements( smp.at(i) );
     }
 }
 
 void merge_duplicate_names( Pquery& pquery )
 {
-    // We add names to this map, indexed by their actual name string.
-    std::unordered_map<std::string, PqueryName> result;
+    // Merge the names into this list, in the order of their first occurrence. As for the
+    // placements, we use a linear search for the usual case of few names, and a map otherwise.
+    std::vector<PqueryName> result;
+    bool const use_map = pquery.name_size() > 16;
+    std::unordered_map<std::string, size_t> positions;
+
     for( auto name_it = pquery.begin_names(); name_it != pquery.end_names(); ++name_it ) {
         auto const& name = *name_it;
 
-        if( result.count( name.name ) == 0 ) {
-            result[ name.name ] = name;
+        auto pos = result.size();
+        if( use_map ) {
+            auto const it = positions.find( name.name );
+            if( it != positions.end() ) {
+                pos = it->second;
+            } else {
+                positions[ name.name ] = pos;
+            }
+        } else {
+            for( size_t r = 0; r < result.size(); ++r ) {
+                if( result[ r ].name == name.name ) {
+                    pos = r;
+                    break;
+                }
+            }
+        }
+
+        if( pos == result.size() ) {
+            result.push_back( name );
         } else {
-            result[ name.name ].multiplicity += name.multiplicity;
+            result[ pos ].multiplicity += name.multiplicity;
         }
     }
 
-    // Now delete all names and re-populate using the map.
+    // Now delete all names and re-populate using the list.
     pquery.clear_names();
     for( auto const& n : result ) {
-        pquery.add_name( n.second );
+        pquery.add_name( n );
     }
 }
 
 void merge_duplicate_names( Sample& smp )
 {
-    for( auto pquery_it = smp.begin(); pquery_it != smp.end(); ++pquery_it ) {
-        merge_duplicate_names( *pquery_it );
+    #pragma omp parallel for
+    for( size_t i = 0; i < smp.size(); ++i ) {
+        merge_duplicate_names( smp.at(i) );
     }
 }
 
@@ -31,6 +31,7 @@
  * @ingroup placement
  */
 
+#include "genesis/placement/function/name_index.hpp"
 #include "genesis/placement/sample.hpp"
 
 #include <string>
@@ -54,11 +55,15 @@ bool has_name( Pquery const& pquery, std::string const& name );
 /**
  * @brief Return true iff the given Sample contains a Pquery with a particular name, i.e.,
  * a PqueryName whose name member equals the given name.
+ *
+ * This scans all Pqueries. For many lookups, use PqueryNameIndex::has_name() instead.
  */
 bool has_name( Sample const& smp, std::string const& name );
 
 /**
  * @brief Return the first Pquery that has a particular name, or nullptr of none has.
+ *
+ * This scans all Pqueries. For many lookups, use PqueryNameIndex::find_pquery() instead.
  */
 Pquery const* find_pquery( Sample const& smp, std::string const& name );
 
@@ -196,6 +201,16 @@ void filter_pqueries_keeping_names( Sample& smp, std::string const& regex );
  */
 void filter_pqueries_keeping_names(  Sample& smp, std::unordered_set<std::string> keep_list );
 
+/**
+ * @brief Remove all @link Pquery Pqueries@endlink which do not have at least one name that also
+ * occurs in the Sample of the given PqueryNameIndex.
+ *
+ * This is the same as filter_pqueries_keeping_names( Sample&, std::unordered_set<std::string> )
+ * with all names of the other Sample as keep list, but without copying the names.
+ * The index must not refer to @p smp itself.
+ */
+void filter_pqueries_keeping_names(  Sample& smp, PqueryNameIndex const& keep_index );
+
 /**
  * @brief Remove all @link Pquery Pqueries@endlink which have at least one name that matches the given
  * regex.
@@ -217,6 +232,16 @@ void filter_pqueries_removing_names( Sample& smp, std::string const& regex );
  */
 void filter_pqueries_removing_names( Sample& smp, std::unordered_set<std::string> remove_list );
 
+/**
+ * @brief Remove all @link Pquery Pqueries@endlink which have at least one name that also occurs
+ * in the Sample of the given PqueryNameIndex.
+ *
+ * This is the same as filter_pqueries_removing_names( Sample&, std::unordered_set<std::string> )
+ * with all names of the other Sample as remove list, but without copying the names.
+ * The index must not refer to @p smp itself.
+ */
+void filter_pqueries_removing_names( Sample& smp, PqueryNameIndex const& remove_index );
+
 /**
  * @brief Remove all @link Pquery Pqueries@endlink from the two Sample%s except the ones that
  * have names in common.
@@ -291,6 +316,11 @@ void merge_duplicates( Sample& smp );
  * be doubled after this function. Also, Placements on the same edge can occur.
  * Thus, usually `merge_duplicate_names()` and `merge_duplicate_placements()` are called after
  * this function. The function merge_duplicates() does exaclty this, for convenience.
+ *
+ * The combined Pquery takes the position of the first Pquery of its group, and gets the
+ * Placements and Names of the other Pqueries of the group in their order in the Sample. The
+ * remaining Pqueries keep their order. The groups are found in linear expected time, using hash
+ * tables that are filled in parallel if OpenMP is available.
  */
 void collect_duplicate_pqueries( Sample& smp );
 
@@ -300,22 +330,29 @@ void collect_duplicate_pqueries( Sample& smp );
  *
  * The merging is done via averaging all values of the PqueryPlacement: `likelihood`,
  * `like_weight_ratio`, `proximal_length`, `pendant_length` and `parsimony`.
+ * The merged placements are ordered by the first occurrence of their edge in the Pquery.
  */
 void merge_duplicate_placements( Pquery& pquery );
 
 /**
  * @brief Call merge_duplicate_placements( Pquery& ) for each Pquery of a Sample.
+ *
+ * The Pqueries are processed in parallel if OpenMP is available.
  */
 void merge_duplicate_placements( Sample& smp );
 
 /**
  * @brief Merge all PqueryName%s that have the same `name` property into one, while adding up their
  * `multiplicity`.
+ *
+ * The merged names are ordered by their first occurrence in the Pquery.
  */
 void merge_duplicate_names( Pquery& pquery );
 
 /**
  * @brief Call `merge_duplicate_names()` for each Pquery of the Sample.
+ *
+ * The Pqueries are processed in parallel if OpenMP is available.
  */
 void merge_duplicate_names( Sample& smp );
 
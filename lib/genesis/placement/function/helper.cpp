@@ -32,6 +32,7 @@
 
 #include "genesis/placement/function/functions.hpp"
 #include "genesis/placement/pquery/plain.hpp"
+#include "genesis/placement/sample_columns.hpp"
 #include "genesis/tree/function/operators.hpp"
 #include "genesis/tree/iterator/postorder.hpp"
 #include "genesis/utils/core/logging.hpp"
@@ -196,6 +197,17 @@ utils::Matrix<size_t> placement_count_per_edge( SampleSet const& sample_set )
     return result;
 }
 
+std::vector<size_t> placement_count_per_edge( SampleColumns const& columns )
+{
+    auto result = std::vector<size_t>( columns.edge_count(), 0 );
+
+    for( auto const edge_index : columns.edge_indices() ) {
+        ++result[ edge_index ];
+    }
+
+    return result;
+}
+
 std::vector<double> placement_weight_per_edge( Sample const& sample )
 {
     auto result = std::vector<double>( sample.tree().edge_count(), 0.0 );
@@ -209,6 +221,19 @@ std::vector<double> placement_weight_per_edge( Sample const& sample )
     return result;
 }
 
+std::vector<double> placement_weight_per_edge( SampleColumns const& columns )
+{
+    auto result = std::vector<double>( columns.edge_count(), 0.0 );
+
+    auto const& edge_indices = columns.edge_indices();
+    auto const& lwrs         = columns.like_weight_ratios();
+    for( size_t i = 0; i < edge_indices.size(); ++i ) {
+        result[ edge_indices[i] ] += lwrs[i];
+    }
+
+    return result;
+}
+
 utils::Matrix<double> placement_weight_per_edge( SampleSet const& sample_set )
 {
     // Basics.
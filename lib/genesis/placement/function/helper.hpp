@@ -46,6 +46,7 @@ namespace placement {
 // =================================================================================================
 
 struct PqueryPlain;
+class SampleColumns;
 
 // =================================================================================================
 //     Helper Functions
@@ -123,6 +124,14 @@ std::vector<size_t> placement_count_per_edge( Sample const& sample );
 
 utils::Matrix<size_t> placement_count_per_edge( SampleSet const& sample_set );
 
+/**
+ * @brief Return a vector that contains the number of placements per edge, computed from the
+ * columnar representation of a Sample.
+ *
+ * This streams the edge index column of the SampleColumns, without touching the Pqueries.
+ */
+std::vector<size_t> placement_count_per_edge( SampleColumns const& columns );
+
 /**
  * @brief Return a vector that contains the sum of the weights of the PqueryPlacement%s per
  * @link ::PlacementTreeEdge edge@endlink of the @link ::PlacementTree tree@endlink of the Sample.
@@ -134,6 +143,14 @@ std::vector<double> placement_weight_per_edge( Sample const& sample );
 
 utils::Matrix<double> placement_weight_per_edge( SampleSet const& sample_set );
 
+/**
+ * @brief Return a vector that contains the sum of the `like_weight_ratio`s per edge, computed
+ * from the columnar representation of a Sample.
+ *
+ * This streams the edge index and `like_weight_ratio` columns of the SampleColumns.
+ */
+std::vector<double> placement_weight_per_edge( SampleColumns const& columns );
+
 /**
  * @brief Return a plain representation of all pqueries of this map.
  *
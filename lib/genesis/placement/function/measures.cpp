@@ -35,9 +35,11 @@
 #include "genesis/placement/function/operators.hpp"
 #include "genesis/placement/placement_tree.hpp"
 #include "genesis/placement/pquery/plain.hpp"
+#include "genesis/placement/sample_columns.hpp"
 #include "genesis/placement/sample_set.hpp"
 #include "genesis/placement/sample.hpp"
 
+#include "genesis/tree/default/distance_oracle.hpp"
 #include "genesis/tree/default/distances.hpp"
 #include "genesis/tree/function/distances.hpp"
 #include "genesis/tree/function/operators.hpp"
@@ -56,6 +58,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <map>
 #include <stdexcept>
 
@@ -74,10 +77,15 @@ namespace placement {
 //     Helper Method pquery_distance
 // =================================================================================================
 
-double pquery_distance (
+/**
+ * @brief Local helper that implements pquery_distance() for any type of @p node_distances that
+ * offers an `operator()( size_t, size_t )` lookup of node distances.
+ */
+template< class NodeDistances >
+static double pquery_distance_(
     const PqueryPlain&            pqry_a,
     const PqueryPlain&            pqry_b,
-    const utils::Matrix<double>&  node_distances,
+    NodeDistances const&          node_distances,
     bool                          with_pendant_length
 ) {
     double sum = 0.0;
@@ -123,10 +131,32 @@ double pquery_distance (
     return sum;
 }
 
-double placement_distance(
+double pquery_distance (
+    const PqueryPlain&            pqry_a,
+    const PqueryPlain&            pqry_b,
+    const utils::Matrix<double>&  node_distances,
+    bool                          with_pendant_length
+) {
+    return pquery_distance_( pqry_a, pqry_b, node_distances, with_pendant_length );
+}
+
+double pquery_distance (
+    const PqueryPlain&              pqry_a,
+    const PqueryPlain&              pqry_b,
+    tree::NodeDistanceOracle const& node_distances,
+    bool                            with_pendant_length
+) {
+    return pquery_distance_( pqry_a, pqry_b, node_distances, with_pendant_length );
+}
+
+/**
+ * @brief Local helper that implements placement_distance() for any type of @p node_distances.
+ */
+template< class NodeDistances >
+static double placement_distance_(
     PqueryPlacement const& place_a,
     PqueryPlacement const& place_b,
-    utils::Matrix<double> const& node_distances
+    NodeDistances const&   node_distances
 ) {
     double pp, pd, dp, dist;
 
@@ -168,6 +198,22 @@ double placement_distance(
     return dist;
 }
 
+double placement_distance(
+    PqueryPlacement const& place_a,
+    PqueryPlacement const& place_b,
+    utils::Matrix<double> const& node_distances
+) {
+    return placement_distance_( place_a, place_b, node_distances );
+}
+
+double placement_distance(
+    PqueryPlacement const& place_a,
+    PqueryPlacement const& place_b,
+    tree::NodeDistanceOracle const& node_distances
+) {
+    return placement_distance_( place_a, place_b, node_distances );
+}
+
 // =================================================================================================
 //     Expected Distance between Placement Locations
 // =================================================================================================
@@ -175,9 +221,10 @@ double placement_distance(
 /**
  * @brief Local helper function to calculate the expected_distance_between_placement_locations().
  */
-double expected_distance_between_placement_locations(
+template< class NodeDistances >
+static double expected_distance_between_placement_locations_(
     Pquery const& pquery,
-    utils::Matrix<double> const& node_distances
+    NodeDistances const& node_distances
 ) {
     double result = 0.0;
 
@@ -186,7 +233,7 @@ double expected_distance_between_placement_locations(
             auto const& place_i = pquery.placement_at(i);
             auto const& place_j = pquery.placement_at(j);
 
-            auto dist = placement_distance( place_i, place_j, node_distances );
+            auto dist = placement_distance_( place_i, place_j, node_distances );
             result += place_i.like_weight_ratio * place_j.like_weight_ratio * dist;
         }
     }
@@ -195,8 +242,8 @@ double expected_distance_between_placement_locations(
 
 double expected_distance_between_placement_locations( Sample const& sample, Pquery const& pquery )
 {
-    auto node_distances = node_branch_length_distance_matrix( sample.tree() );
-    return expected_distance_between_placement_locations( pquery, node_distances );
+    auto const node_distances = tree::NodeDistanceOracle( sample.tree() );
+    return expected_distance_between_placement_locations_( pquery, node_distances );
 }
 
 double edpl( Sample const& sample, Pquery const& pquery )
@@ -206,23 +253,238 @@ double edpl( Sample const& sample, Pquery const& pquery )
 
 std::vector<double> expected_distance_between_placement_locations( Sample const& sample )
 {
-    // Prepare result (facilitate copy elision).
-    std::vector<double> result;
-    result.reserve( sample.size() );
+    // Get an oracle for the dists between all nodes of the tree, and stream the placements in columns.
+    auto const node_distances = tree::NodeDistanceOracle( sample.tree() );
+    return expected_distance_between_placement_locations( SampleColumns( sample ), node_distances );
+}
 
-    // Get pairwise dists between all nodes of the tree.
-    auto node_distances = node_branch_length_distance_matrix( sample.tree() );
+std::vector<double> edpl( Sample const& sample )
+{
+    return expected_distance_between_placement_locations( sample );
+}
 
-    // Fill result vector.
-    for( auto const& pquery : sample ) {
-        result.push_back( expected_distance_between_placement_locations( pquery, node_distances ));
+/**
+ * @brief Local helper that implements the EDPL kernel on SampleColumns for any type of
+ * @p node_distances. The caller has to check that the distances fit the columns.
+ */
+template< class NodeDistances >
+static std::vector<double> expected_distance_between_placement_locations_(
+    SampleColumns const& columns,
+    NodeDistances const& node_distances
+) {
+    auto const& offsets      = columns.placement_offsets();
+    auto const& edge_indices = columns.edge_indices();
+    auto const& lwrs         = columns.like_weight_ratios();
+    auto const& proximals    = columns.proximal_lengths();
+    auto const& branches     = columns.branch_lengths();
+    auto const& primaries    = columns.primary_node_indices();
+    auto const& secondaries  = columns.secondary_node_indices();
+
+    // Same cases as in placement_distance(), but using the columns instead of the edge pointers.
+    auto distance = [&]( size_t a, size_t b ){
+        auto const edge_a = edge_indices[a];
+        auto const edge_b = edge_indices[b];
+        if( edge_a == edge_b ) {
+            return std::abs( proximals[a] - proximals[b] );
+        }
+
+        double const pp = proximals[a]
+            + node_distances( primaries[ edge_a ], primaries[ edge_b ] )
+            + proximals[b];
+        double const pd = proximals[a]
+            + node_distances( primaries[ edge_a ], secondaries[ edge_b ] )
+            + branches[ edge_b ] - proximals[b];
+        double const dp = branches[ edge_a ] - proximals[a]
+            + node_distances( secondaries[ edge_a ], primaries[ edge_b ] )
+            + proximals[b];
+        return std::min( pp, std::min( pd, dp ));
+    };
+
+    std::vector<double> result( columns.size(), 0.0 );
+    for( size_t q = 0; q < columns.size(); ++q ) {
+        double sum = 0.0;
+        for( size_t i = offsets[q]; i < offsets[q + 1]; ++i ) {
+            for( size_t j = i + 1; j < offsets[q + 1]; ++j ) {
+                sum += lwrs[i] * lwrs[j] * distance( i, j );
+            }
+        }
+        result[q] = 2 * sum;
     }
     return result;
 }
 
-std::vector<double> edpl( Sample const& sample )
+std::vector<double> expected_distance_between_placement_locations(
+    SampleColumns const&         columns,
+    utils::Matrix<double> const& node_distances
+) {
+    if(
+        node_distances.rows() != columns.node_count() ||
+        node_distances.cols() != columns.node_count()
+    ) {
+        throw std::invalid_argument(
+            "Node distance matrix does not fit the tree of the SampleColumns."
+        );
+    }
+    return expected_distance_between_placement_locations_( columns, node_distances );
+}
+
+std::vector<double> expected_distance_between_placement_locations(
+    SampleColumns const&            columns,
+    tree::NodeDistanceOracle const& node_distances
+) {
+    if( node_distances.node_count() != columns.node_count() ) {
+        throw std::invalid_argument(
+            "Node distance oracle does not fit the tree of the SampleColumns."
+        );
+    }
+    return expected_distance_between_placement_locations_( columns, node_distances );
+}
+
+std::vector<double> edpl(
+    SampleColumns const&         columns,
+    utils::Matrix<double> const& node_distances
+) {
+    return expected_distance_between_placement_locations( columns, node_distances );
+}
+
+std::vector<double> edpl(
+    SampleColumns const&            columns,
+    tree::NodeDistanceOracle const& node_distances
+) {
+    return expected_distance_between_placement_locations( columns, node_distances );
+}
+
+// =================================================================================================
+//     Pairwise Sums via Tree Dynamic Programming
+// =================================================================================================
+
+/**
+ * @brief Local helper that stores a weighted point on an edge of the tree, given by its
+ * proximal length, for the pairwise sums computed by tree_pair_distance_sums_().
+ */
+struct TreePairSumPoint_
 {
-    return expected_distance_between_placement_locations( sample );
+    double proximal_length;
+    double weight_u;
+    double weight_v;
+};
+
+/**
+ * @brief Local helper that stores the zeroth, first and second moments of the distances of a set
+ * of weighted points to a reference point in the tree, for both weights `u` and `v`.
+ */
+struct TreePairSumMoments_
+{
+    double u0 = 0.0;
+    double u1 = 0.0;
+    double u2 = 0.0;
+    double v0 = 0.0;
+    double v1 = 0.0;
+    double v2 = 0.0;
+
+    /**
+     * @brief Move the reference point by @p length away from the points.
+     */
+    void shift( double length )
+    {
+        u2 += 2.0 * length * u1 + length * length * u0;
+        u1 += length * u0;
+        v2 += 2.0 * length * v1 + length * length * v0;
+        v1 += length * v0;
+    }
+
+    /**
+     * @brief Add the @p other points, which have the same reference point, and return the
+     * contribution of all pairs between the two sets to the sums of distances and squared
+     * distances, in both directions `u`-`v` and `v`-`u`.
+     */
+    std::pair<double, double> merge( TreePairSumMoments_ const& other )
+    {
+        // The distance between two points of the two sets is the sum of their distances to the
+        // common reference point. Expanding the (squared) sum yields products of the moments.
+        auto const sum_1
+            = u1 * other.v0 + u0 * other.v1
+            + other.u1 * v0 + other.u0 * v1
+        ;
+        auto const sum_2
+            = u2 * other.v0 + 2.0 * u1 * other.v1 + u0 * other.v2
+            + other.u2 * v0 + 2.0 * other.u1 * v1 + other.u0 * v2
+        ;
+
+        u0 += other.u0;
+        u1 += other.u1;
+        u2 += other.u2;
+        v0 += other.v0;
+        v1 += other.v1;
+        v2 += other.v2;
+        return { sum_1, sum_2 };
+    }
+};
+
+/**
+ * @brief Local helper that calculates the sums \f$ \sum_{a,b} u_a v_b d(a,b) \f$ and
+ * \f$ \sum_{a,b} u_a v_b d(a,b)^2 \f$ over all ordered pairs of points on the tree, where
+ * \f$ d(a,b) \f$ is the branch length distance between the points.
+ *
+ * The @p edge_points are indexed by edge index, and are sorted by this function. The branch
+ * lengths are taken from the @p tree. The function runs a postorder traversal that moves the
+ * moments of all points in a subtree up to its root, and sums up the contributions of each pair
+ * of points at their lowest common ancestor, so that it runs in linear time (plus the sorting of
+ * points on each edge), instead of the quadratic time needed to evaluate each pair.
+ */
+static std::pair<double, double> tree_pair_distance_sums_(
+    PlacementTree const&                          tree,
+    std::vector<std::vector<TreePairSumPoint_>>&  edge_points
+) {
+    assert( edge_points.size() == tree.edge_count() );
+
+    double sum_1 = 0.0;
+    double sum_2 = 0.0;
+    auto add_sums = [&]( std::pair<double, double> const& sums ){
+        sum_1 += sums.first;
+        sum_2 += sums.second;
+    };
+
+    // Moments of all points below each node, with the node as reference point.
+    auto node_moments = std::vector<TreePairSumMoments_>( tree.node_count() );
+
+    for( auto it : postorder( tree )) {
+        // The root has no edge to move its moments along.
+        if( it.is_last_iteration() ) {
+            continue;
+        }
+
+        auto const& edge   = it.edge();
+        auto const  length = edge.data<PlacementEdgeData>().branch_length;
+        assert( edge.secondary_node().index() == it.node().index() );
+
+        // Walk the edge from its lower (secondary) node towards the upper (primary) one,
+        // and add the points on the edge as we meet them.
+        auto& points = edge_points[ edge.index() ];
+        std::sort( points.begin(), points.end(),
+            []( TreePairSumPoint_ const& lhs, TreePairSumPoint_ const& rhs ){
+                return lhs.proximal_length > rhs.proximal_length;
+            }
+        );
+
+        auto moments = node_moments[ edge.secondary_node().index() ];
+        double position = 0.0;
+        for( auto const& point : points ) {
+            auto const distal = std::min( std::max( length - point.proximal_length, position ), length );
+            moments.shift( distal - position );
+            position = distal;
+
+            TreePairSumMoments_ point_moments;
+            point_moments.u0 = point.weight_u;
+            point_moments.v0 = point.weight_v;
+            add_sums( moments.merge( point_moments ));
+        }
+        moments.shift( length - position );
+
+        add_sums( node_moments[ edge.primary_node().index() ].merge( moments ));
+    }
+
+    return { sum_1, sum_2 };
 }
 
 // =================================================================================================
@@ -238,29 +500,57 @@ double pairwise_distance (
         throw std::invalid_argument("__FUNCTION__: Incompatible trees.");
     }
 
-    // Init.
-    double sum = 0.0;
-
-    // Create PqueryPlain objects for every placement and copy all interesting data into it.
-    // This way, we won't have to do all the pointer dereferencing during the actual calculations,
-    // and furthermore, the data is close in memory. this gives a tremendous speedup!
-    std::vector<PqueryPlain> pqueries_a = plain_queries( smp_a );
-    std::vector<PqueryPlain> pqueries_b = plain_queries( smp_b );
-
-    // Calculate a matrix containing the pairwise distance between all nodes. This way, we
-    // do not need to search a path between placements every time. We use the tree of the first smp
-    // here, ignoring branch lengths on tree b.
+    // The sum of the weighted distances between all pairs of placements of the two samples is
+    // computed in linear time by a tree dynamic programming, where the placements of smp_a carry
+    // the weight u, and the ones of smp_b the weight v. We use the tree of the first smp here,
+    // ignoring branch lengths on tree b. The placements of smp_b are hence moved to the same
+    // relative position on the edges of tree a, as done by Sample::add( Pquery const& ).
     // FIXME this might be made better by using average or so in the future.
-    auto node_distances = node_branch_length_distance_matrix(smp_a.tree());
-
-    for (const PqueryPlain& pqry_a : pqueries_a) {
-        for (const PqueryPlain& pqry_b : pqueries_b) {
-            sum += pquery_distance(pqry_a, pqry_b, node_distances, with_pendant_length);
+    auto edge_points = std::vector<std::vector<TreePairSumPoint_>>( smp_a.tree().edge_count() );
+    double mass_a    = 0.0;
+    double mass_b    = 0.0;
+    double pendant_a = 0.0;
+    double pendant_b = 0.0;
+
+    for( auto const& pqry : smp_a.pqueries() ) {
+        for( auto const& place : pqry.placements() ) {
+            edge_points[ place.edge().index() ].push_back({
+                place.proximal_length, place.like_weight_ratio, 0.0
+            });
+            mass_a    += place.like_weight_ratio;
+            pendant_a += place.like_weight_ratio * place.pendant_length;
         }
     }
+    auto const& tree_a = smp_a.tree();
+    for( auto const& pqry : smp_b.pqueries() ) {
+        for( auto const& place : pqry.placements() ) {
+            auto const edge_index = place.edge().index();
+            auto const length_a   = tree_a.edge_at( edge_index ).data<PlacementEdgeData>().branch_length;
+            auto const length_b   = place.edge().data<PlacementEdgeData>().branch_length;
+
+            auto proximal = place.proximal_length;
+            if( length_b > 0.0 && length_a != length_b ) {
+                proximal *= length_a / length_b;
+            }
+            edge_points[ edge_index ].push_back({
+                proximal, 0.0, place.like_weight_ratio
+            });
+            mass_b    += place.like_weight_ratio;
+            pendant_b += place.like_weight_ratio * place.pendant_length;
+        }
+    }
+
+    // Only pairs with one placement of each sample have a non-zero product of weights, in either
+    // order of the pair, so the directed sum counts each of them exactly once.
+    double sum = tree_pair_distance_sums_( tree_a, edge_points ).first;
+
+    // The pendant lengths are added to each pair, so that their sum is independent of the tree.
+    if( with_pendant_length ) {
+        sum += pendant_a * mass_b + mass_a * pendant_b;
+    }
 
     // Return normalized value.
-    return sum / total_placement_mass( smp_a ) / total_placement_mass( smp_b );
+    return sum / mass_a / mass_b;
 }
 
 // =================================================================================================
@@ -277,7 +567,7 @@ double pairwise_distance (
 double variance_partial (
     const PqueryPlain&              pqry_a,
     const std::vector<PqueryPlain>& pqrys_b,
-    const utils::Matrix<double>&    node_distances,
+    const tree::NodeDistanceOracle& node_distances,
     bool                            with_pendant_length
 ) {
     double partial = 0.0;
@@ -307,7 +597,7 @@ void variance_thread (
     const int                       offset,
     const int                       incr,
     const std::vector<PqueryPlain>* pqrys,
-    const utils::Matrix<double>*    node_distances,
+    const tree::NodeDistanceOracle* node_distances,
     double*                         partial,
     bool                            with_pendant_length
 ) {
@@ -327,6 +617,64 @@ void variance_thread (
     *partial = tmp_partial;
 }
 
+/**
+ * @brief Internal function that calculates the sum of squared distances for the variance in
+ * linear time, for the case that each pquery has at most one placement.
+ *
+ * In that case, the distance between two pqueries is \f$ w_a w_b ( d_{ab} + p_a + p_b ) \f$, with
+ * the weights \f$ w \f$, the distance \f$ d_{ab} \f$ between the placements, and the pendant
+ * lengths \f$ p \f$ (if used). Its square expands into sums over all pairs that can be obtained
+ * from tree_pair_distance_sums_() and from totals of the weights.
+ * This function is intended to be called by variance() -- it is not a stand-alone function.
+ */
+static double variance_tree_sum_(
+    const Sample& smp,
+    bool          with_pendant_length
+) {
+    // Squared weights of the pairs, as those are squared along with the distance.
+    // For the pendant lengths, we also need the weights times the pendant length.
+    auto edge_points    = std::vector<std::vector<TreePairSumPoint_>>( smp.tree().edge_count() );
+    auto pendant_points = edge_points;
+    double weight_sum       = 0.0;
+    double pendant_sum      = 0.0;
+    double pendant_sq_sum   = 0.0;
+    double pendant_self_sum = 0.0;
+
+    for( auto const& pqry : smp.pqueries() ) {
+        if( pqry.placement_size() == 0 ) {
+            continue;
+        }
+        assert( pqry.placement_size() == 1 );
+
+        auto const& place  = pqry.placement_at(0);
+        auto const  weight = place.like_weight_ratio * place.like_weight_ratio;
+        auto const  edge   = place.edge().index();
+        edge_points[ edge ].push_back({ place.proximal_length, weight, weight });
+
+        if( with_pendant_length ) {
+            auto const pendant = place.pendant_length;
+            pendant_points[ edge ].push_back({ place.proximal_length, weight * pendant, weight });
+            weight_sum       += weight;
+            pendant_sum      += weight * pendant;
+            pendant_sq_sum   += weight * pendant * pendant;
+            pendant_self_sum += weight * weight * pendant * pendant;
+        }
+    }
+
+    // Sum over all ordered pairs of pqueries of their squared placement distance.
+    double sum = tree_pair_distance_sums_( smp.tree(), edge_points ).second;
+
+    // Add the mixed and squared terms of the pendant lengths, again for ordered pairs.
+    if( with_pendant_length ) {
+        sum += 4.0 * tree_pair_distance_sums_( smp.tree(), pendant_points ).first;
+        sum += 2.0 * ( pendant_sq_sum * weight_sum - pendant_self_sum );
+        sum += 2.0 * ( pendant_sum * pendant_sum - pendant_self_sum );
+    }
+
+    // Each unordered pair of pqueries was counted twice.
+    return sum / 2.0;
+}
+
 double variance(
     const Sample& smp,
     bool          with_pendant_length
@@ -334,14 +682,29 @@ double variance(
     // Init.
     double variance = 0.0;
 
+    // If every pquery has at most one placement, the squared pquery distances are sums over
+    // pairs of placements, which we can compute in linear time. Otherwise, the squares of the
+    // weighted sums over all placements of two pqueries do not decompose along the tree,
+    // and we need to evaluate every pair of pqueries.
+    bool const single_placements = std::all_of(
+        smp.pqueries().begin(), smp.pqueries().end(),
+        []( Pquery const& pqry ){
+            return pqry.placement_size() <= 1;
+        }
+    );
+    if( single_placements ) {
+        auto const mass = total_placement_mass( smp );
+        return (( variance_tree_sum_( smp, with_pendant_length ) / mass ) / mass );
+    }
+
     // Create PqueryPlain objects for every placement and copy all interesting data into it.
     // This way, we won't have to do all the pointer dereferencing during the actual calculations,
     // and furthermore, the data is close in memory. This gives a tremendous speedup!
     std::vector<PqueryPlain> vd_pqueries = plain_queries( smp );
 
-    // Also, calculate a matrix containing the pairwise distance between all nodes. this way, we
+    // Also, build an oracle for the pairwise distance between all nodes. this way, we
     // do not need to search a path between placements every time.
-    auto node_distances = node_branch_length_distance_matrix(smp.tree());
+    auto const node_distances = tree::NodeDistanceOracle( smp.tree() );
 
 #ifdef GENESIS_PTHREADS
 
@@ -46,6 +46,7 @@ namespace genesis {
 namespace placement {
 
     class Sample;
+    class SampleColumns;
     class SampleSet;
     class PlacementTreeEdgeData;
     class PlacementTreeNodeData;
@@ -55,6 +56,12 @@ namespace placement {
 
 }
 
+namespace tree {
+
+    class NodeDistanceOracle;
+
+}
+
 namespace utils {
 
     template<typename T>
@@ -109,7 +116,9 @@ namespace placement {
  * To speed this up, we instead use a distance matrix that is calculated in the beginning of any
  * algorithm using this method and contains the pairwise distances between all nodes of the tree.
  * Using this, we do not need to find paths between placements, but simply go to the nodes at the
- * end of the branches of the placements and do a lookup for those nodes.
+ * end of the branches of the placements and do a lookup for those nodes. For large trees,
+ * a tree::NodeDistanceOracle can be used instead of the matrix, which offers the same constant
+ * time lookups, but only needs linear memory.
  *
  * With this technique, we can calculate the distances between the placements for all
  * three cases (promixal-promixal, proximal-distal and distal-proximal) cheaply. The wanted distance
@@ -126,12 +135,29 @@ double pquery_distance (
     bool                   with_pendant_length = false
 );
 
+/**
+ * @brief Calculate the pquery_distance() using a tree::NodeDistanceOracle instead of a distance
+ * matrix for the node distances.
+ */
+double pquery_distance (
+    const PqueryPlain&              pqry_a,
+    const PqueryPlain&              pqry_b,
+    tree::NodeDistanceOracle const& node_distances,
+    bool                            with_pendant_length = false
+);
+
 double placement_distance(
     PqueryPlacement const& place_a,
     PqueryPlacement const& place_b,
     utils::Matrix<double> const& node_distances
 );
 
+double placement_distance(
+    PqueryPlacement const& place_a,
+    PqueryPlacement const& place_b,
+    tree::NodeDistanceOracle const& node_distances
+);
+
 // -------------------------------------------------------------------------------------------------
 //     Expected Distance between Placement Locations
 // -------------------------------------------------------------------------------------------------
@@ -167,6 +193,54 @@ std::vector<double> expected_distance_between_placement_locations( Sample const&
  */
 std::vector<double> edpl(                                          Sample const& sample );
 
+/**
+ * @brief Calculate the @link
+ * expected_distance_between_placement_locations( Sample const&, Pquery const& )
+ * expected_distance_between_placement_locations()@endlink for all Pqueries of the columnar
+ * representation of a Sample.
+ *
+ * The @p node_distances have to be the pairwise distances between the nodes of the tree that the
+ * SampleColumns were built from, as obtained from node_branch_length_distance_matrix().
+ */
+std::vector<double> expected_distance_between_placement_locations(
+    SampleColumns const&         columns,
+    utils::Matrix<double> const& node_distances
+);
+
+/**
+ * @brief Shortcut alias for @link expected_distance_between_placement_locations(
+ * SampleColumns const&, utils::Matrix<double> const& )
+ * expected_distance_between_placement_locations()@endlink.
+ */
+std::vector<double> edpl(
+    SampleColumns const&         columns,
+    utils::Matrix<double> const& node_distances
+);
+
+/**
+ * @brief Calculate the @link expected_distance_between_placement_locations(
+ * SampleColumns const&, utils::Matrix<double> const& )
+ * expected_distance_between_placement_locations()@endlink for all Pqueries of the columnar
+ * representation of a Sample, using a tree::NodeDistanceOracle for the node distances.
+ *
+ * This avoids the quadratic memory of the full node distance matrix, and is what
+ * expected_distance_between_placement_locations( Sample const& ) uses internally.
+ */
+std::vector<double> expected_distance_between_placement_locations(
+    SampleColumns const&            columns,
+    tree::NodeDistanceOracle const& node_distances
+);
+
+/**
+ * @brief Shortcut alias for @link expected_distance_between_placement_locations(
+ * SampleColumns const&, tree::NodeDistanceOracle const& )
+ * expected_distance_between_placement_locations()@endlink.
+ */
+std::vector<double> edpl(
+    SampleColumns const&            columns,
+    tree::NodeDistanceOracle const& node_distances
+);
+
 // -------------------------------------------------------------------------------------------------
 //     Pairwise Distance
 // -------------------------------------------------------------------------------------------------
@@ -177,7 +251,12 @@ std::vector<double> edpl(                                          Sample const&
  * This method calculates the distance between two Sample%s as the normalized sum of the distances
  * between all pairs of @link Pquery Pqueries @endlink in the Sample. It is similar to the
  * variance() calculation, which calculates this sum for the squared distances between all Pqueries
- * of one Sample.
+ * of one Sample. The sum is computed in linear time via a dynamic programming on the tree.
+ *
+ * The distances are measured on the branch lengths of the tree of @p smp_a. If the tree of
+ * @p smp_b has different branch lengths, its placements are positioned at the same relative
+ * position on the respective edge of the tree of @p smp_a, that is, their `proximal_length` is
+ * scaled by the ratio of the two branch lengths.
  *
  * @param  smp_a               First Sample to which the distances shall be calculated to.
  * @param  smp_b               Second Sample to which the distances shall be calculated to.
@@ -228,6 +307,10 @@ double pairwise_distance (
  * number will be equal to the number of pqueries (and thus be equal to the usual case of using the
  * number of elements). However, as this is not required (placements with small ratio can be
  * dropped, so that their sum per pquery is less than 1.0), we cannout simply use the count.
+ *
+ * If each Pquery has at most one placement, the sum is computed in linear time via a dynamic
+ * programming on the tree. Otherwise, all pairs of Pqueries need to be evaluated, which takes
+ * quadratic time.
  */
 double variance (
     const Sample& smp,
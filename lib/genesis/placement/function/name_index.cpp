@@ -0,0 +1,178 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include "genesis/placement/function/name_index.hpp"
+
+#include "genesis/placement/function/functions.hpp"
+#include "genesis/placement/pquery.hpp"
+#include "genesis/placement/sample.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Constructors
+// =================================================================================================
+
+PqueryNameIndex::PqueryNameIndex( Sample const& sample )
+{
+    rebuild( sample );
+}
+
+// =================================================================================================
+//     Modifiers
+// =================================================================================================
+
+void PqueryNameIndex::rebuild( Sample const& sample )
+{
+    sample_       = &sample;
+    pquery_count_ = 0;
+    name_count_   = 0;
+    slots_.clear();
+    update();
+}
+
+void PqueryNameIndex::update()
+{
+    if( ! sample_ ) {
+        throw std::runtime_error( "Cannot update a PqueryNameIndex that has no Sample." );
+    }
+    if( sample_->size() < pquery_count_ ) {
+        rebuild( *sample_ );
+        return;
+    }
+
+    std::hash<std::string> hasher;
+    for( size_t i = pquery_count_; i < sample_->size(); ++i ) {
+        for( auto const& name : sample_->at(i).names() ) {
+            insert_( hasher( name.name ), name.name, i );
+        }
+    }
+    pquery_count_ = sample_->size();
+}
+
+// =================================================================================================
+//     Lookup
+// =================================================================================================
+
+bool PqueryNameIndex::has_name( std::string const& name ) const
+{
+    return sample_ && pquery_index( name ) < sample_->size();
+}
+
+size_t PqueryNameIndex::pquery_index( std::string const& name ) const
+{
+    if( ! sample_ ) {
+        return 0;
+    }
+    auto const pos = find_slot_( std::hash<std::string>()( name ), name );
+    if( slots_.empty() || slots_[ pos ].pquery == 0 ) {
+        return sample_->size();
+    }
+    return slots_[ pos ].pquery - 1;
+}
+
+Pquery const* PqueryNameIndex::find_pquery( std::string const& name ) const
+{
+    auto const index = pquery_index( name );
+    if( ! sample_ || index >= sample_->size() ) {
+        return nullptr;
+    }
+    return &sample_->at( index );
+}
+
+// =================================================================================================
+//     Internal Functions
+// =================================================================================================
+
+size_t PqueryNameIndex::find_slot_( size_t hash, std::string const& name ) const
+{
+    if( slots_.empty() ) {
+        return 0;
+    }
+
+    // Linear probing. Each name has one slot, so we can stop at the first verified match.
+    // The table always has empty slots, so this terminates.
+    auto const mask = slots_.size() - 1;
+    auto pos = hash & mask;
+    while( slots_[ pos ].pquery != 0 ) {
+        auto const& slot = slots_[ pos ];
+        if( slot.hash == hash && placement::has_name( sample_->at( slot.pquery - 1 ), name )) {
+            break;
+        }
+        pos = ( pos + 1 ) & mask;
+    }
+    return pos;
+}
+
+void PqueryNameIndex::insert_( size_t hash, std::string const& name, size_t pquery_index )
+{
+    // Pqueries are inserted in their order in the Sample, so if the name is already there,
+    // it belongs to an earlier Pquery, which is the one we want to find.
+    auto pos = find_slot_( hash, name );
+    if( ! slots_.empty() && slots_[ pos ].pquery != 0 ) {
+        return;
+    }
+
+    // Keep at most half of the slots used.
+    if( 2 * ( name_count_ + 1 ) > slots_.size() ) {
+        grow_();
+        pos = find_slot_( hash, name );
+    }
+    slots_[ pos ].hash   = hash;
+    slots_[ pos ].pquery = pquery_index + 1;
+    ++name_count_;
+}
+
+void PqueryNameIndex::grow_()
+{
+    // The size is always a power of two, so that the hash can be masked.
+    // The names in the old table are distinct, so they can be placed without comparing them.
+    auto old_slots = std::move( slots_ );
+    slots_ = std::vector<Slot>( std::max< size_t >( 16, 2 * old_slots.size() ));
+    auto const mask = slots_.size() - 1;
+    for( auto const& slot : old_slots ) {
+        if( slot.pquery == 0 ) {
+            continue;
+        }
+        auto pos = slot.hash & mask;
+        while( slots_[ pos ].pquery != 0 ) {
+            pos = ( pos + 1 ) & mask;
+        }
+        slots_[ pos ] = slot;
+    }
+}
+
+} // namespace placement
+} // namespace genesis
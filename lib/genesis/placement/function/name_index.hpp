@@ -0,0 +1,183 @@
+#ifndef GENESIS_PLACEMENT_FUNCTION_NAME_INDEX_H_
+#define GENESIS_PLACEMENT_FUNCTION_NAME_INDEX_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class Pquery;
+class Sample;
+
+// =================================================================================================
+//     Pquery Name Index
+// =================================================================================================
+
+/**
+ * @brief Hash index from the @link PqueryName::name names@endlink of the
+ * @link Pquery Pqueries@endlink of a Sample to the Pqueries, for lookups in constant time.
+ *
+ * The functions find_pquery( Sample const&, std::string const& ) and
+ * has_name( Sample const&, std::string const& ) scan all Pqueries of a Sample. When many names
+ * have to be looked up, it is thus faster to build this index once, and use its functions instead.
+ *
+ * The index does not copy the names. Instead, it stores one entry per distinct name, consisting of
+ * its hash and the index of the first Pquery with that name, and compares the names in the Sample
+ * when looking them up. It hence needs a few bytes per name, and the Sample has to outlive the
+ * index.
+ *
+ * When @link Pquery Pqueries@endlink are added to the end of the Sample, update() adds them to the
+ * index as well. Any other change of the Sample (removing or reordering Pqueries, or changing
+ * their names) invalidates the index, in which case rebuild() has to be called.
+ */
+class PqueryNameIndex
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    PqueryNameIndex() = default;
+
+    /**
+     * @brief Build the index for all names of a Sample.
+     */
+    explicit PqueryNameIndex( Sample const& sample );
+
+    ~PqueryNameIndex() = default;
+
+    PqueryNameIndex( PqueryNameIndex const& ) = default;
+    PqueryNameIndex( PqueryNameIndex&& )      = default;
+
+    PqueryNameIndex& operator= ( PqueryNameIndex const& ) = default;
+    PqueryNameIndex& operator= ( PqueryNameIndex&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Modifiers
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Build the index anew for all names of a Sample.
+     */
+    void rebuild( Sample const& sample );
+
+    /**
+     * @brief Add the @link Pquery Pqueries@endlink that were added to the end of the Sample since
+     * the index was built or last updated.
+     *
+     * If the Sample has fewer Pqueries than the index knows of, the index is built anew.
+     */
+    void update();
+
+    // -------------------------------------------------------------------------
+    //     Lookup
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the number of distinct names in the index.
+     */
+    size_t size() const
+    {
+        return name_count_;
+    }
+
+    /**
+     * @brief Return whether any Pquery of the Sample has the given name.
+     */
+    bool has_name( std::string const& name ) const;
+
+    /**
+     * @brief Return the index of the first Pquery in the Sample that has the given name.
+     *
+     * If no Pquery has the name, the number of Pqueries in the Sample is returned,
+     * similar to an end iterator.
+     */
+    size_t pquery_index( std::string const& name ) const;
+
+    /**
+     * @brief Return the first Pquery in the Sample that has the given name, or `nullptr` if none
+     * has.
+     *
+     * This is the same as find_pquery( Sample const&, std::string const& ), but in constant time.
+     */
+    Pquery const* find_pquery( std::string const& name ) const;
+
+    // -------------------------------------------------------------------------
+    //     Internal Functions
+    // -------------------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Entry of the hash table. Empty entries have a #pquery of `0`, so that the table can
+     * be filled with zeros; other entries store the index of the first Pquery with their name
+     * plus one.
+     */
+    struct Slot
+    {
+        size_t hash   = 0;
+        size_t pquery = 0;
+    };
+
+    /**
+     * @brief Return the position of the slot of the given name, or of the empty slot where it
+     * would be inserted.
+     */
+    size_t find_slot_( size_t hash, std::string const& name ) const;
+
+    void insert_( size_t hash, std::string const& name, size_t pquery_index );
+    void grow_();
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    Sample const*     sample_       = nullptr;
+    size_t            pquery_count_ = 0;
+    size_t            name_count_   = 0;
+    std::vector<Slot> slots_;
+};
+
+} // namespace placement
+} // namespace genesis
+
+#endif // include guard
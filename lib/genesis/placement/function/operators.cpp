@@ -89,9 +89,30 @@ bool compatible_trees( PlacementTree const& lhs, PlacementTree const& rhs )
 
 bool compatible_trees( Sample const& lhs, Sample const& rhs )
 {
+    // Samples that share their tree do not need to be compared.
+    if( &lhs.tree() == &rhs.tree() ) {
+        return true;
+    }
     return compatible_trees( lhs.tree(), rhs.tree() );
 }
 
+bool identical_trees( PlacementTree const& lhs, PlacementTree const& rhs )
+{
+    if( ! compatible_trees( lhs, rhs )) {
+        return false;
+    }
+
+    // The trees have the same edge indices, so we can simply compare the branch lengths in order.
+    for( size_t i = 0; i < lhs.edge_count(); ++i ) {
+        auto const& l_data = lhs.edge_at(i).data<PlacementEdgeData>();
+        auto const& r_data = rhs.edge_at(i).data<PlacementEdgeData>();
+        if( l_data.branch_length != r_data.branch_length ) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // =================================================================================================
 //     Conversion
 // =================================================================================================
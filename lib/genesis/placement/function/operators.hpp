@@ -85,10 +85,22 @@ bool compatible_trees( PlacementTree const& lhs, PlacementTree const& rhs );
  *
  * See
  * @link compatible_trees( PlacementTree const& lhs, PlacementTree const& rhs ) this version @endlink
- * of the function for details.
+ * of the function for details. If both Sample%s share the same tree, see Sample::shared_tree(),
+ * this is trivially the case, and the trees are not compared.
  */
 bool compatible_trees( Sample        const& lhs, Sample        const& rhs );
 
+/**
+ * @brief Return whether two PlacementTree%s are compatible, and furthermore have the same
+ * branch lengths.
+ *
+ * This is the condition for Sample%s to be able to share their tree without changing the
+ * positions of their placements, see Sample::share_tree(). See
+ * @link compatible_trees( PlacementTree const& lhs, PlacementTree const& rhs ) compatible_trees()
+ * @endlink for the other conditions.
+ */
+bool identical_trees( PlacementTree const& lhs, PlacementTree const& rhs );
+
 // =================================================================================================
 //     Conversion
 // =================================================================================================
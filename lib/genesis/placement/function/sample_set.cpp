@@ -35,7 +35,10 @@
 #include "genesis/tree/function/tree_set.hpp"
 #include "genesis/tree/tree_set.hpp"
 
+#include <algorithm>
+#include <memory>
 #include <ostream>
+#include <vector>
 
 namespace genesis {
 namespace placement {
@@ -96,6 +99,28 @@ bool all_identical_trees( SampleSet const& sset )
     return all_equal( tree_set( sset ), node_comparator, edge_comparator );
 }
 
+size_t share_identical_trees( SampleSet& sset )
+{
+    // Usually, all Samples have the same tree, so that this list stays short.
+    std::vector< std::shared_ptr<PlacementTree const> > trees;
+    for( auto& named_sample : sset ) {
+        auto& smp = named_sample.sample;
+        auto const& smp_tree = static_cast< Sample const& >( smp ).tree();
+
+        auto const it = std::find_if( trees.begin(), trees.end(),
+            [&]( std::shared_ptr<PlacementTree const> const& tree ){
+                return tree.get() == &smp_tree || identical_trees( *tree, smp_tree );
+            }
+        );
+        if( it == trees.end() ) {
+            trees.push_back( smp.shared_tree() );
+        } else {
+            smp.share_tree( *it );
+        }
+    }
+    return trees.size();
+}
+
 tree::TreeSet tree_set( SampleSet const& sset )
 {
     tree::TreeSet tset;
@@ -63,6 +63,18 @@ Sample const* find_sample( SampleSet const& sset, std::string const& name );
  */
 bool all_identical_trees( SampleSet const& sset );
 
+/**
+ * @brief Let the Sample%s of the set share their PlacementTree, where the trees are identical.
+ *
+ * Each Sample whose tree is identical to the tree of an earlier Sample in the set, as tested by
+ * identical_trees(), is changed to use the tree of that earlier Sample, see Sample::share_tree().
+ * This way, a set of Sample%s that were placed on the same reference tree only keeps one copy of
+ * the tree in memory, and compatible_trees() does not need to compare them any more.
+ *
+ * The function returns the number of different trees that are left in the set.
+ */
+size_t share_identical_trees( SampleSet& sset );
+
 /**
  * @brief Return a TreeSet containing all the trees of the SampleSet.
  */
@@ -33,6 +33,8 @@
 #include "genesis/placement/placement_tree.hpp"
 #include "genesis/utils/core/std.hpp"
 
+#include <utility>
+
 namespace genesis {
 namespace placement {
 
@@ -251,7 +253,7 @@ utils::Range<Pquery::const_iterator_names> Pquery::names() const
  */
 PqueryName& Pquery::add_name( std::string name, double multiplicity )
 {
-    names_.emplace_back( name, multiplicity );
+    names_.emplace_back( std::move( name ), multiplicity );
     return names_.back();
 }
 
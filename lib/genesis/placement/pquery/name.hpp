@@ -32,6 +32,7 @@
  */
 
 #include <string>
+#include <utility>
 
 namespace genesis {
 namespace placement {
@@ -76,7 +77,7 @@ public:
      * @brief Constructor that takes a #name and optionally a #multiplicity.
      */
     PqueryName(std::string name, double multiplicity = 1.0)
-        : name(name)
+        : name( std::move( name ))
         , multiplicity(multiplicity)
     {}
 
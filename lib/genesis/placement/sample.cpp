@@ -52,35 +52,45 @@ namespace placement {
 //     Constructor and Rule of Five
 // =================================================================================================
 
+Sample::Sample()
+    : tree_( std::make_shared<PlacementTree>() )
+{}
+
 Sample::Sample( PlacementTree const& tree )
-    : tree_( tree )
+    : tree_( std::make_shared<PlacementTree>( tree ))
 {
-    if( ! tree::tree_data_is< PlacementNodeData, PlacementEdgeData >( tree_ ) ) {
+    if( ! tree::tree_data_is< PlacementNodeData, PlacementEdgeData >( *tree_ ) ) {
         throw std::runtime_error( "Tree for constructing the Sample is no PlacementTree." );
     }
 }
 
-Sample::Sample( Sample const& other )
+Sample::Sample( std::shared_ptr<PlacementTree const> tree )
 {
-    // We need this custom ctor because the placements contain pointers to their edges.
-    // As the whole tree is copied, the pointers need to be adjusted to that new tree.
-
-    // First, use normal copy assignment for the data structures.
-    pqueries_ = other.pqueries_;
-    tree_     = other.tree_;
-    metadata  = other.metadata;
+    if( ! tree ) {
+        throw std::invalid_argument( "Tree for constructing the Sample is a null pointer." );
+    }
+    if( ! tree::tree_data_is< PlacementNodeData, PlacementEdgeData >( *tree ) ) {
+        throw std::runtime_error( "Tree for constructing the Sample is no PlacementTree." );
+    }
 
-    // Now adjust all placement to edge pointers.
-    for( auto& pqry : pqueries_ ) {
-        for( auto& place : pqry.placements() ) {
-            // Get the index using the pointer to the (still valid) old edge.
-            // (Remember: the placement is still pointing to the old edge at that point.)
-            auto index = place.edge().index();
+    // The tree is never changed while it is shared, see make_tree_unique_().
+    tree_ = std::const_pointer_cast<PlacementTree>( tree );
+}
 
-            // Now set the pointer of the placement to the edge of the new tree.
-            place.reset_edge( tree_.edge_at( index ) );
-        }
+Sample::Sample( Sample const& other )
+    : pqueries_( other.pqueries_ )
+    , metadata( other.metadata )
+{
+    // We need this custom ctor because the placements contain pointers to their edges.
+    // The whole tree is copied, even if the other Sample shares it, so that the copy is independent
+    // of the original. Sharing a tree is only done on request, see share_tree(). Hence, the
+    // pointers need to be adjusted to the new tree.
+    if( other.tree_ ) {
+        tree_ = std::make_shared<PlacementTree>( *other.tree_ );
+    } else {
+        tree_ = std::make_shared<PlacementTree>();
     }
+    move_placements_( *tree_, false );
 }
 
 Sample& Sample::operator= ( Sample const& other )
@@ -108,7 +118,7 @@ void Sample::swap( Sample& other )
 void Sample::clear()
 {
     pqueries_.clear();
-    tree_ = PlacementTree();
+    tree_ = std::make_shared<PlacementTree>();
     metadata.clear();
 }
 
@@ -118,14 +128,100 @@ void Sample::clear()
 
 PlacementTree& Sample::tree()
 {
-    return tree_;
+    make_tree_unique_();
+    return *tree_;
 }
 
 PlacementTree const& Sample::tree() const
 {
+    // A moved-from Sample does not have a tree.
+    if( ! tree_ ) {
+        static PlacementTree const empty_tree;
+        return empty_tree;
+    }
+    return *tree_;
+}
+
+std::shared_ptr<PlacementTree const> Sample::shared_tree() const
+{
+    if( ! tree_ ) {
+        return std::make_shared<PlacementTree const>();
+    }
     return tree_;
 }
 
+void Sample::share_tree( std::shared_ptr<PlacementTree const> tree )
+{
+    if( ! tree ) {
+        throw std::invalid_argument( "Cannot share a tree that is a null pointer." );
+    }
+    if( tree.get() == tree_.get() ) {
+        return;
+    }
+    auto const edge_count = tree_ ? tree_->edge_count() : 0;
+    if( tree->edge_count() != edge_count ) {
+        throw std::runtime_error( "Trees are incompatible for sharing between Samples." );
+    }
+
+    // Check all placements first, before changing any of them, so that the Sample stays
+    // unchanged if the trees turn out to be incompatible.
+    for( auto const& pqry : pqueries_ ) {
+        for( auto const& place : pqry.placements() ) {
+            auto const index = place.edge().index();
+            if( place.edge_num() != tree->edge_at( index ).data<PlacementEdgeData>().edge_num() ) {
+                throw std::runtime_error( "Trees are incompatible for sharing between Samples." );
+            }
+        }
+    }
+
+    // The tree is never changed while it is shared, see make_tree_unique_().
+    auto new_tree = std::const_pointer_cast<PlacementTree>( tree );
+    move_placements_( *new_tree, true );
+    tree_ = std::move( new_tree );
+}
+
+void Sample::make_tree_unique_()
+{
+    if( ! tree_ ) {
+        tree_ = std::make_shared<PlacementTree>();
+        return;
+    }
+    if( tree_.use_count() == 1 ) {
+        return;
+    }
+
+    // Copy the tree. It has the same edge indices, so that the placements can simply be moved
+    // to the edges of the copy.
+    auto copy = std::make_shared<PlacementTree>( *tree_ );
+    move_placements_( *copy, false );
+    tree_ = std::move( copy );
+}
+
+void Sample::move_placements_( PlacementTree& new_tree, bool adjust_lengths )
+{
+    // The edges of the new tree have already been checked to fit the placements, see share_tree().
+    // Thus, nothing in here throws, and the placements are never left in a half-moved state.
+    for( auto& pqry : pqueries_ ) {
+        for( auto& place : pqry.placements() ) {
+            // Get the index using the pointer to the (still valid) old edge.
+            // (Remember: the placement is still pointing to the old edge at that point.)
+            auto const index      = place.edge().index();
+            auto const old_length = place.edge().data<PlacementEdgeData>().branch_length;
+
+            // Now set the pointer of the placement to the edge of the new tree.
+            place.reset_edge( new_tree.edge_at( index ));
+            if( ! adjust_lengths ) {
+                continue;
+            }
+
+            auto const new_length = place.edge().data<PlacementEdgeData>().branch_length;
+            if( old_length != new_length && old_length > 0.0 ) {
+                place.proximal_length *= new_length / old_length;
+            }
+        }
+    }
+}
+
 // =================================================================================================
 //     Pquery Accessors and Modifiers
 // =================================================================================================
@@ -137,7 +233,7 @@ size_t Sample::size() const
 
 bool Sample::empty() const
 {
-    return tree_.empty() || pqueries_.empty();
+    return tree().empty() || pqueries_.empty();
 }
 
 // -------------------------------------------------------------------------
@@ -152,6 +248,9 @@ Pquery& Sample::add()
 
 Pquery& Sample::add( Pquery const& other )
 {
+    if( ! tree_ ) {
+        make_tree_unique_();
+    }
     pqueries_.push_back( other );
 
     // Adjust the edge pointers of the placements.
@@ -162,7 +261,8 @@ Pquery& Sample::add( Pquery const& other )
         auto const edge_index      = place.edge().index();
         auto const old_edge_num    = old_edge_data.edge_num();
         auto const rel_pos         = place.proximal_length / old_edge_data.branch_length;
-        place.reset_edge( tree().edge_at( edge_index ));
+        // Use the tree directly, as only the pointer is set, and the tree is not changed.
+        place.reset_edge( tree_->edge_at( edge_index ));
 
         // Now the placement points to the new edge. We can thus check if this one still has the
         // same edge_num as the old edge.
@@ -64,6 +64,16 @@ namespace placement {
  *     http://journals.plos.org/plosone/article?id=10.1371/journal.pone.0031009
  *
  * This class and other related classes are modeled after this standard.
+ *
+ * The PlacementTree is held via a shared pointer, so that several Sample%s can share the same
+ * reference tree. Copies of a Sample get their own copy of the tree. Sharing is only done on
+ * request: shared_tree() and share_tree() allow to explicitly share a tree between Sample%s,
+ * for example for all Sample%s of a SampleSet that were placed on the same reference tree.
+ * A shared tree is treated as immutable: The non-const tree() accessor first makes a copy of the
+ * tree for this Sample if other owners of the tree exist (copy-on-write), and adjusts the
+ * PqueryPlacement%s to point to the edges of that copy. Note that the edges obtained via
+ * PqueryPlacement::edge() of a Sample with a shared tree point into that shared tree; they must
+ * not be used to change the tree. Use tree() instead.
  */
 class Sample
 {
@@ -84,7 +94,7 @@ public:
     /**
      * @brief Default constructor.
      */
-    Sample() = default;
+    Sample();
 
     /**
      * @brief Constructor taking a reference tree.
@@ -94,8 +104,20 @@ public:
      */
     Sample( PlacementTree const& tree );
 
+    /**
+     * @brief Constructor taking a reference tree that is shared with other owners.
+     *
+     * The tree is not copied; instead, it is copied on the first non-const access via tree(), as
+     * long as it is still shared. Apart from that, the same requirements as for
+     * Sample( PlacementTree const& ) apply.
+     */
+    Sample( std::shared_ptr<PlacementTree const> tree );
+
     /**
      * @brief Copy constructor.
+     *
+     * The copy gets its own copy of the PlacementTree, even if the original shares its tree with
+     * other Sample%s. Use share_tree() to explicitly share the tree instead.
      */
     Sample( Sample const& );
 
@@ -138,6 +160,11 @@ public:
 
     /**
      * @brief Get the PlacementTree of this Sample.
+     *
+     * If the tree is shared with other Sample%s or owners, it is copied first, so that changes
+     * to the tree only affect this Sample. The @link PqueryPlacement::edge() edges@endlink of the
+     * placements are then adjusted to point to the copy. Hence, as long as the tree is not going
+     * to be changed, the const version of this function should be preferred.
      */
     PlacementTree& tree();
 
@@ -146,6 +173,30 @@ public:
      */
     PlacementTree const& tree() const;
 
+    /**
+     * @brief Get a shared pointer to the PlacementTree of this Sample, so that it can be used
+     * by other Sample%s as well.
+     *
+     * As long as the returned pointer (or a copy of it) exists, the tree is treated as shared,
+     * so that a call to the non-const tree() makes a copy of it first.
+     */
+    std::shared_ptr<PlacementTree const> shared_tree() const;
+
+    /**
+     * @brief Replace the PlacementTree of this Sample by a shared one.
+     *
+     * The new tree needs to have the same topology and
+     * @link PlacementTreeEdge::index() edge indices@endlink as the current one, for example a tree
+     * obtained from shared_tree() of another Sample that was placed on the same reference tree.
+     * The placements are moved to the edges of the new tree, and their `proximal_length` is
+     * adjusted so that the relative position on the edge is maintained, as in
+     * add( Pquery const& ). If the trees do not have the same number of edges, or a placement
+     * would end up on an edge with a different @link PlacementEdgeData::edge_num() edge_num@endlink,
+     * an `std::runtime_error` is thrown. All placements are checked before any of them is moved,
+     * so that in this case, the Sample is left unchanged.
+     */
+    void share_tree( std::shared_ptr<PlacementTree const> tree );
+
     // -------------------------------------------------------------------------
     //     Pquery Accessors and Modifiers
     // -------------------------------------------------------------------------
@@ -281,8 +332,21 @@ public:
 
 private:
 
-    std::vector<Pquery> pqueries_;
-    PlacementTree       tree_;
+    /**
+     * @brief Make sure that the tree is not shared with other owners, so that it can be changed.
+     */
+    void make_tree_unique_();
+
+    /**
+     * @brief Point the placements to the edges of a new tree with the same edge indices.
+     *
+     * The new tree has to be checked to fit the placements before, as this function does not
+     * throw, so that the placements are never left partially moved.
+     */
+    void move_placements_( PlacementTree& new_tree, bool adjust_lengths );
+
+    std::vector<Pquery>            pqueries_;
+    std::shared_ptr<PlacementTree> tree_;
 
 public:
 
@@ -0,0 +1,92 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include "genesis/placement/sample_columns.hpp"
+
+#include "genesis/placement/function/functions.hpp"
+#include "genesis/placement/sample.hpp"
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Constructors
+// =================================================================================================
+
+SampleColumns::SampleColumns()
+    : placement_offsets_( 1, 0 )
+{}
+
+SampleColumns::SampleColumns( Sample const& sample )
+{
+    auto const& tree = sample.tree();
+
+    // Per edge values.
+    branch_lengths_.resize( tree.edge_count() );
+    primary_node_indices_.resize( tree.edge_count() );
+    secondary_node_indices_.resize( tree.edge_count() );
+    for( auto const& edge : tree.edges() ) {
+        auto const idx = edge->index();
+        branch_lengths_[ idx ]         = edge->data<PlacementEdgeData>().branch_length;
+        primary_node_indices_[ idx ]   = edge->primary_node().index();
+        secondary_node_indices_[ idx ] = edge->secondary_node().index();
+    }
+    node_count_ = tree.node_count();
+
+    // Count first, so that every column is allocated exactly once.
+    size_t total = 0;
+    for( auto const& pqry : sample ) {
+        total += pqry.placement_size();
+    }
+
+    placement_offsets_.reserve( sample.size() + 1 );
+    multiplicities_.reserve( sample.size() );
+    edge_indices_.reserve( total );
+    likelihoods_.reserve( total );
+    like_weight_ratios_.reserve( total );
+    proximal_lengths_.reserve( total );
+    pendant_lengths_.reserve( total );
+
+    placement_offsets_.push_back( 0 );
+    for( auto const& pqry : sample ) {
+        for( auto const& place : pqry.placements() ) {
+            edge_indices_.push_back( place.edge().index() );
+            likelihoods_.push_back( place.likelihood );
+            like_weight_ratios_.push_back( place.like_weight_ratio );
+            proximal_lengths_.push_back( place.proximal_length );
+            pendant_lengths_.push_back( place.pendant_length );
+        }
+        placement_offsets_.push_back( edge_indices_.size() );
+        multiplicities_.push_back( total_multiplicity( pqry ));
+    }
+}
+
+} // namespace placement
+} // namespace genesis
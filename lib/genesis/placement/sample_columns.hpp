@@ -0,0 +1,454 @@
+#ifndef GENESIS_PLACEMENT_SAMPLE_COLUMNS_H_
+#define GENESIS_PLACEMENT_SAMPLE_COLUMNS_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup placement
+ */
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace genesis {
+namespace placement {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class Sample;
+
+// =================================================================================================
+//     Sample Columns
+// =================================================================================================
+
+/**
+ * @brief Columnar (structure of arrays) representation of the placements of a Sample.
+ *
+ * The default representation of a Sample stores its @link Pquery Pqueries@endlink as individual
+ * objects, each with its own vector of PqueryPlacement%s, which in turn point to their edge in the
+ * tree. This is flexible, but whole-sample computations then have to chase pointers for every
+ * single placement.
+ *
+ * This class instead stores the placement values of all Pqueries of a Sample in contiguous arrays,
+ * one per property, in the order of the Pqueries and their placements. The placements of the
+ * Pquery at index `i` are found in the range `[ placement_offsets()[i], placement_offsets()[i+1] )`
+ * of the placement columns. The values that the kernels need from the tree (branch lengths and
+ * the indices of the nodes at both ends of each edge) are stored per edge, indexed by the
+ * @link PlacementTreeEdge::index() index@endlink of the edges.
+ *
+ * The columns are a snapshot: changing the Sample afterwards does not update them.
+ * The names of the Pqueries are not stored; instead, their total
+ * @link PqueryName::multiplicity multiplicity@endlink is kept per Pquery.
+ *
+ * For code that works on single Pqueries, at() and the iterators offer lightweight
+ * @link PqueryView views@endlink that mimic the read-only part of the Pquery and PqueryPlacement
+ * interface, so that such code can be used with both representations.
+ */
+class SampleColumns
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Placement View
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Values of one placement, with the member names of PqueryPlacement.
+     */
+    struct PlacementView
+    {
+        size_t edge_index;
+
+        double likelihood;
+        double like_weight_ratio;
+        double proximal_length;
+        double pendant_length;
+    };
+
+    // -------------------------------------------------------------------------
+    //     Pquery View
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Read-only view of the placements of one Pquery in a SampleColumns.
+     *
+     * The view is only valid as long as the SampleColumns it was obtained from.
+     */
+    class PqueryView
+    {
+    public:
+
+        class const_iterator
+        {
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = PlacementView;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = PlacementView const*;
+            using reference         = PlacementView;
+
+            const_iterator( SampleColumns const& columns, size_t index )
+                : columns_( &columns )
+                , index_( index )
+            {}
+
+            PlacementView operator * () const
+            {
+                return columns_->placement_view_( index_ );
+            }
+
+            const_iterator& operator ++ ()
+            {
+                ++index_;
+                return *this;
+            }
+
+            const_iterator operator ++ (int)
+            {
+                auto tmp = *this;
+                ++index_;
+                return tmp;
+            }
+
+            bool operator == ( const_iterator const& other ) const
+            {
+                return columns_ == other.columns_ && index_ == other.index_;
+            }
+
+            bool operator != ( const_iterator const& other ) const
+            {
+                return !( *this == other );
+            }
+
+        private:
+
+            SampleColumns const* columns_;
+            size_t               index_;
+        };
+
+        PqueryView( SampleColumns const& columns, size_t index )
+            : columns_( &columns )
+            , index_( index )
+        {}
+
+        /**
+         * @brief Return the index of the Pquery in the Sample.
+         */
+        size_t index() const
+        {
+            return index_;
+        }
+
+        size_t placement_size() const
+        {
+            return columns_->placement_offsets_[ index_ + 1 ]
+                 - columns_->placement_offsets_[ index_ ];
+        }
+
+        PlacementView placement_at( size_t index ) const
+        {
+            return columns_->placement_view_( columns_->placement_offsets_[ index_ ] + index );
+        }
+
+        /**
+         * @brief Return the sum of the multiplicities of the names of the Pquery.
+         */
+        double multiplicity() const
+        {
+            return columns_->multiplicities_[ index_ ];
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator( *columns_, columns_->placement_offsets_[ index_ ] );
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator( *columns_, columns_->placement_offsets_[ index_ + 1 ] );
+        }
+
+    private:
+
+        SampleColumns const* columns_;
+        size_t               index_;
+    };
+
+    // -------------------------------------------------------------------------
+    //     Iterator
+    // -------------------------------------------------------------------------
+
+    class const_iterator
+    {
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = PqueryView;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = PqueryView const*;
+        using reference         = PqueryView;
+
+        const_iterator( SampleColumns const& columns, size_t index )
+            : columns_( &columns )
+            , index_( index )
+        {}
+
+        PqueryView operator * () const
+        {
+            return PqueryView( *columns_, index_ );
+        }
+
+        const_iterator& operator ++ ()
+        {
+            ++index_;
+            return *this;
+        }
+
+        const_iterator operator ++ (int)
+        {
+            auto tmp = *this;
+            ++index_;
+            return tmp;
+        }
+
+        bool operator == ( const_iterator const& other ) const
+        {
+            return columns_ == other.columns_ && index_ == other.index_;
+        }
+
+        bool operator != ( const_iterator const& other ) const
+        {
+            return !( *this == other );
+        }
+
+    private:
+
+        SampleColumns const* columns_;
+        size_t               index_;
+    };
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    SampleColumns();
+
+    /**
+     * @brief Build the columns from the Pqueries and the tree of a Sample.
+     */
+    explicit SampleColumns( Sample const& sample );
+
+    ~SampleColumns() = default;
+
+    SampleColumns( SampleColumns const& ) = default;
+    SampleColumns( SampleColumns&& )      = default;
+
+    SampleColumns& operator= ( SampleColumns const& ) = default;
+    SampleColumns& operator= ( SampleColumns&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the number of Pqueries.
+     */
+    size_t size() const
+    {
+        return multiplicities_.size();
+    }
+
+    bool empty() const
+    {
+        return multiplicities_.empty();
+    }
+
+    /**
+     * @brief Return the total number of placements of all Pqueries.
+     */
+    size_t placement_size() const
+    {
+        return edge_indices_.size();
+    }
+
+    /**
+     * @brief Return the number of edges of the tree that the columns were built from.
+     */
+    size_t edge_count() const
+    {
+        return branch_lengths_.size();
+    }
+
+    /**
+     * @brief Return the number of nodes of the tree that the columns were built from.
+     */
+    size_t node_count() const
+    {
+        return node_count_;
+    }
+
+    PqueryView at( size_t index ) const
+    {
+        return PqueryView( *this, index );
+    }
+
+    PqueryView operator[] ( size_t index ) const
+    {
+        return PqueryView( *this, index );
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator( *this, 0 );
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator( *this, size() );
+    }
+
+    // -------------------------------------------------------------------------
+    //     Columns
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Offsets of the placements of each Pquery into the placement columns.
+     *
+     * The vector has size() + 1 entries, the last one being placement_size().
+     */
+    std::vector<size_t> const& placement_offsets() const
+    {
+        return placement_offsets_;
+    }
+
+    /**
+     * @brief Total multiplicity per Pquery.
+     */
+    std::vector<double> const& multiplicities() const
+    {
+        return multiplicities_;
+    }
+
+    std::vector<size_t> const& edge_indices() const
+    {
+        return edge_indices_;
+    }
+
+    std::vector<double> const& likelihoods() const
+    {
+        return likelihoods_;
+    }
+
+    std::vector<double> const& like_weight_ratios() const
+    {
+        return like_weight_ratios_;
+    }
+
+    std::vector<double> const& proximal_lengths() const
+    {
+        return proximal_lengths_;
+    }
+
+    std::vector<double> const& pendant_lengths() const
+    {
+        return pendant_lengths_;
+    }
+
+    /**
+     * @brief Branch length per edge of the tree.
+     */
+    std::vector<double> const& branch_lengths() const
+    {
+        return branch_lengths_;
+    }
+
+    /**
+     * @brief Index of the primary node (towards the root) per edge of the tree.
+     */
+    std::vector<size_t> const& primary_node_indices() const
+    {
+        return primary_node_indices_;
+    }
+
+    /**
+     * @brief Index of the secondary node (away from the root) per edge of the tree.
+     */
+    std::vector<size_t> const& secondary_node_indices() const
+    {
+        return secondary_node_indices_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Internal Functions
+    // -------------------------------------------------------------------------
+
+private:
+
+    PlacementView placement_view_( size_t index ) const
+    {
+        return {
+            edge_indices_[ index ],
+            likelihoods_[ index ],
+            like_weight_ratios_[ index ],
+            proximal_lengths_[ index ],
+            pendant_lengths_[ index ]
+        };
+    }
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    // Per Pquery.
+    std::vector<size_t> placement_offsets_;
+    std::vector<double> multiplicities_;
+
+    // Per placement.
+    std::vector<size_t> edge_indices_;
+    std::vector<double> likelihoods_;
+    std::vector<double> like_weight_ratios_;
+    std::vector<double> proximal_lengths_;
+    std::vector<double> pendant_lengths_;
+
+    // Per edge.
+    std::vector<double> branch_lengths_;
+    std::vector<size_t> primary_node_indices_;
+    std::vector<size_t> secondary_node_indices_;
+
+    size_t node_count_ = 0;
+};
+
+} // namespace placement
+} // namespace genesis
+
+#endif // include guard
@@ -34,7 +34,9 @@
 #include "genesis/sequence/sequence.hpp"
 #include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
 #include "genesis/utils/io/input_stream.hpp"
+#include "genesis/utils/io/parallel_chunk_reader.hpp"
 #include "genesis/utils/io/scanner.hpp"
 #include "genesis/utils/text/string.hpp"
 
@@ -62,9 +64,7 @@ FastaReader::FastaReader()
 
 void FastaReader::from_stream ( std::istream& input_stream, SequenceSet& sequence_set ) const
 {
-    // Create an input stream and process it.
-    utils::InputStream it( utils::make_unique< utils::StreamInputSource >( input_stream ));
-    parse_document( it, sequence_set );
+    read_source_( utils::make_unique< utils::StreamInputSource >( input_stream ), sequence_set );
 }
 
 SequenceSet FastaReader::from_stream( std::istream& input_stream ) const
@@ -77,9 +77,7 @@ SequenceSet FastaReader::from_stream( std::istream& input_stream ) const
 
 void FastaReader::from_file ( std::string const& file_name, SequenceSet& sequence_set ) const
 {
-    // Create an input stream and process it.
-    utils::InputStream it( utils::make_unique< utils::FileInputSource >( file_name ));
-    parse_document( it, sequence_set );
+    read_source_( utils::from_file( file_name ), sequence_set );
 }
 
 SequenceSet FastaReader::from_file( std::string const& file_name ) const
@@ -92,9 +90,7 @@ SequenceSet FastaReader::from_file( std::string const& file_name ) const
 
 void FastaReader::from_string ( std::string const& input_string, SequenceSet& sequence_set ) const
 {
-    // Create an input stream and process it.
-    utils::InputStream it( utils::make_unique< utils::StringInputSource >( input_string ));
-    parse_document( it, sequence_set );
+    read_source_( utils::make_unique< utils::StringInputSource >( input_string ), sequence_set );
 }
 
 SequenceSet FastaReader::from_string( std::string const& input_string ) const
@@ -105,6 +101,33 @@ SequenceSet FastaReader::from_string( std::string const& input_string ) const
     return result;
 }
 
+void FastaReader::read_source_(
+    std::unique_ptr<utils::BaseInputSource> input_source,
+    SequenceSet&                            sequence_set
+) const {
+    // Simple case: Create an input stream and process it.
+    if( ! parallel_parsing_ ) {
+        utils::InputStream it( std::move( input_source ));
+        parse_document( it, sequence_set );
+        return;
+    }
+
+    // Parse chunks of sequences in parallel, and move them to the set in input order.
+    utils::ParallelChunkReader( utils::fasta_record_boundary ).read<SequenceSet>(
+        std::move( input_source ),
+        [&]( utils::InputStream& it ){
+            SequenceSet chunk;
+            parse_document( it, chunk );
+            return chunk;
+        },
+        [&]( SequenceSet& chunk ){
+            for( auto& seq : chunk ) {
+                sequence_set.add( std::move( seq ));
+            }
+        }
+    );
+}
+
 // =================================================================================================
 //     Parsing
 // =================================================================================================
@@ -418,6 +441,17 @@ FastaReader::ParsingMethod FastaReader::parsing_method() const
     return parsing_method_;
 }
 
+FastaReader& FastaReader::parallel_parsing( bool value )
+{
+    parallel_parsing_ = value;
+    return *this;
+}
+
+bool FastaReader::parallel_parsing() const
+{
+    return parallel_parsing_;
+}
+
 FastaReader& FastaReader::to_upper( bool value )
 {
     to_upper_ = value;
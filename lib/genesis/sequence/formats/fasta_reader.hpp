@@ -34,6 +34,7 @@
 #include "genesis/utils/tools/char_lookup.hpp"
 
 #include <iosfwd>
+#include <memory>
 #include <string>
 
 namespace genesis {
@@ -44,6 +45,7 @@ namespace genesis {
 
 namespace utils {
     class InputStream;
+    class BaseInputSource;
 }
 
 namespace sequence {
@@ -282,6 +284,28 @@ public:
      */
     ParsingMethod parsing_method() const;
 
+    /**
+     * @brief Set whether to parse the input in parallel.
+     *
+     * If set to `true`, the reading functions from_...() split the input into large chunks at
+     * the beginnings of sequences, which are then parsed in parallel, using
+     * utils::ParallelChunkReader with @link utils::Options::number_of_threads()
+     * Options::get().number_of_threads()@endlink many threads. The resulting sequences are the
+     * same and in the same order as without parallel parsing. However, line numbers in error
+     * messages are relative to the chunk in which the error occured, whose first line is reported
+     * as well.
+     *
+     * Default is `false`. This setting does not affect the parse_...() functions.
+     */
+    FastaReader&  parallel_parsing( bool value );
+
+    /**
+     * @brief Return whether the input is parsed in parallel.
+     *
+     * See parallel_parsing( bool ) for details.
+     */
+    bool          parallel_parsing() const;
+
     /**
      * @brief Set whether Sequence sites are automatically turned into upper case.
      *
@@ -336,7 +360,16 @@ public:
 
 private:
 
-    ParsingMethod           parsing_method_ = ParsingMethod::kDefault;
+    /**
+     * @brief Read all Sequence%s from an input source, using parallel_parsing() if set.
+     */
+    void read_source_(
+        std::unique_ptr<utils::BaseInputSource> input_source,
+        SequenceSet&                            sequence_set
+    ) const;
+
+    ParsingMethod           parsing_method_   = ParsingMethod::kDefault;
+    bool                    parallel_parsing_ = false;
 
     bool                    to_upper_       = true;
     bool                    use_validation_ = false;
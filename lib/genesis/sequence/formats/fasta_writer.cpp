@@ -33,6 +33,7 @@
 #include "genesis/sequence/sequence_set.hpp"
 #include "genesis/sequence/sequence.hpp"
 #include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/io/compressed_output_target.hpp"
 #include "genesis/utils/io/output_stream.hpp"
 
 #include <fstream>
@@ -76,11 +77,12 @@ void FastaWriter::to_stream( SequenceSet const& sset, std::ostream& os ) const
     }
 }
 
-void FastaWriter::to_file( SequenceSet const& sset, std::string const& filename ) const
-{
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    to_stream( sset, ofs );
+void FastaWriter::to_file(
+    SequenceSet const& sset, std::string const& filename, utils::CompressionFormat compression
+) const {
+    utils::OutputStream os( utils::to_file( filename, compression ));
+    to_stream( sset, os );
+    os.close();
 }
 
 std::string FastaWriter::to_string ( SequenceSet const& sset ) const
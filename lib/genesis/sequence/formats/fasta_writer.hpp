@@ -31,6 +31,8 @@
  * @ingroup sequence
  */
 
+#include "genesis/utils/io/compressed_input_source.hpp"
+
 #include <iosfwd>
 #include <string>
 
@@ -106,8 +108,14 @@ public:
      * already exists, an exception is thrown.
      * See @link utils::Options::allow_file_overwriting( bool ) Options::allow_file_overwriting()@endlink to
      * change this behaviour.
+     *
+     * The file is written uncompressed, unless a `compression` format is given. The format is
+     * not inferred from the file name.
      */
-    void        to_file   ( SequenceSet const& sset, std::string const& fn ) const;
+    void        to_file   (
+        SequenceSet const& sset, std::string const& fn,
+        utils::CompressionFormat compression = utils::CompressionFormat::kNone
+    ) const;
 
     /**
      * @brief Return Sequences of a SequenceSet in form of a Fasta formatted string.
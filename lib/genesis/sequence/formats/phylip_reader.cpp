@@ -34,6 +34,7 @@
 #include "genesis/sequence/sequence.hpp"
 #include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
 #include "genesis/utils/io/input_stream.hpp"
 #include "genesis/utils/io/scanner.hpp"
 #include "genesis/utils/text/string.hpp"
@@ -100,7 +101,7 @@ void PhylipReader::from_file( std::string const& file_name, SequenceSet& sequenc
     // is also not nice.
 
     // Get stream.
-    utils::InputStream it( utils::make_unique< utils::FileInputSource >( file_name ));
+    utils::InputStream it( utils::from_file( file_name ));
 
     // If the mode is specified, use it.
     if( mode_ == Mode::kSequential ) {
@@ -127,7 +128,7 @@ void PhylipReader::from_file( std::string const& file_name, SequenceSet& sequenc
             tmp.clear();
 
             // Prepare stream. Again. Then parse.
-            utils::InputStream it( utils::make_unique< utils::FileInputSource >( file_name ));
+            utils::InputStream it( utils::from_file( file_name ));
             parse_phylip_interleaved( it, tmp );
         }
 
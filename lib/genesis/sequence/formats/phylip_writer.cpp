@@ -33,6 +33,7 @@
 #include "genesis/sequence/sequence_set.hpp"
 #include "genesis/sequence/sequence.hpp"
 #include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/io/compressed_output_target.hpp"
 #include "genesis/utils/io/output_stream.hpp"
 
 #include <fstream>
@@ -109,12 +110,16 @@ void PhylipWriter::to_stream( SequenceSet const& sset, std::ostream& os ) const
  * already exists, an exception is thrown.
  * See @link utils::Options::allow_file_overwriting( bool ) Options::allow_file_overwriting()@endlink to
  * change this behaviour.
+ *
+ * The file is written uncompressed, unless a `compression` format is given. The format is
+ * not inferred from the file name.
  */
-void PhylipWriter::to_file( SequenceSet const& sset, std::string const& filename ) const
-{
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    to_stream( sset, ofs );
+void PhylipWriter::to_file(
+    SequenceSet const& sset, std::string const& filename, utils::CompressionFormat compression
+) const {
+    utils::OutputStream os( utils::to_file( filename, compression ));
+    to_stream( sset, os );
+    os.close();
 }
 
 /**
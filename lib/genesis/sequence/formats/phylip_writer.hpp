@@ -31,6 +31,8 @@
  * @ingroup sequence
  */
 
+#include "genesis/utils/io/compressed_input_source.hpp"
+
 #include <iosfwd>
 #include <string>
 
@@ -72,7 +74,10 @@ public:
     // void to_stream_sequential  ( SequenceSet const& sset, std::ostream& os ) const;
 
     void        to_stream ( SequenceSet const& sset, std::ostream&      os ) const;
-    void        to_file   ( SequenceSet const& sset, std::string const& fn ) const;
+    void        to_file   (
+        SequenceSet const& sset, std::string const& fn,
+        utils::CompressionFormat compression = utils::CompressionFormat::kNone
+    ) const;
     std::string to_string ( SequenceSet const& sset ) const;
 
     // ---------------------------------------------------------------------
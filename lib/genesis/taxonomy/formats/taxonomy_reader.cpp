@@ -37,6 +37,7 @@
 
 #include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
 #include "genesis/utils/io/input_stream.hpp"
 #include "genesis/utils/text/string.hpp"
 
@@ -82,7 +83,7 @@ void TaxonomyReader::from_stream( std::istream& is, Taxonomy& tax ) const
  */
 void TaxonomyReader::from_file( std::string const& fn, Taxonomy& tax ) const
 {
-    utils::InputStream it( utils::make_unique< utils::FileInputSource >( fn ));
+    utils::InputStream it( utils::from_file( fn ));
     parse_document( it, tax );
 }
 
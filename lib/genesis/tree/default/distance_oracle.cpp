@@ -0,0 +1,133 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/default/distance_oracle.hpp"
+
+#include "genesis/tree/default/tree.hpp"
+#include "genesis/tree/iterator/eulertour.hpp"
+
+#include <cassert>
+#include <limits>
+#include <utility>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Constructors
+// =================================================================================================
+
+NodeDistanceOracle::NodeDistanceOracle( Tree const& tree )
+    : tour_rmq_( build_tour_( tree ))
+{}
+
+std::vector<utils::RangeMinimumQuery::IntType> NodeDistanceOracle::build_tour_( Tree const& tree )
+{
+    using IntType = utils::RangeMinimumQuery::IntType;
+
+    first_visits_   = std::vector<size_t>( tree.node_count(), std::numeric_limits<size_t>::max() );
+    root_distances_ = std::vector<double>( tree.node_count(), 0.0 );
+    tour_nodes_.clear();
+
+    auto depths = std::vector<IntType>( tree.node_count(), 0 );
+    auto tour_depths = std::vector<IntType>();
+    if( tree.empty() ) {
+        return tour_depths;
+    }
+
+    // The Euler tour visits every node once per link, that is, once when coming from its parent,
+    // and once more after returning from each of its children. The first visit of each node
+    // is thus always preceeded by the first visit of its parent, whose values we can use.
+    tour_nodes_.reserve( 2 * tree.node_count() );
+    tour_depths.reserve( 2 * tree.node_count() );
+    auto const root_index = tree.root_node().index();
+    for( auto it : eulertour( tree )) {
+        auto const node_index = it.node().index();
+
+        if( first_visits_[ node_index ] == std::numeric_limits<size_t>::max() ) {
+            first_visits_[ node_index ] = tour_nodes_.size();
+
+            if( node_index != root_index ) {
+                auto const& parent_link = it.node().primary_link().outer();
+                auto const parent_index = parent_link.node().index();
+                assert( first_visits_[ parent_index ] < tour_nodes_.size() );
+
+                depths[ node_index ] = depths[ parent_index ] + 1;
+                root_distances_[ node_index ]
+                    = root_distances_[ parent_index ]
+                    + parent_link.edge().data<DefaultEdgeData>().branch_length
+                ;
+            }
+        }
+
+        tour_nodes_.push_back( node_index );
+        tour_depths.push_back( depths[ node_index ] );
+    }
+
+    return tour_depths;
+}
+
+// =================================================================================================
+//     Queries
+// =================================================================================================
+
+size_t NodeDistanceOracle::lowest_common_ancestor(
+    size_t node_index_a, size_t node_index_b
+) const {
+    assert( node_index_a < first_visits_.size() && node_index_b < first_visits_.size() );
+
+    // The node with the lowest depth between the first visits of both nodes is their LCA.
+    auto first = first_visits_[ node_index_a ];
+    auto last  = first_visits_[ node_index_b ];
+    if( last < first ) {
+        std::swap( first, last );
+    }
+    return tour_nodes_[ tour_rmq_.query( first, last ) ];
+}
+
+double NodeDistanceOracle::distance( size_t node_index_a, size_t node_index_b ) const
+{
+    if( node_index_a == node_index_b ) {
+        return 0.0;
+    }
+    auto const lca = lowest_common_ancestor( node_index_a, node_index_b );
+    return root_distances_[ node_index_a ]
+         + root_distances_[ node_index_b ]
+         - 2.0 * root_distances_[ lca ]
+    ;
+}
+
+double NodeDistanceOracle::distance( TreeNode const& node_a, TreeNode const& node_b ) const
+{
+    return distance( node_a.index(), node_b.index() );
+}
+
+} // namespace tree
+} // namespace genesis
@@ -0,0 +1,164 @@
+#ifndef GENESIS_TREE_DEFAULT_DISTANCE_ORACLE_H_
+#define GENESIS_TREE_DEFAULT_DISTANCE_ORACLE_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/tree.hpp"
+#include "genesis/utils/math/range_minimum_query.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Node Distance Oracle
+// =================================================================================================
+
+/**
+ * @brief Answer queries for the branch length distance between pairs of TreeNode%s in constant
+ * time, using linear memory.
+ *
+ * This is a drop-in replacement for the Matrix returned by node_branch_length_distance_matrix(),
+ * for cases where the quadratic memory and construction time of the full matrix are prohibitive.
+ * It offers the same `operator()( size_t, size_t )` lookup by node index as the Matrix, so that
+ * code can use either of them.
+ *
+ * Internally, we store an Euler tour of the tree, indexed by a RangeMinimumQuery over the depths
+ * of the visited nodes, which yields the lowest common ancestor (LCA) of two nodes in constant
+ * time. Together with the branch length distance of each node from the root, the distance between
+ * two nodes is then `root_distance(a) + root_distance(b) - 2 * root_distance( lca(a, b) )`.
+ *
+ * The branch lengths are read from the DefaultEdgeData of the tree at construction time. Later
+ * changes of the tree are not reflected in the oracle.
+ */
+class NodeDistanceOracle
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Build the oracle for a Tree whose edges derive from DefaultEdgeData.
+     */
+    explicit NodeDistanceOracle( Tree const& tree );
+
+    ~NodeDistanceOracle() = default;
+
+    NodeDistanceOracle( NodeDistanceOracle const& ) = default;
+    NodeDistanceOracle( NodeDistanceOracle&& )      = default;
+
+    NodeDistanceOracle& operator= ( NodeDistanceOracle const& ) = default;
+    NodeDistanceOracle& operator= ( NodeDistanceOracle&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Queries
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the number of nodes of the tree that the oracle was built from.
+     */
+    size_t node_count() const
+    {
+        return root_distances_.size();
+    }
+
+    /**
+     * @brief Return the sum of branch lengths between the root and the node with the given index.
+     */
+    double root_distance( size_t node_index ) const
+    {
+        return root_distances_[ node_index ];
+    }
+
+    /**
+     * @brief Return the index of the lowest common ancestor of the two nodes with the given
+     * indices, with respect to the root of the tree.
+     */
+    size_t lowest_common_ancestor( size_t node_index_a, size_t node_index_b ) const;
+
+    /**
+     * @brief Return the sum of branch lengths on the path between the two nodes with the given
+     * indices.
+     */
+    double distance( size_t node_index_a, size_t node_index_b ) const;
+
+    /**
+     * @brief Return the sum of branch lengths on the path between two TreeNode%s.
+     */
+    double distance( TreeNode const& node_a, TreeNode const& node_b ) const;
+
+    /**
+     * @brief Shortcut for distance( size_t, size_t ), so that the oracle can be used in place of
+     * the Matrix returned by node_branch_length_distance_matrix().
+     */
+    double operator() ( size_t node_index_a, size_t node_index_b ) const
+    {
+        return distance( node_index_a, node_index_b );
+    }
+
+    // -------------------------------------------------------------------------
+    //     Internal Functions
+    // -------------------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Fill the tour and per node members, and return the depths of the tour nodes,
+     * which are used to construct the RangeMinimumQuery.
+     */
+    std::vector<utils::RangeMinimumQuery::IntType> build_tour_( Tree const& tree );
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    // Per node index: the position of its first visit in the tour, and its distance from the root.
+    std::vector<size_t> first_visits_;
+    std::vector<double> root_distances_;
+
+    // Node indices in the order of the Euler tour, and the RMQ over their depths.
+    // The RMQ is initialized via build_tour_(), which fills the members above,
+    // so it has to be declared after them.
+    std::vector<size_t>      tour_nodes_;
+    utils::RangeMinimumQuery tour_rmq_;
+
+};
+
+} // namespace tree
+} // namespace genesis
+
+#endif // include guard
@@ -35,8 +35,13 @@
 #include "genesis/tree/formats/newick/element.hpp"
 #include "genesis/tree/formats/newick/reader.hpp"
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/parser.hpp"
 #include "genesis/utils/text/string.hpp"
 
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
 namespace genesis {
 namespace tree {
 
@@ -245,7 +250,26 @@ public:
         // If there is an interpretation where this is not the case, it is best to introduce
         // an array index for this as a paramter of this class.
         if( element.values.size() > 0 ) {
-            edge.data<DefaultEdgeData>().branch_length = std::stod( element.values[0] );
+            auto const& value = element.values[0];
+            auto const  end   = value.data() + value.size();
+            auto& branch_length = edge.data<DefaultEdgeData>().branch_length;
+
+            // Fast path for the usual branch lengths. Everything else, such as surrounding
+            // whitespace, a trailing dot, zero, or values that over- or underflow, is left to
+            // std::stod(), so that we accept and reject the same values as it does.
+            double parsed = 0.0;
+            if(
+                ! value.empty() && utils::parse_float( value.data(), end, parsed ) == end &&
+                std::isnormal( parsed )
+            ) {
+                branch_length = parsed;
+                return;
+            }
+            try {
+                branch_length = std::stod( value );
+            } catch( std::invalid_argument const& ) {
+                throw std::invalid_argument( "Invalid branch length '" + value + "'." );
+            }
         } else {
             edge.data<DefaultEdgeData>().branch_length = default_branch_length_;
         }
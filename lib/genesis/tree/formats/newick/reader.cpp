@@ -37,8 +37,10 @@
 #include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/core/logging.hpp"
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
 
 #include "genesis/utils/io/input_stream.hpp"
+#include "genesis/utils/io/parallel_chunk_reader.hpp"
 #include "genesis/utils/io/parser.hpp"
 #include "genesis/utils/io/scanner.hpp"
 #include "genesis/utils/text/string.hpp"
@@ -47,6 +49,8 @@
 #include <deque>
 #include <memory>
 #include <iostream>
+#include <utility>
+#include <vector>
 #include <sstream>
 #include <stdexcept>
 
@@ -65,7 +69,7 @@ Tree NewickReader::from_stream( std::istream& input_stream ) const
 
 Tree NewickReader::from_file( std::string const& filename ) const
 {
-    utils::InputStream it( utils::make_unique< utils::FileInputSource >( filename ));
+    utils::InputStream it( utils::from_file( filename ));
     return parse_single_tree( it );
 }
 
@@ -84,8 +88,9 @@ void NewickReader::from_stream(
     TreeSet&           tree_set,
     std::string const& default_name
 ) const {
-    utils::InputStream it( utils::make_unique< utils::StreamInputSource >( input_stream ));
-    parse_multiple_trees( it, tree_set, default_name );
+    read_source_(
+        utils::make_unique< utils::StreamInputSource >( input_stream ), tree_set, default_name
+    );
 }
 
 void NewickReader::from_file (
@@ -93,8 +98,7 @@ void NewickReader::from_file (
     TreeSet&           tree_set,
     std::string const& default_name
 ) const {
-    utils::InputStream it( utils::make_unique< utils::FileInputSource >( filename ));
-    parse_multiple_trees( it, tree_set, default_name );
+    read_source_( utils::from_file( filename ), tree_set, default_name );
 }
 
 void NewickReader::from_string (
@@ -102,8 +106,9 @@ void NewickReader::from_string (
     TreeSet&           tree_set,
     std::string const& default_name
 ) const {
-    utils::InputStream it( utils::make_unique< utils::StringInputSource >( tree_string ));
-    parse_multiple_trees( it, tree_set, default_name );
+    read_source_(
+        utils::make_unique< utils::StringInputSource >( tree_string ), tree_set, default_name
+    );
 }
 
 // =================================================================================================
@@ -129,6 +134,51 @@ void NewickReader::from_strings (
     }
 }
 
+// =================================================================================================
+//     Parallel Reading
+// =================================================================================================
+
+void NewickReader::read_source_(
+    std::unique_ptr<utils::BaseInputSource> input_source,
+    TreeSet&                                tree_set,
+    std::string const&                      default_name
+) const {
+    // Simple case: Create an input stream and process it.
+    if( ! parallel_parsing_ ) {
+        utils::InputStream it( std::move( input_source ));
+        parse_multiple_trees( it, tree_set, default_name );
+        return;
+    }
+
+    // Parse chunks of trees in parallel. The default names of unnamed trees depend on the number
+    // of unnamed trees before them, so we can only assign them when adding them in input order.
+    using named_trees = std::vector< std::pair< std::string, Tree >>;
+    size_t unnamed_ctr = 0;
+    utils::ParallelChunkReader( utils::newick_record_boundary ).read<named_trees>(
+        std::move( input_source ),
+        [&]( utils::InputStream& it ){
+            named_trees chunk;
+            while( it ) {
+                auto named_tree = parse_named_tree( it );
+                if( named_tree.first.empty() && named_tree.second.empty() ) {
+                    break;
+                }
+                chunk.push_back( std::move( named_tree ));
+            }
+            return chunk;
+        },
+        [&]( named_trees& chunk ){
+            for( auto& named_tree : chunk ) {
+                if( named_tree.first.empty() ) {
+                    named_tree.first = default_name + std::to_string( unnamed_ctr );
+                    ++unnamed_ctr;
+                }
+                tree_set.add( std::move( named_tree.first ), std::move( named_tree.second ));
+            }
+        }
+    );
+}
+
 // =================================================================================================
 //     Parse Single Tree
 // =================================================================================================
@@ -837,5 +887,16 @@ bool NewickReader::stop_at_semicolon() const
     return stop_at_semicolon_;
 }
 
+NewickReader& NewickReader::parallel_parsing( bool value )
+{
+    parallel_parsing_ = value;
+    return *this;
+}
+
+bool NewickReader::parallel_parsing() const
+{
+    return parallel_parsing_;
+}
+
 } // namespace tree
 } // namespace genesis
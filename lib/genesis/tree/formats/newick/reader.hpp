@@ -33,6 +33,7 @@
 
 #include <iosfwd>
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -45,6 +46,7 @@ namespace genesis {
 
 namespace utils {
     class InputStream;
+    class BaseInputSource;
 }
 
 namespace tree {
@@ -334,6 +336,28 @@ public:
      */
     bool stop_at_semicolon() const;
 
+    /**
+     * @brief Set whether to parse lists of trees in parallel.
+     *
+     * If set to `true`, the functions that read Tree%s into a TreeSet split the input into large
+     * chunks after the semicolons that finish the trees. The chunks are then parsed in parallel,
+     * using utils::ParallelChunkReader with @link utils::Options::number_of_threads()
+     * Options::get().number_of_threads()@endlink many threads. The resulting TreeSet is the same
+     * as without parallel parsing. However, line numbers in error messages are relative to the
+     * chunk in which the error occured. Furthermore, the plugin functions are then called
+     * concurrently for different trees, and hence must not modify shared state.
+     *
+     * Default is `false`. Reading single trees and the parse_...() functions are not affected.
+     */
+    NewickReader& parallel_parsing( bool value );
+
+    /**
+     * @brief Return whether lists of trees are parsed in parallel.
+     *
+     * See parallel_parsing( bool ) for details.
+     */
+    bool parallel_parsing() const;
+
     // -------------------------------------------------------------------------
     //     Plugin Functions
     // -------------------------------------------------------------------------
@@ -378,6 +402,15 @@ public:
 
 private:
 
+    /**
+     * @brief Add all Tree%s from an input source to a TreeSet, using parallel_parsing() if set.
+     */
+    void read_source_(
+        std::unique_ptr<utils::BaseInputSource> input_source,
+        TreeSet&                                tree_set,
+        std::string const&                      default_name
+    ) const;
+
     /**
      * @brief Check for input after a semicolon and throw if it is not a comment.
      */
@@ -404,6 +437,7 @@ private:
 
     bool enable_tags_       = false;
     bool stop_at_semicolon_ = false;
+    bool parallel_parsing_  = false;
 
 };
 
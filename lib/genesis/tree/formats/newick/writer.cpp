@@ -39,6 +39,7 @@
 #include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/core/logging.hpp"
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/compressed_output_target.hpp"
 #include "genesis/utils/io/output_stream.hpp"
 
 #include <assert.h>
@@ -56,11 +57,13 @@ namespace tree {
 // =================================================================================================
 
 void NewickWriter::to_file (
-    Tree const& tree, std::string const& filename
+    Tree const& tree, std::string const& filename, utils::CompressionFormat compression
 ) const {
     std::string ts;
     to_string(tree, ts);
-    utils::file_write(ts, filename);
+    utils::OutputStream os( utils::to_file( filename, compression ));
+    os << ts;
+    os.close();
 }
 
 void NewickWriter::to_string (
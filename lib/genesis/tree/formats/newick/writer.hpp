@@ -31,6 +31,8 @@
  * @ingroup tree
  */
 
+#include "genesis/utils/io/compressed_input_source.hpp"
+
 #include <functional>
 #include <string>
 #include <vector>
@@ -169,8 +171,14 @@ public:
      * already exists, an exception is thrown.
      * See @link utils::Options::allow_file_overwriting( bool ) Options::allow_file_overwriting()@endlink to
      * change this behaviour.
+     *
+     * The file is written uncompressed, unless a `compression` format is given. The format is
+     * not inferred from the file name.
      */
-    void to_file( Tree const& tree, std::string const& filename) const;
+    void to_file(
+        Tree const& tree, std::string const& filename,
+        utils::CompressionFormat compression = utils::CompressionFormat::kNone
+    ) const;
 
     /**
      * @brief Gives a Newick string representation of the tree.
@@ -40,6 +40,7 @@
 #include "genesis/utils/core/std.hpp"
 #include "genesis/utils/formats/xml/document.hpp"
 #include "genesis/utils/formats/xml/writer.hpp"
+#include "genesis/utils/io/compressed_output_target.hpp"
 #include "genesis/utils/io/output_stream.hpp"
 
 #include <assert.h>
@@ -53,11 +54,14 @@ namespace tree {
 //     Printing
 // =================================================================================================
 
-void PhyloxmlWriter::to_file (const Tree& tree, const std::string filename) const
-{
+void PhyloxmlWriter::to_file (
+    const Tree& tree, const std::string filename, utils::CompressionFormat compression
+) const {
     std::string ts;
     to_string(tree, ts);
-    utils::file_write(ts, filename);
+    utils::OutputStream os( utils::to_file( filename, compression ));
+    os << ts;
+    os.close();
 }
 
 void PhyloxmlWriter::to_string (const Tree& tree, std::string& ts) const
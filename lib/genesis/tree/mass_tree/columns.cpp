@@ -0,0 +1,97 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/mass_tree/columns.hpp"
+
+#include "genesis/tree/iterator/postorder.hpp"
+#include "genesis/tree/tree.hpp"
+
+#include <cassert>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Constructors
+// =================================================================================================
+
+MassTreeColumns::MassTreeColumns()
+    : mass_offsets_( 1, 0 )
+{}
+
+MassTreeColumns::MassTreeColumns( MassTree const& tree )
+    : node_count_( tree.node_count() )
+    , root_node_index_( tree.empty() ? 0 : tree.root_node().index() )
+{
+    auto const edge_count = tree.edge_count();
+    branch_lengths_.resize( edge_count );
+    primary_node_indices_.resize( edge_count );
+    secondary_node_indices_.resize( edge_count );
+
+    // Count the masses first, so that the columns are allocated only once.
+    mass_offsets_.resize( edge_count + 1, 0 );
+    for( size_t i = 0; i < edge_count; ++i ) {
+        auto const& edge = tree.edge_at( i );
+        auto const& edge_data = edge.data<MassTreeEdgeData>();
+
+        branch_lengths_[i]         = edge_data.branch_length;
+        primary_node_indices_[i]   = edge.primary_node().index();
+        secondary_node_indices_[i] = edge.secondary_node().index();
+        mass_offsets_[ i + 1 ]     = mass_offsets_[i] + edge_data.masses.size();
+    }
+
+    // The map already keeps the masses sorted by position, so we can simply copy them over.
+    mass_positions_.reserve( mass_offsets_.back() );
+    mass_values_.reserve( mass_offsets_.back() );
+    for( size_t i = 0; i < edge_count; ++i ) {
+        for( auto const& mass : tree.edge_at( i ).data<MassTreeEdgeData>().masses ) {
+            mass_positions_.push_back( mass.first );
+            mass_values_.push_back( mass.second );
+        }
+        assert( mass_positions_.size() == mass_offsets_[ i + 1 ] );
+    }
+
+    // Store the postorder sequence of edges. The last iteration is the root node itself,
+    // which has no edge of its own.
+    postorder_edge_indices_.reserve( edge_count );
+    if( ! tree.empty() ) {
+        for( auto it : postorder( tree )) {
+            if( it.is_last_iteration() ) {
+                continue;
+            }
+            assert( it.edge().secondary_node().index() == it.node().index() );
+            postorder_edge_indices_.push_back( it.edge().index() );
+        }
+    }
+    assert( postorder_edge_indices_.size() == edge_count );
+}
+
+} // namespace tree
+} // namespace genesis
@@ -0,0 +1,208 @@
+#ifndef GENESIS_TREE_MASS_TREE_COLUMNS_H_
+#define GENESIS_TREE_MASS_TREE_COLUMNS_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup tree
+ */
+
+#include "genesis/tree/mass_tree/tree.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace genesis {
+namespace tree {
+
+// =================================================================================================
+//     Mass Tree Columns
+// =================================================================================================
+
+/**
+ * @brief Flat (structure of arrays) representation of the masses of a MassTree.
+ *
+ * The @link MassTreeEdgeData::masses masses@endlink of a MassTree are stored in one `std::map`
+ * per edge, which is convenient for accumulating masses, but slow to iterate, as every step
+ * follows pointers between the nodes of the map.
+ *
+ * This class instead stores the masses of all edges in two contiguous arrays, mass_positions()
+ * and mass_values(), in a compressed sparse row layout: The masses of the edge with index `e` are
+ * found in the range `[ mass_offsets()[e], mass_offsets()[e+1] )`, sorted by their position on
+ * the edge. The values needed from the tree (branch lengths, the indices of the nodes at both
+ * ends of each edge, and the postorder sequence of edges) are stored along with them, so that
+ * algorithms like the earth_movers_distance() do not need to touch the tree at all.
+ *
+ * The columns are a snapshot: changing the MassTree afterwards does not update them.
+ */
+class MassTreeColumns
+{
+public:
+
+    // -------------------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------------------
+
+    MassTreeColumns();
+
+    /**
+     * @brief Build the columns from the masses and the topology of a MassTree.
+     */
+    explicit MassTreeColumns( MassTree const& tree );
+
+    ~MassTreeColumns() = default;
+
+    MassTreeColumns( MassTreeColumns const& ) = default;
+    MassTreeColumns( MassTreeColumns&& )      = default;
+
+    MassTreeColumns& operator= ( MassTreeColumns const& ) = default;
+    MassTreeColumns& operator= ( MassTreeColumns&& )      = default;
+
+    // -------------------------------------------------------------------------
+    //     Accessors
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Return the number of edges of the tree that the columns were built from.
+     */
+    size_t edge_count() const
+    {
+        return branch_lengths_.size();
+    }
+
+    /**
+     * @brief Return the number of nodes of the tree that the columns were built from.
+     */
+    size_t node_count() const
+    {
+        return node_count_;
+    }
+
+    /**
+     * @brief Return the index of the root node of the tree that the columns were built from.
+     */
+    size_t root_node_index() const
+    {
+        return root_node_index_;
+    }
+
+    /**
+     * @brief Return the total number of masses on all edges.
+     */
+    size_t mass_size() const
+    {
+        return mass_positions_.size();
+    }
+
+    // -------------------------------------------------------------------------
+    //     Columns
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Offsets of the masses of each edge into the mass columns.
+     *
+     * The vector has edge_count() + 1 entries, the last one being mass_size().
+     */
+    std::vector<size_t> const& mass_offsets() const
+    {
+        return mass_offsets_;
+    }
+
+    /**
+     * @brief Position of each mass on its edge, sorted in increasing order per edge.
+     */
+    std::vector<double> const& mass_positions() const
+    {
+        return mass_positions_;
+    }
+
+    /**
+     * @brief Value of each mass, in the same order as mass_positions().
+     */
+    std::vector<double> const& mass_values() const
+    {
+        return mass_values_;
+    }
+
+    /**
+     * @brief Branch length per edge of the tree.
+     */
+    std::vector<double> const& branch_lengths() const
+    {
+        return branch_lengths_;
+    }
+
+    /**
+     * @brief Index of the primary node (towards the root) per edge of the tree.
+     */
+    std::vector<size_t> const& primary_node_indices() const
+    {
+        return primary_node_indices_;
+    }
+
+    /**
+     * @brief Index of the secondary node (away from the root) per edge of the tree.
+     */
+    std::vector<size_t> const& secondary_node_indices() const
+    {
+        return secondary_node_indices_;
+    }
+
+    /**
+     * @brief Indices of all edges, in the order of a postorder traversal starting at the root.
+     *
+     * That is, each edge is listed after all edges of the subtree below it.
+     */
+    std::vector<size_t> const& postorder_edge_indices() const
+    {
+        return postorder_edge_indices_;
+    }
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
+private:
+
+    size_t node_count_      = 0;
+    size_t root_node_index_ = 0;
+
+    std::vector<size_t> mass_offsets_;
+    std::vector<double> mass_positions_;
+    std::vector<double> mass_values_;
+
+    std::vector<double> branch_lengths_;
+    std::vector<size_t> primary_node_indices_;
+    std::vector<size_t> secondary_node_indices_;
+    std::vector<size_t> postorder_edge_indices_;
+
+};
+
+} // namespace tree
+} // namespace genesis
+
+#endif // include guard
@@ -31,7 +31,7 @@
 #include "genesis/tree/mass_tree/emd.hpp"
 
 #include "genesis/tree/function/operators.hpp"
-#include "genesis/tree/iterator/postorder.hpp"
+#include "genesis/tree/mass_tree/columns.hpp"
 #include "genesis/tree/mass_tree/tree.hpp"
 #include "genesis/tree/tree.hpp"
 
@@ -53,6 +53,19 @@
 namespace genesis {
 namespace tree {
 
+// =================================================================================================
+//     Local Helpers
+// =================================================================================================
+
+/**
+ * @brief Local helper that returns the work factor of moving the given @p mass, that is,
+ * its absolute value to the power of @p p, with a shortcut for the common case `p == 1.0`.
+ */
+static inline double emd_mass_work_( double mass, double p )
+{
+    return p == 1.0 ? std::abs( mass ) : std::pow( std::abs( mass ), p );
+}
+
 // =================================================================================================
 //     Earth Movers Distance
 // =================================================================================================
@@ -66,18 +79,46 @@ double earth_movers_distance( MassTree const& lhs, MassTree const& rhs, double c
         );
     }
 
-    // We make an extra copy, which is super expensive. In our our code, thus better do not
-    // use this function, but the one-tree version directly!
-    // auto copy = lhs;
-    // mass_tree_reverse_signs( copy );
-    // mass_tree_merge_trees_inplace( copy, rhs );
-    // return earth_movers_distance( copy, p ).first;
-
     // We don't do a full check for compatile topologies, but at least this check is cheap.
     if( lhs.edge_count() != rhs.edge_count() ) {
         throw std::invalid_argument( "MassTrees need to have same size." );
     }
 
+    // Instead of merging the maps of both trees on each edge, we walk their flat representations
+    // in parallel. The remaining checks for compatibility are done there.
+    return earth_movers_distance( MassTreeColumns( lhs ), MassTreeColumns( rhs ), p );
+}
+
+double earth_movers_distance( MassTreeColumns const& lhs, MassTreeColumns const& rhs, double const p )
+{
+    // Check.
+    if( p <= 0.0 ) {
+        throw std::runtime_error(
+            "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
+        );
+    }
+
+    // We don't do a full check for compatile topologies, but at least check that both trees
+    // have the same edges in the same order of traversal.
+    if( lhs.edge_count() != rhs.edge_count() || lhs.node_count() != rhs.node_count() ) {
+        throw std::invalid_argument( "MassTrees need to have same size." );
+    }
+    if(
+        lhs.postorder_edge_indices() != rhs.postorder_edge_indices() ||
+        lhs.primary_node_indices()   != rhs.primary_node_indices()   ||
+        lhs.secondary_node_indices() != rhs.secondary_node_indices()
+    ) {
+        throw std::invalid_argument( "Incompatible MassTrees." );
+    }
+
+    // Shorthands.
+    auto const& lhs_offsets   = lhs.mass_offsets();
+    auto const& lhs_positions = lhs.mass_positions();
+    auto const& lhs_values    = lhs.mass_values();
+    auto const& rhs_offsets   = rhs.mass_offsets();
+    auto const& rhs_positions = rhs.mass_positions();
+    auto const& rhs_values    = rhs.mass_values();
+
     // Keep track of the total resulting work (the distance we moved the masses).
     // This is the result returned in the end.
     double work = 0.0;
@@ -88,90 +129,65 @@ double earth_movers_distance( MassTree const& lhs, MassTree const& rhs, double c
     // issues), in order for the result of this function to be meaningful.
     auto node_masses = std::vector<double>( lhs.node_count(), 0.0 );
 
-    // Do a postorder traversal over both trees in parallel, starting at the root.
+    // Process the edges in postorder, starting at the root.
     // In theory, it does not matter where we start the traversal - however, the positions of the
     // masses are given as "proximal_length" on their branch, which always points away from the
     // root. Thus, if we decided to traverse from a different node than the root, we would have to
     // take this into account. So, we do start at the root, to keep it simple.
-    auto lhs_it  = postorder( lhs ).begin();
-    auto rhs_it  = postorder( rhs ).begin();
-    auto lhs_end = postorder( lhs ).end();
-    auto rhs_end = postorder( rhs ).end();
-    for( ; lhs_it != lhs_end && rhs_it != rhs_end ; ++lhs_it, ++rhs_it ) {
-
-        // If we are at the last iteration, we reached the root. Thus, we have moved all masses
-        // and don't need to proceed. If we did, we would count an edge of the root again
-        // (because the iterator traverses nodes, not edges, so the root node itself is traversed,
-        // although it has no proper edge that we would need to process).
-        if( lhs_it.is_last_iteration() || rhs_it.is_last_iteration() ) {
-            // If one iterator is at the end, but not the other, something is wrong.
-            if( ! lhs_it.is_last_iteration() || ! rhs_it.is_last_iteration() ) {
-                throw std::invalid_argument( "Incompatible MassTrees." );
-            }
-            continue;
-        }
+    for( auto const edge_index : lhs.postorder_edge_indices() ) {
 
         // Some shorthands.
-        const size_t pri_node_index = lhs_it.edge().primary_node().index();
-        const size_t sec_node_index = lhs_it.edge().secondary_node().index();
-
-        // More checks.
-        if(
-            pri_node_index != rhs_it.edge().primary_node().index() ||
-            sec_node_index != rhs_it.edge().secondary_node().index()
-        ) {
-            throw std::invalid_argument( "Incompatible MassTrees." );
-        }
-
-        // The iterator should guarantee that its edge is always the one pointing towards the root.
-        // Still, better check this!
-        assert( sec_node_index == lhs_it.node().index() );
-        assert( sec_node_index == rhs_it.node().index() );
-
-        // Add both masses to a common map, one of them with negative sign.
-        // This is faster than merging into a vector, and easier than doing a parallel iteration
-        // over the values in sorted order.
-        auto edge_masses = lhs_it.edge().data<MassTreeEdgeData>().masses;
-        for( auto const& mass : rhs_it.edge().data<MassTreeEdgeData>().masses ) {
-            edge_masses[ mass.first ] -= mass.second;
-        }
+        const size_t pri_node_index = lhs.primary_node_indices()[ edge_index ];
+        const size_t sec_node_index = lhs.secondary_node_indices()[ edge_index ];
 
         // We now start a "normal" earth movers distance caluclation along the current edge.
         // We start at the end of the branch, with the mass that comes from the subtree below it...
         double current_pos  = std::max(
-            lhs_it.edge().data<MassTreeEdgeData>().branch_length,
-            rhs_it.edge().data<MassTreeEdgeData>().branch_length
+            lhs.branch_lengths()[ edge_index ],
+            rhs.branch_lengths()[ edge_index ]
         );
         double current_mass = node_masses[ sec_node_index ];
 
         // ... and move the mass along the branch, balancing it with the masses found on the branch.
-        // We use a reverse iterator in order to traverse the branch from end to start.
-        for(
-            auto mass_rit = edge_masses.crbegin();
-            mass_rit != edge_masses.crend();
-            ++mass_rit
-        ) {
+        // The masses of both trees are sorted by position, so we walk both of them from the end
+        // backwards, always taking the one that is further away from the start of the branch.
+        // The masses of the rhs tree are used with negative sign.
+        size_t       lhs_i     = lhs_offsets[ edge_index + 1 ];
+        size_t       rhs_i     = rhs_offsets[ edge_index + 1 ];
+        size_t const lhs_begin = lhs_offsets[ edge_index ];
+        size_t const rhs_begin = rhs_offsets[ edge_index ];
+        while( lhs_i > lhs_begin || rhs_i > rhs_begin ) {
+            double mass_pos;
+            double mass_val;
+            if(
+                rhs_i == rhs_begin ||
+                ( lhs_i > lhs_begin && lhs_positions[ lhs_i - 1 ] >= rhs_positions[ rhs_i - 1 ] )
+            ) {
+                --lhs_i;
+                mass_pos = lhs_positions[ lhs_i ];
+                mass_val = lhs_values[ lhs_i ];
+            } else {
+                --rhs_i;
+                mass_pos = rhs_positions[ rhs_i ];
+                mass_val = -rhs_values[ rhs_i ];
+            }
+
             // The work is accumulated: The mass that we are currently moving times the distances
-            // that we move it.
-            work += std::pow( std::abs( current_mass ), p ) * ( current_pos - mass_rit->first );
+            // that we move it. For two masses at the same position, the distance is zero.
+            work += emd_mass_work_( current_mass, p ) * ( current_pos - mass_pos );
 
             // Update the current position and mass.
-            current_pos   = mass_rit->first;
-            current_mass += mass_rit->second;
+            current_pos   = mass_pos;
+            current_mass += mass_val;
         }
 
         // After we finished moving along the branch, we need extra work to move the remaining mass
         // to the node at the top end of the branch. Also, add the remaining mass to this node, so
         // that it is available for when we process the upper part of that node (towards the root).
-        work += std::pow( std::abs( current_mass ), p ) * current_pos;
+        work += emd_mass_work_( current_mass, p ) * current_pos;
         node_masses[ pri_node_index ] += current_mass;
     }
 
-    // Now we need to be done with both trees, otherwise we have a problem.
-    if( lhs_it != lhs_end || rhs_it != rhs_end ) {
-        throw std::invalid_argument( "Incompatible MassTrees." );
-    }
-
     // Apply the outer exponent.
     if( p > 1.0 ) {
         work = std::pow( work, 1.0 / p );
@@ -192,6 +208,13 @@ utils::Matrix<double> earth_movers_distance( std::vector<MassTree> const& trees,
     // Init result matrix.
     auto result = utils::Matrix<double>( trees.size(), trees.size(), 0.0 );
 
+    // Convert all trees to their flat representation once, instead of for every pair.
+    auto columns = std::vector<MassTreeColumns>( trees.size() );
+    #pragma omp parallel for
+    for( size_t i = 0; i < trees.size(); ++i ) {
+        columns[i] = MassTreeColumns( trees[i] );
+    }
+
     // Parallel specialized code.
     #ifdef GENESIS_OPENMP
 
@@ -210,7 +233,7 @@ utils::Matrix<double> earth_movers_distance( std::vector<MassTree> const& trees,
             auto const j = ij.second;
 
             // Calculate EMD and fill symmetric Matrix.
-            auto const emd = earth_movers_distance( trees[i], trees[j], p );
+            auto const emd = earth_movers_distance( columns[i], columns[j], p );
             result( i, j ) = emd;
             result( j, i ) = emd;
         }
@@ -223,7 +246,7 @@ utils::Matrix<double> earth_movers_distance( std::vector<MassTree> const& trees,
             // The result is symmetric - we only calculate the upper triangle.
             for( size_t j = i + 1; j < trees.size(); ++j ) {
 
-                auto const emd = earth_movers_distance( trees[i], trees[j], p );
+                auto const emd = earth_movers_distance( columns[i], columns[j], p );
                 result( i, j ) = emd;
                 result( j, i ) = emd;
             }
@@ -243,6 +266,23 @@ std::pair<double, double> earth_movers_distance( MassTree const& tree, double co
         );
     }
 
+    return earth_movers_distance( MassTreeColumns( tree ), p );
+}
+
+std::pair<double, double> earth_movers_distance( MassTreeColumns const& columns, double const p )
+{
+    // Check.
+    if( p <= 0.0 ) {
+        throw std::runtime_error(
+            "Invalid exponent value p for earth mover's distance calculation. Has to be > 0.0."
+        );
+    }
+
+    // Shorthands.
+    auto const& offsets   = columns.mass_offsets();
+    auto const& positions = columns.mass_positions();
+    auto const& values    = columns.mass_values();
+
     // Keep track of the total resulting work (the distance we moved the masses).
     // This is the result returned in the end.
     double work = 0.0;
@@ -251,58 +291,42 @@ std::pair<double, double> earth_movers_distance( MassTree const& tree, double co
     // mass that comes from the subtree below that node. Thus, for the root node, it should be
     // the same value as sum_of_masses(). Both values should be close to zero (except for numerical
     // issues), in order for the result of this function to be meaningful.
-    auto node_masses = std::vector<double>( tree.node_count(), 0.0 );
+    auto node_masses = std::vector<double>( columns.node_count(), 0.0 );
 
-    // Do a postorder traversal of the tree, starting at the root.
+    // Process the edges in postorder, starting at the root.
     // In theory, it does not matter where we start the traversal - however, the positions of the
     // masses are given as "proximal_length" on their branch, which always points away from the
     // root. Thus, if we decided to traverse from a different node than the root, we would have to
     // take this into account. So, we do start at the root, to keep it simple.
-    for( auto tree_it : postorder(tree) ) {
-
-        // If we are at the last iteration, we reached the root. Thus, we have moved all masses
-        // and don't need to proceed. If we did, we would count an edge of the root again
-        // (because the iterator traverses nodes, not edges, so the root node itself is traversed,
-        // although it has no proper edge that we would need to process).
-        if( tree_it.is_last_iteration() ) {
-            continue;
-        }
+    for( auto const edge_index : columns.postorder_edge_indices() ) {
 
         // Some shorthands.
-        const size_t pri_node_index = tree_it.edge().primary_node().index();
-        const size_t sec_node_index = tree_it.edge().secondary_node().index();
-
-        // The iterator should guarantee that its edge is always the one pointing towards the root.
-        // Still, better check this!
-        assert( sec_node_index == tree_it.node().index() );
+        const size_t pri_node_index = columns.primary_node_indices()[ edge_index ];
+        const size_t sec_node_index = columns.secondary_node_indices()[ edge_index ];
 
         // We now start a "normal" earth movers distance caluclation along the current edge.
         // We start at the end of the branch, with the mass that comes from the subtree below it...
-        double current_pos  = tree_it.edge().data<MassTreeEdgeData>().branch_length;
+        double current_pos  = columns.branch_lengths()[ edge_index ];
         double current_mass = node_masses[ sec_node_index ];
 
         // ... and move the mass along the branch, balancing it with the masses found on the branch.
-        // We use a reverse iterator in order to traverse the branch from end to start.
-        auto const& edge_masses = tree_it.edge().data<MassTreeEdgeData>().masses;
-        for(
-            auto mass_rit = edge_masses.crbegin();
-            mass_rit != edge_masses.crend();
-            ++mass_rit
-        ) {
+        // We traverse the sorted masses backwards, in order to go from the end of the branch
+        // to its start.
+        for( size_t i = offsets[ edge_index + 1 ]; i > offsets[ edge_index ]; --i ) {
             // The work is accumulated: The mass that we are currently moving times the distances
             // that we move it, taking the exponent into account.
-            work += std::pow( std::abs( current_mass ), p ) * ( current_pos - mass_rit->first );
+            work += emd_mass_work_( current_mass, p ) * ( current_pos - positions[ i - 1 ] );
 
             // Update the current position and mass.
-            current_pos   = mass_rit->first;
-            current_mass += mass_rit->second;
+            current_pos   = positions[ i - 1 ];
+            current_mass += values[ i - 1 ];
         }
 
         // After we finished moving along the branch, we need extra work to move the remaining mass
         // to the node at the top end of the branch. Also, add the remaining mass to this node, so
         // that it is available for when we process the upper part of that node (towards the root).
         // Here again we need to take the exponent into account.
-        work += std::pow( std::abs( current_mass ), p ) * current_pos;
+        work += emd_mass_work_( current_mass, p ) * current_pos;
         node_masses[ pri_node_index ] += current_mass;
     }
 
@@ -312,7 +336,8 @@ std::pair<double, double> earth_movers_distance( MassTree const& tree, double co
     }
 
     // Finally, return the needed work, and the mass at the root, as a way of correctness checking.
-    return { work, node_masses[ tree.root_node().index() ] };
+    auto const root_mass = columns.node_count() > 0 ? node_masses[ columns.root_node_index() ] : 0.0;
+    return { work, root_mass };
 }
 
 } // namespace tree
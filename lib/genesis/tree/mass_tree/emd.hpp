@@ -56,6 +56,8 @@ namespace tree {
 
     using MassTree = Tree;
 
+    class MassTreeColumns;
+
 }
 
 namespace tree {
@@ -149,6 +151,30 @@ utils::Matrix<double> earth_movers_distance( std::vector<MassTree> const& trees,
  */
 std::pair<double, double> earth_movers_distance( MassTree const& tree, double p = 1.0 );
 
+/**
+ * @brief Calculate the earth mover's distance of two distributions of masses, given as
+ * MassTreeColumns.
+ *
+ * This is the kernel that all other variants of this function use internally: it walks the sorted
+ * mass arrays of both distributions in parallel, instead of the maps of the MassTree%s.
+ * When the distance between many pairs of distributions is needed, it is thus faster to convert
+ * each MassTree into MassTreeColumns once, and then call this function for each pair.
+ * See earth_movers_distance( MassTree const&, MassTree const&, double ) for details on the
+ * calculation.
+ */
+double earth_movers_distance(
+    MassTreeColumns const& lhs,
+    MassTreeColumns const& rhs,
+    double p = 1.0
+);
+
+/**
+ * @brief Calculate the earth mover's distance of signed masses, given as MassTreeColumns.
+ *
+ * See earth_movers_distance( MassTree const&, double ) for details.
+ */
+std::pair<double, double> earth_movers_distance( MassTreeColumns const& columns, double p = 1.0 );
+
 } // namespace tree
 } // namespace genesis
 
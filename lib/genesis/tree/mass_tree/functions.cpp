@@ -32,6 +32,7 @@
 
 #include "genesis/tree/function/operators.hpp"
 #include "genesis/tree/iterator/postorder.hpp"
+#include "genesis/tree/mass_tree/columns.hpp"
 #include "genesis/tree/mass_tree/tree.hpp"
 #include "genesis/tree/tree.hpp"
 
@@ -42,6 +43,8 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <iterator>
+#include <map>
 #include <stdexcept>
 #include <utility>
 #include <vector>
@@ -53,6 +56,29 @@
 namespace genesis {
 namespace tree {
 
+// =================================================================================================
+//     Local Helpers
+// =================================================================================================
+
+/**
+ * @brief Local helper that adds a mass to a map of masses that is being filled in order of
+ * increasing positions.
+ *
+ * In that case, the new position belongs at the end of the map, so that we can insert it there
+ * in constant time, instead of searching the tree of the map. Positions that are not in order
+ * still work, but take the usual logarithmic time.
+ */
+static void mass_tree_append_mass_( std::map<double, double>& masses, double position, double mass )
+{
+    if( masses.empty() || masses.rbegin()->first < position ) {
+        masses.emplace_hint( masses.end(), position, mass );
+    } else if( masses.rbegin()->first == position ) {
+        masses.rbegin()->second += mass;
+    } else {
+        masses[ position ] += mass;
+    }
+}
+
 // =================================================================================================
 //     Manipulate Masses
 // =================================================================================================
@@ -87,8 +113,21 @@ void mass_tree_merge_trees_inplace(
     #pragma omp parallel for
     for( size_t i = 0; i < lhs.edge_count(); ++i ) {
         auto& lhs_masses = lhs.edge_at( i ).data<MassTreeEdgeData>().masses;
+
+        // Both maps are sorted by position, so we can merge them in one pass, keeping an iterator
+        // into the lhs map that serves as the insertion hint for the next rhs mass.
+        auto lhs_it = lhs_masses.begin();
         for( auto const& rhs_mass : rhs.edge_at( i ).data<MassTreeEdgeData>().masses ) {
-            lhs_masses[ rhs_mass.first ] += scaler_rhs * rhs_mass.second;
+            while( lhs_it != lhs_masses.end() && lhs_it->first < rhs_mass.first ) {
+                ++lhs_it;
+            }
+            if( lhs_it != lhs_masses.end() && lhs_it->first == rhs_mass.first ) {
+                lhs_it->second += scaler_rhs * rhs_mass.second;
+            } else {
+                lhs_it = lhs_masses.emplace_hint(
+                    lhs_it, rhs_mass.first, scaler_rhs * rhs_mass.second
+                );
+            }
         }
     }
 }
@@ -130,8 +169,9 @@ void mass_tree_normalize_masses( MassTree& tree )
         return;
     }
 
-    for( auto& edge : tree.edges() ) {
-        for( auto& mass : edge->data<MassTreeEdgeData>().masses ) {
+    #pragma omp parallel for
+    for( size_t i = 0; i < tree.edge_count(); ++i ) {
+        for( auto& mass : tree.edge_at( i ).data<MassTreeEdgeData>().masses ) {
             mass.second /= total_mass;
         }
     }
@@ -144,10 +184,10 @@ void mass_tree_transform_to_unit_branch_lengths( MassTree& tree )
         std::map<double, double> relative;
 
         for( auto& mass : edge_data.masses ) {
-            relative[ mass.first / edge_data.branch_length ] += mass.second;
+            mass_tree_append_mass_( relative, mass.first / edge_data.branch_length, mass.second );
         }
 
-        edge_data.masses = relative;
+        edge_data.masses = std::move( relative );
         edge_data.branch_length = 1.0;
     }
 }
@@ -239,15 +279,16 @@ double mass_tree_binify_masses( MassTree& tree, size_t number_of_bins )
         auto new_masses = std::map<double, double>();
 
         // Accumulate masses at the closest bins, and accumulate the work needed to do so.
+        // The bins are monotonous in the positions, so we can append them to the new map.
         for( auto const& mass : edge_data.masses ) {
             auto const bin = get_bin_pos( mass.first, edge_data.branch_length );
 
-            work              += mass.second * std::abs( bin - mass.first );
-            new_masses[ bin ] += mass.second;
+            work += mass.second * std::abs( bin - mass.first );
+            mass_tree_append_mass_( new_masses, bin, mass.second );
         }
 
         // Replace masses by new accumuated ones.
-        edge_data.masses = new_masses;
+        edge_data.masses = std::move( new_masses );
     }
 
     return work;
@@ -271,6 +312,21 @@ std::vector<double> mass_tree_mass_per_edge( MassTree const& tree )
     return result;
 }
 
+std::vector<double> mass_tree_mass_per_edge( MassTreeColumns const& columns )
+{
+    auto result = std::vector<double>( columns.edge_count(), 0.0 );
+
+    auto const& offsets = columns.mass_offsets();
+    auto const& values  = columns.mass_values();
+    for( size_t e = 0; e < columns.edge_count(); ++e ) {
+        for( size_t i = offsets[ e ]; i < offsets[ e + 1 ]; ++i ) {
+            result[ e ] += values[ i ];
+        }
+    }
+
+    return result;
+}
+
 double mass_tree_sum_of_masses( MassTree const& tree )
 {
     double total_mass = 0.0;
@@ -282,6 +338,15 @@ double mass_tree_sum_of_masses( MassTree const& tree )
     return total_mass;
 }
 
+double mass_tree_sum_of_masses( MassTreeColumns const& columns )
+{
+    double total_mass = 0.0;
+    for( auto const& value : columns.mass_values() ) {
+        total_mass += value;
+    }
+    return total_mass;
+}
+
 bool mass_tree_validate( MassTree const& tree, double valid_total_mass_difference )
 {
     // Check tree.
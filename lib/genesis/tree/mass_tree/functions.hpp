@@ -56,6 +56,8 @@ namespace tree {
 
     using MassTree = Tree;
 
+    class MassTreeColumns;
+
 }
 
 namespace tree {
@@ -180,6 +182,13 @@ double mass_tree_binify_masses( MassTree& tree, size_t number_of_bins );
  */
 std::vector<double> mass_tree_mass_per_edge( MassTree const& tree );
 
+/**
+ * @brief Return the total mass for each edge of the MassTreeColumns.
+ *
+ * See mass_tree_mass_per_edge( MassTree const& ) for details.
+ */
+std::vector<double> mass_tree_mass_per_edge( MassTreeColumns const& columns );
+
 /**
  * @brief Return the total sum of all masses on the ::MassTree.
  *
@@ -192,6 +201,13 @@ std::vector<double> mass_tree_mass_per_edge( MassTree const& tree );
  */
 double mass_tree_sum_of_masses( MassTree const& tree );
 
+/**
+ * @brief Return the total sum of all masses of the MassTreeColumns.
+ *
+ * See mass_tree_sum_of_masses( MassTree const& ) for details.
+ */
+double mass_tree_sum_of_masses( MassTreeColumns const& columns );
+
 /**
  * @brief Validate the data on a ::MassTree.
  *
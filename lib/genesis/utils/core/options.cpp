@@ -47,6 +47,7 @@
 #endif
 
 #ifdef GENESIS_PTHREADS
+#    include "genesis/utils/core/thread_pool.hpp"
 #    include <thread>
 #endif
 
@@ -63,8 +64,9 @@ Options::Options()
     #if defined( GENESIS_OPENMP )
 
         // Initialize threads to number of OpenMP threads, which might be set through the
-        // `OMP_NUM_THREADS` environment variable.
-        number_of_threads( omp_get_num_threads() );
+        // `OMP_NUM_THREADS` environment variable. We are not in a parallel region here,
+        // so we need the maximum instead of the current number of threads, which would be 1.
+        number_of_threads( omp_get_max_threads() );
 
     #elif defined( GENESIS_PTHREADS )
 
@@ -78,6 +80,13 @@ Options::Options()
 
     #endif
 
+    // Initialize io threads with the actual number of cores, if available.
+    #if defined( GENESIS_PTHREADS )
+        io_threads( std::thread::hardware_concurrency() );
+    #else
+        io_threads( 1 );
+    #endif
+
     // Initialize random seed with time.
     random_seed( std::chrono::system_clock::now().time_since_epoch().count() );
 }
@@ -111,16 +120,33 @@ void Options::command_line( int const argc, char const* const* argv )
 
 void Options::number_of_threads (const unsigned int number)
 {
-    number_of_threads_ = number;
+    // Zero is used by std::thread::hardware_concurrency() if the number is not computable.
+    number_of_threads_ = ( number == 0 ? 1 : number );
 
     #if defined( GENESIS_OPENMP )
 
         // If we use OpenMp, set the thread number there, too.
-        omp_set_num_threads( number );
+        omp_set_num_threads( number_of_threads_ );
 
     #endif
 }
 
+#ifdef GENESIS_PTHREADS
+
+ThreadPool& Options::thread_pool()
+{
+    static ThreadPool pool( number_of_threads() );
+    return pool;
+}
+
+#endif
+
+void Options::io_threads( unsigned int number )
+{
+    // Zero is used by std::thread::hardware_concurrency() if the number is not computable.
+    io_threads_ = ( number == 0 ? 1 : number );
+}
+
 bool Options::using_pthreads() const
 {
     #ifdef GENESIS_PTHREADS
@@ -139,6 +165,24 @@ bool Options::using_openmp() const
     #endif
 }
 
+bool Options::using_zlib() const
+{
+    #ifdef GENESIS_ZLIB
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+bool Options::using_zstd() const
+{
+    #ifdef GENESIS_ZSTD
+        return true;
+    #else
+        return false;
+    #endif
+}
+
 // =================================================================================================
 //     Random Seed & Engine
 // =================================================================================================
@@ -323,12 +367,15 @@ std::string Options::info() const
     res += "Endianness:        " + std::string( is_little_endian() ? "little endian" : "big endian" ) + "\n";
     res += "Using Pthreads:    " + std::string( using_pthreads() ? "true" : "false" ) + "\n";
     res += "Using OpenMP:      " + std::string( using_openmp() ? "true" : "false" ) + "\n";
+    res += "Using zlib:        " + std::string( using_zlib() ? "true" : "false" ) + "\n";
+    res += "Using zstd:        " + std::string( using_zstd() ? "true" : "false" ) + "\n";
 
     res += "\n";
     res += "Run Time Options\n";
     res += "=============================================\n\n";
     res += "Command line:      " + command_line_string() + "\n";
     res += "Number of threads: " + std::to_string( number_of_threads() ) + "\n";
+    res += "IO threads:        " + std::to_string( io_threads() ) + "\n";
     res += "Random seed:       " + std::to_string( random_seed_ ) + "\n";
     return res;
 }
@@ -38,6 +38,14 @@
 namespace genesis {
 namespace utils {
 
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+#ifdef GENESIS_PTHREADS
+    class ThreadPool;
+#endif
+
 // =================================================================================================
 //     Options
 // =================================================================================================
@@ -103,10 +111,50 @@ public:
      * @brief Overwrite the system given number of threads.
      *
      * On startup, the value is initialized with the actual number of cores available in the system
-     * using std::thread::hardware_concurrency(). This method overwrites this value.
+     * using std::thread::hardware_concurrency(), or, if OpenMP is used, with the maximal number of
+     * OpenMP threads, which can be set through the `OMP_NUM_THREADS` environment variable.
+     * This method overwrites this value.
      */
     void number_of_threads (const unsigned int number);
 
+#ifdef GENESIS_PTHREADS
+
+    /**
+     * @brief Return the process-wide thread pool for parallel computations.
+     *
+     * All parallel parsing and computing in Genesis that uses a ThreadPool shares this pool, so
+     * that they do not compete for the cores with pools of their own. The pool is created on first
+     * use, with number_of_threads() many threads, so this value has to be set before that in order
+     * to take effect. Reading and writing uses a separate pool, see io_threads().
+     *
+     * This function is only available if the `GENESIS_PTHREADS` macro definition is set.
+     */
+    ThreadPool& thread_pool();
+
+#endif
+
+    /**
+     * @brief Returns the number of threads used for asynchronous input reading and output writing.
+     *
+     * See io_threads( unsigned int ) for details.
+     */
+    inline unsigned int io_threads() const
+    {
+        return io_threads_;
+    }
+
+    /**
+     * @brief Set the number of threads used for asynchronous input reading and output writing.
+     *
+     * All @link AsynchronousReader AsynchronousReaders@endlink and
+     * @link AsynchronousWriter AsynchronousWriters@endlink (and hence, all InputStream%s and
+     * OutputStream%s) share one process-wide pool of this many threads.
+     * This is thus the maximum number of reads and writes that run concurrently. The pool is
+     * created when it is first needed, so this value has to be set before the first input is read
+     * or output is written in order to take effect. On startup, it is initialized with the number of cores in the system.
+     */
+    void io_threads( unsigned int number );
+
     /**
      * @brief Return whether the binary was compiled using Pthreads.
      */
@@ -117,6 +165,16 @@ public:
      */
     bool using_openmp() const;
 
+    /**
+     * @brief Return whether the binary was compiled using zlib, for reading gzip compressed files.
+     */
+    bool using_zlib() const;
+
+    /**
+     * @brief Return whether the binary was compiled using zstd, for reading zstd compressed files.
+     */
+    bool using_zstd() const;
+
     // -------------------------------------------------------------------------
     //     Random Seed & Engine
     // -------------------------------------------------------------------------
@@ -289,6 +347,7 @@ private:
 
     std::vector<std::string>   command_line_;
     unsigned int               number_of_threads_;
+    unsigned int               io_threads_;
 
     unsigned                   random_seed_;
     std::default_random_engine random_engine_;
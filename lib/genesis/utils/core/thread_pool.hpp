@@ -0,0 +1,205 @@
+#ifndef GENESIS_UTILS_CORE_THREAD_POOL_H_
+#define GENESIS_UTILS_CORE_THREAD_POOL_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#ifdef GENESIS_PTHREADS
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Thread Pool
+// =================================================================================================
+
+/**
+ * @brief Simple thread pool with a fixed number of worker threads and a shared task queue.
+ *
+ * Tasks are submitted via enqueue(), which returns a `std::future` for the result of the task.
+ * Exceptions thrown by a task are stored in its future, and re-thrown when calling `get()` on it.
+ * The tasks are started in the order in which they were submitted. The destructor waits for all
+ * submitted tasks to be finished.
+ *
+ * Tasks must not wait for other tasks of the same pool to finish, as this can dead-lock the pool
+ * if all workers are waiting. Functions that submit tasks and wait for them can use
+ * is_worker_thread() to detect that they are themselves run by a task of the pool, and do their
+ * work in the calling thread instead.
+ *
+ * This class is only available if threading is available, that is, if the `GENESIS_PTHREADS` macro
+ * definition is set.
+ */
+class ThreadPool
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct a thread pool with the given number of worker threads.
+     *
+     * At least one thread is always used.
+     */
+    explicit ThreadPool( size_t num_threads )
+    {
+        if( num_threads == 0 ) {
+            num_threads = 1;
+        }
+
+        workers_.reserve( num_threads );
+        for( size_t i = 0; i < num_threads; ++i ) {
+            workers_.emplace_back( [this] {
+                while( true ) {
+                    std::function< void() > task;
+
+                    // Wait for a task, or for the signal to stop.
+                    {
+                        std::unique_lock< std::mutex > guard( lock_ );
+                        cond_task_.wait( guard, [this] {
+                            return stop_ || ! tasks_.empty();
+                        });
+                        if( stop_ && tasks_.empty() ) {
+                            return;
+                        }
+                        task = std::move( tasks_.front() );
+                        tasks_.pop();
+                    }
+
+                    // Run the task. Exceptions are captured by its packaged task.
+                    task();
+                }
+            });
+        }
+    }
+
+    ThreadPool( ThreadPool const& ) = delete;
+    ThreadPool( ThreadPool&& )      = delete;
+
+    ThreadPool& operator= ( ThreadPool const& ) = delete;
+    ThreadPool& operator= ( ThreadPool&& )      = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::unique_lock< std::mutex > guard( lock_ );
+            stop_ = true;
+        }
+        cond_task_.notify_all();
+        for( auto& worker : workers_ ) {
+            worker.join();
+        }
+    }
+
+    // -------------------------------------------------------------
+    //     Members
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Return the number of worker threads of the pool.
+     */
+    size_t size() const
+    {
+        return workers_.size();
+    }
+
+    /**
+     * @brief Return whether the calling thread is one of the worker threads of this pool.
+     */
+    bool is_worker_thread() const
+    {
+        auto const id = std::this_thread::get_id();
+        for( auto const& worker : workers_ ) {
+            if( worker.get_id() == id ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Submit a task to the pool, and return a future for its result.
+     */
+    template< class F, class... Args >
+    auto enqueue( F&& f, Args&&... args )
+    -> std::future< typename std::result_of< F( Args... )>::type >
+    {
+        using result_type = typename std::result_of< F( Args... )>::type;
+
+        auto task = std::make_shared< std::packaged_task< result_type() >>(
+            std::bind( std::forward< F >( f ), std::forward< Args >( args )... )
+        );
+        auto result = task->get_future();
+
+        {
+            std::unique_lock< std::mutex > guard( lock_ );
+            if( stop_ ) {
+                throw std::runtime_error( "Cannot enqueue tasks into a stopped ThreadPool." );
+            }
+            tasks_.emplace( [task] () {
+                ( *task )();
+            });
+        }
+        cond_task_.notify_one();
+        return result;
+    }
+
+    // -------------------------------------------------------------
+    //     Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    std::vector< std::thread >            workers_;
+    std::queue< std::function< void() >>  tasks_;
+
+    std::mutex              lock_;
+    std::condition_variable cond_task_;
+    bool                    stop_ = false;
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // GENESIS_PTHREADS
+
+#endif // include guard
@@ -34,12 +34,15 @@
 #include <assert.h>
 #include <cctype>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <stdexcept>
 
 #include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
 #include "genesis/utils/io/input_stream.hpp"
+#include "genesis/utils/io/parallel_chunk_reader.hpp"
 #include "genesis/utils/io/parser.hpp"
 #include "genesis/utils/io/scanner.hpp"
 #include "genesis/utils/text/string.hpp"
@@ -56,8 +59,7 @@ namespace utils {
  */
 CsvReader::table CsvReader::from_stream( std::istream& is ) const
 {
-    utils::InputStream it( utils::make_unique< utils::StreamInputSource >( is ));
-    return parse_document( it );
+    return read_source_( utils::make_unique< utils::StreamInputSource >( is ));
 }
 
 /**
@@ -65,8 +67,7 @@ CsvReader::table CsvReader::from_stream( std::istream& is ) const
  */
 CsvReader::table CsvReader::from_file( std::string const& fn ) const
 {
-    utils::InputStream it( utils::make_unique< utils::FileInputSource >( fn ));
-    return parse_document( it );
+    return read_source_( utils::from_file( fn ));
 }
 
 /**
@@ -74,8 +75,41 @@ CsvReader::table CsvReader::from_file( std::string const& fn ) const
  */
 CsvReader::table CsvReader::from_string( std::string const& fs ) const
 {
-    utils::InputStream it( utils::make_unique< utils::StringInputSource >( fs ));
-    return parse_document( it );
+    return read_source_( utils::make_unique< utils::StringInputSource >( fs ));
+}
+
+/**
+ * @brief Read from an input source, using parallel parsing if set.
+ */
+CsvReader::table CsvReader::read_source_( std::unique_ptr<BaseInputSource> input_source ) const
+{
+    // Simple case: Create an input stream and process it.
+    if( ! parallel_parsing_ ) {
+        utils::InputStream it( std::move( input_source ));
+        return parse_document( it );
+    }
+
+    // Parse chunks of lines in parallel, and move them to the result in input order.
+    // Each chunk uses its own copy of the reader, as the parsing buffer is not thread safe.
+    table result;
+    auto const boundary = csv_record_boundary(
+        quotation_chars_, separator_chars_, comment_chars_, use_escapes_
+    );
+    ParallelChunkReader( boundary ).read<table>(
+        std::move( input_source ),
+        [&]( utils::InputStream& it ){
+            auto const reader = *this;
+            return reader.parse_document( it );
+        },
+        [&]( table& chunk ){
+            result.insert(
+                result.end(),
+                std::make_move_iterator( chunk.begin() ),
+                std::make_move_iterator( chunk.end() )
+            );
+        }
+    );
+    return result;
 }
 
 // =================================================================================================
@@ -552,5 +586,39 @@ bool CsvReader::use_twin_quotes() const
     return use_twin_quotes_;
 }
 
+// ---------------------------------------------------------------------
+//     parallel_parsing
+// ---------------------------------------------------------------------
+
+/**
+ * @brief Set whether to parse the input in parallel.
+ *
+ * If set to `true`, the reading functions from_...() split the input into large chunks of lines,
+ * which are then parsed in parallel, using ParallelChunkReader with
+ * @link Options::number_of_threads() Options::get().number_of_threads()@endlink many threads.
+ * Quoted fields that contain new line chars are kept intact. The resulting table is the same
+ * as without parallel parsing. However, line numbers in error messages are relative to the chunk
+ * in which the error occured.
+ *
+ * Default is `false`. This setting does not affect the parse_...() functions.
+ *
+ * The function returns a reference to the CsvReader object in order to allow a fluent interface.
+ */
+CsvReader& CsvReader::parallel_parsing( bool value )
+{
+    parallel_parsing_ = value;
+    return *this;
+}
+
+/**
+ * @brief Return whether to parse the input in parallel.
+ *
+ * See the @link parallel_parsing( bool value ) setter @endlink of this function for details.
+ */
+bool CsvReader::parallel_parsing() const
+{
+    return parallel_parsing_;
+}
+
 } // namespace utils
 } // namespace genesis
@@ -32,6 +32,7 @@
  */
 
 #include <iosfwd>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -43,6 +44,7 @@ namespace utils {
 // =================================================================================================
 
 class InputStream;
+class BaseInputSource;
 
 // =================================================================================================
 //     Csv Reader
@@ -147,12 +149,21 @@ public:
     CsvReader& use_twin_quotes( bool value );
     bool       use_twin_quotes() const;
 
+    CsvReader& parallel_parsing( bool value );
+    bool       parallel_parsing() const;
+
     // ---------------------------------------------------------------------
-    //     Members
+    //     Internal Functions
     // ---------------------------------------------------------------------
 
 private:
 
+    table read_source_( std::unique_ptr<BaseInputSource> input_source ) const;
+
+    // ---------------------------------------------------------------------
+    //     Members
+    // ---------------------------------------------------------------------
+
     // We store the following char sets as strings and use find() to check whether a given char
     // is part of the sets. This is linear in length of the string. As there are usually just a
     // few chars in there, this is fast. We also tested with a char lookup table, which offers
@@ -166,6 +177,7 @@ private:
     bool        merge_separators_  = false;
     bool        use_escapes_       = false;
     bool        use_twin_quotes_   = true;
+    bool        parallel_parsing_  = false;
 
     // We use a buffer in order to make copying and resizing strings rare and hence fast.
     // This buffer will grow for bigger csv input fields (but never shrink). We then copy from it,
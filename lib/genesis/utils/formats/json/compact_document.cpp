@@ -0,0 +1,393 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/formats/json/compact_document.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Json Compact Value
+// =================================================================================================
+
+JsonCompactEntry const JsonCompactValue::null_entry_ = JsonCompactEntry();
+
+std::string JsonCompactValue::type_name() const
+{
+    switch( entry_->type ) {
+        case ValueType::kNull: {
+            return "null";
+        }
+        case ValueType::kArray: {
+            return "array";
+        }
+        case ValueType::kObject: {
+            return "object";
+        }
+        case ValueType::kString: {
+            return "string";
+        }
+        case ValueType::kBoolean: {
+            return "boolean";
+        }
+        case ValueType::kNumberFloat: {
+            return "float";
+        }
+        case ValueType::kNumberSigned: {
+            return "signed integer";
+        }
+        case ValueType::kNumberUnsigned: {
+            return "unsigned integer";
+        }
+        default: {
+            assert( false );
+            return "";
+        }
+    }
+}
+
+// -------------------------------------------------------------------------
+//     Element Access
+// -------------------------------------------------------------------------
+
+JsonCompactValue JsonCompactValue::at( size_t index ) const
+{
+    if( ! is_array() ) {
+        throw std::domain_error( "Cannot use at() with " + type_name() );
+    }
+    if( index >= entry_->size ) {
+        throw std::out_of_range( "Array index " + std::to_string( index ) + " is out of range." );
+    }
+    return element_( entry_->offset + index );
+}
+
+JsonCompactValue JsonCompactValue::at( std::string const& key ) const
+{
+    if( ! is_object() ) {
+        throw std::domain_error( "Cannot use at() with " + type_name() );
+    }
+    auto const it = find( key );
+    if( it == end() ) {
+        throw std::out_of_range( "Invalid key '" + key + "' for object access." );
+    }
+    return it.value();
+}
+
+// -------------------------------------------------------------------------
+//     Lookup
+// -------------------------------------------------------------------------
+
+bool JsonCompactValue::key_equals_( size_t index, std::string const& key ) const
+{
+    auto const& entry = entries_[ index ];
+    assert( entry.type == ValueType::kString );
+    return entry.size == key.size() &&
+        std::memcmp( strings_ + entry.offset, key.data(), entry.size ) == 0;
+}
+
+JsonCompactIterator JsonCompactValue::find( std::string const& key ) const
+{
+    if( ! is_object() ) {
+        return end();
+    }
+
+    // Search backwards, so that we find the last occurrence of duplicate keys.
+    for( size_t i = entry_->size; i > 0; --i ) {
+        if( key_equals_( entry_->offset + 2 * ( i - 1 ), key )) {
+            return JsonCompactIterator( *this, i - 1 );
+        }
+    }
+    return end();
+}
+
+size_t JsonCompactValue::count( std::string const& key ) const
+{
+    return find( key ) == end() ? 0 : 1;
+}
+
+// -------------------------------------------------------------------------
+//     Iterators
+// -------------------------------------------------------------------------
+
+JsonCompactIterator JsonCompactValue::begin() const
+{
+    // Null values are empty, so begin() == end() for them.
+    return JsonCompactIterator( *this, is_null() ? 1 : 0 );
+}
+
+JsonCompactIterator JsonCompactValue::end() const
+{
+    return JsonCompactIterator( *this, is_structured() ? entry_->size : 1 );
+}
+
+JsonCompactIterator JsonCompactValue::cbegin() const
+{
+    return begin();
+}
+
+JsonCompactIterator JsonCompactValue::cend() const
+{
+    return end();
+}
+
+// -------------------------------------------------------------------------
+//     Conversion
+// -------------------------------------------------------------------------
+
+JsonDocument JsonCompactValue::to_document() const
+{
+    switch( entry_->type ) {
+        case ValueType::kNull: {
+            return JsonDocument();
+        }
+        case ValueType::kArray: {
+            auto result = JsonDocument::array();
+            auto& array = result.get_array();
+            array.reserve( entry_->size );
+            for( auto const& element : *this ) {
+                array.push_back( element.to_document() );
+            }
+            return result;
+        }
+        case ValueType::kObject: {
+            auto result = JsonDocument::object();
+            auto& object = result.get_object();
+            for( auto it = begin(); it != end(); ++it ) {
+                object[ it.key() ] = it.value().to_document();
+            }
+            return result;
+        }
+        case ValueType::kString: {
+            return JsonDocument::string( get_string() );
+        }
+        case ValueType::kBoolean: {
+            return JsonDocument::boolean( entry_->boolean );
+        }
+        case ValueType::kNumberFloat: {
+            return JsonDocument::number_float( entry_->number_float );
+        }
+        case ValueType::kNumberSigned: {
+            return JsonDocument::number_signed( entry_->number_signed );
+        }
+        case ValueType::kNumberUnsigned: {
+            return JsonDocument::number_unsigned( entry_->number_unsigned );
+        }
+        default: {
+            throw std::runtime_error( "Invalid Json Value Type." );
+        }
+    }
+}
+
+// =================================================================================================
+//     Json Compact Document
+// =================================================================================================
+
+JsonCompactIterator JsonCompactDocument::find( std::string const& key ) const
+{
+    return root().find( key );
+}
+
+size_t JsonCompactDocument::count( std::string const& key ) const
+{
+    return root().count( key );
+}
+
+JsonCompactIterator JsonCompactDocument::begin() const
+{
+    return root().begin();
+}
+
+JsonCompactIterator JsonCompactDocument::end() const
+{
+    return root().end();
+}
+
+// =================================================================================================
+//     Json Compact Builder
+// =================================================================================================
+
+// -------------------------------------------------------------------------
+//     Events
+// -------------------------------------------------------------------------
+
+void JsonCompactBuilder::start_object()
+{
+    starts_.push_back( stack_.size() );
+}
+
+void JsonCompactBuilder::end_object()
+{
+    close_( JsonDocument::ValueType::kObject );
+}
+
+void JsonCompactBuilder::start_array()
+{
+    starts_.push_back( stack_.size() );
+}
+
+void JsonCompactBuilder::end_array()
+{
+    close_( JsonDocument::ValueType::kArray );
+}
+
+void JsonCompactBuilder::key( std::string& key )
+{
+    JsonCompactEntry entry;
+    entry.type = JsonDocument::ValueType::kString;
+    entry.size = static_cast<std::uint32_t>( key.size() );
+
+    auto const it = keys_.find( key );
+    if( it != keys_.end() ) {
+        entry.offset = it->second;
+    } else {
+        entry.offset = add_string_( key );
+        keys_.emplace( std::move( key ), entry.offset );
+    }
+    stack_.push_back( entry );
+}
+
+void JsonCompactBuilder::string_value( std::string& value )
+{
+    JsonCompactEntry entry;
+    entry.type   = JsonDocument::ValueType::kString;
+    entry.size   = static_cast<std::uint32_t>( value.size() );
+    entry.offset = add_string_( value );
+    stack_.push_back( entry );
+}
+
+void JsonCompactBuilder::number_unsigned( std::uint64_t value )
+{
+    JsonCompactEntry entry;
+    entry.type            = JsonDocument::ValueType::kNumberUnsigned;
+    entry.number_unsigned = value;
+    stack_.push_back( entry );
+}
+
+void JsonCompactBuilder::number_signed( std::int64_t value )
+{
+    JsonCompactEntry entry;
+    entry.type          = JsonDocument::ValueType::kNumberSigned;
+    entry.number_signed = value;
+    stack_.push_back( entry );
+}
+
+void JsonCompactBuilder::number_float( double value )
+{
+    JsonCompactEntry entry;
+    entry.type         = JsonDocument::ValueType::kNumberFloat;
+    entry.number_float = value;
+    stack_.push_back( entry );
+}
+
+void JsonCompactBuilder::boolean( bool value )
+{
+    JsonCompactEntry entry;
+    entry.type    = JsonDocument::ValueType::kBoolean;
+    entry.boolean = value;
+    stack_.push_back( entry );
+}
+
+void JsonCompactBuilder::null()
+{
+    stack_.push_back( JsonCompactEntry() );
+}
+
+// -------------------------------------------------------------------------
+//     Result
+// -------------------------------------------------------------------------
+
+JsonCompactDocument JsonCompactBuilder::finish()
+{
+    if( ! starts_.empty() || stack_.size() > 1 ) {
+        throw std::runtime_error( "Cannot finish incomplete Json document." );
+    }
+
+    // The root value is the last entry of the arena, after all its children.
+    auto& entries = document_.entries_;
+    if( stack_.empty() ) {
+        entries.push_back( JsonCompactEntry() );
+    } else {
+        entries.push_back( stack_.back() );
+    }
+    document_.root_ = entries.size() - 1;
+
+    // Reset the builder for the next document.
+    auto result = std::move( document_ );
+    document_   = JsonCompactDocument();
+    document_.entries_.clear();
+    stack_.clear();
+    keys_.clear();
+    return result;
+}
+
+// -------------------------------------------------------------------------
+//     Internal Helpers
+// -------------------------------------------------------------------------
+
+void JsonCompactBuilder::close_( JsonDocument::ValueType type )
+{
+    assert( ! starts_.empty() );
+    auto const start = starts_.back();
+    starts_.pop_back();
+
+    // Move the elements of the container to the arena, as one contiguous range.
+    auto& entries = document_.entries_;
+    auto const size = stack_.size() - start;
+    auto const count = ( type == JsonDocument::ValueType::kObject ? size / 2 : size );
+    if( count > std::numeric_limits<std::uint32_t>::max() ) {
+        throw std::length_error( "Json container too large for JsonCompactDocument." );
+    }
+
+    JsonCompactEntry entry;
+    entry.type   = type;
+    entry.size   = static_cast<std::uint32_t>( count );
+    entry.offset = entries.size();
+    entries.insert( entries.end(), stack_.begin() + start, stack_.end() );
+    stack_.resize( start );
+    stack_.push_back( entry );
+}
+
+std::uint64_t JsonCompactBuilder::add_string_( std::string const& str )
+{
+    if( str.size() > std::numeric_limits<std::uint32_t>::max() ) {
+        throw std::length_error( "Json string too large for JsonCompactDocument." );
+    }
+    auto const offset = document_.strings_.size();
+    document_.strings_.insert( document_.strings_.end(), str.begin(), str.end() );
+    return offset;
+}
+
+} // namespace utils
+} // namespace genesis
@@ -0,0 +1,918 @@
+#ifndef GENESIS_UTILS_FORMATS_JSON_COMPACT_DOCUMENT_H_
+#define GENESIS_UTILS_FORMATS_JSON_COMPACT_DOCUMENT_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/formats/json/document.hpp"
+#include "genesis/utils/formats/json/sax_reader.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class JsonCompactIterator;
+class JsonCompactDocument;
+class JsonCompactBuilder;
+
+// =================================================================================================
+//     Json Compact Entry
+// =================================================================================================
+
+/**
+ * @brief Tagged 16 byte representation of a single value in a JsonCompactDocument.
+ *
+ * Numbers and booleans are stored in place. For strings, `size` is the length of the string,
+ * and `offset` its first char in the string pool of the document. For arrays and objects,
+ * `size` is the number of elements or members, and `offset` is the index of the first entry
+ * of the contiguous range of entries that contains the elements, or the keys and values of the
+ * members, which are stored alternatingly.
+ */
+struct JsonCompactEntry
+{
+    JsonDocument::ValueType type = JsonDocument::ValueType::kNull;
+    std::uint32_t           size = 0;
+
+    union
+    {
+        JsonDocument::NumberFloatType    number_float;
+        JsonDocument::NumberSignedType   number_signed;
+        JsonDocument::NumberUnsignedType number_unsigned;
+        JsonDocument::BooleanType        boolean;
+        std::uint64_t                    offset = 0;
+    };
+};
+
+static_assert( sizeof( JsonCompactEntry ) == 16, "JsonCompactEntry is expected to be 16 bytes." );
+
+// =================================================================================================
+//     Json Compact Value
+// =================================================================================================
+
+/**
+ * @brief Read-only view of a value in a JsonCompactDocument.
+ *
+ * The class offers the same accessors as a const JsonDocument, so that code that reads from a
+ * JsonDocument can be used with a JsonCompactDocument with few changes. As the values are not
+ * stored as individual objects, the accessors return new views or copies instead of references.
+ * In particular, get_string() returns a copy of the string; use string_data() and string_size()
+ * to access the chars in the string pool directly instead.
+ *
+ * A view stays valid as long as the document that it belongs to exists, including when the
+ * document is moved. A default constructed view is a `null` value.
+ */
+class JsonCompactValue
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Typedefs and Enums
+    // ---------------------------------------------------------------------
+
+    using ValueType          = JsonDocument::ValueType;
+    using StringType         = JsonDocument::StringType;
+    using BooleanType        = JsonDocument::BooleanType;
+    using NumberFloatType    = JsonDocument::NumberFloatType;
+    using NumberSignedType   = JsonDocument::NumberSignedType;
+    using NumberUnsignedType = JsonDocument::NumberUnsignedType;
+
+    using iterator           = JsonCompactIterator;
+    using const_iterator     = JsonCompactIterator;
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    JsonCompactValue()
+        : entries_( &null_entry_ )
+        , strings_( nullptr )
+        , entry_( &null_entry_ )
+    {}
+
+    JsonCompactValue(
+        JsonCompactEntry const* entries, char const* strings, JsonCompactEntry const* entry
+    )
+        : entries_( entries )
+        , strings_( strings )
+        , entry_( entry )
+    {}
+
+    ~JsonCompactValue() = default;
+
+    JsonCompactValue( JsonCompactValue const& ) = default;
+    JsonCompactValue( JsonCompactValue&& )      = default;
+
+    JsonCompactValue& operator= ( JsonCompactValue const& ) = default;
+    JsonCompactValue& operator= ( JsonCompactValue&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Type Inspection
+    // ---------------------------------------------------------------------
+
+    ValueType type() const
+    {
+        return entry_->type;
+    }
+
+    bool is_primitive() const
+    {
+        return is_null() or is_string() or is_boolean() or is_number();
+    }
+
+    bool is_structured() const
+    {
+        return is_array() or is_object();
+    }
+
+    bool is_null() const
+    {
+        return entry_->type == ValueType::kNull;
+    }
+
+    bool is_array() const
+    {
+        return entry_->type == ValueType::kArray;
+    }
+
+    bool is_object() const
+    {
+        return entry_->type == ValueType::kObject;
+    }
+
+    bool is_string() const
+    {
+        return entry_->type == ValueType::kString;
+    }
+
+    bool is_boolean() const
+    {
+        return entry_->type == ValueType::kBoolean;
+    }
+
+    bool is_number() const
+    {
+        return is_number_integer() or is_number_float();
+    }
+
+    bool is_number_float() const
+    {
+        return entry_->type == ValueType::kNumberFloat;
+    }
+
+    bool is_number_integer() const
+    {
+        return is_number_signed() or is_number_unsigned();
+    }
+
+    bool is_number_signed() const
+    {
+        return entry_->type == ValueType::kNumberSigned;
+    }
+
+    bool is_number_unsigned() const
+    {
+        return entry_->type == ValueType::kNumberUnsigned;
+    }
+
+    std::string type_name() const;
+
+    // ---------------------------------------------------------------------
+    //     Capacity
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return whether the value is empty, using the same semantics as JsonDocument::empty().
+     */
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Return the number of elements, using the same semantics as JsonDocument::size().
+     *
+     * That is, null values have size 0, arrays and objects the number of their elements or
+     * members, and all other values have size 1.
+     */
+    size_t size() const
+    {
+        switch( entry_->type ) {
+            case ValueType::kNull:
+                return 0;
+            case ValueType::kArray:
+            case ValueType::kObject:
+                return entry_->size;
+            default:
+                return 1;
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    //     Value Access
+    // ---------------------------------------------------------------------
+
+    StringType get_string() const
+    {
+        return StringType( string_data(), string_size() );
+    }
+
+    char const* string_data() const
+    {
+        if( ! is_string() ) {
+            throw std::domain_error( "Cannot use get_string() with " + type_name() + "." );
+        }
+        return strings_ + entry_->offset;
+    }
+
+    size_t string_size() const
+    {
+        if( ! is_string() ) {
+            throw std::domain_error( "Cannot use get_string() with " + type_name() + "." );
+        }
+        return entry_->size;
+    }
+
+    BooleanType get_boolean() const
+    {
+        if( ! is_boolean() ) {
+            throw std::domain_error( "Cannot use get_boolean() with " + type_name() + "." );
+        }
+        return entry_->boolean;
+    }
+
+    NumberFloatType get_number_float() const
+    {
+        if( ! is_number_float() ) {
+            throw std::domain_error( "Cannot use get_number_float() with " + type_name() + "." );
+        }
+        return entry_->number_float;
+    }
+
+    NumberSignedType get_number_signed() const
+    {
+        if( ! is_number_signed() ) {
+            throw std::domain_error( "Cannot use get_number_signed() with " + type_name() + "." );
+        }
+        return entry_->number_signed;
+    }
+
+    NumberUnsignedType get_number_unsigned() const
+    {
+        if( ! is_number_unsigned() ) {
+            throw std::domain_error(
+                "Cannot use get_number_unsigned() with " + type_name() + "."
+            );
+        }
+        return entry_->number_unsigned;
+    }
+
+    template<typename T>
+    T get_number() const
+    {
+        if( is_number_float() ) {
+            return entry_->number_float;
+        } else if( is_number_signed() ) {
+            return entry_->number_signed;
+        } else if( is_number_unsigned() ) {
+            return entry_->number_unsigned;
+        } else {
+            throw std::domain_error( "Cannot use get_number<T>() with " + type_name() + "." );
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    //     Element Access
+    // ---------------------------------------------------------------------
+
+    JsonCompactValue at( size_t index ) const;
+    JsonCompactValue at( std::string const& key ) const;
+
+    /**
+     * @brief Return the element at the given index of an array, without bounds checking.
+     */
+    JsonCompactValue operator [] ( size_t index ) const
+    {
+        if( ! is_array() ) {
+            throw std::domain_error( "Cannot use operator[] with " + type_name() );
+        }
+        assert( index < entry_->size );
+        return element_( entry_->offset + index );
+    }
+
+    /**
+     * @brief Return the value of the member with the given key of an object.
+     *
+     * In contrast to JsonDocument, this throws if the key does not exist.
+     */
+    JsonCompactValue operator [] ( std::string const& key ) const
+    {
+        return at( key );
+    }
+
+    // ---------------------------------------------------------------------
+    //     Lookup
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Find the member with the given key in an object.
+     *
+     * Returns the end() iterator if the key is not found, or if the value is not an object.
+     * Members are searched linearly. If a key appears multiple times, the last one is found,
+     * which is the one that a JsonDocument would store.
+     */
+    JsonCompactIterator find( std::string const& key ) const;
+
+    size_t count( std::string const& key ) const;
+
+    // ---------------------------------------------------------------------
+    //     Iterators
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return an iterator to the first element of the value.
+     *
+     * Same as for JsonDocument, this iterates the elements of arrays and the members of objects,
+     * while other values are treated as containing themselves as a single element.
+     * In contrast to the JsonDocument, the members of objects are iterated in the order in which
+     * they appear in the input, instead of being sorted by their keys.
+     */
+    JsonCompactIterator begin() const;
+    JsonCompactIterator end() const;
+    JsonCompactIterator cbegin() const;
+    JsonCompactIterator cend() const;
+
+    // ---------------------------------------------------------------------
+    //     Conversion and Comparison
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return a JsonDocument that contains a copy of this value and all its children.
+     */
+    JsonDocument to_document() const;
+
+    /**
+     * @brief Return whether two views refer to the same value of the same document.
+     */
+    bool operator == ( JsonCompactValue const& other ) const
+    {
+        return entry_ == other.entry_;
+    }
+
+    bool operator != ( JsonCompactValue const& other ) const
+    {
+        return !( *this == other );
+    }
+
+    // ---------------------------------------------------------------------
+    //     Internal Helpers
+    // ---------------------------------------------------------------------
+
+private:
+
+    friend class JsonCompactIterator;
+
+    JsonCompactValue element_( size_t index ) const
+    {
+        return JsonCompactValue( entries_, strings_, entries_ + index );
+    }
+
+    bool key_equals_( size_t index, std::string const& key ) const;
+
+    // ---------------------------------------------------------------------
+    //     Data Members
+    // ---------------------------------------------------------------------
+
+private:
+
+    static JsonCompactEntry const null_entry_;
+
+    JsonCompactEntry const* entries_;
+    char const*             strings_;
+    JsonCompactEntry const* entry_;
+};
+
+// =================================================================================================
+//     Json Compact Iterator
+// =================================================================================================
+
+/**
+ * @brief Iterator over the elements of a JsonCompactValue.
+ *
+ * This offers the same interface as the JsonIterator, with key() and value() for accessing
+ * object members. As there are no value objects to point to, dereferencing the iterator
+ * returns a JsonCompactValue view by value.
+ */
+class JsonCompactIterator
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Typedefs and Enums
+    // ---------------------------------------------------------------------
+
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = JsonCompactValue;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = JsonCompactValue;
+
+    /**
+     * @brief Helper that makes `operator->` work on the returned view.
+     */
+    struct pointer
+    {
+        JsonCompactValue value;
+
+        JsonCompactValue const* operator->() const
+        {
+            return &value;
+        }
+    };
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    JsonCompactIterator() = default;
+
+    JsonCompactIterator( JsonCompactValue const& container, size_t position )
+        : container_( container )
+        , position_( position )
+    {}
+
+    ~JsonCompactIterator() = default;
+
+    JsonCompactIterator( JsonCompactIterator const& ) = default;
+    JsonCompactIterator( JsonCompactIterator&& )      = default;
+
+    JsonCompactIterator& operator= ( JsonCompactIterator const& ) = default;
+    JsonCompactIterator& operator= ( JsonCompactIterator&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Operators
+    // ---------------------------------------------------------------------
+
+    reference operator * () const
+    {
+        auto const& entry = *container_.entry_;
+        switch( entry.type ) {
+            case JsonDocument::ValueType::kArray: {
+                assert( position_ < entry.size );
+                return container_.element_( entry.offset + position_ );
+            }
+            case JsonDocument::ValueType::kObject: {
+                assert( position_ < entry.size );
+                return container_.element_( entry.offset + 2 * position_ + 1 );
+            }
+            case JsonDocument::ValueType::kNull: {
+                throw std::out_of_range( "Cannot get value from Json Iterator." );
+            }
+            default: {
+                if( position_ == 0 ) {
+                    return container_;
+                }
+                throw std::out_of_range( "Cannot get value from Json Iterator." );
+            }
+        }
+    }
+
+    pointer operator -> () const
+    {
+        return pointer{ operator*() };
+    }
+
+    JsonCompactIterator& operator ++ ()
+    {
+        ++position_;
+        return *this;
+    }
+
+    JsonCompactIterator operator ++ ( int )
+    {
+        auto result = *this;
+        ++position_;
+        return result;
+    }
+
+    JsonCompactIterator& operator -- ()
+    {
+        --position_;
+        return *this;
+    }
+
+    JsonCompactIterator operator -- ( int )
+    {
+        auto result = *this;
+        --position_;
+        return result;
+    }
+
+    JsonCompactIterator& operator += ( difference_type i )
+    {
+        position_ += i;
+        return *this;
+    }
+
+    JsonCompactIterator& operator -= ( difference_type i )
+    {
+        position_ -= i;
+        return *this;
+    }
+
+    JsonCompactIterator operator + ( difference_type i ) const
+    {
+        auto result = *this;
+        result += i;
+        return result;
+    }
+
+    JsonCompactIterator operator - ( difference_type i ) const
+    {
+        auto result = *this;
+        result -= i;
+        return result;
+    }
+
+    difference_type operator - ( JsonCompactIterator const& other ) const
+    {
+        check_same_( other );
+        return static_cast<difference_type>( position_ ) -
+               static_cast<difference_type>( other.position_ );
+    }
+
+    reference operator [] ( difference_type n ) const
+    {
+        return *( *this + n );
+    }
+
+    bool operator == ( JsonCompactIterator const& other ) const
+    {
+        check_same_( other );
+        return position_ == other.position_;
+    }
+
+    bool operator != ( JsonCompactIterator const& other ) const
+    {
+        return !( *this == other );
+    }
+
+    bool operator < ( JsonCompactIterator const& other ) const
+    {
+        check_same_( other );
+        if( container_.is_object() ) {
+            throw std::domain_error( "Cannot compare order of Json object iterators." );
+        }
+        return position_ < other.position_;
+    }
+
+    bool operator <= ( JsonCompactIterator const& other ) const
+    {
+        return !( other < *this );
+    }
+
+    bool operator > ( JsonCompactIterator const& other ) const
+    {
+        return other < *this;
+    }
+
+    bool operator >= ( JsonCompactIterator const& other ) const
+    {
+        return !( *this < other );
+    }
+
+    // ---------------------------------------------------------------------
+    //     Key Value Access for Objects
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return the key of an object iterator.
+     */
+    std::string key() const
+    {
+        if( ! container_.is_object() ) {
+            throw std::domain_error( "Cannot use key() for non-object Json Iterators." );
+        }
+        assert( position_ < container_.entry_->size );
+        return container_.element_( container_.entry_->offset + 2 * position_ ).get_string();
+    }
+
+    /**
+     * @brief Return the value of the iterator.
+     */
+    reference value() const
+    {
+        return operator*();
+    }
+
+    // ---------------------------------------------------------------------
+    //     Internal Helpers
+    // ---------------------------------------------------------------------
+
+private:
+
+    void check_same_( JsonCompactIterator const& other ) const
+    {
+        if( container_ != other.container_ ) {
+            throw std::domain_error( "Cannot compare Json Iterators of different containers." );
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    //     Data Members
+    // ---------------------------------------------------------------------
+
+    JsonCompactValue container_;
+    size_t           position_ = 0;
+};
+
+// =================================================================================================
+//     Json Compact Document
+// =================================================================================================
+
+/**
+ * @brief Compact, read-only representation of a `Json` document.
+ *
+ * The JsonDocument stores each value as an individual object, with strings, arrays and objects
+ * being separately allocated on the heap. For large documents, this results in a huge number of
+ * small allocations. This class instead stores all values in one contiguous arena of tagged
+ * 16 byte JsonCompactEntry%s, with all strings in a shared string pool, and the elements of
+ * arrays and objects as contiguous index ranges within the arena. Keys of objects are stored only
+ * once in the pool, as they tend to repeat a lot in typical documents.
+ *
+ * The document is created by a JsonCompactBuilder, which is for example used by
+ * JsonCompactReader. Its values are accessed via JsonCompactValue views, which offer the same
+ * accessors as a const JsonDocument. For convenience, the document itself offers the most
+ * important of them, which are forwarded to its root().
+ */
+class JsonCompactDocument
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Typedefs and Enums
+    // ---------------------------------------------------------------------
+
+    using ValueType      = JsonDocument::ValueType;
+    using iterator       = JsonCompactIterator;
+    using const_iterator = JsonCompactIterator;
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Create a document that consists of a single `null` value.
+     */
+    JsonCompactDocument()
+        : entries_( 1 )
+        , root_( 0 )
+    {}
+
+    ~JsonCompactDocument() = default;
+
+    JsonCompactDocument( JsonCompactDocument const& ) = default;
+    JsonCompactDocument( JsonCompactDocument&& )      = default;
+
+    JsonCompactDocument& operator= ( JsonCompactDocument const& ) = default;
+    JsonCompactDocument& operator= ( JsonCompactDocument&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Accessors
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return a view of the top level value of the document.
+     */
+    JsonCompactValue root() const
+    {
+        return JsonCompactValue( entries_.data(), strings_.data(), entries_.data() + root_ );
+    }
+
+    /**
+     * @brief Return the number of entries in the arena, that is, the number of values and keys.
+     */
+    size_t entry_count() const
+    {
+        return entries_.size();
+    }
+
+    /**
+     * @brief Return the number of bytes used by the arena and the string pool.
+     */
+    size_t memory_size() const
+    {
+        return entries_.capacity() * sizeof( JsonCompactEntry ) + strings_.capacity();
+    }
+
+    // ---------------------------------------------------------------------
+    //     Root Value Access
+    // ---------------------------------------------------------------------
+
+    ValueType type() const
+    {
+        return root().type();
+    }
+
+    bool is_null() const
+    {
+        return root().is_null();
+    }
+
+    bool is_array() const
+    {
+        return root().is_array();
+    }
+
+    bool is_object() const
+    {
+        return root().is_object();
+    }
+
+    bool empty() const
+    {
+        return root().empty();
+    }
+
+    size_t size() const
+    {
+        return root().size();
+    }
+
+    JsonCompactValue at( size_t index ) const
+    {
+        return root().at( index );
+    }
+
+    JsonCompactValue at( std::string const& key ) const
+    {
+        return root().at( key );
+    }
+
+    JsonCompactValue operator [] ( size_t index ) const
+    {
+        return root()[ index ];
+    }
+
+    JsonCompactValue operator [] ( std::string const& key ) const
+    {
+        return root()[ key ];
+    }
+
+    JsonCompactIterator find( std::string const& key ) const;
+    size_t count( std::string const& key ) const;
+
+    JsonCompactIterator begin() const;
+    JsonCompactIterator end() const;
+
+    JsonDocument to_document() const
+    {
+        return root().to_document();
+    }
+
+    // ---------------------------------------------------------------------
+    //     Data Members
+    // ---------------------------------------------------------------------
+
+private:
+
+    friend class JsonCompactBuilder;
+
+    // The string pool is a vector instead of a std::string, because the small string optimization
+    // would move short pools to a new address when the document is moved, invalidating all views.
+    std::vector<JsonCompactEntry> entries_;
+    std::vector<char>             strings_;
+    size_t                        root_;
+};
+
+// =================================================================================================
+//     Json Compact Builder
+// =================================================================================================
+
+/**
+ * @brief JsonSaxHandler that builds a JsonCompactDocument from the events of a JsonSaxReader.
+ *
+ * While parsing, the values of all currently open arrays and objects are kept on a stack.
+ * Once a container is closed, its elements are moved to the arena as one contiguous range.
+ * After parsing, finish() returns the document and resets the builder, so that it can be
+ * used for the next document.
+ */
+class JsonCompactBuilder : public JsonSaxHandler
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    JsonCompactBuilder()
+    {
+        // The default document contains a null value, which we do not need for building.
+        document_.entries_.clear();
+    }
+
+    ~JsonCompactBuilder() override = default;
+
+    JsonCompactBuilder( JsonCompactBuilder const& ) = default;
+    JsonCompactBuilder( JsonCompactBuilder&& )      = default;
+
+    JsonCompactBuilder& operator= ( JsonCompactBuilder const& ) = default;
+    JsonCompactBuilder& operator= ( JsonCompactBuilder&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Events
+    // ---------------------------------------------------------------------
+
+    void start_object() override;
+    void end_object() override;
+    void start_array() override;
+    void end_array() override;
+
+    void key( std::string& key ) override;
+    void string_value( std::string& value ) override;
+
+    void number_unsigned( std::uint64_t value ) override;
+    void number_signed( std::int64_t value ) override;
+    void number_float( double value ) override;
+
+    void boolean( bool value ) override;
+    void null() override;
+
+    // ---------------------------------------------------------------------
+    //     Result
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return the document that was built from the events so far.
+     *
+     * If no value was reported, the document is `null`. Throws if there are unclosed containers.
+     */
+    JsonCompactDocument finish();
+
+    // ---------------------------------------------------------------------
+    //     Internal Helpers
+    // ---------------------------------------------------------------------
+
+private:
+
+    void close_( JsonDocument::ValueType type );
+    std::uint64_t add_string_( std::string const& str );
+
+    // ---------------------------------------------------------------------
+    //     Data Members
+    // ---------------------------------------------------------------------
+
+private:
+
+    JsonCompactDocument document_;
+
+    // Values of the currently open containers, and the positions in that stack where
+    // each open container starts.
+    std::vector<JsonCompactEntry> stack_;
+    std::vector<size_t>           starts_;
+
+    // Offsets of the keys in the string pool, so that each key is only stored once.
+    std::unordered_map<std::string, std::uint64_t> keys_;
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
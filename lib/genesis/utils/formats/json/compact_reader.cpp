@@ -0,0 +1,79 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/formats/json/compact_reader.hpp"
+
+#include <fstream>
+
+#include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/core/std.hpp"
+#include "genesis/utils/formats/json/compact_document.hpp"
+#include "genesis/utils/formats/json/sax_reader.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
+#include "genesis/utils/io/input_stream.hpp"
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Reading
+// =================================================================================================
+
+JsonCompactDocument JsonCompactReader::from_stream( std::istream& input_stream ) const
+{
+    utils::InputStream is( utils::make_unique< utils::StreamInputSource >( input_stream ));
+    return parse( is );
+}
+
+JsonCompactDocument JsonCompactReader::from_file( std::string const& filename ) const
+{
+    utils::InputStream is( utils::from_file( filename ));
+    return parse( is );
+}
+
+JsonCompactDocument JsonCompactReader::from_string( std::string const& json ) const
+{
+    utils::InputStream is( utils::make_unique< utils::StringInputSource >( json ));
+    return parse( is );
+}
+
+// =================================================================================================
+//     Parsing
+// =================================================================================================
+
+JsonCompactDocument JsonCompactReader::parse( InputStream& input_stream ) const
+{
+    JsonCompactBuilder builder;
+    JsonSaxReader().parse( input_stream, builder );
+    return builder.finish();
+}
+
+} // namespace utils
+} // namespace genesis
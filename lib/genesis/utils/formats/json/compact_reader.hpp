@@ -0,0 +1,110 @@
+#ifndef GENESIS_UTILS_FORMATS_JSON_COMPACT_READER_H_
+#define GENESIS_UTILS_FORMATS_JSON_COMPACT_READER_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include <iosfwd>
+#include <string>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Forward declarations
+// =================================================================================================
+
+class InputStream;
+class JsonCompactDocument;
+
+// =================================================================================================
+//     Json Compact Reader
+// =================================================================================================
+
+/**
+ * @brief Read `Json` data into a JsonCompactDocument.
+ *
+ * This uses the JsonSaxReader to parse the input, and a JsonCompactBuilder to store the values
+ * in the compact representation. Compared to reading into a JsonDocument with the JsonReader,
+ * this avoids allocating each value individually, which for large documents considerably
+ * reduces the needed memory and time.
+ */
+class JsonCompactReader
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    JsonCompactReader()  = default;
+    ~JsonCompactReader() = default;
+
+    JsonCompactReader( JsonCompactReader const& ) = default;
+    JsonCompactReader( JsonCompactReader&& )      = default;
+
+    JsonCompactReader& operator= ( JsonCompactReader const& ) = default;
+    JsonCompactReader& operator= ( JsonCompactReader&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Reading
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Read from a stream containing a JSON document and parse its contents
+     * into a JsonCompactDocument.
+     */
+    JsonCompactDocument from_stream( std::istream& input_stream ) const;
+
+    /**
+     * @brief Take a JSON document file path and parse its contents into a JsonCompactDocument.
+     *
+     * If the file does not exists, the function throws.
+     */
+    JsonCompactDocument from_file( std::string const& filename ) const;
+
+    /**
+     * @brief Take a string containing a JSON document and parse its contents
+     * into a JsonCompactDocument.
+     */
+    JsonCompactDocument from_string( std::string const& json ) const;
+
+    // ---------------------------------------------------------------------
+    //     Parsing
+    // ---------------------------------------------------------------------
+
+    JsonCompactDocument parse( InputStream& input_stream ) const;
+
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
@@ -0,0 +1,1029 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/formats/json/on_demand.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/char_search.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
+#include "genesis/utils/io/input_source.hpp"
+#include "genesis/utils/io/parser.hpp"
+#include "genesis/utils/text/string.hpp"
+
+#if defined( __SSE2__ )
+#    include <immintrin.h>
+#endif
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Structural Index
+// =================================================================================================
+
+/**
+ * @brief Bit masks of the char classes of a block of 64 chars, with bit `i` for char `i`.
+ */
+struct JsonOnDemandBlockMasks
+{
+    std::uint64_t quote     = 0;
+    std::uint64_t backslash = 0;
+    std::uint64_t op        = 0;
+    std::uint64_t space     = 0;
+};
+
+/**
+ * @brief Local helper to compute the char class masks of a block of 64 chars.
+ */
+static inline JsonOnDemandBlockMasks json_on_demand_block_masks_( char const* block )
+{
+    JsonOnDemandBlockMasks result;
+
+    #ifdef __SSE2__
+
+        // Process the block in four parts of 16 chars. The brackets `[` and `{` differ only in the
+        // bit 0x20, and so do `]` and `}`, so that we can find both with one comparison each.
+        auto const v_quote     = _mm_set1_epi8( '"' );
+        auto const v_backslash = _mm_set1_epi8( '\\' );
+        auto const v_case      = _mm_set1_epi8( 0x20 );
+        auto const v_open      = _mm_set1_epi8( '{' );
+        auto const v_close     = _mm_set1_epi8( '}' );
+        auto const v_colon     = _mm_set1_epi8( ':' );
+        auto const v_comma     = _mm_set1_epi8( ',' );
+        auto const v_space     = _mm_set1_epi8( ' ' );
+        auto const v_tab       = _mm_set1_epi8( '\t' );
+        auto const v_newline   = _mm_set1_epi8( '\n' );
+        auto const v_return    = _mm_set1_epi8( '\r' );
+
+        for( size_t i = 0; i < 4; ++i ) {
+            auto const data = _mm_loadu_si128(
+                reinterpret_cast< __m128i const* >( block + 16 * i )
+            );
+            auto const data_case = _mm_or_si128( data, v_case );
+
+            auto const quote     = _mm_cmpeq_epi8( data, v_quote );
+            auto const backslash = _mm_cmpeq_epi8( data, v_backslash );
+            auto const op = _mm_or_si128(
+                _mm_or_si128(
+                    _mm_cmpeq_epi8( data_case, v_open ), _mm_cmpeq_epi8( data_case, v_close )
+                ),
+                _mm_or_si128( _mm_cmpeq_epi8( data, v_colon ), _mm_cmpeq_epi8( data, v_comma ))
+            );
+            auto const space = _mm_or_si128(
+                _mm_or_si128( _mm_cmpeq_epi8( data, v_space ), _mm_cmpeq_epi8( data, v_tab )),
+                _mm_or_si128( _mm_cmpeq_epi8( data, v_newline ), _mm_cmpeq_epi8( data, v_return ))
+            );
+
+            auto const shift = 16 * i;
+            auto const mask  = []( __m128i const& v ){
+                return static_cast< std::uint64_t >(
+                    static_cast< unsigned int >( _mm_movemask_epi8( v )) & 0xFFFFu
+                );
+            };
+            result.quote     |= mask( quote )     << shift;
+            result.backslash |= mask( backslash ) << shift;
+            result.op        |= mask( op )        << shift;
+            result.space     |= mask( space )     << shift;
+        }
+
+    #else
+
+        for( size_t i = 0; i < 64; ++i ) {
+            auto const bit = std::uint64_t( 1 ) << i;
+            switch( block[i] ) {
+                case '"':
+                    result.quote |= bit;
+                    break;
+                case '\\':
+                    result.backslash |= bit;
+                    break;
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',':
+                    result.op |= bit;
+                    break;
+                case ' ':
+                case '\t':
+                case '\n':
+                case '\r':
+                    result.space |= bit;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+    #endif
+
+    return result;
+}
+
+/**
+ * @brief Local helper that returns the index of the lowest set bit of a non-zero value.
+ */
+static inline size_t json_on_demand_lowest_bit_( std::uint64_t value )
+{
+    assert( value != 0 );
+    #if defined( __GNUC__ ) || defined( __clang__ )
+        return static_cast< size_t >( __builtin_ctzll( value ));
+    #else
+        size_t result = 0;
+        while(( value & 1 ) == 0 ) {
+            value >>= 1;
+            ++result;
+        }
+        return result;
+    #endif
+}
+
+/**
+ * @brief Local helper that returns the mask of chars that are escaped by a backslash.
+ *
+ * The `prev_escaped` flag carries over whether the first char of the next block is escaped.
+ * Backslashes are rare in typical documents, so we simply process them one by one.
+ */
+static inline std::uint64_t json_on_demand_escaped_( std::uint64_t backslash, bool& prev_escaped )
+{
+    std::uint64_t escaped = 0;
+    if( prev_escaped ) {
+        // The first char is escaped, so if it is a backslash, it does not escape the next char.
+        escaped   |= 1;
+        backslash &= ~std::uint64_t( 1 );
+    }
+    prev_escaped = false;
+
+    while( backslash ) {
+        auto const i = json_on_demand_lowest_bit_( backslash );
+        if( i == 63 ) {
+            prev_escaped = true;
+            break;
+        }
+        auto const next = std::uint64_t( 1 ) << ( i + 1 );
+        escaped   |= next;
+        backslash &= ~(( std::uint64_t( 1 ) << i ) | next );
+    }
+    return escaped;
+}
+
+/**
+ * @brief Local helper that computes the prefix xor of the bits of a value.
+ *
+ * For the mask of quotation marks, this yields the mask of chars that are inside of strings,
+ * including the opening, but excluding the closing quotation mark.
+ */
+static inline std::uint64_t json_on_demand_prefix_xor_( std::uint64_t value )
+{
+    value ^= value << 1;
+    value ^= value << 2;
+    value ^= value << 4;
+    value ^= value << 8;
+    value ^= value << 16;
+    value ^= value << 32;
+    return value;
+}
+
+std::vector<std::uint32_t> json_structural_index( char const* data, size_t size )
+{
+    if( size >= std::numeric_limits<std::uint32_t>::max() ) {
+        throw std::length_error( "Json input too large for building a structural index." );
+    }
+
+    std::vector<std::uint32_t> result;
+    result.reserve( size / 8 + 1 );
+
+    // State that is carried over between blocks.
+    bool prev_escaped = false;
+    std::uint64_t prev_in_string = 0;
+    std::uint64_t prev_scalar    = 0;
+
+    // The last block is padded with white space.
+    char tail[64];
+    for( size_t base = 0; base < size; base += 64 ) {
+        auto block = data + base;
+        if( size - base < 64 ) {
+            std::memset( tail, ' ', 64 );
+            std::memcpy( tail, block, size - base );
+            block = tail;
+        }
+        auto const masks = json_on_demand_block_masks_( block );
+
+        // Find the quotation marks that delimit strings, and all chars inside of strings.
+        auto const escaped   = json_on_demand_escaped_( masks.backslash, prev_escaped );
+        auto const quote     = masks.quote & ~escaped;
+        auto const in_string = json_on_demand_prefix_xor_( quote ) ^ prev_in_string;
+        prev_in_string = ( in_string >> 63 ) ? ~std::uint64_t( 0 ) : 0;
+
+        // Numbers and literals are all other chars outside of strings. We need their first chars.
+        auto const scalar = ~( masks.op | masks.space | quote ) & ~in_string;
+        auto const scalar_starts = scalar & ~(( scalar << 1 ) | prev_scalar );
+        prev_scalar = scalar >> 63;
+
+        // Structural chars, the opening quotation marks of strings, and the starts of scalars.
+        auto structurals = ( masks.op & ~in_string ) | ( quote & in_string ) | scalar_starts;
+        while( structurals ) {
+            auto const i = json_on_demand_lowest_bit_( structurals );
+            result.push_back( static_cast< std::uint32_t >( base + i ));
+            structurals &= structurals - 1;
+        }
+    }
+    if( prev_in_string ) {
+        throw std::runtime_error( "Unexpected end of Json string at the end of the input." );
+    }
+
+    result.push_back( static_cast< std::uint32_t >( size ));
+    return result;
+}
+
+// =================================================================================================
+//     Local Helpers
+// =================================================================================================
+
+/**
+ * @brief Local helper to find the end of a number or literal.
+ */
+static char const* json_on_demand_scalar_end_( char const* begin, char const* end )
+{
+    while( begin != end ) {
+        auto const c = *begin;
+        if(
+            c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' || c == ':' ||
+            c == '{' || c == '}' || c == '[' || c == ']' || c == '"'
+        ) {
+            break;
+        }
+        ++begin;
+    }
+    return begin;
+}
+
+/**
+ * @brief Local helper to append a unicode code point to a string, encoded as UTF-8.
+ */
+static void json_on_demand_append_utf8_( std::string& target, unsigned int cp )
+{
+    if( cp < 0x80 ) {
+        target += static_cast<char>( cp );
+    } else if( cp < 0x800 ) {
+        target += static_cast<char>( 0xC0 | ( cp >> 6 ));
+        target += static_cast<char>( 0x80 | ( cp & 0x3F ));
+    } else if( cp < 0x10000 ) {
+        target += static_cast<char>( 0xE0 | ( cp >> 12 ));
+        target += static_cast<char>( 0x80 | (( cp >> 6 ) & 0x3F ));
+        target += static_cast<char>( 0x80 | ( cp & 0x3F ));
+    } else {
+        target += static_cast<char>( 0xF0 | ( cp >> 18 ));
+        target += static_cast<char>( 0x80 | (( cp >> 12 ) & 0x3F ));
+        target += static_cast<char>( 0x80 | (( cp >> 6 ) & 0x3F ));
+        target += static_cast<char>( 0x80 | ( cp & 0x3F ));
+    }
+}
+
+/**
+ * @brief Local helper to read the four hex digits of a `\u` escape sequence.
+ * Returns a value larger than 0xFFFF if the digits are invalid.
+ */
+static unsigned int json_on_demand_read_hex_( char const* pos, char const* end )
+{
+    if( end - pos < 4 ) {
+        return 0x10000;
+    }
+    unsigned int result = 0;
+    for( size_t i = 0; i < 4; ++i ) {
+        auto const c = to_lower_ascii( pos[i] );
+        result *= 16;
+        if( c >= '0' && c <= '9' ) {
+            result += c - '0';
+        } else if( c >= 'a' && c <= 'f' ) {
+            result += c - 'a' + 10;
+        } else {
+            return 0x10000;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Local helper to check whether the chars are the given lower case @p literal,
+ * accepting any case, without copying them.
+ */
+static bool json_on_demand_literal_equals_(
+    char const* begin, char const* end, char const* literal
+) {
+    for( ; begin != end; ++begin, ++literal ) {
+        if( *literal == '\0' || to_lower_ascii( *begin ) != *literal ) {
+            return false;
+        }
+    }
+    return *literal == '\0';
+}
+
+/**
+ * @brief Parsed number of a JsonOnDemandValue.
+ */
+struct JsonOnDemandNumber
+{
+    JsonDocument::ValueType type = JsonDocument::ValueType::kNull;
+    union
+    {
+        JsonDocument::NumberFloatType    number_float;
+        JsonDocument::NumberSignedType   number_signed;
+        JsonDocument::NumberUnsignedType number_unsigned = 0;
+    };
+};
+
+/**
+ * @brief Local helper to parse a number. Returns a null type if the chars are not a number.
+ */
+static JsonOnDemandNumber json_on_demand_parse_number_( char const* begin, char const* end )
+{
+    JsonOnDemandNumber result;
+
+    // Try to parse the number as an integer first.
+    auto pos = begin;
+    bool is_neg = false;
+    if( pos != end && ( *pos == '-' || *pos == '+' )) {
+        is_neg = ( *pos == '-' );
+        ++pos;
+    }
+    if( pos != end ) {
+        auto const max = std::numeric_limits<std::uint64_t>::max();
+        auto const max_signed = static_cast<std::uint64_t>(
+            std::numeric_limits<std::int64_t>::max()
+        );
+
+        std::uint64_t ix = 0;
+        bool valid = true;
+        for( ; pos != end; ++pos ) {
+            auto const digit = static_cast<std::uint64_t>( *pos - '0' );
+            if( digit > 9 || ix > ( max - digit ) / 10 ) {
+                valid = false;
+                break;
+            }
+            ix = 10 * ix + digit;
+        }
+        if( valid && !is_neg ) {
+            result.type = JsonDocument::ValueType::kNumberUnsigned;
+            result.number_unsigned = ix;
+            return result;
+        }
+        if( valid && is_neg && ix <= max_signed + 1 ) {
+            result.type = JsonDocument::ValueType::kNumberSigned;
+            result.number_signed = static_cast<std::int64_t>( std::uint64_t( 0 ) - ix );
+            return result;
+        }
+    }
+
+    // Otherwise, it is a float, or invalid.
+    double value;
+    if( begin != end && parse_float( begin, end, value ) == end ) {
+        result.type = JsonDocument::ValueType::kNumberFloat;
+        result.number_float = value;
+    }
+    return result;
+}
+
+// =================================================================================================
+//     Json On Demand Value
+// =================================================================================================
+
+static char const          json_on_demand_null_data_[]  = "null";
+static std::uint32_t const json_on_demand_null_index_[] = { 0, 4 };
+
+JsonOnDemandValue::JsonOnDemandValue()
+    : data_( json_on_demand_null_data_ )
+    , index_( json_on_demand_null_index_ )
+    , index_size_( 2 )
+    , position_( 0 )
+{}
+
+// -------------------------------------------------------------------------
+//     Type Inspection
+// -------------------------------------------------------------------------
+
+JsonDocument::ValueType JsonOnDemandValue::type() const
+{
+    switch( first_char_() ) {
+        case '{':
+            return ValueType::kObject;
+        case '[':
+            return ValueType::kArray;
+        case '"':
+            return ValueType::kString;
+        default:
+            break;
+    }
+
+    // Literals, accepting any case, same as the other Json readers.
+    auto const begin = data_ + index_[ position_ ];
+    auto const end   = json_on_demand_scalar_end_( begin, data_ + index_[ index_size_ - 1 ]);
+    if( json_on_demand_literal_equals_( begin, end, "null" )) {
+        return ValueType::kNull;
+    } else if(
+        json_on_demand_literal_equals_( begin, end, "true" ) ||
+        json_on_demand_literal_equals_( begin, end, "false" )
+    ) {
+        return ValueType::kBoolean;
+    }
+
+    // Numbers.
+    auto const number = json_on_demand_parse_number_( begin, end );
+    if( number.type == ValueType::kNull ) {
+        throw_invalid_( position_, "Json value" );
+    }
+    return number.type;
+}
+
+std::string JsonOnDemandValue::type_name() const
+{
+    switch( type() ) {
+        case ValueType::kNull: {
+            return "null";
+        }
+        case ValueType::kArray: {
+            return "array";
+        }
+        case ValueType::kObject: {
+            return "object";
+        }
+        case ValueType::kString: {
+            return "string";
+        }
+        case ValueType::kBoolean: {
+            return "boolean";
+        }
+        case ValueType::kNumberFloat: {
+            return "float";
+        }
+        case ValueType::kNumberSigned: {
+            return "signed integer";
+        }
+        case ValueType::kNumberUnsigned: {
+            return "unsigned integer";
+        }
+        default: {
+            assert( false );
+            return "";
+        }
+    }
+}
+
+// -------------------------------------------------------------------------
+//     Capacity
+// -------------------------------------------------------------------------
+
+size_t JsonOnDemandValue::size() const
+{
+    if( ! is_structured() ) {
+        return is_null() ? 0 : 1;
+    }
+    size_t result = 0;
+    for( auto it = begin(); it != end(); ++it ) {
+        ++result;
+    }
+    return result;
+}
+
+// -------------------------------------------------------------------------
+//     Value Access
+// -------------------------------------------------------------------------
+
+JsonDocument::StringType JsonOnDemandValue::get_string() const
+{
+    if( ! is_string() ) {
+        throw std::domain_error( "Cannot use get_string() with " + type_name() + "." );
+    }
+    return parse_string_at_( position_ );
+}
+
+JsonDocument::BooleanType JsonOnDemandValue::get_boolean() const
+{
+    if( type() != ValueType::kBoolean ) {
+        throw std::domain_error( "Cannot use get_boolean() with " + type_name() + "." );
+    }
+    return to_lower_ascii( first_char_() ) == 't';
+}
+
+JsonDocument::NumberFloatType JsonOnDemandValue::get_number_float() const
+{
+    ValueType t;
+    NumberFloatType f;
+    NumberSignedType i;
+    NumberUnsignedType u;
+    parse_number_( t, f, i, u );
+    if( t != ValueType::kNumberFloat ) {
+        throw std::domain_error( "Cannot use get_number_float() with " + type_name() + "." );
+    }
+    return f;
+}
+
+JsonDocument::NumberSignedType JsonOnDemandValue::get_number_signed() const
+{
+    ValueType t;
+    NumberFloatType f;
+    NumberSignedType i;
+    NumberUnsignedType u;
+    parse_number_( t, f, i, u );
+    if( t != ValueType::kNumberSigned ) {
+        throw std::domain_error( "Cannot use get_number_signed() with " + type_name() + "." );
+    }
+    return i;
+}
+
+JsonDocument::NumberUnsignedType JsonOnDemandValue::get_number_unsigned() const
+{
+    ValueType t;
+    NumberFloatType f;
+    NumberSignedType i;
+    NumberUnsignedType u;
+    parse_number_( t, f, i, u );
+    if( t != ValueType::kNumberUnsigned ) {
+        throw std::domain_error( "Cannot use get_number_unsigned() with " + type_name() + "." );
+    }
+    return u;
+}
+
+// -------------------------------------------------------------------------
+//     Element Access
+// -------------------------------------------------------------------------
+
+JsonOnDemandValue JsonOnDemandValue::at( size_t index ) const
+{
+    if( ! is_array() ) {
+        throw std::domain_error( "Cannot use at() with " + type_name() );
+    }
+    size_t i = 0;
+    for( auto it = begin(); it != end(); ++it ) {
+        if( i == index ) {
+            return *it;
+        }
+        ++i;
+    }
+    throw std::out_of_range( "Array index " + std::to_string( index ) + " is out of range." );
+}
+
+JsonOnDemandValue JsonOnDemandValue::at( std::string const& key ) const
+{
+    if( ! is_object() ) {
+        throw std::domain_error( "Cannot use at() with " + type_name() );
+    }
+    auto const it = find( key );
+    if( it == end() ) {
+        throw std::out_of_range( "Invalid key '" + key + "' for object access." );
+    }
+    return it.value();
+}
+
+JsonOnDemandIterator JsonOnDemandValue::find( std::string const& key ) const
+{
+    if( ! is_object() ) {
+        return end();
+    }
+    for( auto it = begin(); it != end(); ++it ) {
+        if( key_equals_( it.position_, key )) {
+            return it;
+        }
+    }
+    return end();
+}
+
+size_t JsonOnDemandValue::count( std::string const& key ) const
+{
+    return find( key ) == end() ? 0 : 1;
+}
+
+// -------------------------------------------------------------------------
+//     Iterators
+// -------------------------------------------------------------------------
+
+JsonOnDemandIterator JsonOnDemandValue::begin() const
+{
+    if( is_structured() ) {
+        return JsonOnDemandIterator( *this, position_ + 1 );
+    }
+    if( is_null() ) {
+        return end();
+    }
+    return JsonOnDemandIterator( *this, position_ );
+}
+
+JsonOnDemandIterator JsonOnDemandValue::end() const
+{
+    return JsonOnDemandIterator( *this, std::numeric_limits<size_t>::max() );
+}
+
+// -------------------------------------------------------------------------
+//     Conversion
+// -------------------------------------------------------------------------
+
+JsonDocument JsonOnDemandValue::to_document() const
+{
+    switch( type() ) {
+        case ValueType::kNull: {
+            return JsonDocument();
+        }
+        case ValueType::kArray: {
+            auto result = JsonDocument::array();
+            auto& array = result.get_array();
+            for( auto const& element : *this ) {
+                array.push_back( element.to_document() );
+            }
+            return result;
+        }
+        case ValueType::kObject: {
+            auto result = JsonDocument::object();
+            auto& object = result.get_object();
+            for( auto it = begin(); it != end(); ++it ) {
+                object[ it.key() ] = it.value().to_document();
+            }
+            return result;
+        }
+        case ValueType::kString: {
+            return JsonDocument::string( get_string() );
+        }
+        case ValueType::kBoolean: {
+            return JsonDocument::boolean( get_boolean() );
+        }
+        case ValueType::kNumberFloat: {
+            return JsonDocument::number_float( get_number_float() );
+        }
+        case ValueType::kNumberSigned: {
+            return JsonDocument::number_signed( get_number_signed() );
+        }
+        case ValueType::kNumberUnsigned: {
+            return JsonDocument::number_unsigned( get_number_unsigned() );
+        }
+        default: {
+            throw std::runtime_error( "Invalid Json Value Type." );
+        }
+    }
+}
+
+std::string JsonOnDemandValue::raw_json() const
+{
+    auto const begin = data_ + index_[ position_ ];
+    char const* end;
+    if( is_structured() ) {
+        end = data_ + index_[ skip_( position_ ) - 1 ] + 1;
+    } else {
+        // Between a value and the next structural char, there is only white space.
+        end = data_ + index_[ position_ + 1 ];
+        while( end != begin && (
+            end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r'
+        )) {
+            --end;
+        }
+    }
+    return std::string( begin, end );
+}
+
+// -------------------------------------------------------------------------
+//     Internal Helpers
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Parse the value as a number, and set the type accordingly. If the value is not a number,
+ * the type is set to null.
+ */
+void JsonOnDemandValue::parse_number_(
+    ValueType& type, NumberFloatType& number_float,
+    NumberSignedType& number_signed, NumberUnsignedType& number_unsigned
+) const {
+    auto const c = first_char_();
+    if( c != '-' && c != '+' && c != '.' && ( c < '0' || c > '9' )) {
+        type = ValueType::kNull;
+        return;
+    }
+
+    auto const begin  = data_ + index_[ position_ ];
+    auto const end    = json_on_demand_scalar_end_( begin, data_ + index_[ index_size_ - 1 ]);
+    auto const number = json_on_demand_parse_number_( begin, end );
+    type = number.type;
+    switch( type ) {
+        case ValueType::kNumberFloat:
+            number_float = number.number_float;
+            break;
+        case ValueType::kNumberSigned:
+            number_signed = number.number_signed;
+            break;
+        case ValueType::kNumberUnsigned:
+            number_unsigned = number.number_unsigned;
+            break;
+        default:
+            throw_invalid_( position_, "number" );
+    }
+}
+
+/**
+ * @brief Return the position after the value at the given position, skipping all its children.
+ *
+ * For arrays and objects, this only needs to look at the structural chars, and counts the
+ * nesting depth until the closing bracket.
+ */
+size_t JsonOnDemandValue::skip_( size_t position ) const
+{
+    auto c = char_at_( position );
+    ++position;
+    if( c != '{' && c != '[' ) {
+        return position;
+    }
+
+    size_t depth = 1;
+    while( depth > 0 ) {
+        // The last entry of the index is the end of the input.
+        if( position + 1 >= index_size_ ) {
+            throw_invalid_( position, "closing bracket" );
+        }
+        c = char_at_( position );
+        if( c == '{' || c == '[' ) {
+            ++depth;
+        } else if( c == '}' || c == ']' ) {
+            --depth;
+        }
+        ++position;
+    }
+    return position;
+}
+
+/**
+ * @brief Return the position of the next element of an array, or the key of the next member
+ * of an object, given the current one, or the position of the closing bracket.
+ */
+size_t JsonOnDemandValue::next_element_( size_t position ) const
+{
+    assert( is_structured() );
+    auto const is_obj = is_object();
+    auto value_position = position;
+    if( is_obj ) {
+        if( char_at_( position ) != '"' ) {
+            throw_invalid_( position, "object key" );
+        }
+        if( char_at_( position + 1 ) != ':' ) {
+            throw_invalid_( position + 1, "':'" );
+        }
+        value_position = position + 2;
+    }
+
+    auto const after = skip_( value_position );
+    auto const c = char_at_( after );
+    if( c == ',' ) {
+        return after + 1;
+    }
+    if( c == ( is_obj ? '}' : ']' )) {
+        return after;
+    }
+    throw_invalid_( after, is_obj ? "',' or '}'" : "',' or ']'" );
+}
+
+std::string JsonOnDemandValue::parse_string_at_( size_t position ) const
+{
+    assert( char_at_( position ) == '"' );
+    auto pos = data_ + index_[ position ] + 1;
+    auto const end = data_ + index_[ index_size_ - 1 ];
+    std::string result;
+
+    while( true ) {
+        // Copy everything up to the closing quotation mark or the next escape sequence.
+        auto const next = find_first_of( pos, end, '"', '\\' );
+        result.append( pos, next );
+        if( next == end || next + 1 == end ) {
+            throw_invalid_( position, "string" );
+        }
+        if( *next == '"' ) {
+            return result;
+        }
+
+        pos = next + 2;
+        switch( next[1] ) {
+            case '"':
+            case '\\':
+            case '/':
+                result += next[1];
+                break;
+            case 'b':
+                result += '\b';
+                break;
+            case 'f':
+                result += '\f';
+                break;
+            case 'n':
+                result += '\n';
+                break;
+            case 'r':
+                result += '\r';
+                break;
+            case 't':
+                result += '\t';
+                break;
+            case 'u': {
+                auto cp = json_on_demand_read_hex_( pos, end );
+                pos += 4;
+
+                // Combine surrogate pairs. Lone surrogates are invalid in UTF-8.
+                if( cp >= 0xD800 && cp <= 0xDBFF ) {
+                    unsigned int low = 0x10000;
+                    if( end - pos >= 6 && pos[0] == '\\' && pos[1] == 'u' ) {
+                        low = json_on_demand_read_hex_( pos + 2, end );
+                    }
+                    if( low < 0xDC00 || low > 0xDFFF ) {
+                        throw_invalid_( position, "string with valid unicode escape sequences" );
+                    }
+                    cp = 0x10000 + (( cp - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+                    pos += 6;
+                } else if( cp > 0xFFFF || ( cp >= 0xDC00 && cp <= 0xDFFF )) {
+                    throw_invalid_( position, "string with valid unicode escape sequences" );
+                }
+                json_on_demand_append_utf8_( result, cp );
+                break;
+            }
+            default:
+                throw_invalid_( position, "string with valid escape sequences" );
+        }
+    }
+}
+
+bool JsonOnDemandValue::key_equals_( size_t position, std::string const& key ) const
+{
+    if( char_at_( position ) != '"' ) {
+        throw_invalid_( position, "object key" );
+    }
+
+    // Compare the raw chars if there are no escape sequences in the key, which is the usual case.
+    auto const begin = data_ + index_[ position ] + 1;
+    auto const end   = data_ + index_[ index_size_ - 1 ];
+    auto const next  = find_first_of( begin, end, '"', '\\' );
+    if( next != end && *next == '"' ) {
+        auto const size = static_cast<size_t>( next - begin );
+        return size == key.size() && std::memcmp( begin, key.data(), size ) == 0;
+    }
+    return parse_string_at_( position ) == key;
+}
+
+void JsonOnDemandValue::throw_invalid_( size_t position, std::string const& expected ) const
+{
+    auto const offset = index_[ position < index_size_ ? position : index_size_ - 1 ];
+    throw std::runtime_error(
+        "Invalid Json input at char " + std::to_string( offset ) + ". Expecting " +
+        expected + "."
+    );
+}
+
+// =================================================================================================
+//     Json On Demand Iterator
+// =================================================================================================
+
+JsonOnDemandIterator::reference JsonOnDemandIterator::operator * () const
+{
+    if( is_end_() ) {
+        throw std::out_of_range( "Cannot get value from Json Iterator." );
+    }
+    if( container_.is_object() ) {
+        if( container_.char_at_( position_ + 1 ) != ':' ) {
+            container_.throw_invalid_( position_ + 1, "':'" );
+        }
+        return container_.value_at_( position_ + 2 );
+    }
+    if( container_.is_array() ) {
+        return container_.value_at_( position_ );
+    }
+    return container_;
+}
+
+JsonOnDemandIterator& JsonOnDemandIterator::operator ++ ()
+{
+    if( container_.is_structured() ) {
+        position_ = container_.next_element_( position_ );
+    } else {
+        position_ = std::numeric_limits<size_t>::max();
+    }
+    return *this;
+}
+
+std::string JsonOnDemandIterator::key() const
+{
+    if( ! container_.is_object() ) {
+        throw std::domain_error( "Cannot use key() for non-object Json Iterators." );
+    }
+    return container_.parse_string_at_( position_ );
+}
+
+bool JsonOnDemandIterator::is_end_() const
+{
+    if( position_ == std::numeric_limits<size_t>::max() ) {
+        return true;
+    }
+    if( container_.is_structured() ) {
+        auto const c = container_.char_at_( position_ );
+        return c == '}' || c == ']';
+    }
+    return position_ != container_.position_;
+}
+
+// =================================================================================================
+//     Json On Demand Document
+// =================================================================================================
+
+JsonOnDemandDocument::JsonOnDemandDocument( std::vector<char>&& data )
+    : data_( std::move( data ))
+    , index_( json_structural_index( data_.data(), data_.size() ))
+{}
+
+JsonOnDemandIterator JsonOnDemandDocument::find( std::string const& key ) const
+{
+    return root().find( key );
+}
+
+size_t JsonOnDemandDocument::count( std::string const& key ) const
+{
+    return root().count( key );
+}
+
+JsonOnDemandIterator JsonOnDemandDocument::begin() const
+{
+    return root().begin();
+}
+
+JsonOnDemandIterator JsonOnDemandDocument::end() const
+{
+    return root().end();
+}
+
+// =================================================================================================
+//     Json On Demand Reader
+// =================================================================================================
+
+JsonOnDemandDocument JsonOnDemandReader::from_stream( std::istream& input_stream ) const
+{
+    return from_source( utils::make_unique< utils::StreamInputSource >( input_stream ));
+}
+
+JsonOnDemandDocument JsonOnDemandReader::from_file( std::string const& filename ) const
+{
+    return from_source( utils::from_file( filename ));
+}
+
+JsonOnDemandDocument JsonOnDemandReader::from_string( std::string const& json ) const
+{
+    return JsonOnDemandDocument( std::vector<char>( json.begin(), json.end() ));
+}
+
+JsonOnDemandDocument JsonOnDemandReader::from_source(
+    std::unique_ptr<BaseInputSource> source
+) const {
+    // Read the whole input, in blocks of increasing size.
+    std::vector<char> data;
+    size_t block_size = 1 << 20;
+    while( true ) {
+        auto const old_size = data.size();
+        data.resize( old_size + block_size );
+        auto const got = source->read( data.data() + old_size, block_size );
+        data.resize( old_size + got );
+        if( got == 0 ) {
+            break;
+        }
+        if( block_size < ( 1 << 26 )) {
+            block_size *= 2;
+        }
+    }
+    return JsonOnDemandDocument( std::move( data ));
+}
+
+} // namespace utils
+} // namespace genesis
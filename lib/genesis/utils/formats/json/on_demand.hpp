@@ -0,0 +1,678 @@
+#ifndef GENESIS_UTILS_FORMATS_JSON_ON_DEMAND_H_
+#define GENESIS_UTILS_FORMATS_JSON_ON_DEMAND_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/formats/json/document.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Forward Declarations
+// =================================================================================================
+
+class BaseInputSource;
+class JsonOnDemandIterator;
+
+// =================================================================================================
+//     Structural Index
+// =================================================================================================
+
+/**
+ * @brief Find the structural chars of a `Json` document.
+ *
+ * This is the first stage of the on-demand parsing, see JsonOnDemandDocument. It returns the
+ * positions of all chars `{}[]:,` that are not inside of strings, as well as the positions of the
+ * opening quotation marks of strings, and of the first chars of numbers and literals.
+ * The positions are followed by a final entry that is the size of the input.
+ *
+ * The input is processed in blocks of 64 chars, for which bit masks of the char classes are
+ * computed, using SSE2 instructions if available. Escaped quotation marks and the extent of strings
+ * are then resolved with bit operations on these masks, so that the chars of strings never need to
+ * be looked at individually. Throws if the input ends within a string, or exceeds 4GB.
+ */
+std::vector<std::uint32_t> json_structural_index( char const* data, size_t size );
+
+// =================================================================================================
+//     Json On Demand Value
+// =================================================================================================
+
+/**
+ * @brief Lazy view of a value in a JsonOnDemandDocument.
+ *
+ * A view only consists of the position of the value in the structural index of its document.
+ * Its contents are only parsed when accessed, and elements of arrays and objects that are not
+ * accessed are skipped using the structural index, without looking at their contents. This also
+ * means that invalid input is only detected in parts of the document that are accessed.
+ *
+ * The accessors mirror the const accessors of JsonDocument. Note that finding an element by
+ * index or key, as well as size(), scan the array or object from its beginning, so iterating
+ * is the preferred way to access all elements.
+ */
+class JsonOnDemandValue
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Typedefs and Enums
+    // ---------------------------------------------------------------------
+
+    using ValueType          = JsonDocument::ValueType;
+    using StringType         = JsonDocument::StringType;
+    using BooleanType        = JsonDocument::BooleanType;
+    using NumberFloatType    = JsonDocument::NumberFloatType;
+    using NumberSignedType   = JsonDocument::NumberSignedType;
+    using NumberUnsignedType = JsonDocument::NumberUnsignedType;
+
+    using iterator           = JsonOnDemandIterator;
+    using const_iterator     = JsonOnDemandIterator;
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Create a view of a `null` value.
+     */
+    JsonOnDemandValue();
+
+    JsonOnDemandValue(
+        char const* data, std::uint32_t const* index, size_t index_size, size_t position
+    )
+        : data_( data )
+        , index_( index )
+        , index_size_( index_size )
+        , position_( position )
+    {}
+
+    ~JsonOnDemandValue() = default;
+
+    JsonOnDemandValue( JsonOnDemandValue const& ) = default;
+    JsonOnDemandValue( JsonOnDemandValue&& )      = default;
+
+    JsonOnDemandValue& operator= ( JsonOnDemandValue const& ) = default;
+    JsonOnDemandValue& operator= ( JsonOnDemandValue&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Type Inspection
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return the type of the value.
+     *
+     * For most values, this is determined by their first char. Numbers however have to be parsed,
+     * in order to distinguish between the different number types.
+     */
+    ValueType type() const;
+
+    bool is_null() const
+    {
+        return type() == ValueType::kNull;
+    }
+
+    bool is_array() const
+    {
+        return first_char_() == '[';
+    }
+
+    bool is_object() const
+    {
+        return first_char_() == '{';
+    }
+
+    bool is_string() const
+    {
+        return first_char_() == '"';
+    }
+
+    bool is_boolean() const
+    {
+        return type() == ValueType::kBoolean;
+    }
+
+    bool is_number() const
+    {
+        auto const t = type();
+        return t == ValueType::kNumberFloat || t == ValueType::kNumberSigned ||
+               t == ValueType::kNumberUnsigned;
+    }
+
+    bool is_structured() const
+    {
+        return is_array() or is_object();
+    }
+
+    std::string type_name() const;
+
+    // ---------------------------------------------------------------------
+    //     Capacity
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return the number of elements, using the same semantics as JsonDocument::size().
+     */
+    size_t size() const;
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    // ---------------------------------------------------------------------
+    //     Value Access
+    // ---------------------------------------------------------------------
+
+    StringType         get_string() const;
+    BooleanType        get_boolean() const;
+    NumberFloatType    get_number_float() const;
+    NumberSignedType   get_number_signed() const;
+    NumberUnsignedType get_number_unsigned() const;
+
+    template<typename T>
+    T get_number() const
+    {
+        // Parse the number only once, instead of checking its type first.
+        ValueType          t;
+        NumberFloatType    f;
+        NumberSignedType   i;
+        NumberUnsignedType u;
+        parse_number_( t, f, i, u );
+        if( t == ValueType::kNumberFloat ) {
+            return f;
+        } else if( t == ValueType::kNumberSigned ) {
+            return i;
+        } else if( t == ValueType::kNumberUnsigned ) {
+            return u;
+        } else {
+            throw std::domain_error( "Cannot use get_number<T>() with " + type_name() + "." );
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    //     Element Access
+    // ---------------------------------------------------------------------
+
+    JsonOnDemandValue at( size_t index ) const;
+    JsonOnDemandValue at( std::string const& key ) const;
+
+    JsonOnDemandValue operator [] ( size_t index ) const
+    {
+        return at( index );
+    }
+
+    JsonOnDemandValue operator [] ( std::string const& key ) const
+    {
+        return at( key );
+    }
+
+    /**
+     * @brief Find the member with the given key in an object.
+     *
+     * Returns the end() iterator if the key is not found, or if the value is not an object.
+     * If a key appears multiple times, the first one is found.
+     */
+    JsonOnDemandIterator find( std::string const& key ) const;
+
+    size_t count( std::string const& key ) const;
+
+    // ---------------------------------------------------------------------
+    //     Iterators
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return a forward iterator to the first element of an array or member of an object.
+     *
+     * Other values are treated as containing themselves as a single element, same as for
+     * JsonDocument. Members of objects are iterated in the order in which they appear in the input.
+     */
+    JsonOnDemandIterator begin() const;
+    JsonOnDemandIterator end() const;
+
+    // ---------------------------------------------------------------------
+    //     Conversion
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Parse the complete value and all its children into a JsonDocument.
+     */
+    JsonDocument to_document() const;
+
+    /**
+     * @brief Return the raw Json text of the value, without parsing it.
+     */
+    std::string raw_json() const;
+
+    // ---------------------------------------------------------------------
+    //     Internal Helpers
+    // ---------------------------------------------------------------------
+
+private:
+
+    friend class JsonOnDemandIterator;
+
+    char first_char_() const
+    {
+        return data_[ index_[ position_ ]];
+    }
+
+    char char_at_( size_t position ) const
+    {
+        // The last entry of the index is the end of the input, which is not a valid char.
+        return position + 1 < index_size_ ? data_[ index_[ position ]] : '\0';
+    }
+
+    JsonOnDemandValue value_at_( size_t position ) const
+    {
+        return JsonOnDemandValue( data_, index_, index_size_, position );
+    }
+
+    void parse_number_(
+        ValueType& type, NumberFloatType& number_float,
+        NumberSignedType& number_signed, NumberUnsignedType& number_unsigned
+    ) const;
+
+    size_t skip_( size_t position ) const;
+    size_t next_element_( size_t position ) const;
+    std::string parse_string_at_( size_t position ) const;
+    bool key_equals_( size_t position, std::string const& key ) const;
+    [[noreturn]] void throw_invalid_( size_t position, std::string const& expected ) const;
+
+    // ---------------------------------------------------------------------
+    //     Data Members
+    // ---------------------------------------------------------------------
+
+private:
+
+    char const*          data_;
+    std::uint32_t const* index_;
+    size_t               index_size_;
+    size_t               position_;
+};
+
+// =================================================================================================
+//     Json On Demand Iterator
+// =================================================================================================
+
+/**
+ * @brief Forward iterator over the elements of an array or the members of an object
+ * of a JsonOnDemandDocument.
+ *
+ * Same as the JsonIterator, it offers key() and value() for accessing object members.
+ * Moving the iterator skips the current value without parsing it.
+ */
+class JsonOnDemandIterator
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Typedefs and Enums
+    // ---------------------------------------------------------------------
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = JsonOnDemandValue;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = JsonOnDemandValue;
+
+    /**
+     * @brief Helper that makes `operator->` work on the returned view.
+     */
+    struct pointer
+    {
+        JsonOnDemandValue value;
+
+        JsonOnDemandValue const* operator->() const
+        {
+            return &value;
+        }
+    };
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    JsonOnDemandIterator() = default;
+
+    /**
+     * @brief Create an iterator over the `container`, pointing to the element at `position`
+     * in the structural index.
+     *
+     * For arrays and objects, the end of the iteration is reached once the position points to the
+     * closing bracket. For all other values, the position is that of the value itself, and any
+     * other position is the end.
+     */
+    JsonOnDemandIterator( JsonOnDemandValue const& container, size_t position )
+        : container_( container )
+        , position_( position )
+    {}
+
+    ~JsonOnDemandIterator() = default;
+
+    JsonOnDemandIterator( JsonOnDemandIterator const& ) = default;
+    JsonOnDemandIterator( JsonOnDemandIterator&& )      = default;
+
+    JsonOnDemandIterator& operator= ( JsonOnDemandIterator const& ) = default;
+    JsonOnDemandIterator& operator= ( JsonOnDemandIterator&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Operators
+    // ---------------------------------------------------------------------
+
+    reference operator * () const;
+
+    pointer operator -> () const
+    {
+        return pointer{ operator*() };
+    }
+
+    JsonOnDemandIterator& operator ++ ();
+
+    JsonOnDemandIterator operator ++ ( int )
+    {
+        auto result = *this;
+        ++( *this );
+        return result;
+    }
+
+    /**
+     * @brief Compare two iterators.
+     *
+     * The end of an array or object is only known once the iteration gets there. Hence, all
+     * iterators that have reached the end compare equal to end(), without the need to scan the
+     * container for its end when calling end().
+     */
+    bool operator == ( JsonOnDemandIterator const& other ) const
+    {
+        auto const this_end  = is_end_();
+        auto const other_end = other.is_end_();
+        if( this_end || other_end ) {
+            return this_end && other_end;
+        }
+        return position_ == other.position_;
+    }
+
+    bool operator != ( JsonOnDemandIterator const& other ) const
+    {
+        return !( *this == other );
+    }
+
+    // ---------------------------------------------------------------------
+    //     Key Value Access for Objects
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return the key of an object iterator.
+     */
+    std::string key() const;
+
+    /**
+     * @brief Return the value of the iterator.
+     */
+    reference value() const
+    {
+        return operator*();
+    }
+
+    // ---------------------------------------------------------------------
+    //     Internal Helpers
+    // ---------------------------------------------------------------------
+
+private:
+
+    bool is_end_() const;
+
+    // ---------------------------------------------------------------------
+    //     Data Members
+    // ---------------------------------------------------------------------
+
+private:
+
+    friend class JsonOnDemandValue;
+
+    JsonOnDemandValue container_;
+    size_t            position_ = static_cast<size_t>( -1 );
+};
+
+// =================================================================================================
+//     Json On Demand Document
+// =================================================================================================
+
+/**
+ * @brief `Json` document that is parsed on demand, in two stages.
+ *
+ * In the first stage, which runs when the document is created, the input is scanned for its
+ * structural chars, see json_structural_index(). This is a fast, vectorized pass over the input,
+ * which does not parse any values. In the second stage, values are accessed via lazy
+ * JsonOnDemandValue views, which only parse a value once it is accessed, and skip over all
+ * values that are not needed, using the structural index.
+ *
+ * Hence, the cost of reading a document mostly depends on the parts of it that are actually used.
+ * For example, for a `jplace` file, the often large `metadata` object and `nm` arrays can be
+ * skipped if not needed, and the placements can be iterated without building a document for them.
+ *
+ * The document keeps the whole input and its structural index in memory. Values stay valid as
+ * long as the document exists, including when it is moved.
+ */
+class JsonOnDemandDocument
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Typedefs and Enums
+    // ---------------------------------------------------------------------
+
+    using ValueType      = JsonDocument::ValueType;
+    using iterator       = JsonOnDemandIterator;
+    using const_iterator = JsonOnDemandIterator;
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Create an empty document, whose root is a `null` value.
+     */
+    JsonOnDemandDocument() = default;
+
+    /**
+     * @brief Create a document from the given Json text, and build its structural index.
+     */
+    explicit JsonOnDemandDocument( std::vector<char>&& data );
+
+    ~JsonOnDemandDocument() = default;
+
+    JsonOnDemandDocument( JsonOnDemandDocument const& ) = default;
+    JsonOnDemandDocument( JsonOnDemandDocument&& )      = default;
+
+    JsonOnDemandDocument& operator= ( JsonOnDemandDocument const& ) = default;
+    JsonOnDemandDocument& operator= ( JsonOnDemandDocument&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Accessors
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return a view of the top level value of the document.
+     */
+    JsonOnDemandValue root() const
+    {
+        // The index always contains the final entry for the end of the input.
+        if( index_.size() <= 1 ) {
+            return JsonOnDemandValue();
+        }
+        return JsonOnDemandValue( data_.data(), index_.data(), index_.size(), 0 );
+    }
+
+    /**
+     * @brief Return the number of entries in the structural index.
+     */
+    size_t structural_count() const
+    {
+        return index_.size();
+    }
+
+    // ---------------------------------------------------------------------
+    //     Root Value Access
+    // ---------------------------------------------------------------------
+
+    ValueType type() const
+    {
+        return root().type();
+    }
+
+    bool is_null() const
+    {
+        return root().is_null();
+    }
+
+    bool is_array() const
+    {
+        return root().is_array();
+    }
+
+    bool is_object() const
+    {
+        return root().is_object();
+    }
+
+    size_t size() const
+    {
+        return root().size();
+    }
+
+    JsonOnDemandValue at( size_t index ) const
+    {
+        return root().at( index );
+    }
+
+    JsonOnDemandValue at( std::string const& key ) const
+    {
+        return root().at( key );
+    }
+
+    JsonOnDemandValue operator [] ( size_t index ) const
+    {
+        return root()[ index ];
+    }
+
+    JsonOnDemandValue operator [] ( std::string const& key ) const
+    {
+        return root()[ key ];
+    }
+
+    JsonOnDemandIterator find( std::string const& key ) const;
+    size_t count( std::string const& key ) const;
+
+    JsonOnDemandIterator begin() const;
+    JsonOnDemandIterator end() const;
+
+    JsonDocument to_document() const
+    {
+        return root().to_document();
+    }
+
+    // ---------------------------------------------------------------------
+    //     Data Members
+    // ---------------------------------------------------------------------
+
+private:
+
+    std::vector<char>          data_;
+    std::vector<std::uint32_t> index_;
+};
+
+// =================================================================================================
+//     Json On Demand Reader
+// =================================================================================================
+
+/**
+ * @brief Read `Json` data into a JsonOnDemandDocument.
+ *
+ * The whole input is read into memory, and its structural index is built, see
+ * JsonOnDemandDocument for details.
+ */
+class JsonOnDemandReader
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    JsonOnDemandReader()  = default;
+    ~JsonOnDemandReader() = default;
+
+    JsonOnDemandReader( JsonOnDemandReader const& ) = default;
+    JsonOnDemandReader( JsonOnDemandReader&& )      = default;
+
+    JsonOnDemandReader& operator= ( JsonOnDemandReader const& ) = default;
+    JsonOnDemandReader& operator= ( JsonOnDemandReader&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Reading
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Read from a stream containing a JSON document.
+     */
+    JsonOnDemandDocument from_stream( std::istream& input_stream ) const;
+
+    /**
+     * @brief Read a JSON document file.
+     *
+     * If the file does not exists, the function throws.
+     */
+    JsonOnDemandDocument from_file( std::string const& filename ) const;
+
+    /**
+     * @brief Read a JSON document from a string.
+     */
+    JsonOnDemandDocument from_string( std::string const& json ) const;
+
+    /**
+     * @brief Read all data from an input source, and build the document from it.
+     */
+    JsonOnDemandDocument from_source( std::unique_ptr<BaseInputSource> source ) const;
+
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
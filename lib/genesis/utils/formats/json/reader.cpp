@@ -38,7 +38,9 @@
 
 #include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
 #include "genesis/utils/formats/json/document.hpp"
+#include "genesis/utils/formats/json/sax_reader.hpp"
 #include "genesis/utils/io/input_stream.hpp"
 #include "genesis/utils/io/parser.hpp"
 #include "genesis/utils/io/scanner.hpp"
@@ -60,7 +62,7 @@ JsonDocument JsonReader::from_stream( std::istream& input_stream ) const
 
 JsonDocument JsonReader::from_file (const std::string& filename ) const
 {
-    utils::InputStream is( utils::make_unique< utils::FileInputSource >( filename ));
+    utils::InputStream is( utils::from_file( filename ));
     return parse( is );
 }
 
@@ -259,99 +261,28 @@ JsonDocument JsonReader::parse_object( InputStream& input_stream ) const
 
 JsonDocument JsonReader::parse_number( InputStream& input_stream ) const
 {
-    auto& it = input_stream;
-    skip_while( it, isspace );
-    if( !it ) {
-        throw std::runtime_error(
-            "Expecting number in " + it.source_name() + " at " + it.at() + "."
-        );
-    }
-
-    // Sign
-    bool is_neg = false;
-    if( *it == '-' ){
-        is_neg = true;
-        ++it;
-    } else if( *it == '+' ) {
-        ++it;
-    }
-
-    // Integer Part
-    bool found_mantisse = false;
-    JsonDocument::NumberUnsignedType ix = 0;
-    while( it && isdigit( *it )) {
-        int y = *it - '0';
-        ix *= 10;
-        ix += y;
-        ++it;
-        found_mantisse = true;
-    }
-
-    // If not float
-    if( found_mantisse && !( *it == '.' || tolower(*it) == 'e' ) ) {
-        if( is_neg ) {
-            return JsonDocument::number_signed( -ix );
-        } else {
-            return JsonDocument::number_unsigned( ix );
+    // We use the number parsing of the JsonSaxReader, and store the reported number.
+    struct NumberHandler : public JsonSaxHandler
+    {
+        void number_unsigned( std::uint64_t value ) override
+        {
+            result = JsonDocument::number_unsigned( value );
         }
-    }
-
-    // Decimal part
-    JsonDocument::NumberFloatType dx = ix;
-    if( it && *it == '.' ) {
-        ++it;
-
-        JsonDocument::NumberFloatType pos = 1.0;
-        while( it && isdigit( *it )) {
-            pos /= 10.0;
-            int y = *it - '0';
-            dx += y * pos;
-            ++it;
-            found_mantisse = true;
+        void number_signed( std::int64_t value ) override
+        {
+            result = JsonDocument::number_signed( value );
         }
-    }
-
-    // We need to have some digits before the exponential part.
-    if( ! found_mantisse ) {
-        throw std::runtime_error(
-            "Invalid float number in " + it.source_name() + " at " + it.at() + "."
-        );
-    }
-
-    // Exponential part
-    if( it && tolower(*it) == 'e' ) {
-        ++it;
-
-        // Read the exp. If there are no digits, this throws.
-        int e = parse_signed_integer<int>( it );
-        if( e != 0 ) {
-            JsonDocument::NumberFloatType base;
-            if( e < 0 ) {
-                base = 0.1;
-                e = -e;
-            } else {
-                base = 10;
-            }
-
-            while( e != 1 ) {
-                if( ( e & 1 ) == 0 ) {
-                    base = base * base;
-                    e >>= 1;
-                } else {
-                    dx *= base;
-                    --e;
-                }
-            }
-            dx *= base;
+        void number_float( double value ) override
+        {
+            result = JsonDocument::number_float( value );
         }
-    }
 
-    // Sign
-    if (is_neg) {
-        dx = -dx;
-    }
+        JsonDocument result;
+    };
 
-    return JsonDocument::number_float( dx );
+    NumberHandler handler;
+    JsonSaxReader().parse_number( input_stream, handler );
+    return std::move( handler.result );
 }
 
 } // namespace utils
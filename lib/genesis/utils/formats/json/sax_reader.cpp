@@ -0,0 +1,579 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/formats/json/sax_reader.hpp"
+
+#include <cassert>
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/char_search.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
+#include "genesis/utils/io/input_stream.hpp"
+#include "genesis/utils/io/parser.hpp"
+#include "genesis/utils/text/char.hpp"
+#include "genesis/utils/text/string.hpp"
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Json Sax Path
+// =================================================================================================
+
+std::string JsonSaxPath::to_string() const
+{
+    std::string result;
+    for( size_t i = 0; i < size_; ++i ) {
+        auto const& element = elements_[i];
+        result += '/';
+        if( element.is_index ) {
+            result += std::to_string( element.index );
+            continue;
+        }
+        for( auto const c : element.key ) {
+            if( c == '~' ) {
+                result += "~0";
+            } else if( c == '/' ) {
+                result += "~1";
+            } else {
+                result += c;
+            }
+        }
+    }
+    return result;
+}
+
+// =================================================================================================
+//     Reading
+// =================================================================================================
+
+void JsonSaxReader::from_stream(
+    std::istream& input_stream, JsonSaxHandler& handler, JsonSaxPath* path
+) const {
+    utils::InputStream is( utils::make_unique< utils::StreamInputSource >( input_stream ));
+    parse( is, handler, path );
+}
+
+void JsonSaxReader::from_file(
+    std::string const& filename, JsonSaxHandler& handler, JsonSaxPath* path
+) const {
+    utils::InputStream is( utils::from_file( filename ));
+    parse( is, handler, path );
+}
+
+void JsonSaxReader::from_string(
+    std::string const& json, JsonSaxHandler& handler, JsonSaxPath* path
+) const {
+    utils::InputStream is( utils::make_unique< utils::StringInputSource >( json ));
+    parse( is, handler, path );
+}
+
+// =================================================================================================
+//     Local Helpers
+// =================================================================================================
+
+/**
+ * @brief Local helper to skip white space.
+ *
+ * This is called between all tokens, so we use a plain loop here instead of the more general
+ * skip_while() with its function argument.
+ */
+static inline void json_sax_skip_space_( InputStream& it )
+{
+    while( it && std::isspace( static_cast<unsigned char>( *it ))) {
+        ++it;
+    }
+}
+
+/**
+ * @brief Local helper to read four hex digits of a `\u` escape sequence.
+ */
+static unsigned int json_sax_read_hex_( InputStream& it )
+{
+    unsigned int result = 0;
+    for( size_t i = 0; i < 4; ++i ) {
+        if( !it || !std::isxdigit( static_cast<unsigned char>( *it ))) {
+            throw std::runtime_error(
+                "Invalid unicode escape sequence in Json string in " + it.source_name() +
+                " at " + it.at() + "."
+            );
+        }
+        auto const c = *it;
+        result *= 16;
+        if( c >= '0' && c <= '9' ) {
+            result += c - '0';
+        } else {
+            result += to_lower_ascii( c ) - 'a' + 10;
+        }
+        ++it;
+    }
+    return result;
+}
+
+/**
+ * @brief Local helper to append a unicode code point to a string, encoded as UTF-8.
+ */
+static void json_sax_append_utf8_( std::string& target, unsigned int cp )
+{
+    if( cp < 0x80 ) {
+        target += static_cast<char>( cp );
+    } else if( cp < 0x800 ) {
+        target += static_cast<char>( 0xC0 | ( cp >> 6 ));
+        target += static_cast<char>( 0x80 | ( cp & 0x3F ));
+    } else if( cp < 0x10000 ) {
+        target += static_cast<char>( 0xE0 | ( cp >> 12 ));
+        target += static_cast<char>( 0x80 | (( cp >> 6 ) & 0x3F ));
+        target += static_cast<char>( 0x80 | ( cp & 0x3F ));
+    } else {
+        target += static_cast<char>( 0xF0 | ( cp >> 18 ));
+        target += static_cast<char>( 0x80 | (( cp >> 12 ) & 0x3F ));
+        target += static_cast<char>( 0x80 | (( cp >> 6 ) & 0x3F ));
+        target += static_cast<char>( 0x80 | ( cp & 0x3F ));
+    }
+}
+
+/**
+ * @brief Local helper to read a quoted string into the target, resolving all Json escape
+ * sequences. The stream has to be at the opening quotation mark.
+ *
+ * Only the quotation mark and the backslash are special. All chars between them are copied in
+ * bulk from the buffer of the stream, without any checks. In particular, control chars, which Json
+ * only allows in escaped form, are accepted and copied as they are, and new line chars are not
+ * converted. Escape sequences are resolved one char at a time, with `\u` sequences (including
+ * surrogate pairs) encoded as UTF-8. Invalid escape sequences, lone surrogates, and an end of the
+ * input within the string throw.
+ */
+static void json_sax_read_string_( InputStream& it, std::string& target )
+{
+    assert( it && *it == '"' );
+    ++it;
+    target.clear();
+
+    while( true ) {
+        // Copy everything up to the next quotation mark or backslash, or the whole buffer, if it
+        // contains neither of them. In that case, the next iteration gets the next buffered block.
+        // If nothing was copied, we are either at one of the two chars, or at the end of the
+        // input, where the buffer is empty.
+        auto const view = it.buffer();
+        auto const end  = view.first + view.second;
+        auto const pos  = find_first_of( view.first, end, '"', '\\' );
+        if( pos != view.first ) {
+            target.append( view.first, pos );
+            it.jump_unchecked( static_cast<size_t>( pos - view.first ));
+            continue;
+        }
+        if( !it ) {
+            throw std::runtime_error(
+                "Unexpected end of Json string in " + it.source_name() + " at " + it.at() + "."
+            );
+        }
+
+        // End of the string.
+        if( *it == '"' ) {
+            ++it;
+            return;
+        }
+
+        // Escape sequence.
+        assert( *it == '\\' );
+        ++it;
+        if( !it ) {
+            throw std::runtime_error(
+                "Unexpected end of Json string in " + it.source_name() + " at " + it.at() + "."
+            );
+        }
+        switch( *it ) {
+            case '"':
+            case '\\':
+            case '/':
+                target += *it;
+                break;
+            case 'b':
+                target += '\b';
+                break;
+            case 'f':
+                target += '\f';
+                break;
+            case 'n':
+                target += '\n';
+                break;
+            case 'r':
+                target += '\r';
+                break;
+            case 't':
+                target += '\t';
+                break;
+            case 'u': {
+                ++it;
+                auto cp = json_sax_read_hex_( it );
+
+                // Combine surrogate pairs. Lone surrogates are invalid in UTF-8, so we throw.
+                if( cp >= 0xD800 && cp <= 0xDBFF ) {
+                    if( !it || *it != '\\' || ( ++it, !it ) || *it != 'u' ) {
+                        throw std::runtime_error(
+                            "Invalid unicode surrogate pair in Json string in " +
+                            it.source_name() + " at " + it.at() + "."
+                        );
+                    }
+                    ++it;
+                    auto const low = json_sax_read_hex_( it );
+                    if( low < 0xDC00 || low > 0xDFFF ) {
+                        throw std::runtime_error(
+                            "Invalid unicode surrogate pair in Json string in " +
+                            it.source_name() + " at " + it.at() + "."
+                        );
+                    }
+                    cp = 0x10000 + (( cp - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+                } else if( cp >= 0xDC00 && cp <= 0xDFFF ) {
+                    throw std::runtime_error(
+                        "Invalid unicode surrogate pair in Json string in " +
+                        it.source_name() + " at " + it.at() + "."
+                    );
+                }
+                json_sax_append_utf8_( target, cp );
+
+                // We already moved past the escape sequence.
+                continue;
+            }
+            default:
+                throw std::runtime_error(
+                    "Invalid escape sequence '\\" + std::string( 1, *it ) +
+                    "' in Json string in " + it.source_name() + " at " + it.at() + "."
+                );
+        }
+        ++it;
+    }
+}
+
+/**
+ * @brief Local helper to read the key of an object member, including the colon after it.
+ */
+static void json_sax_read_key_(
+    InputStream& it, std::string& buffer, JsonSaxHandler& handler, JsonSaxPath* path
+) {
+    json_sax_skip_space_( it );
+    if( !it || *it != '"' ) {
+        throw std::runtime_error(
+            "Expecting Json object key in " + it.source_name() + " at " + it.at() + "."
+        );
+    }
+    json_sax_read_string_( it, buffer );
+
+    // The handler might move from the buffer, so we first need to update the path.
+    if( path ) {
+        path->push_key( buffer );
+    }
+    handler.key( buffer );
+
+    json_sax_skip_space_( it );
+    if( !it || *it != ':' ) {
+        throw std::runtime_error(
+            "Expecting ':' after Json object key in " + it.source_name() + " at " + it.at() + "."
+        );
+    }
+    ++it;
+}
+
+/**
+ * @brief Local helper that reports the chars of an integer number to the handler.
+ *
+ * Returns false if the chars are not a valid integer, or if the integer does not fit into
+ * 64 bits. In that case, nothing is reported.
+ */
+static bool json_sax_parse_integer_(
+    char const* first, char const* last, JsonSaxHandler& handler
+) {
+    bool is_neg = false;
+    if( first != last && ( *first == '-' || *first == '+' )) {
+        is_neg = ( *first == '-' );
+        ++first;
+    }
+    if( first == last ) {
+        return false;
+    }
+
+    using UnsignedType = std::uint64_t;
+    using SignedType   = std::int64_t;
+    auto const max = std::numeric_limits<UnsignedType>::max();
+
+    UnsignedType ix = 0;
+    for( ; first != last; ++first ) {
+        auto const digit = static_cast<UnsignedType>( *first - '0' );
+        if( digit > 9 || ix > ( max - digit ) / 10 ) {
+            return false;
+        }
+        ix = 10 * ix + digit;
+    }
+
+    if( is_neg ) {
+        auto const max_signed = static_cast<UnsignedType>( std::numeric_limits<SignedType>::max() );
+        if( ix > max_signed + 1 ) {
+            return false;
+        }
+        // Negate in unsigned arithmetic, which also works for the minimum value.
+        handler.number_signed( static_cast<SignedType>( UnsignedType( 0 ) - ix ));
+    } else {
+        handler.number_unsigned( ix );
+    }
+    return true;
+}
+
+// =================================================================================================
+//     Parsing
+// =================================================================================================
+
+// -----------------------------------------------------------------------------
+//     Parse
+// -----------------------------------------------------------------------------
+
+void JsonSaxReader::parse(
+    InputStream& input_stream, JsonSaxHandler& handler, JsonSaxPath* path
+) const {
+    auto& it = input_stream;
+    if( path ) {
+        path->clear();
+    }
+
+    // Buffer for keys and string values, reused for all of them.
+    std::string buffer;
+
+    // Stack of the currently open containers, as their opening chars.
+    std::vector<char> stack;
+
+    // If there is no content, there is nothing to report.
+    json_sax_skip_space_( it );
+    if( !it ) {
+        return;
+    }
+
+    bool done = false;
+    while( ! done ) {
+
+        // At this point, we expect a value.
+        json_sax_skip_space_( it );
+        if( !it ) {
+            throw std::runtime_error(
+                "Unexpected end of Json input in " + it.source_name() + " at " + it.at() + "."
+            );
+        }
+        auto const c = *it;
+
+        // Start an object. If it is not empty, continue with the value of its first member.
+        if( c == '{' ) {
+            ++it;
+            handler.start_object();
+            json_sax_skip_space_( it );
+            if( it && *it == '}' ) {
+                ++it;
+                handler.end_object();
+            } else {
+                stack.push_back( '{' );
+                json_sax_read_key_( it, buffer, handler, path );
+                continue;
+            }
+
+        // Start an array. If it is not empty, continue with its first element.
+        } else if( c == '[' ) {
+            ++it;
+            handler.start_array();
+            json_sax_skip_space_( it );
+            if( it && *it == ']' ) {
+                ++it;
+                handler.end_array();
+            } else {
+                stack.push_back( '[' );
+                if( path ) {
+                    path->push_index();
+                }
+                continue;
+            }
+
+        // Parse a string.
+        } else if( c == '"' ) {
+            json_sax_read_string_( it, buffer );
+            handler.string_value( buffer );
+
+        // Either null or boolean. We accept any case, same as the JsonReader.
+        } else if( std::isalpha( static_cast<unsigned char>( c ))) {
+            buffer.clear();
+            while( it && std::isalpha( static_cast<unsigned char>( *it ))) {
+                buffer += to_lower_ascii( *it );
+                ++it;
+            }
+            if( buffer == "null" ) {
+                handler.null();
+            } else if( buffer == "true" ) {
+                handler.boolean( true );
+            } else if( buffer == "false" ) {
+                handler.boolean( false );
+            } else {
+                throw std::runtime_error(
+                    "Unexpected Json input string: '" + buffer + "' at " + it.at() + "."
+                );
+            }
+
+        // Parse a number.
+        } else if( char_is_digit( c ) || char_is_sign( c ) || c == '.' ) {
+            parse_number( it, handler );
+
+        // Parse error.
+        } else {
+            throw std::runtime_error(
+                "Unexpected Json input char: '" + std::string( 1, c ) + "' at " + it.at() + "."
+            );
+        }
+
+        // After a complete value, we either close containers, or move on to the next element
+        // of the innermost open container.
+        while( true ) {
+            json_sax_skip_space_( it );
+            if( stack.empty() ) {
+                done = true;
+                break;
+            }
+            if( !it ) {
+                throw std::runtime_error(
+                    "Unexpected end of Json input in " + it.source_name() + " at " + it.at() + "."
+                );
+            }
+
+            // Next element.
+            if( *it == ',' ) {
+                ++it;
+                if( stack.back() == '[' ) {
+                    if( path ) {
+                        path->next_index();
+                    }
+                } else {
+                    if( path ) {
+                        path->pop();
+                    }
+                    json_sax_read_key_( it, buffer, handler, path );
+                }
+                break;
+            }
+
+            // End of the container.
+            if(( stack.back() == '[' && *it == ']' ) || ( stack.back() == '{' && *it == '}' )) {
+                ++it;
+                if( path ) {
+                    path->pop();
+                }
+                if( stack.back() == '[' ) {
+                    handler.end_array();
+                } else {
+                    handler.end_object();
+                }
+                stack.pop_back();
+                continue;
+            }
+
+            throw std::runtime_error(
+                "Unexpected Json input char: '" + std::string( 1, *it ) + "' at " + it.at() +
+                ". Expecting ',' or '" + std::string( 1, stack.back() == '[' ? ']' : '}' ) + "'."
+            );
+        }
+    }
+
+    // We are done with the top level value. There should be nothing left.
+    assert( stack.empty() );
+    if( it ) {
+        throw std::runtime_error(
+            "Expected end of input while reading Json at " + it.at()
+        );
+    }
+}
+
+// -----------------------------------------------------------------------------
+//     Parse Number
+// -----------------------------------------------------------------------------
+
+void JsonSaxReader::parse_number( InputStream& input_stream, JsonSaxHandler& handler ) const
+{
+    auto& it = input_stream;
+    json_sax_skip_space_( it );
+    if( !it ) {
+        throw std::runtime_error(
+            "Expecting number in " + it.source_name() + " at " + it.at() + "."
+        );
+    }
+
+    // Work directly on the buffer. Find the end of the integer part, to see whether the number
+    // is an integer or a float.
+    auto const view = it.buffer();
+    auto const end  = view.first + view.second;
+    auto pos = view.first;
+    if( pos != end && ( *pos == '-' || *pos == '+' )) {
+        ++pos;
+    }
+    while( pos != end && std::isdigit( static_cast<unsigned char>( *pos ))) {
+        ++pos;
+    }
+
+    // Integer numbers that are completely in the buffer.
+    if( pos != end && *pos != '.' && *pos != 'e' && *pos != 'E' ) {
+        if( json_sax_parse_integer_( view.first, pos, handler )) {
+            it.jump_unchecked( static_cast<size_t>( pos - view.first ));
+            return;
+        }
+    }
+
+    // If we reached the end of the buffered data, the number might continue in the next block.
+    // This is rare, so we simply read it as a string first then.
+    if( pos == end ) {
+        auto const str     = parse_number_string( it );
+        auto const str_end = str.data() + str.size();
+        double value;
+        if( str.find_first_of( ".eE" ) == std::string::npos ) {
+            if( json_sax_parse_integer_( str.data(), str_end, handler )) {
+                return;
+            }
+        }
+        if( str.empty() || parse_float( str.data(), str_end, value ) != str_end ) {
+            throw std::runtime_error(
+                "Invalid number in " + it.source_name() + " at " + it.at() + "."
+            );
+        }
+        handler.number_float( value );
+        return;
+    }
+
+    // Float numbers, as well as integers that do not fit into 64 bits.
+    // This throws if the number is invalid.
+    handler.number_float( parse_float<double>( it ));
+}
+
+} // namespace utils
+} // namespace genesis
@@ -0,0 +1,322 @@
+#ifndef GENESIS_UTILS_FORMATS_JSON_SAX_READER_H_
+#define GENESIS_UTILS_FORMATS_JSON_SAX_READER_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Forward declarations
+// =================================================================================================
+
+class InputStream;
+
+// =================================================================================================
+//     Json Sax Handler
+// =================================================================================================
+
+/**
+ * @brief Base class for receiving the events of a JsonSaxReader.
+ *
+ * Derive from this class and override the functions for the events that are of interest.
+ * All functions have empty default implementations, so that events that are not overridden are
+ * simply ignored.
+ *
+ * The string that is passed to key() and string_value() is a buffer of the reader that is reused
+ * for the next string. Hence, an implementation can move from it, but should not keep a reference.
+ */
+class JsonSaxHandler
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    JsonSaxHandler()          = default;
+    virtual ~JsonSaxHandler() = default;
+
+    JsonSaxHandler( JsonSaxHandler const& ) = default;
+    JsonSaxHandler( JsonSaxHandler&& )      = default;
+
+    JsonSaxHandler& operator= ( JsonSaxHandler const& ) = default;
+    JsonSaxHandler& operator= ( JsonSaxHandler&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Events
+    // ---------------------------------------------------------------------
+
+    virtual void start_object() {}
+    virtual void end_object() {}
+    virtual void start_array() {}
+    virtual void end_array() {}
+
+    virtual void key( std::string& ) {}
+    virtual void string_value( std::string& ) {}
+
+    virtual void number_unsigned( std::uint64_t ) {}
+    virtual void number_signed( std::int64_t ) {}
+    virtual void number_float( double ) {}
+
+    virtual void boolean( bool ) {}
+    virtual void null() {}
+};
+
+// =================================================================================================
+//     Json Sax Path
+// =================================================================================================
+
+/**
+ * @brief Location of the current value within the document while reading with a JsonSaxReader.
+ *
+ * If a path is passed to the JsonSaxReader, the reader keeps it up to date while parsing,
+ * so that a JsonSaxHandler that holds a reference to the path can check where in the document
+ * the current event happens. For each event of a value, as well as for the start and end events
+ * of objects and arrays, the path points to that value, that is, it contains the keys of all
+ * enclosing objects and the indices of all enclosing arrays. The path of the top level value
+ * is empty.
+ *
+ * The path is lightweight: Its elements are reused while parsing, so that keeping track of the
+ * location does not allocate memory for every value.
+ */
+class JsonSaxPath
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Typedefs and Enums
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Element of the path, which is either the key of an object member
+     * or the index of an array element.
+     */
+    struct Element
+    {
+        bool        is_index = false;
+        std::size_t index    = 0;
+        std::string key;
+    };
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    JsonSaxPath()  = default;
+    ~JsonSaxPath() = default;
+
+    JsonSaxPath( JsonSaxPath const& ) = default;
+    JsonSaxPath( JsonSaxPath&& )      = default;
+
+    JsonSaxPath& operator= ( JsonSaxPath const& ) = default;
+    JsonSaxPath& operator= ( JsonSaxPath&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Accessors
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Return the depth of the current value, that is, the number of path elements.
+     */
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    Element const& operator[] ( std::size_t index ) const
+    {
+        return elements_[ index ];
+    }
+
+    Element const& back() const
+    {
+        return elements_[ size_ - 1 ];
+    }
+
+    /**
+     * @brief Return the path as a JSON Pointer (RFC 6901), for example `/fields/2`.
+     */
+    std::string to_string() const;
+
+    // ---------------------------------------------------------------------
+    //     Modifiers
+    // ---------------------------------------------------------------------
+
+    void clear()
+    {
+        size_ = 0;
+    }
+
+    void push_key( std::string const& key )
+    {
+        auto& element = push_();
+        element.is_index = false;
+        element.key      = key;
+    }
+
+    void push_index()
+    {
+        auto& element = push_();
+        element.is_index = true;
+        element.index    = 0;
+    }
+
+    void next_index()
+    {
+        ++elements_[ size_ - 1 ].index;
+    }
+
+    void pop()
+    {
+        --size_;
+    }
+
+private:
+
+    Element& push_()
+    {
+        if( size_ == elements_.size() ) {
+            elements_.emplace_back();
+        }
+        return elements_[ size_++ ];
+    }
+
+    // ---------------------------------------------------------------------
+    //     Data Members
+    // ---------------------------------------------------------------------
+
+    // We keep popped elements, so that their key strings can be reused.
+    std::vector<Element> elements_;
+    std::size_t          size_ = 0;
+};
+
+// =================================================================================================
+//     Json Sax Reader
+// =================================================================================================
+
+/**
+ * @brief Read `Json` data in a streaming fashion, and report its contents as events
+ * to a JsonSaxHandler.
+ *
+ * In contrast to the JsonReader, this does not build a JsonDocument, so that the memory needed
+ * for reading does not depend on the size of the input. The parsing is iterative, hence deeply
+ * nested documents do not use stack space, and strings and numbers are read in bulk from the
+ * buffer of the InputStream.
+ *
+ * Optionally, a JsonSaxPath can be provided, which is then kept up to date with the location
+ * of the current value in the document, see there for details.
+ */
+class JsonSaxReader
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    JsonSaxReader()  = default;
+    ~JsonSaxReader() = default;
+
+    JsonSaxReader( JsonSaxReader const& ) = default;
+    JsonSaxReader( JsonSaxReader&& )      = default;
+
+    JsonSaxReader& operator= ( JsonSaxReader const& ) = default;
+    JsonSaxReader& operator= ( JsonSaxReader&& )      = default;
+
+    // ---------------------------------------------------------------------
+    //     Reading
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Read from a stream containing a JSON document and report its contents
+     * to the handler.
+     */
+    void from_stream(
+        std::istream& input_stream, JsonSaxHandler& handler, JsonSaxPath* path = nullptr
+    ) const;
+
+    /**
+     * @brief Take a JSON document file path and report its contents to the handler.
+     *
+     * If the file does not exists, the function throws.
+     */
+    void from_file(
+        std::string const& filename, JsonSaxHandler& handler, JsonSaxPath* path = nullptr
+    ) const;
+
+    /**
+     * @brief Take a string containing a JSON document and report its contents to the handler.
+     */
+    void from_string(
+        std::string const& json, JsonSaxHandler& handler, JsonSaxPath* path = nullptr
+    ) const;
+
+    // ---------------------------------------------------------------------
+    //     Parsing Functions
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Parse a complete JSON document from the input and report its contents
+     * to the handler.
+     *
+     * An empty input does not produce any events. If there is content after the document,
+     * an exception is thrown.
+     */
+    void parse(
+        InputStream& input_stream, JsonSaxHandler& handler, JsonSaxPath* path = nullptr
+    ) const;
+
+    /**
+     * @brief Parse a single number from the input and report it to the handler.
+     *
+     * Integers are reported as number_unsigned() or, if negative, as number_signed().
+     * Numbers with a fractional part or exponent, as well as integers that do not fit into
+     * 64 bits, are reported as number_float().
+     */
+    void parse_number( InputStream& input_stream, JsonSaxHandler& handler ) const;
+
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
@@ -0,0 +1,339 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/formats/json/stream_writer.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+#include "genesis/utils/text/float_format.hpp"
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Constructor and Rule of Five
+// =================================================================================================
+
+JsonStreamWriter::JsonStreamWriter( std::ostream& out )
+    : out_( &out )
+{
+    buffer_.reserve( flush_size_ + 1024 );
+}
+
+JsonStreamWriter::~JsonStreamWriter()
+{
+    // Destructors must not throw. Writing errors are only reported by explicit calls to flush()
+    // and finish(), and are otherwise lost here.
+    try {
+        flush();
+    } catch( ... ) {}
+}
+
+// =================================================================================================
+//     Containers
+// =================================================================================================
+
+JsonStreamWriter& JsonStreamWriter::begin_object( bool single_line )
+{
+    begin_container_( true, single_line );
+    return *this;
+}
+
+JsonStreamWriter& JsonStreamWriter::end_object()
+{
+    end_container_( true );
+    return *this;
+}
+
+JsonStreamWriter& JsonStreamWriter::begin_array( bool single_line )
+{
+    begin_container_( false, single_line );
+    return *this;
+}
+
+JsonStreamWriter& JsonStreamWriter::end_array()
+{
+    end_container_( false );
+    return *this;
+}
+
+JsonStreamWriter& JsonStreamWriter::key( std::string const& name )
+{
+    if( stack_.empty() || ! stack_.back().is_object || after_key_ ) {
+        throw std::logic_error( "Json key \"" + name + "\" written outside of an object." );
+    }
+    write_separator_( stack_.back() );
+    write_string_( name.data(), name.size() );
+    buffer_ += ( indent_ > 0 ? ": " : ":" );
+    after_key_ = true;
+    return *this;
+}
+
+JsonStreamWriter& JsonStreamWriter::key( char const* name )
+{
+    return key( std::string( name ));
+}
+
+// =================================================================================================
+//     Values
+// =================================================================================================
+
+JsonStreamWriter& JsonStreamWriter::value( std::string const& text )
+{
+    prepare_value_();
+    write_string_( text.data(), text.size() );
+    flush_if_full_();
+    return *this;
+}
+
+JsonStreamWriter& JsonStreamWriter::value( char const* text )
+{
+    prepare_value_();
+    write_string_( text, std::strlen( text ));
+    flush_if_full_();
+    return *this;
+}
+
+JsonStreamWriter& JsonStreamWriter::value( bool flag )
+{
+    prepare_value_();
+    buffer_ += ( flag ? "true" : "false" );
+    return *this;
+}
+
+JsonStreamWriter& JsonStreamWriter::value( std::nullptr_t )
+{
+    prepare_value_();
+    buffer_ += "null";
+    return *this;
+}
+
+JsonStreamWriter& JsonStreamWriter::value( double number )
+{
+    // Json has no representation for infinity and NaN, and writing them as `null` would lose
+    // the value without notice. Check before writing anything, so that the document stays valid.
+    if( ! std::isfinite( number )) {
+        throw std::invalid_argument(
+            "Cannot write non-finite number " + std::to_string( number ) + " to Json."
+        );
+    }
+    prepare_value_();
+
+    char text[ FloatFormatBufferSize + 2 ];
+    char* end = format_float_shortest( text, number );
+
+    // Make sure that the number is read as a float again.
+    if( ! std::memchr( text, '.', end - text ) && ! std::memchr( text, 'e', end - text )) {
+        *end++ = '.';
+        *end++ = '0';
+    }
+    buffer_.append( text, end );
+    flush_if_full_();
+    return *this;
+}
+
+// =================================================================================================
+//     Finishing
+// =================================================================================================
+
+void JsonStreamWriter::flush()
+{
+    if( ! buffer_.empty() ) {
+        out_->write( buffer_.data(), buffer_.size() );
+        buffer_.clear();
+    }
+}
+
+void JsonStreamWriter::finish()
+{
+    if( ! complete_ && stack_.empty() ) {
+        throw std::logic_error( "Json document is empty." );
+    }
+    if( ! complete_ ) {
+        throw std::logic_error(
+            "Json document is incomplete: " + std::to_string( stack_.size() ) +
+            " containers are still open."
+        );
+    }
+    flush();
+}
+
+// =================================================================================================
+//     Internal Functions
+// =================================================================================================
+
+void JsonStreamWriter::begin_container_( bool is_object, bool single_line )
+{
+    prepare_value_();
+    buffer_ += ( is_object ? '{' : '[' );
+
+    // Containers within a single line container have to stay on that line.
+    single_line |= ( ! stack_.empty() && stack_.back().single_line );
+    stack_.push_back({ is_object, single_line, 0 });
+    complete_ = false;
+}
+
+void JsonStreamWriter::end_container_( bool is_object )
+{
+    if( stack_.empty() || stack_.back().is_object != is_object || after_key_ ) {
+        throw std::logic_error(
+            std::string( "Invalid end of Json " ) + ( is_object ? "object." : "array." )
+        );
+    }
+
+    auto const frame = stack_.back();
+    stack_.pop_back();
+    if( frame.count > 0 && indent_ > 0 ) {
+        if( frame.single_line ) {
+            buffer_ += ' ';
+        } else {
+            write_newline_( stack_.size() );
+        }
+    }
+    buffer_ += ( is_object ? '}' : ']' );
+
+    complete_ = stack_.empty();
+    flush_if_full_();
+}
+
+void JsonStreamWriter::prepare_value_()
+{
+    if( stack_.empty() ) {
+        if( complete_ ) {
+            throw std::logic_error( "Json document can only have one root value." );
+        }
+        complete_ = true;
+        return;
+    }
+
+    auto& frame = stack_.back();
+    if( frame.is_object ) {
+        if( ! after_key_ ) {
+            throw std::logic_error( "Json object member written without a key." );
+        }
+        after_key_ = false;
+    } else {
+        write_separator_( frame );
+    }
+}
+
+void JsonStreamWriter::write_separator_( Frame& frame )
+{
+    if( frame.count > 0 ) {
+        buffer_ += ',';
+    }
+    ++frame.count;
+    if( indent_ > 0 ) {
+        if( frame.single_line ) {
+            buffer_ += ' ';
+        } else {
+            write_newline_( stack_.size() );
+        }
+    }
+}
+
+void JsonStreamWriter::write_newline_( size_t level )
+{
+    buffer_ += '\n';
+    buffer_.append( level * indent_, ' ' );
+}
+
+void JsonStreamWriter::write_string_( char const* text, size_t size )
+{
+    static const char hex[] = "0123456789abcdef";
+
+    buffer_ += '"';
+
+    // Copy runs of chars that do not need escaping in one go.
+    size_t run = 0;
+    for( size_t i = 0; i < size; ++i ) {
+        auto const c = static_cast< unsigned char >( text[i] );
+        if( c >= 0x20 && c != '"' && c != '\\' ) {
+            continue;
+        }
+        buffer_.append( text + run, i - run );
+        run = i + 1;
+
+        switch( c ) {
+            case '"':  buffer_ += "\\\""; break;
+            case '\\': buffer_ += "\\\\"; break;
+            case '\b': buffer_ += "\\b";  break;
+            case '\f': buffer_ += "\\f";  break;
+            case '\n': buffer_ += "\\n";  break;
+            case '\r': buffer_ += "\\r";  break;
+            case '\t': buffer_ += "\\t";  break;
+            default: {
+                buffer_ += "\\u00";
+                buffer_ += hex[ c >> 4 ];
+                buffer_ += hex[ c & 0xF ];
+            }
+        }
+    }
+    buffer_.append( text + run, size - run );
+
+    buffer_ += '"';
+}
+
+void JsonStreamWriter::write_signed_( int64_t number )
+{
+    prepare_value_();
+    if( number < 0 ) {
+        buffer_ += '-';
+
+        // Negate in unsigned arithmetic, so that the smallest value does not overflow.
+        write_unsigned_digits_( 0 - static_cast< uint64_t >( number ));
+    } else {
+        write_unsigned_digits_( static_cast< uint64_t >( number ));
+    }
+}
+
+void JsonStreamWriter::write_unsigned_( uint64_t number )
+{
+    prepare_value_();
+    write_unsigned_digits_( number );
+}
+
+void JsonStreamWriter::write_unsigned_digits_( uint64_t number )
+{
+    char text[ 20 ];
+    size_t pos = sizeof( text );
+    do {
+        text[ --pos ] = static_cast< char >( '0' + number % 10 );
+        number /= 10;
+    } while( number > 0 );
+    buffer_.append( text + pos, sizeof( text ) - pos );
+}
+
+} // namespace utils
+} // namespace genesis
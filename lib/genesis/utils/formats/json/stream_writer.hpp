@@ -0,0 +1,257 @@
+#ifndef GENESIS_UTILS_FORMATS_JSON_STREAM_WRITER_H_
+#define GENESIS_UTILS_FORMATS_JSON_STREAM_WRITER_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Json Stream Writer
+// =================================================================================================
+
+/**
+ * @brief Write Json data element by element, without building a JsonDocument first.
+ *
+ * This is the writing counterpart of the JsonSaxReader. The document is produced by a sequence
+ * of calls to begin_object(), key(), value(), end_object() and so on, which are directly
+ * turned into Json text. Example:
+ *
+ *     JsonStreamWriter writer( std::cout );
+ *     writer.indent( 4 );
+ *     writer.begin_object();
+ *     writer.key( "name" ).value( "genesis" );
+ *     writer.key( "values" ).begin_array( true ).value( 1 ).value( 2.5 ).end_array();
+ *     writer.end_object();
+ *     writer.finish();
+ *
+ * The text is collected in an internal buffer, which is written to the output stream in large
+ * blocks. Hence, using a utils::OutputStream as output gives fast (and optionally compressed)
+ * file output. Call finish() when done; it checks that the document is complete, and flushes the
+ * buffer. The destructor also flushes, but does not check, and ignores errors of the output stream,
+ * as it must not throw.
+ *
+ * Floating point numbers are written in their shortest representation that reads back to exactly
+ * the same value, see format_float_shortest(). Integral values of a `double` get a trailing `.0`,
+ * so that they are read as floating point numbers again. As Json has no representation for
+ * infinity and NaN, writing those throws an `std::invalid_argument`, and nothing is written.
+ * Strings and keys are escaped as needed.
+ *
+ * With an indent() of 0 (the default), the output is compact, without any white space.
+ * Otherwise, each element of an object or array is written on a line of its own. Containers that
+ * are begun with `single_line = true` are instead written on one line, which is useful for short
+ * arrays of numbers. All containers nested in such a container are also written on that line.
+ *
+ * Calls in invalid order, such as a value in an object without a preceding key, or closing a
+ * container that was not opened, throw an `std::logic_error`.
+ */
+class JsonStreamWriter
+{
+public:
+
+    // ---------------------------------------------------------------------
+    //     Constructor and Rule of Five
+    // ---------------------------------------------------------------------
+
+    explicit JsonStreamWriter( std::ostream& out );
+    ~JsonStreamWriter();
+
+    JsonStreamWriter( JsonStreamWriter const& ) = delete;
+    JsonStreamWriter( JsonStreamWriter&& )      = delete;
+
+    JsonStreamWriter& operator= ( JsonStreamWriter const& ) = delete;
+    JsonStreamWriter& operator= ( JsonStreamWriter&& )      = delete;
+
+    // ---------------------------------------------------------------------
+    //     Containers
+    // ---------------------------------------------------------------------
+
+    JsonStreamWriter& begin_object( bool single_line = false );
+    JsonStreamWriter& end_object();
+
+    JsonStreamWriter& begin_array( bool single_line = false );
+    JsonStreamWriter& end_array();
+
+    /**
+     * @brief Write the key of the next member of the current object.
+     *
+     * Has to be followed by a value, or by the begin of an object or array.
+     */
+    JsonStreamWriter& key( std::string const& name );
+    JsonStreamWriter& key( char const* name );
+
+    // ---------------------------------------------------------------------
+    //     Values
+    // ---------------------------------------------------------------------
+
+    JsonStreamWriter& value( std::string const& text );
+    JsonStreamWriter& value( char const* text );
+    JsonStreamWriter& value( bool flag );
+    JsonStreamWriter& value( std::nullptr_t );
+    JsonStreamWriter& value( double number );
+
+    /**
+     * @brief Write an integral number.
+     */
+    template<
+        typename T,
+        typename std::enable_if<
+            std::is_integral<T>::value && ! std::is_same<T, bool>::value, int
+        >::type = 0
+    >
+    JsonStreamWriter& value( T number )
+    {
+        if( std::is_signed<T>::value ) {
+            write_signed_( static_cast< int64_t >( number ));
+        } else {
+            write_unsigned_( static_cast< uint64_t >( number ));
+        }
+        return *this;
+    }
+
+    // ---------------------------------------------------------------------
+    //     Finishing
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Write the buffered text to the output stream.
+     */
+    void flush();
+
+    /**
+     * @brief Check that the document is complete, and flush the buffered text.
+     *
+     * Throws an `std::logic_error` if there are containers that have not been closed,
+     * or if nothing was written at all.
+     */
+    void finish();
+
+    /**
+     * @brief Return the number of containers that are currently open.
+     */
+    size_t depth() const
+    {
+        return stack_.size();
+    }
+
+    // ---------------------------------------------------------------------
+    //     Settings
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief Get the indent used for printing the elements of Json arrays and objects.
+     */
+    size_t indent() const
+    {
+        return indent_;
+    }
+
+    /**
+     * @brief Set the indent used for printing the elements of Json arrays and objects.
+     *
+     * An indent of 0 yields compact output without any white space.
+     * The function returns a reference to the JsonStreamWriter to allow for fluent interfaces.
+     */
+    JsonStreamWriter& indent( size_t value )
+    {
+        indent_ = value;
+        return *this;
+    }
+
+    // ---------------------------------------------------------------------
+    //     Internal Functions
+    // ---------------------------------------------------------------------
+
+private:
+
+    struct Frame
+    {
+        bool   is_object;
+        bool   single_line;
+        size_t count;
+    };
+
+    void begin_container_( bool is_object, bool single_line );
+    void end_container_( bool is_object );
+
+    /**
+     * @brief Check that a value can be written here, and write the separator before it.
+     */
+    void prepare_value_();
+
+    /**
+     * @brief Write the comma and white space between the elements of a container.
+     */
+    void write_separator_( Frame& frame );
+
+    void write_newline_( size_t level );
+    void write_string_( char const* text, size_t size );
+    void write_signed_( int64_t number );
+    void write_unsigned_( uint64_t number );
+    void write_unsigned_digits_( uint64_t number );
+
+    void flush_if_full_()
+    {
+        if( buffer_.size() >= flush_size_ ) {
+            flush();
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    //     Data Members
+    // ---------------------------------------------------------------------
+
+private:
+
+    static const size_t flush_size_ = 1 << 16;
+
+    std::ostream* out_;
+    std::string   buffer_;
+
+    std::vector< Frame > stack_;
+    bool after_key_ = false;
+    bool complete_  = false;
+
+    size_t indent_ = 0;
+
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
@@ -39,6 +39,7 @@
 #include "genesis/utils/formats/json/document.hpp"
 #include "genesis/utils/formats/json/iterator.hpp"
 #include "genesis/utils/text/string.hpp"
+#include "genesis/utils/io/compressed_output_target.hpp"
 #include "genesis/utils/io/output_stream.hpp"
 
 namespace genesis {
@@ -53,11 +54,12 @@ void JsonWriter::to_stream( JsonDocument const& document, std::ostream& out ) co
     print_value( document, out );
 }
 
-void JsonWriter::to_file( JsonDocument const& document, std::string const& filename ) const
-{
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    print_value( document, ofs );
+void JsonWriter::to_file(
+    JsonDocument const& document, std::string const& filename, CompressionFormat compression
+) const {
+    utils::OutputStream os( utils::to_file( filename, compression ));
+    print_value( document, os );
+    os.close();
 }
 
 void JsonWriter::to_string( JsonDocument const& document, std::string& output ) const
@@ -31,6 +31,8 @@
  * @ingroup utils
  */
 
+#include "genesis/utils/io/compressed_input_source.hpp"
+
 #include <iosfwd>
 #include <string>
 
@@ -85,8 +87,14 @@ public:
      * file already exists, an exception is thrown.
      * See @link Options::allow_file_overwriting( bool ) Options::allow_file_overwriting()@endlink
      * to change this behaviour.
+     *
+     * The file is written uncompressed, unless a `compression` format is given. The format is
+     * not inferred from the file name.
      */
-    void        to_file   ( JsonDocument const& document, std::string const& filename) const;
+    void        to_file   (
+        JsonDocument const& document, std::string const& filename,
+        CompressionFormat compression = CompressionFormat::kNone
+    ) const;
 
     /**
      * @brief Give the Json string representation of a JsonDocument.
@@ -32,6 +32,7 @@
 
 #include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/formats/nexus/document.hpp"
+#include "genesis/utils/io/compressed_output_target.hpp"
 #include "genesis/utils/io/output_stream.hpp"
 
 #include <stdexcept>
@@ -57,11 +58,12 @@ void NexusWriter::to_stream( NexusDocument const& doc, std::ostream& out ) const
     }
 }
 
-void NexusWriter::to_file( NexusDocument const& doc, std::string const& filename) const
-{
-    std::ofstream ofs;
-    utils::file_output_stream( filename, ofs );
-    to_stream( doc, ofs );
+void NexusWriter::to_file(
+    NexusDocument const& doc, std::string const& filename, CompressionFormat compression
+) const {
+    utils::OutputStream os( utils::to_file( filename, compression ));
+    to_stream( doc, os );
+    os.close();
 }
 
 void NexusWriter::to_string( NexusDocument const& doc, std::string& output) const
@@ -31,6 +31,8 @@
  * @ingroup utils
  */
 
+#include "genesis/utils/io/compressed_input_source.hpp"
+
 #include <iosfwd>
 #include <string>
 
@@ -72,7 +74,10 @@ public:
     // ---------------------------------------------------------------------
 
     void        to_stream   ( NexusDocument const& doc, std::ostream& out ) const;
-    void        to_file     ( NexusDocument const& doc, std::string const& filename) const;
+    void        to_file     (
+        NexusDocument const& doc, std::string const& filename,
+        CompressionFormat compression = CompressionFormat::kNone
+    ) const;
     void        to_string   ( NexusDocument const& doc, std::string& output) const;
     std::string to_string   ( NexusDocument const& doc) const;
 };
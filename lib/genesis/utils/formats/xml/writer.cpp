@@ -34,6 +34,7 @@
 #include "genesis/utils/core/logging.hpp"
 #include "genesis/utils/formats/xml/document.hpp"
 #include "genesis/utils/formats/xml/helper.hpp"
+#include "genesis/utils/io/compressed_output_target.hpp"
 #include "genesis/utils/io/output_stream.hpp"
 #include "genesis/utils/text/string.hpp"
 
@@ -54,12 +55,18 @@ namespace utils {
  * already exists, an exception is thrown.
  * See @link Options::allow_file_overwriting( bool ) Options::allow_file_overwriting()@endlink to
  * change this behaviour.
+ *
+ * The file is written uncompressed, unless a `compression` format is given. The format is
+ * not inferred from the file name.
  */
-void XmlWriter::to_file( const XmlDocument& document, const std::string& filename )
-{
+void XmlWriter::to_file(
+    const XmlDocument& document, const std::string& filename, CompressionFormat compression
+) {
     std::string xml;
     to_string( document, xml );
-    utils::file_write(xml, filename);
+    utils::OutputStream os( utils::to_file( filename, compression ));
+    os << xml;
+    os.close();
 }
 
 /**
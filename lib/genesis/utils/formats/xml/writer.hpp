@@ -31,6 +31,8 @@
  * @ingroup utils
  */
 
+#include "genesis/utils/io/compressed_input_source.hpp"
+
 #include <string>
 #include <unordered_map>
 
@@ -62,7 +64,10 @@ class XmlWriter
     // ---------------------------------------------------------------------
 
 public:
-    void        to_file   ( const XmlDocument& document, const std::string& filename);
+    void        to_file   (
+        const XmlDocument& document, const std::string& filename,
+        CompressionFormat compression = CompressionFormat::kNone
+    );
     void        to_string ( const XmlDocument& document,       std::string& output);
     std::string to_string ( const XmlDocument& document);
 
@@ -0,0 +1,201 @@
+#ifndef GENESIS_UTILS_IO_CHAR_SEARCH_H_
+#define GENESIS_UTILS_IO_CHAR_SEARCH_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include <cstddef>
+
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+#    include <immintrin.h>
+#endif
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Char Search
+// =================================================================================================
+
+/*
+ * The functions in this file search blocks of chars, and are used by InputStream for its bulk
+ * scanning. If the compiler targets SSE2 (which is always the case on x86-64) or AVX2 (e.g., with
+ * `-mavx2` or `-march=native`), they process 16 or 32 chars at a time, respectively. Otherwise,
+ * and for the remaining tail of a block, they fall back to a simple loop.
+ */
+
+/**
+ * @brief Return a pointer to the first char in `[begin, end)` that equals one of `c1`, `c2` or
+ * `c3`, or `end` if there is no such char.
+ */
+inline char const* find_first_of( char const* begin, char const* end, char c1, char c2, char c3 )
+{
+    #ifdef __AVX2__
+        auto const v1_32 = _mm256_set1_epi8( c1 );
+        auto const v2_32 = _mm256_set1_epi8( c2 );
+        auto const v3_32 = _mm256_set1_epi8( c3 );
+        while( end - begin >= 32 ) {
+            auto const data = _mm256_loadu_si256( reinterpret_cast< __m256i const* >( begin ));
+            auto const eq = _mm256_or_si256(
+                _mm256_or_si256(
+                    _mm256_cmpeq_epi8( data, v1_32 ), _mm256_cmpeq_epi8( data, v2_32 )
+                ),
+                _mm256_cmpeq_epi8( data, v3_32 )
+            );
+            auto const mask = static_cast< unsigned int >( _mm256_movemask_epi8( eq ));
+            if( mask != 0 ) {
+                return begin + __builtin_ctz( mask );
+            }
+            begin += 32;
+        }
+    #endif
+
+    #ifdef __SSE2__
+        auto const v1_16 = _mm_set1_epi8( c1 );
+        auto const v2_16 = _mm_set1_epi8( c2 );
+        auto const v3_16 = _mm_set1_epi8( c3 );
+        while( end - begin >= 16 ) {
+            auto const data = _mm_loadu_si128( reinterpret_cast< __m128i const* >( begin ));
+            auto const eq = _mm_or_si128(
+                _mm_or_si128( _mm_cmpeq_epi8( data, v1_16 ), _mm_cmpeq_epi8( data, v2_16 )),
+                _mm_cmpeq_epi8( data, v3_16 )
+            );
+            auto const mask = static_cast< unsigned int >( _mm_movemask_epi8( eq ));
+            if( mask != 0 ) {
+                return begin + __builtin_ctz( mask );
+            }
+            begin += 16;
+        }
+    #endif
+
+    while( begin != end && *begin != c1 && *begin != c2 && *begin != c3 ) {
+        ++begin;
+    }
+    return begin;
+}
+
+/**
+ * @brief Return a pointer to the first char in `[begin, end)` that equals one of `c1` or `c2`,
+ * or `end` if there is no such char.
+ */
+inline char const* find_first_of( char const* begin, char const* end, char c1, char c2 )
+{
+    return find_first_of( begin, end, c1, c2, c2 );
+}
+
+/**
+ * @brief Return a pointer to the first char in `[begin, end)` that equals `c`,
+ * or `end` if there is no such char.
+ */
+inline char const* find_first_of( char const* begin, char const* end, char c )
+{
+    return find_first_of( begin, end, c, c, c );
+}
+
+/**
+ * @brief Return a pointer to the first char in `[begin, end)` that is not equal to `c`,
+ * or `end` if there is no such char.
+ */
+inline char const* find_first_not_of( char const* begin, char const* end, char c )
+{
+    #ifdef __AVX2__
+        auto const v32 = _mm256_set1_epi8( c );
+        while( end - begin >= 32 ) {
+            auto const data = _mm256_loadu_si256( reinterpret_cast< __m256i const* >( begin ));
+            auto const mask = ~static_cast< unsigned int >(
+                _mm256_movemask_epi8( _mm256_cmpeq_epi8( data, v32 ))
+            );
+            if( mask != 0 ) {
+                return begin + __builtin_ctz( mask );
+            }
+            begin += 32;
+        }
+    #endif
+
+    #ifdef __SSE2__
+        auto const v16 = _mm_set1_epi8( c );
+        while( end - begin >= 16 ) {
+            auto const data = _mm_loadu_si128( reinterpret_cast< __m128i const* >( begin ));
+            auto const mask = ~static_cast< unsigned int >(
+                _mm_movemask_epi8( _mm_cmpeq_epi8( data, v16 ))
+            ) & 0xFFFFu;
+            if( mask != 0 ) {
+                return begin + __builtin_ctz( mask );
+            }
+            begin += 16;
+        }
+    #endif
+
+    while( begin != end && *begin == c ) {
+        ++begin;
+    }
+    return begin;
+}
+
+/**
+ * @brief Return how often the char `c` occurs in `[begin, end)`.
+ */
+inline size_t count_chars( char const* begin, char const* end, char c )
+{
+    size_t result = 0;
+
+    #ifdef __AVX2__
+        auto const v32 = _mm256_set1_epi8( c );
+        while( end - begin >= 32 ) {
+            auto const data = _mm256_loadu_si256( reinterpret_cast< __m256i const* >( begin ));
+            result += __builtin_popcount(
+                static_cast< unsigned int >( _mm256_movemask_epi8( _mm256_cmpeq_epi8( data, v32 )))
+            );
+            begin += 32;
+        }
+    #endif
+
+    #ifdef __SSE2__
+        auto const v16 = _mm_set1_epi8( c );
+        while( end - begin >= 16 ) {
+            auto const data = _mm_loadu_si128( reinterpret_cast< __m128i const* >( begin ));
+            result += __builtin_popcount(
+                static_cast< unsigned int >( _mm_movemask_epi8( _mm_cmpeq_epi8( data, v16 )))
+            );
+            begin += 16;
+        }
+    #endif
+
+    while( begin != end ) {
+        result += ( *begin == c );
+        ++begin;
+    }
+    return result;
+}
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
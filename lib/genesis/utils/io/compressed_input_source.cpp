@@ -0,0 +1,379 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/io/compressed_input_source.hpp"
+
+#include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/core/std.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+#ifdef GENESIS_ZLIB
+#   include <zlib.h>
+#endif
+
+#ifdef GENESIS_ZSTD
+#   include <zstd.h>
+#endif
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Compression Detection
+// =================================================================================================
+
+CompressionFormat compression_format( char const* data, size_t size )
+{
+    auto const bytes = reinterpret_cast< unsigned char const* >( data );
+
+    if( size >= 2 && bytes[0] == 0x1F && bytes[1] == 0x8B ) {
+        return CompressionFormat::kGzip;
+    }
+    if(
+        size >= 4 &&
+        bytes[0] == 0x28 && bytes[1] == 0xB5 && bytes[2] == 0x2F && bytes[3] == 0xFD
+    ) {
+        return CompressionFormat::kZstd;
+    }
+    return CompressionFormat::kNone;
+}
+
+CompressionFormat compression_format( std::string const& file_name )
+{
+    if( ! file_exists( file_name ) ) {
+        throw std::runtime_error( "File does not exists: " + file_name );
+    }
+
+    std::ifstream in( file_name, std::ios::binary );
+    if( ! in ) {
+        throw std::runtime_error( "Cannot open file: " + file_name );
+    }
+
+    char magic[4];
+    in.read( magic, 4 );
+    return compression_format( magic, static_cast< size_t >( in.gcount() ));
+}
+
+bool compression_format_available( CompressionFormat format )
+{
+    switch( format ) {
+        case CompressionFormat::kNone:
+            return true;
+
+        case CompressionFormat::kGzip:
+            #ifdef GENESIS_ZLIB
+                return true;
+            #else
+                return false;
+            #endif
+
+        case CompressionFormat::kZstd:
+            #ifdef GENESIS_ZSTD
+                return true;
+            #else
+                return false;
+            #endif
+    }
+    return false;
+}
+
+// =================================================================================================
+//     Gzip Input Source
+// =================================================================================================
+
+/**
+ * @brief Size of the buffer for the compressed input data.
+ */
+static const size_t compressed_chunk_size_ = 1 << 20;
+
+#ifdef GENESIS_ZLIB
+
+struct GzipInputSource::ZlibState
+{
+    z_stream                     stream;
+    std::vector< unsigned char > in_buffer;
+    bool                         input_done = false;
+    bool                         stream_end = false;
+};
+
+GzipInputSource::GzipInputSource( std::unique_ptr< BaseInputSource > input_source )
+    : input_source_( std::move( input_source ))
+    , state_( utils::make_unique< ZlibState >() )
+{
+    state_->in_buffer.resize( compressed_chunk_size_ );
+
+    auto& zs = state_->stream;
+    zs.zalloc   = Z_NULL;
+    zs.zfree    = Z_NULL;
+    zs.opaque   = Z_NULL;
+    zs.next_in  = Z_NULL;
+    zs.avail_in = 0;
+
+    // Window bits 15 plus 32 enables automatic detection of gzip and zlib headers.
+    if( inflateInit2( &zs, 15 + 32 ) != Z_OK ) {
+        throw std::runtime_error(
+            "Cannot initialize gzip decompression for " + input_source_->source_name()
+        );
+    }
+}
+
+GzipInputSource::~GzipInputSource()
+{
+    inflateEnd( &state_->stream );
+}
+
+size_t GzipInputSource::read_( char* buffer, size_t size )
+{
+    auto& zs = state_->stream;
+    zs.next_out  = reinterpret_cast< Bytef* >( buffer );
+    zs.avail_out = static_cast< uInt >( size );
+
+    while( zs.avail_out > 0 ) {
+
+        // Get more compressed data if needed.
+        if( zs.avail_in == 0 && ! state_->input_done ) {
+            auto const got = input_source_->read(
+                reinterpret_cast< char* >( state_->in_buffer.data() ), state_->in_buffer.size()
+            );
+            zs.next_in  = state_->in_buffer.data();
+            zs.avail_in = static_cast< uInt >( got );
+            state_->input_done = ( got == 0 );
+        }
+
+        // At the end of a gzip member, either we are done, or the next member follows.
+        // As the gzip tool does, we ignore trailing data that does not start with the first
+        // magic byte of another member, such as zero padding.
+        if( state_->stream_end ) {
+            if( zs.avail_in > 0 && *zs.next_in != 0x1F ) {
+                zs.avail_in = 0;
+                state_->input_done = true;
+            }
+            if( zs.avail_in == 0 ) {
+                break;
+            }
+            inflateReset( &zs );
+            state_->stream_end = false;
+        }
+
+        // Decompress as much as fits.
+        auto const avail_before = zs.avail_out;
+        auto const ret = inflate( &zs, Z_NO_FLUSH );
+        if( ret == Z_STREAM_END ) {
+            state_->stream_end = true;
+            continue;
+        }
+        if( ret != Z_OK && ret != Z_BUF_ERROR ) {
+            throw std::runtime_error(
+                "Invalid gzip compressed data in " + input_source_->source_name() +
+                ( zs.msg ? ": " + std::string( zs.msg ) : std::string() )
+            );
+        }
+
+        // If there is no input left, and still no progress, the data is truncated.
+        if( zs.avail_in == 0 && state_->input_done && zs.avail_out == avail_before ) {
+            throw std::runtime_error(
+                "Unexpected end of gzip compressed data in " + input_source_->source_name()
+            );
+        }
+    }
+
+    return size - zs.avail_out;
+}
+
+#else // GENESIS_ZLIB
+
+struct GzipInputSource::ZlibState
+{};
+
+GzipInputSource::GzipInputSource( std::unique_ptr< BaseInputSource > input_source )
+    : input_source_( std::move( input_source ))
+{
+    throw std::runtime_error(
+        "Cannot read gzip compressed " + input_source_->source_name() +
+        ", as Genesis was compiled without zlib support."
+    );
+}
+
+GzipInputSource::~GzipInputSource()
+{}
+
+size_t GzipInputSource::read_( char*, size_t )
+{
+    return 0;
+}
+
+#endif // GENESIS_ZLIB
+
+GzipInputSource::GzipInputSource( std::string const& file_name )
+    : GzipInputSource( utils::make_unique< FileInputSource >( file_name ))
+{}
+
+std::string GzipInputSource::source_name_() const
+{
+    return input_source_->source_name() + " (gzip compressed)";
+}
+
+// =================================================================================================
+//     Zstd Input Source
+// =================================================================================================
+
+#ifdef GENESIS_ZSTD
+
+struct ZstdInputSource::ZstdState
+{
+    ZSTD_DStream*       stream = nullptr;
+    std::vector< char > in_buffer;
+    ZSTD_inBuffer       input  = { nullptr, 0, 0 };
+    bool                input_done = false;
+    size_t              last_ret   = 0;
+};
+
+ZstdInputSource::ZstdInputSource( std::unique_ptr< BaseInputSource > input_source )
+    : input_source_( std::move( input_source ))
+    , state_( utils::make_unique< ZstdState >() )
+{
+    state_->in_buffer.resize( compressed_chunk_size_ );
+    state_->input = { state_->in_buffer.data(), 0, 0 };
+
+    state_->stream = ZSTD_createDStream();
+    if( state_->stream == nullptr || ZSTD_isError( ZSTD_initDStream( state_->stream ))) {
+        ZSTD_freeDStream( state_->stream );
+        throw std::runtime_error(
+            "Cannot initialize zstd decompression for " + input_source_->source_name()
+        );
+    }
+}
+
+ZstdInputSource::~ZstdInputSource()
+{
+    ZSTD_freeDStream( state_->stream );
+}
+
+size_t ZstdInputSource::read_( char* buffer, size_t size )
+{
+    auto& in = state_->input;
+    ZSTD_outBuffer out = { buffer, size, 0 };
+
+    while( out.pos < out.size ) {
+
+        // Get more compressed data if needed.
+        if( in.pos == in.size && ! state_->input_done ) {
+            auto const got = input_source_->read(
+                state_->in_buffer.data(), state_->in_buffer.size()
+            );
+            in = { state_->in_buffer.data(), got, 0 };
+            state_->input_done = ( got == 0 );
+        }
+
+        // Decompress as much as fits. This also flushes data that zstd still holds internally.
+        auto const pos_before = out.pos;
+        state_->last_ret = ZSTD_decompressStream( state_->stream, &out, &in );
+        if( ZSTD_isError( state_->last_ret )) {
+            throw std::runtime_error(
+                "Invalid zstd compressed data in " + input_source_->source_name() + ": " +
+                ZSTD_getErrorName( state_->last_ret )
+            );
+        }
+
+        // If there is no input left and no progress, we are done. A non-zero return value
+        // then means that the last frame is incomplete.
+        if( in.pos == in.size && state_->input_done && out.pos == pos_before ) {
+            if( state_->last_ret != 0 ) {
+                throw std::runtime_error(
+                    "Unexpected end of zstd compressed data in " + input_source_->source_name()
+                );
+            }
+            break;
+        }
+    }
+
+    return out.pos;
+}
+
+#else // GENESIS_ZSTD
+
+struct ZstdInputSource::ZstdState
+{};
+
+ZstdInputSource::ZstdInputSource( std::unique_ptr< BaseInputSource > input_source )
+    : input_source_( std::move( input_source ))
+{
+    throw std::runtime_error(
+        "Cannot read zstd compressed " + input_source_->source_name() +
+        ", as Genesis was compiled without zstd support."
+    );
+}
+
+ZstdInputSource::~ZstdInputSource()
+{}
+
+size_t ZstdInputSource::read_( char*, size_t )
+{
+    return 0;
+}
+
+#endif // GENESIS_ZSTD
+
+ZstdInputSource::ZstdInputSource( std::string const& file_name )
+    : ZstdInputSource( utils::make_unique< FileInputSource >( file_name ))
+{}
+
+std::string ZstdInputSource::source_name_() const
+{
+    return input_source_->source_name() + " (zstd compressed)";
+}
+
+// =================================================================================================
+//     Input Source Factory
+// =================================================================================================
+
+std::unique_ptr< BaseInputSource > from_file(
+    std::string const& file_name,
+    bool detect_compression
+) {
+    if( detect_compression ) {
+        switch( compression_format( file_name )) {
+            case CompressionFormat::kGzip:
+                return utils::make_unique< GzipInputSource >( file_name );
+
+            case CompressionFormat::kZstd:
+                return utils::make_unique< ZstdInputSource >( file_name );
+
+            case CompressionFormat::kNone:
+                break;
+        }
+    }
+    return utils::make_unique< FileInputSource >( file_name );
+}
+
+} // namespace utils
+} // namespace genesis
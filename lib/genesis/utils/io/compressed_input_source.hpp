@@ -0,0 +1,228 @@
+#ifndef GENESIS_UTILS_IO_COMPRESSED_INPUT_SOURCE_H_
+#define GENESIS_UTILS_IO_COMPRESSED_INPUT_SOURCE_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/io/input_source.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Compression Detection
+// =================================================================================================
+
+/**
+ * @brief List of compression formats that can be detected and read by Genesis.
+ */
+enum class CompressionFormat
+{
+    kNone,
+    kGzip,
+    kZstd
+};
+
+/**
+ * @brief Detect the compression format of a file by looking at its magic bytes.
+ *
+ * Gzip files start with the bytes `1F 8B`, zstd files with `28 B5 2F FD`. Everything else is
+ * reported as CompressionFormat::kNone. The detection does not depend on whether Genesis was
+ * compiled with support for the respective compression library.
+ */
+CompressionFormat compression_format( std::string const& file_name );
+
+/**
+ * @brief Detect the compression format of a chunk of data by looking at its magic bytes.
+ *
+ * @copydetails compression_format( std::string const& )
+ */
+CompressionFormat compression_format( char const* data, size_t size );
+
+/**
+ * @brief Return whether Genesis was compiled with support for reading the given compression
+ * format, that is, whether the respective library (zlib or zstd) was found during the build.
+ */
+bool compression_format_available( CompressionFormat format );
+
+// =================================================================================================
+//     Gzip Input Source
+// =================================================================================================
+
+/**
+ * @brief Input source for reading byte data from a gzip (or zlib) compressed input.
+ *
+ * The source wraps around another @link BaseInputSource InputSource@endlink that delivers the
+ * compressed data, and decompresses it on the fly. As the decompression happens within read(),
+ * it runs on the worker thread of the AsynchronousReader when used by InputStream or InputBuffer,
+ * so that inflating the data overlaps with parsing it. Multiple concatenated gzip members (as
+ * produced for example by `cat a.gz b.gz` or `bgzip`) are read as one continuous input.
+ * Data after the last member that does not start like another member, for example zero padding,
+ * is ignored, as it is by the `gzip` tool.
+ *
+ * This class needs zlib. If Genesis was compiled without it, the constructor throws.
+ * See from_file() for a convenient way to open files with automatic detection of the compression.
+ */
+class GzipInputSource : public BaseInputSource
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct the input source from another source that delivers compressed data.
+     */
+    explicit GzipInputSource( std::unique_ptr< BaseInputSource > input_source );
+
+    /**
+     * @brief Construct the input source from a file with the given file name.
+     */
+    explicit GzipInputSource( std::string const& file_name );
+
+    GzipInputSource( GzipInputSource const& ) = delete;
+    GzipInputSource( GzipInputSource&& )      = delete;
+
+    GzipInputSource& operator= ( GzipInputSource const& ) = delete;
+    GzipInputSource& operator= ( GzipInputSource&& )      = delete;
+
+    ~GzipInputSource();
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    size_t read_( char* buffer, size_t size ) override;
+
+    std::string source_name_() const override;
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    // The zlib state is hidden, so that zlib headers are not needed in here.
+    struct ZlibState;
+
+    std::unique_ptr< BaseInputSource > input_source_;
+    std::unique_ptr< ZlibState >       state_;
+};
+
+// =================================================================================================
+//     Zstd Input Source
+// =================================================================================================
+
+/**
+ * @brief Input source for reading byte data from a zstd compressed input.
+ *
+ * The source wraps around another @link BaseInputSource InputSource@endlink that delivers the
+ * compressed data, and decompresses it on the fly. As with the GzipInputSource, the decompression
+ * runs on the worker thread of the AsynchronousReader when used by InputStream or InputBuffer.
+ * Multiple concatenated zstd frames are read as one continuous input.
+ *
+ * This class needs the zstd library. If Genesis was compiled without it, the constructor throws.
+ * See from_file() for a convenient way to open files with automatic detection of the compression.
+ */
+class ZstdInputSource : public BaseInputSource
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct the input source from another source that delivers compressed data.
+     */
+    explicit ZstdInputSource( std::unique_ptr< BaseInputSource > input_source );
+
+    /**
+     * @brief Construct the input source from a file with the given file name.
+     */
+    explicit ZstdInputSource( std::string const& file_name );
+
+    ZstdInputSource( ZstdInputSource const& ) = delete;
+    ZstdInputSource( ZstdInputSource&& )      = delete;
+
+    ZstdInputSource& operator= ( ZstdInputSource const& ) = delete;
+    ZstdInputSource& operator= ( ZstdInputSource&& )      = delete;
+
+    ~ZstdInputSource();
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    size_t read_( char* buffer, size_t size ) override;
+
+    std::string source_name_() const override;
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    // The zstd state is hidden, so that zstd headers are not needed in here.
+    struct ZstdState;
+
+    std::unique_ptr< BaseInputSource > input_source_;
+    std::unique_ptr< ZstdState >       state_;
+};
+
+// =================================================================================================
+//     Input Source Factory
+// =================================================================================================
+
+/**
+ * @brief Create an input source for reading from a file, with automatic decompression.
+ *
+ * If `detect_compression` is set (default), the magic bytes of the file are inspected, and
+ * gzip or zstd compressed files are transparently decompressed via a GzipInputSource or
+ * ZstdInputSource, respectively. Otherwise, and for uncompressed files, a FileInputSource is used.
+ *
+ * This is the function that the `from_file()` functions of the readers (e.g., JplaceReader,
+ * NewickReader, FastaReader) use to open their input.
+ */
+std::unique_ptr< BaseInputSource > from_file(
+    std::string const& file_name,
+    bool detect_compression = true
+);
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
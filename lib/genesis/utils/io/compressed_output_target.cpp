@@ -0,0 +1,366 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/io/compressed_output_target.hpp"
+
+#include "genesis/utils/core/std.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#ifdef GENESIS_ZLIB
+#   include <zlib.h>
+#endif
+
+#ifdef GENESIS_ZSTD
+#   include <zstd.h>
+#endif
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Gzip Output Target
+// =================================================================================================
+
+/**
+ * @brief Size of the buffer for the compressed output data.
+ */
+static const size_t compressed_output_chunk_size_ = 1 << 20;
+
+#ifdef GENESIS_ZLIB
+
+struct GzipOutputTarget::ZlibState
+{
+    z_stream                     stream;
+    std::vector< unsigned char > out_buffer;
+    bool                         finished = false;
+};
+
+GzipOutputTarget::GzipOutputTarget( std::unique_ptr< BaseOutputTarget > output_target, int level )
+    : output_target_( std::move( output_target ))
+    , state_( utils::make_unique< ZlibState >() )
+{
+    if( level < -1 || level > 9 ) {
+        throw std::invalid_argument( "Invalid gzip compression level " + std::to_string( level ));
+    }
+    state_->out_buffer.resize( compressed_output_chunk_size_ );
+
+    auto& zs = state_->stream;
+    zs.zalloc = Z_NULL;
+    zs.zfree  = Z_NULL;
+    zs.opaque = Z_NULL;
+
+    // Window bits 15 plus 16 makes zlib write a gzip header and footer.
+    if( deflateInit2( &zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK ) {
+        throw std::runtime_error(
+            "Cannot initialize gzip compression for " + output_target_->target_name()
+        );
+    }
+}
+
+GzipOutputTarget::~GzipOutputTarget()
+{
+    // Write the footer if not yet done. We cannot report errors from here.
+    try {
+        finish_();
+    } catch( ... ) {}
+    deflateEnd( &state_->stream );
+}
+
+/**
+ * @brief Local helper that runs deflate with the given flush mode until all input is consumed,
+ * and, for flushing modes, until all pending output is written.
+ */
+static void gzip_deflate_(
+    z_stream& zs, std::vector< unsigned char >& out_buffer, BaseOutputTarget& target, int flush
+) {
+    while( true ) {
+        zs.next_out  = out_buffer.data();
+        zs.avail_out = static_cast< uInt >( out_buffer.size() );
+
+        auto const ret = deflate( &zs, flush );
+        if( ret == Z_STREAM_ERROR ) {
+            throw std::runtime_error( "Cannot gzip compress data for " + target.target_name() );
+        }
+
+        auto const have = out_buffer.size() - zs.avail_out;
+        if( have > 0 ) {
+            target.write( reinterpret_cast< char const* >( out_buffer.data() ), have );
+        }
+
+        // Deflate is done once it did not fill the whole output buffer, or the stream ended.
+        if( ret == Z_STREAM_END || ( zs.avail_in == 0 && zs.avail_out > 0 )) {
+            break;
+        }
+    }
+}
+
+void GzipOutputTarget::write_( char const* buffer, size_t size )
+{
+    if( state_->finished ) {
+        throw std::runtime_error( "Cannot write to finished " + target_name_() );
+    }
+
+    // zlib uses 32 bit sizes, so we might need several rounds for very large buffers.
+    auto& zs = state_->stream;
+    while( size > 0 ) {
+        auto const chunk = std::min< size_t >( size, 1u << 30 );
+        zs.next_in  = reinterpret_cast< Bytef* >( const_cast< char* >( buffer ));
+        zs.avail_in = static_cast< uInt >( chunk );
+        gzip_deflate_( zs, state_->out_buffer, *output_target_, Z_NO_FLUSH );
+        buffer += chunk;
+        size   -= chunk;
+    }
+}
+
+void GzipOutputTarget::flush_()
+{
+    if( state_->finished ) {
+        return;
+    }
+
+    // Sync flush, so that everything written so far can be decompressed.
+    gzip_deflate_( state_->stream, state_->out_buffer, *output_target_, Z_SYNC_FLUSH );
+    output_target_->flush();
+}
+
+void GzipOutputTarget::finish_()
+{
+    if( state_->finished ) {
+        return;
+    }
+    state_->finished = true;
+
+    state_->stream.avail_in = 0;
+    gzip_deflate_( state_->stream, state_->out_buffer, *output_target_, Z_FINISH );
+    output_target_->finish();
+}
+
+#else // GENESIS_ZLIB
+
+struct GzipOutputTarget::ZlibState
+{};
+
+GzipOutputTarget::GzipOutputTarget( std::unique_ptr< BaseOutputTarget > output_target, int )
+    : output_target_( std::move( output_target ))
+{
+    throw std::runtime_error(
+        "Cannot write gzip compressed " + output_target_->target_name() +
+        ", as Genesis was compiled without zlib support."
+    );
+}
+
+GzipOutputTarget::~GzipOutputTarget()
+{}
+
+void GzipOutputTarget::write_( char const*, size_t )
+{}
+
+void GzipOutputTarget::flush_()
+{}
+
+void GzipOutputTarget::finish_()
+{}
+
+#endif // GENESIS_ZLIB
+
+GzipOutputTarget::GzipOutputTarget( std::string const& file_name, int level )
+    : GzipOutputTarget( utils::make_unique< FileOutputTarget >( file_name ), level )
+{}
+
+std::string GzipOutputTarget::target_name_() const
+{
+    return output_target_->target_name() + " (gzip compressed)";
+}
+
+// =================================================================================================
+//     Zstd Output Target
+// =================================================================================================
+
+#ifdef GENESIS_ZSTD
+
+struct ZstdOutputTarget::ZstdState
+{
+    ZSTD_CStream*       stream = nullptr;
+    std::vector< char > out_buffer;
+    bool                finished = false;
+};
+
+ZstdOutputTarget::ZstdOutputTarget( std::unique_ptr< BaseOutputTarget > output_target, int level )
+    : output_target_( std::move( output_target ))
+    , state_( utils::make_unique< ZstdState >() )
+{
+    state_->out_buffer.resize( compressed_output_chunk_size_ );
+
+    state_->stream = ZSTD_createCStream();
+    if( state_->stream == nullptr || ZSTD_isError( ZSTD_initCStream( state_->stream, level ))) {
+        ZSTD_freeCStream( state_->stream );
+        throw std::runtime_error(
+            "Cannot initialize zstd compression for " + output_target_->target_name()
+        );
+    }
+}
+
+ZstdOutputTarget::~ZstdOutputTarget()
+{
+    // End the frame if not yet done. We cannot report errors from here.
+    try {
+        finish_();
+    } catch( ... ) {}
+    ZSTD_freeCStream( state_->stream );
+}
+
+void ZstdOutputTarget::write_( char const* buffer, size_t size )
+{
+    if( state_->finished ) {
+        throw std::runtime_error( "Cannot write to finished " + target_name_() );
+    }
+
+    ZSTD_inBuffer in = { buffer, size, 0 };
+    while( in.pos < in.size ) {
+        ZSTD_outBuffer out = { state_->out_buffer.data(), state_->out_buffer.size(), 0 };
+        auto const ret = ZSTD_compressStream( state_->stream, &out, &in );
+        if( ZSTD_isError( ret )) {
+            throw std::runtime_error(
+                "Cannot zstd compress data for " + output_target_->target_name() + ": " +
+                ZSTD_getErrorName( ret )
+            );
+        }
+        if( out.pos > 0 ) {
+            output_target_->write( state_->out_buffer.data(), out.pos );
+        }
+    }
+}
+
+/**
+ * @brief Local helper that calls the given zstd flushing function until all data is written.
+ */
+template< class F >
+static void zstd_flush_(
+    ZSTD_CStream* stream, std::vector< char >& out_buffer, BaseOutputTarget& target, F func
+) {
+    size_t remaining = 1;
+    while( remaining > 0 ) {
+        ZSTD_outBuffer out = { out_buffer.data(), out_buffer.size(), 0 };
+        remaining = func( stream, &out );
+        if( ZSTD_isError( remaining )) {
+            throw std::runtime_error(
+                "Cannot zstd compress data for " + target.target_name() + ": " +
+                ZSTD_getErrorName( remaining )
+            );
+        }
+        if( out.pos > 0 ) {
+            target.write( out_buffer.data(), out.pos );
+        }
+    }
+}
+
+void ZstdOutputTarget::flush_()
+{
+    if( state_->finished ) {
+        return;
+    }
+    zstd_flush_( state_->stream, state_->out_buffer, *output_target_, ZSTD_flushStream );
+    output_target_->flush();
+}
+
+void ZstdOutputTarget::finish_()
+{
+    if( state_->finished ) {
+        return;
+    }
+    state_->finished = true;
+
+    zstd_flush_( state_->stream, state_->out_buffer, *output_target_, ZSTD_endStream );
+    output_target_->finish();
+}
+
+#else // GENESIS_ZSTD
+
+struct ZstdOutputTarget::ZstdState
+{};
+
+ZstdOutputTarget::ZstdOutputTarget( std::unique_ptr< BaseOutputTarget > output_target, int )
+    : output_target_( std::move( output_target ))
+{
+    throw std::runtime_error(
+        "Cannot write zstd compressed " + output_target_->target_name() +
+        ", as Genesis was compiled without zstd support."
+    );
+}
+
+ZstdOutputTarget::~ZstdOutputTarget()
+{}
+
+void ZstdOutputTarget::write_( char const*, size_t )
+{}
+
+void ZstdOutputTarget::flush_()
+{}
+
+void ZstdOutputTarget::finish_()
+{}
+
+#endif // GENESIS_ZSTD
+
+ZstdOutputTarget::ZstdOutputTarget( std::string const& file_name, int level )
+    : ZstdOutputTarget( utils::make_unique< FileOutputTarget >( file_name ), level )
+{}
+
+std::string ZstdOutputTarget::target_name_() const
+{
+    return output_target_->target_name() + " (zstd compressed)";
+}
+
+// =================================================================================================
+//     Output Target Factory
+// =================================================================================================
+
+std::unique_ptr< BaseOutputTarget > to_file(
+    std::string const& file_name,
+    CompressionFormat format
+) {
+    switch( format ) {
+        case CompressionFormat::kGzip:
+            return utils::make_unique< GzipOutputTarget >( file_name );
+
+        case CompressionFormat::kZstd:
+            return utils::make_unique< ZstdOutputTarget >( file_name );
+
+        case CompressionFormat::kNone:
+            break;
+    }
+    return utils::make_unique< FileOutputTarget >( file_name );
+}
+
+} // namespace utils
+} // namespace genesis
@@ -0,0 +1,200 @@
+#ifndef GENESIS_UTILS_IO_COMPRESSED_OUTPUT_TARGET_H_
+#define GENESIS_UTILS_IO_COMPRESSED_OUTPUT_TARGET_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/io/compressed_input_source.hpp"
+#include "genesis/utils/io/output_target.hpp"
+
+#include <memory>
+#include <string>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Gzip Output Target
+// =================================================================================================
+
+/**
+ * @brief Output target for writing gzip compressed byte data.
+ *
+ * The target wraps around another @link BaseOutputTarget OutputTarget@endlink that receives the
+ * compressed data. As the compression happens within write(), it runs on the worker thread of the
+ * AsynchronousWriter when used by OutputStream, so that deflating the data overlaps with producing
+ * it. The gzip footer is written by finish().
+ *
+ * This class needs zlib. If Genesis was compiled without it, the constructor throws.
+ * See to_file() for a convenient way to open compressed files.
+ */
+class GzipOutputTarget : public BaseOutputTarget
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct the output target from another target that receives the compressed data.
+     *
+     * The `level` is the zlib compression level, from 1 (fastest) to 9 (best compression),
+     * or -1 for the zlib default.
+     */
+    explicit GzipOutputTarget( std::unique_ptr< BaseOutputTarget > output_target, int level = -1 );
+
+    /**
+     * @brief Construct the output target writing to a file with the given file name.
+     */
+    explicit GzipOutputTarget( std::string const& file_name, int level = -1 );
+
+    GzipOutputTarget( GzipOutputTarget const& ) = delete;
+    GzipOutputTarget( GzipOutputTarget&& )      = delete;
+
+    GzipOutputTarget& operator= ( GzipOutputTarget const& ) = delete;
+    GzipOutputTarget& operator= ( GzipOutputTarget&& )      = delete;
+
+    ~GzipOutputTarget();
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    void write_( char const* buffer, size_t size ) override;
+
+    void flush_() override;
+
+    void finish_() override;
+
+    std::string target_name_() const override;
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    // The zlib state is hidden, so that zlib headers are not needed in here.
+    struct ZlibState;
+
+    std::unique_ptr< BaseOutputTarget > output_target_;
+    std::unique_ptr< ZlibState >        state_;
+};
+
+// =================================================================================================
+//     Zstd Output Target
+// =================================================================================================
+
+/**
+ * @brief Output target for writing zstd compressed byte data.
+ *
+ * The target wraps around another @link BaseOutputTarget OutputTarget@endlink that receives the
+ * compressed data. As with the GzipOutputTarget, the compression runs on the worker thread of the
+ * AsynchronousWriter when used by OutputStream. The frame is ended by finish().
+ *
+ * This class needs the zstd library. If Genesis was compiled without it, the constructor throws.
+ * See to_file() for a convenient way to open compressed files.
+ */
+class ZstdOutputTarget : public BaseOutputTarget
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct the output target from another target that receives the compressed data.
+     *
+     * The `level` is the zstd compression level, typically from 1 (fastest) to 19 (best
+     * compression). The default of 3 is the one that zstd uses itself.
+     */
+    explicit ZstdOutputTarget( std::unique_ptr< BaseOutputTarget > output_target, int level = 3 );
+
+    /**
+     * @brief Construct the output target writing to a file with the given file name.
+     */
+    explicit ZstdOutputTarget( std::string const& file_name, int level = 3 );
+
+    ZstdOutputTarget( ZstdOutputTarget const& ) = delete;
+    ZstdOutputTarget( ZstdOutputTarget&& )      = delete;
+
+    ZstdOutputTarget& operator= ( ZstdOutputTarget const& ) = delete;
+    ZstdOutputTarget& operator= ( ZstdOutputTarget&& )      = delete;
+
+    ~ZstdOutputTarget();
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    void write_( char const* buffer, size_t size ) override;
+
+    void flush_() override;
+
+    void finish_() override;
+
+    std::string target_name_() const override;
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    // The zstd state is hidden, so that zstd headers are not needed in here.
+    struct ZstdState;
+
+    std::unique_ptr< BaseOutputTarget > output_target_;
+    std::unique_ptr< ZstdState >        state_;
+};
+
+// =================================================================================================
+//     Output Target Factory
+// =================================================================================================
+
+/**
+ * @brief Create an output target for writing to a file, compressed as given by `format`.
+ *
+ * A FileOutputTarget is created for the file, which is wrapped in a GzipOutputTarget or
+ * ZstdOutputTarget if requested. The compression is not inferred from the file name, so that a
+ * file is only ever compressed when asked for. This is the function that the `to_file()` functions
+ * of the writers (e.g., JplaceWriter, NewickWriter, FastaWriter) use to open their output.
+ */
+std::unique_ptr< BaseOutputTarget > to_file(
+    std::string const& file_name,
+    CompressionFormat format = CompressionFormat::kNone
+);
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
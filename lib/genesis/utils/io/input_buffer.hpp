@@ -33,7 +33,9 @@
 
 #include "genesis/utils/io/input_reader.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -46,6 +48,18 @@ namespace utils {
 //     Input Buffer
 // =================================================================================================
 
+/**
+ * @brief Buffered, block-wise access to the byte data of an
+ * @link BaseInputSource InputSource@endlink.
+ *
+ * The data is read in blocks (possibly asynchronously, see
+ * @link utils::InputReader InputReader@endlink). If the input source offers its data as one
+ * contiguous block of memory (see BaseInputSource::is_mapped(), e.g., for an MmapInputSource),
+ * the buffer instead works directly on that memory, and no blocks are allocated.
+ *
+ * Besides read(), which copies data into a target, get_view() offers access to the buffered data
+ * without any copying at all.
+ */
 class InputBuffer
 {
 public:
@@ -55,9 +69,10 @@ public:
     // -------------------------------------------------------------
 
     /**
-     * @brief Block length for internal buffering.
+     * @brief Default block length for internal buffering.
      *
-     * The buffer uses three blocks of this size (4MB each).
+     * The buffer uses two blocks of this size (4MB each) for the current data, plus one or more
+     * blocks for reading ahead, see the constructor.
      */
     static const size_t BlockLength = 1 << 22;
 
@@ -70,20 +85,52 @@ public:
 
     InputBuffer()
         : source_name_( "invalid source" )
+        , block_length_( BlockLength )
+        , read_ahead_(   1 )
         , buffer_(   nullptr )
+        , ahead_buffer_( nullptr )
+        , ahead_next_( 0 )
         , data_pos_( 0 )
         , data_end_( 0 )
     {}
 
-    explicit InputBuffer( std::unique_ptr<BaseInputSource> input_source )
+    /**
+     * @brief Construct the buffer from an @link BaseInputSource InputSource@endlink.
+     *
+     * The `block_length` is the size of the buffer blocks, and `read_ahead` is the number of
+     * blocks that are requested from the input reader in advance. See the constructor of
+     * InputStream for details. Both are ignored if the input source is mapped.
+     */
+    explicit InputBuffer(
+        std::unique_ptr<BaseInputSource> input_source,
+        size_t block_length = BlockLength,
+        size_t read_ahead   = 1
+    )
+        : block_length_( block_length )
+        , read_ahead_(   read_ahead )
+        , ahead_buffer_( nullptr )
+        , ahead_next_( 0 )
     {
+        if( block_length_ == 0 || read_ahead_ == 0 ) {
+            throw std::invalid_argument(
+                "InputBuffer needs a block length and read ahead of at least one."
+            );
+        }
         init_( std::move( input_source ));
     }
 
     ~InputBuffer()
     {
-        delete[] buffer_;
-        buffer_ = nullptr;
+        // Make sure that the reader does not write into our blocks any more before freeing them.
+        input_reader_.reset();
+
+        // In mapped mode, the buffer belongs to the input source.
+        if( ! mapped_source_ ) {
+            delete[] buffer_;
+        }
+        delete[] ahead_buffer_;
+        buffer_       = nullptr;
+        ahead_buffer_ = nullptr;
     }
 
     InputBuffer(self_type const&) = delete;
@@ -101,9 +148,27 @@ public:
         return data_pos_ < data_end_;
     }
 
+    /**
+     * @brief Return the length of the buffer blocks.
+     */
+    size_t block_length() const
+    {
+        return block_length_;
+    }
+
+    /**
+     * @brief Return whether the buffer directly works on the memory of a mapped input source.
+     *
+     * See BaseInputSource::is_mapped() for details.
+     */
+    bool is_mapped() const
+    {
+        return mapped_source_ != nullptr;
+    }
+
     char peek( size_t ahead = 1 )
     {
-        if( ahead > BlockLength ) {
+        if( ! mapped_source_ && ahead > block_length_ ) {
             throw std::runtime_error(
                 "Cannot peek ahead more than one block length of the Input Buffer."
             );
@@ -117,7 +182,7 @@ public:
 
             // Read blocks if necessary. Now we are surely in the first block.
             update_blocks_();
-            assert( data_pos_ < BlockLength );
+            assert( mapped_source_ || data_pos_ < block_length_ );
 
             // Try again. If we still cannot peek ahead, we are at the end of the stream.
             if( data_pos_ + ahead < data_end_ ) {
@@ -130,9 +195,17 @@ public:
 
     size_t read( char* target, size_t size )
     {
+        // In mapped mode, all data is available, so we can simply copy it.
+        if( mapped_source_ ) {
+            size = std::min( size, data_end_ - data_pos_ );
+            std::memcpy( target, buffer_ + data_pos_, size );
+            data_pos_ += size;
+            return size;
+        }
+
         // Shortcut for most common use case: We are in the first block, and have enough buffer
         // to return the whole amount of requested data.
-        if( data_pos_ < BlockLength && size < data_end_ - data_pos_ ) {
+        if( data_pos_ < block_length_ && size < data_end_ - data_pos_ ) {
             std::memcpy( target, buffer_ + data_pos_, size );
             data_pos_ += size;
             return size;
@@ -144,22 +217,22 @@ public:
 
         // Read blocks if necessary. Now we are surely in the first block.
         update_blocks_();
-        assert( data_pos_ < BlockLength );
+        assert( data_pos_ < block_length_ );
 
         // Read data that is too big for one block, as long as there are more blocks.
-        while( yet_to_read > BlockLength && data_end_ == 2 * BlockLength ) {
+        while( yet_to_read > block_length_ && data_end_ == 2 * block_length_ ) {
 
             // Read one block.
-            std::memcpy( target + done_reading, buffer_ + data_pos_, BlockLength );
-            data_pos_    += BlockLength;
+            std::memcpy( target + done_reading, buffer_ + data_pos_, block_length_ );
+            data_pos_    += block_length_;
 
             // Update our track keeping.
-            done_reading += BlockLength;
-            yet_to_read  -= BlockLength;
+            done_reading += block_length_;
+            yet_to_read  -= block_length_;
 
             // Update the blocks.
             update_blocks_();
-            assert( data_pos_ < BlockLength );
+            assert( data_pos_ < block_length_ );
             assert( data_pos_ < data_end_ );
         }
 
@@ -173,7 +246,7 @@ public:
 
         // Saftey. Never read more than there is.
         assert( yet_to_read <= buffered );
-        assert( yet_to_read <= BlockLength );
+        assert( yet_to_read <= block_length_ );
 
         // Read rest.
         std::memcpy( target + done_reading, buffer_ + data_pos_, yet_to_read );
@@ -185,6 +258,38 @@ public:
         return done_reading;
     }
 
+    /**
+     * @brief Return a pointer to the next `size` bytes of the buffered data, and move past them.
+     *
+     * This is the copy-free alternative to read(): Instead of copying the data into a target,
+     * a pointer into the internal buffer is returned, along with the number of bytes that are
+     * available there, which is less than `size` only at the end of the input.
+     *
+     * The returned pointer is only valid until the next call to any reading function of this
+     * buffer, as the underlying blocks are then possibly refilled. In mapped mode, it stays valid
+     * as long as the buffer exists. Without mapping, at most block_length() bytes can be viewed
+     * at a time.
+     */
+    std::pair< char const*, size_t > get_view( size_t size )
+    {
+        if( ! mapped_source_ ) {
+            if( size > block_length_ ) {
+                throw std::runtime_error(
+                    "Cannot view more than one block length of the Input Buffer."
+                );
+            }
+
+            // Read blocks if necessary. Now, at least one block is contiguously available
+            // behind the current position, unless we are at the end of the input.
+            update_blocks_();
+        }
+
+        size = std::min( size, data_end_ - data_pos_ );
+        auto const ptr = buffer_ + data_pos_;
+        data_pos_ += size;
+        return { ptr, size };
+    }
+
     // -------------------------------------------------------------
     //     Internal Members
     // -------------------------------------------------------------
@@ -196,34 +301,38 @@ private:
      */
     void update_blocks_()
     {
-        // Nothing to do. We are already at the end of the input.
-        if( data_pos_ == data_end_ ) {
+        // Nothing to do. We are already at the end of the input, or all data is mapped anyway.
+        if( data_pos_ == data_end_ || mapped_source_ ) {
             return;
         }
         assert( data_pos_ < data_end_ );
 
         // If this assertion breaks, someone tempered with our internal invariants.
-        assert( data_end_ <= BlockLength * 2 );
+        assert( data_end_ <= block_length_ * 2 );
 
         // If we are past the first block, we need to load more data into the blocks.
-        if( data_pos_ >= BlockLength ) {
+        if( data_pos_ >= block_length_ ) {
 
             // Move the second to the first block.
-            std::memcpy( buffer_, buffer_ + BlockLength, BlockLength );
-            data_pos_ -= BlockLength;
-            data_end_ -= BlockLength;
+            std::memcpy( buffer_, buffer_ + block_length_, block_length_ );
+            data_pos_ -= block_length_;
+            data_end_ -= block_length_;
 
-            // If we are not yet at the end of the data, start the reader again:
-            // Copy the third block to the second, and read into the third one.
+            // If we are not yet at the end of the data, get the next block of the read-ahead
+            // ring into the second block, and start the reader again to refill that ring slot.
             if( input_reader_.valid() ) {
-                data_end_ += input_reader_.finish_reading();
-                std::memcpy( buffer_ + BlockLength, buffer_ + 2 * BlockLength, BlockLength );
-                input_reader_.start_reading( buffer_ + 2 * BlockLength, BlockLength );
+                auto const slot = ahead_buffer_ + ahead_next_ * block_length_;
+                auto const got  = input_reader_.finish_reading();
+                std::memcpy( buffer_ + block_length_, slot, got );
+                data_end_ += got;
+
+                input_reader_.start_reading( slot, block_length_ );
+                ahead_next_ = ( ahead_next_ + 1 ) % read_ahead_;
             }
         }
 
         // After the update, the current position needs to be within the first block.
-        assert( data_pos_ < BlockLength );
+        assert( data_pos_ < block_length_ );
     }
 
     /**
@@ -242,9 +351,21 @@ private:
             return;
         }
 
-        // We use three buffer blocks:
-        // The first two for the current blocks, and the third for the async reading.
-        buffer_ = new char[ 3 * BlockLength ];
+        // If the source is mapped, we can directly work on its memory, and are done here.
+        if( input_source->is_mapped() ) {
+            source_name_ = input_source->source_name();
+
+            auto const data = input_source->mapped_data();
+            buffer_   = data.first;
+            data_pos_ = 0;
+            data_end_ = data.second;
+            mapped_source_ = std::move( input_source );
+            return;
+        }
+
+        // We use two buffer blocks for the current data,
+        // and a ring of read-ahead blocks for the (async) reading.
+        buffer_ = new char[ 2 * block_length_ ];
 
         try {
             // Set source name.
@@ -252,17 +373,25 @@ private:
 
             // Read up to two blocks.
             data_pos_ = 0;
-            data_end_ = input_source->read( buffer_, 2 * BlockLength );
+            data_end_ = input_source->read( buffer_, 2 * block_length_ );
 
             // If there is more data after the two blocks that we just read, start the
-            // reading process (possibly async, if pthreads is available), into the third block.
-            if( data_end_ == 2 * BlockLength ) {
+            // reading process (possibly async, if pthreads is available), and request
+            // all read-ahead blocks right away.
+            if( data_end_ == 2 * block_length_ ) {
+                ahead_buffer_ = new char[ read_ahead_ * block_length_ ];
                 input_reader_.init( std::move( input_source ));
-                input_reader_.start_reading( buffer_ + 2 * BlockLength, BlockLength );
+                for( size_t i = 0; i < read_ahead_; ++i ) {
+                    input_reader_.start_reading( ahead_buffer_ + i * block_length_, block_length_ );
+                }
             }
 
         } catch( ... ) {
+            input_reader_.reset();
             delete[] buffer_;
+            delete[] ahead_buffer_;
+            buffer_       = nullptr;
+            ahead_buffer_ = nullptr;
             throw;
         }
     }
@@ -277,8 +406,18 @@ private:
     InputReader input_reader_;
     std::string source_name_;
 
-    // ...and is buffered here.
+    // In mapped mode, we keep the source here, and directly use its memory as our buffer.
+    std::unique_ptr<BaseInputSource> mapped_source_;
+
+    // Size of the buffer blocks, and number of read-ahead blocks.
+    size_t block_length_;
+    size_t read_ahead_;
+
+    // ...and is buffered here. The read-ahead blocks form a ring, with the next block to be
+    // consumed at index `ahead_next_`.
     char*  buffer_;
+    char*  ahead_buffer_;
+    size_t ahead_next_;
 
     // Current position in the buffer. It mostly is in the first block. Once we move into the
     // second block when advancing this position, the next call of update_blocks_() will move
@@ -33,14 +33,19 @@
 
 #include "genesis/utils/io/input_source.hpp"
 
+#include <cassert>
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
 
 #ifdef GENESIS_PTHREADS
+#    include "genesis/utils/core/options.hpp"
+#    include "genesis/utils/core/thread_pool.hpp"
+
 #    include <condition_variable>
+#    include <exception>
 #    include <mutex>
-#    include <thread>
 #endif
 
 namespace genesis {
@@ -97,10 +102,20 @@ namespace utils {
 /**
  * @brief Read bytes from an @link BaseInputSource InputSource@endlink into a `char buffer`.
  *
- * The reading is done asynchronously, that is, a second thread is started. This is usually faster
+ * The reading is done asynchronously, that is, in a different thread. This is usually faster
  * than synchronous reading (see SynchronousReader), particularly for large data blocks.
  * It is thus the preferred reader, if available.
  *
+ * Several reads can be requested via start_reading() before their results are collected via
+ * finish_reading(). The requests are processed in the order in which they were made, and
+ * finish_reading() returns their results in that same order. This allows the caller to keep
+ * the reading busy with reading ahead, for example for slow or network-mounted storage.
+ *
+ * All instances of this class share one process-wide ThreadPool for their reading, see
+ * thread_pool(). Its size, and hence the maximum number of concurrent reads, can be set via
+ * @link Options::io_threads( unsigned int ) Options::get().io_threads()@endlink. The reads of
+ * a single reader are never run concurrently, as input sources are read sequentially.
+ *
  * This class is only available if threading is available, that is, if the `GENESIS_PTHREADS` macro
  * definition is set. If this is the case, the @link utils::InputReader InputReader@endlink
  * typedef is an alias of this class. Otherwise, only the SynchronousReader is available and
@@ -123,65 +138,28 @@ public:
     AsynchronousReader( AsynchronousReader const& ) = delete;
     AsynchronousReader( AsynchronousReader&& )      = delete;
 
-    // Not sure if this move constructor and the move assignment are correct.
-    // We don't need them right now, so better disable them.
-    // Inspired by http://stackoverflow.com/questions/29986208/how-should-i-deal-with-mutexes-in-movable-types-in-c
-
-    // AsynchronousReader( AsynchronousReader&& other )
-    // {
-    //     std::unique_lock< std::mutex > guard( lock_ );
-    //
-    //     input_source_  = std::move( other.input_source_ );
-    //
-    //     target_buffer_ = std::move( other.target_buffer_ );
-    //     target_size_   = std::move( other.target_size_ );
-    //     achieved_size_ = std::move( other.achieved_size_ );
-    //
-    //     worker_            = std::move( other.worker_ );
-    //     destructor_called_ = std::move( other.destructor_called_ );
-    //     read_except_ptr_   = std::move( other.read_except_ptr_ );
-    // }
-
     AsynchronousReader& operator= ( AsynchronousReader const& ) = delete;
     AsynchronousReader& operator= ( AsynchronousReader&& )      = delete;
 
-    // AsynchronousReader& operator= ( AsynchronousReader&& other )
-    // {
-    //     if( this == &other ) {
-    //         return *this;
-    //     }
-    //
-    //     std::unique_lock< std::mutex > guard_lhs( lock_,       std::defer_lock );
-    //     std::unique_lock< std::mutex > guard_rhs( other.lock_, std::defer_lock );
-    //     std::lock( guard_lhs, guard_rhs);
-    //
-    //     input_source_  = std::move( other.input_source_ );
-    //
-    //     target_buffer_ = std::move( other.target_buffer_ );
-    //     target_size_   = std::move( other.target_size_ );
-    //     achieved_size_ = std::move( other.achieved_size_ );
-    //
-    //     worker_            = std::move( other.worker_ );
-    //     destructor_called_ = std::move( other.destructor_called_ );
-    //     read_except_ptr_   = std::move( other.read_except_ptr_ );
-    //
-    //     return *this;
-    // }
-
     ~AsynchronousReader()
     {
-        if( input_source_ == nullptr ) {
-            return;
-        }
+        reset();
+    }
 
-        // Terminate the reading process, in case it is still running.
-        { // Scoped lock.
-            std::unique_lock< std::mutex > guard( lock_ );
-            destructor_called_ = true;
-        }
+    // -------------------------------------------------------------
+    //     Thread Pool
+    // -------------------------------------------------------------
 
-        cond_read_requested_.notify_one();
-        worker_.join();
+    /**
+     * @brief Return the process-wide thread pool that is used by all readers.
+     *
+     * The pool is created on first use, with @link Options::io_threads() Options::get().io_threads()
+     * @endlink many threads.
+     */
+    static ThreadPool& thread_pool()
+    {
+        static ThreadPool pool( Options::get().io_threads() );
+        return pool;
     }
 
     // -------------------------------------------------------------
@@ -190,54 +168,43 @@ public:
 
     void init( std::unique_ptr< BaseInputSource > input_source )
     {
-        // Get a lock.
-        std::unique_lock< std::mutex > guard( lock_ );
+        // Make sure that the pool exists before we use it, so that it outlives this reader
+        // if this reader is a static object itself.
+        thread_pool();
 
-        // Prepare input variables.
-        input_source_      = std::move( input_source );
-        target_size_       = -1;
-        destructor_called_ = false;
-
-        // Prepare worker thread.
-        worker_ = std::thread( [&] {
-            std::unique_lock< std::mutex > guard( lock_ );
-            try {
-
-                // Read until termination requested.
-                while( true ) {
-
-                    // Condition: wait until the master wants the worker to read.
-                    cond_read_requested_.wait(
-                        guard,
-                        [&] () {
-                            return ( target_size_ != -1 ) || destructor_called_;
-                        }
-                    );
-
-                    // If we are about to destroy the object, we can stop here.
-                    if( destructor_called_ ) {
-                        return;
-                    }
-
-                    // Read.
-                    achieved_size_ = input_source_->read( target_buffer_, target_size_ );
-                    target_size_   = -1;
-
-                    // If we did not get any data, we are done with the input source.
-                    if( achieved_size_ == 0 ) {
-                        break;
-                    }
-
-                    cond_read_finished_.notify_one();
-                }
+        std::unique_lock< std::mutex > guard( lock_ );
+        input_source_    = std::move( input_source );
+        requests_.clear();
+        next_request_    = 0;
+        source_finished_ = false;
+        task_active_     = false;
+        stop_requested_  = false;
+        read_except_ptr_ = nullptr;
+    }
 
-            // Store any exception, so that we can re-throw from main thread.
-            } catch( ... ) {
-                read_except_ptr_ = std::current_exception();
-            }
+    /**
+     * @brief Stop the reading process, discard all pending requests, and release the source.
+     *
+     * Afterwards, the reader is not valid() any more, and does not write to any of the target
+     * buffers of its requests any more. If a read is currently running, this waits for it
+     * to finish.
+     */
+    void reset()
+    {
+        if( input_source_ == nullptr ) {
+            return;
+        }
 
-            cond_read_finished_.notify_one();
+        // Stop processing further requests, and wait for the current read to finish.
+        std::unique_lock< std::mutex > guard( lock_ );
+        stop_requested_ = true;
+        cond_read_finished_.wait( guard, [&]{
+            return ! task_active_;
         });
+
+        input_source_.reset();
+        requests_.clear();
+        read_except_ptr_ = nullptr;
     }
 
     bool valid() const
@@ -259,33 +226,53 @@ public:
     //     Reading
     // -------------------------------------------------------------
 
-    void start_reading( char* target_buffer, int target_size )
+    /**
+     * @brief Request to read `target_size` bytes into the `target_buffer`.
+     *
+     * The buffer has to stay valid until the corresponding finish_reading() call returns.
+     */
+    void start_reading( char* target_buffer, size_t target_size )
     {
-        // Set the target variables and start the worker.
+        // Add the request, and make sure that it gets processed.
         std::unique_lock< std::mutex > guard( lock_ );
-        target_buffer_ = target_buffer;
-        target_size_   = target_size;
-        achieved_size_ = -1;
-        cond_read_requested_.notify_one();
+        requests_.push_back({ target_buffer, target_size, 0, false });
+        schedule_();
     }
 
-    int finish_reading()
+    /**
+     * @brief Wait for the oldest pending read request to finish, and return the number of bytes
+     * that were read for it.
+     */
+    size_t finish_reading()
     {
-        // Wait until the worker is done reading.
-        std::unique_lock< std::mutex > guard(lock_);
+        // Wait until the oldest request is done.
+        std::unique_lock< std::mutex > guard( lock_ );
+        assert( ! requests_.empty() );
         cond_read_finished_.wait(
             guard,
             [&]{
-                    return achieved_size_ != -1 || read_except_ptr_;
+                return requests_.front().finished || read_except_ptr_;
             }
         );
 
         // If there was an exception, re-throw. Otherwise, return number of read bytes.
         if( read_except_ptr_ ) {
             std::rethrow_exception( read_except_ptr_ );
-        } else {
-            return achieved_size_;
         }
+
+        auto const result = requests_.front().achieved_size;
+        requests_.pop_front();
+        --next_request_;
+        return result;
+    }
+
+    /**
+     * @brief Return the number of read requests that were started, but not yet finished.
+     */
+    size_t pending() const
+    {
+        std::unique_lock< std::mutex > guard( lock_ );
+        return requests_.size();
     }
 
     // -------------------------------------------------------------
@@ -294,18 +281,99 @@ public:
 
 private:
 
+    /**
+     * @brief Submit a task to the thread pool if there is an unprocessed request and no task
+     * for this reader is currently active. Needs to be called with the lock held.
+     */
+    void schedule_()
+    {
+        if( task_active_ || stop_requested_ || read_except_ptr_ ) {
+            return;
+        }
+        if( next_request_ >= requests_.size() ) {
+            return;
+        }
+
+        task_active_ = true;
+        thread_pool().enqueue( [this] {
+            process_request_();
+        });
+    }
+
+    /**
+     * @brief Process the next unprocessed request. Runs in the thread pool.
+     *
+     * Only one request is processed per task, so that readers get a fair share of the pool.
+     * If there are more requests afterwards, a new task is submitted.
+     */
+    void process_request_()
+    {
+        std::unique_lock< std::mutex > guard( lock_ );
+        try {
+            if( ! stop_requested_ ) {
+
+                // Read, without holding the lock, so that the master can keep requesting
+                // more reads in the meantime. Deque references stay valid while we do this,
+                // as the master only adds elements at the end, and only removes requests
+                // that are already finished.
+                auto& request = requests_[ next_request_ ];
+                size_t achieved = 0;
+                if( ! source_finished_ ) {
+                    guard.unlock();
+                    achieved = input_source_->read( request.target_buffer, request.target_size );
+                    guard.lock();
+                }
+
+                // If we did not get any data, we are done with the input source.
+                // All further requests then simply yield no data.
+                if( achieved == 0 ) {
+                    source_finished_ = true;
+                }
+
+                request.achieved_size = achieved;
+                request.finished      = true;
+                ++next_request_;
+            }
+
+        // Store any exception, so that we can re-throw from main thread.
+        } catch( ... ) {
+            if( ! guard.owns_lock() ) {
+                guard.lock();
+            }
+            read_except_ptr_ = std::current_exception();
+        }
+
+        // We are done with this task. Schedule the next one, if needed.
+        task_active_ = false;
+        schedule_();
+
+        // Notify while holding the lock, so that the reader cannot be destroyed in between.
+        cond_read_finished_.notify_all();
+    }
+
+    struct ReadRequest
+    {
+        char*  target_buffer;
+        size_t target_size;
+        size_t achieved_size;
+        bool   finished;
+    };
+
     std::unique_ptr<BaseInputSource> input_source_;
 
-    char* target_buffer_;
-    int   target_size_;
-    int   achieved_size_;
+    // Requests in the order in which they were made, and the index of the first one
+    // that was not yet processed.
+    std::deque< ReadRequest > requests_;
+    size_t next_request_;
+    bool   source_finished_;
 
-    std::thread worker_;
-    bool destructor_called_;
+    // Whether a task of this reader is currently submitted to the pool, and whether we are
+    // about to stop.
+    bool task_active_;
+    bool stop_requested_;
     std::exception_ptr read_except_ptr_;
 
-    std::mutex lock_;
-    std::condition_variable cond_read_requested_;
+    mutable std::mutex lock_;
     std::condition_variable cond_read_finished_;
 };
 
@@ -319,7 +387,8 @@ private:
  * @brief Read bytes from an @link BaseInputSource InputSource@endlink into a `char buffer`.
  *
  * The reading is done synchronously, that is, reading occurs on request. This is usually slower
- * than asynchronous reading (see AsynchronousReader).
+ * than asynchronous reading (see AsynchronousReader). Requests made via start_reading() are
+ * queued, and executed in order by finish_reading().
  *
  * This class is always available. If threading is not available (that is, if the `GENESIS_PTHREADS`
  * macro definition is not set), the @link utils::InputReader InputReader@endlink typedef is an
@@ -353,6 +422,13 @@ public:
     void init( std::unique_ptr<BaseInputSource> input_source )
     {
         input_source_ = std::move( input_source );
+        requests_.clear();
+    }
+
+    void reset()
+    {
+        input_source_.reset();
+        requests_.clear();
     }
 
     bool valid() const
@@ -374,15 +450,22 @@ public:
     //     Reading
     // -------------------------------------------------------------
 
-    void start_reading( char* target_buffer, int target_size )
+    void start_reading( char* target_buffer, size_t target_size )
+    {
+        requests_.push_back({ target_buffer, target_size });
+    }
+
+    size_t finish_reading()
     {
-        target_buffer_ = target_buffer;
-        target_size_   = target_size;
+        assert( ! requests_.empty() );
+        auto const request = requests_.front();
+        requests_.pop_front();
+        return input_source_->read( request.first, request.second );
     }
 
-    int finish_reading()
+    size_t pending() const
     {
-        return input_source_->read( target_buffer_, target_size_ );
+        return requests_.size();
     }
 
     // -------------------------------------------------------------
@@ -393,8 +476,8 @@ private:
 
     std::unique_ptr<BaseInputSource> input_source_;
 
-    char* target_buffer_;
-    int   target_size_;
+    // Target buffers and sizes of the requests, in the order in which they were made.
+    std::deque< std::pair< char*, size_t >> requests_;
 };
 
 } // namespace utils
@@ -38,6 +38,14 @@
 #include <istream>
 #include <stdexcept>
 #include <string>
+#include <utility>
+
+#if !( defined( _WIN32 ) || defined(  _WIN64  ))
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
 
 namespace genesis {
 namespace utils {
@@ -50,6 +58,11 @@ namespace utils {
  * @brief Abstract base class for reading byte data from input sources.
  *
  * It offers to read() a certain amount of bytes into a char buffer.
+ *
+ * Furthermore, sources that hold their whole content in memory anyway (such as the
+ * MmapInputSource) can offer direct access to that memory via is_mapped() and mapped_data().
+ * Readers such as InputStream and InputBuffer then work on that memory directly instead of
+ * copying the data into their own buffer blocks via read().
  */
 class BaseInputSource
 {
@@ -92,6 +105,33 @@ public:
         return source_name_();
     }
 
+    /**
+     * @brief Return whether the whole input is available as one contiguous block of memory.
+     *
+     * If this is `true`, mapped_data() can be used to access this memory directly.
+     */
+    bool is_mapped() const
+    {
+        // Non-virtual interface.
+        return is_mapped_();
+    }
+
+    /**
+     * @brief Get a pointer to the memory of a mapped source, and its length in bytes.
+     *
+     * This is only valid if is_mapped() returns `true`; otherwise, `{ nullptr, 0 }` is returned.
+     * The memory stays valid as long as the input source object is alive.
+     *
+     * The memory is writable, but changes are private to the process, that is, they do not reach
+     * the underlying file or string. Furthermore, at least one more byte after the end of the
+     * returned range is writable, so that readers can place a terminating char there.
+     */
+    std::pair< char*, size_t > mapped_data()
+    {
+        // Non-virtual interface.
+        return mapped_data_();
+    }
+
     // -------------------------------------------------------------
     //     Internal Members
     // -------------------------------------------------------------
@@ -102,6 +142,16 @@ private:
 
     virtual std::string source_name_() const = 0;
 
+    virtual bool is_mapped_() const
+    {
+        return false;
+    }
+
+    virtual std::pair< char*, size_t > mapped_data_()
+    {
+        return { nullptr, 0 };
+    }
+
 };
 
 // =================================================================================================
@@ -384,6 +434,183 @@ private:
     std::string file_name_;
 };
 
+// =================================================================================================
+//     Mmap Input Source
+// =================================================================================================
+
+/**
+ * @brief Input source for reading byte data from a memory-mapped file.
+ *
+ * The file is mapped into memory as a whole, so that readers like InputStream and InputBuffer
+ * can directly work on the mapped memory (see BaseInputSource::is_mapped()), instead of copying
+ * the data via read() into their buffer blocks, and without the need for asynchronous reading.
+ * This is particularly useful for large files on fast local storage.
+ *
+ * The mapping is private and copy-on-write, which means that readers are allowed to change bytes
+ * in memory (e.g., for normalizing line breaks) without affecting the file. Only the pages that
+ * are actually changed are copied by the operating system.
+ *
+ * Memory mapping is only available on POSIX systems. On other systems, the constructor throws.
+ */
+class MmapInputSource : public BaseInputSource
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct the input source by mapping the file with the given file name.
+     */
+    explicit MmapInputSource( std::string const& file_name )
+        : file_name_( file_name )
+    {
+        if( ! file_exists( file_name ) ) {
+            throw std::runtime_error( "File does not exists: " + file_name );
+        }
+
+        #if defined( _WIN32 ) || defined(  _WIN64  )
+
+            throw std::runtime_error( "Memory mapped files are not available on this system." );
+
+        #else
+
+            int const fd = ::open( file_name.c_str(), O_RDONLY );
+            if( fd == -1 ) {
+                throw std::runtime_error( "Cannot open file: " + file_name );
+            }
+
+            struct stat st;
+            if( ::fstat( fd, &st ) != 0 || ! S_ISREG( st.st_mode )) {
+                ::close( fd );
+                throw std::runtime_error( "Cannot memory map file: " + file_name );
+            }
+            size_ = static_cast< size_t >( st.st_size );
+
+            // We reserve one more page of anonymous (zeroed) memory than needed for the file,
+            // and map the file over the beginning of it. This way, the memory directly after the
+            // end of the data is always valid and writable, even if the file size is a multiple
+            // of the page size, see mapped_data().
+            auto const page_size = static_cast< size_t >( ::sysconf( _SC_PAGESIZE ));
+            map_size_ = ( size_ / page_size + 1 ) * page_size;
+
+            void* region = ::mmap(
+                nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+            );
+            if( region == MAP_FAILED ) {
+                ::close( fd );
+                throw std::runtime_error( "Cannot memory map file: " + file_name );
+            }
+
+            if( size_ > 0 ) {
+                void* data = ::mmap(
+                    region, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0
+                );
+                if( data == MAP_FAILED ) {
+                    ::munmap( region, map_size_ );
+                    ::close( fd );
+                    throw std::runtime_error( "Cannot memory map file: " + file_name );
+                }
+
+                // We are going to read the whole file from front to back.
+                ::madvise( data, size_, MADV_SEQUENTIAL );
+            }
+
+            // The mapping stays valid after closing the descriptor.
+            ::close( fd );
+            data_   = static_cast< char* >( region );
+            cursor_ = data_;
+
+        #endif
+    }
+
+    MmapInputSource( MmapInputSource const& ) = delete;
+    MmapInputSource( MmapInputSource&& )      = delete;
+
+    MmapInputSource& operator= ( MmapInputSource const& ) = delete;
+    MmapInputSource& operator= ( MmapInputSource&& )      = delete;
+
+    ~MmapInputSource()
+    {
+        #if !( defined( _WIN32 ) || defined(  _WIN64  ))
+            if( data_ != nullptr ) {
+                ::munmap( data_, map_size_ );
+            }
+        #endif
+    }
+
+    // -------------------------------------------------------------
+    //     Special Members
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Rewind the source to its start, so that it can be re-read.
+     */
+    void rewind()
+    {
+        cursor_ = data_;
+    }
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Override of the read function.
+     *
+     * This is only used by readers that do not make use of the mapped memory directly.
+     */
+    size_t read_( char* buffer, size_t size ) override
+    {
+        size_t const rest_size = size_ - static_cast< size_t >( cursor_ - data_ );
+        if( size > rest_size ) {
+            size = rest_size;
+        }
+
+        std::memcpy( buffer, cursor_, size );
+        cursor_ += size;
+        return size;
+    }
+
+    /**
+     * @brief Override of the source name funtion. Returns "input file <file_name>".
+     */
+    std::string source_name_() const override
+    {
+        return "input file " + file_name_;
+    }
+
+    /**
+     * @brief Override of the mapped query function. Returns `true`.
+     */
+    bool is_mapped_() const override
+    {
+        return true;
+    }
+
+    /**
+     * @brief Override of the mapped data function. Returns the whole mapped file.
+     */
+    std::pair< char*, size_t > mapped_data_() override
+    {
+        return { data_, size_ };
+    }
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    std::string file_name_;
+
+    char*       data_     = nullptr;
+    char*       cursor_   = nullptr;
+    size_t      size_     = 0;
+    size_t      map_size_ = 0;
+};
+
 } // namespace utils
 } // namespace genesis
 
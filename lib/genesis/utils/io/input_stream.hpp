@@ -31,10 +31,14 @@
  * @ingroup utils
  */
 
+#include "genesis/utils/io/char_search.hpp"
 #include "genesis/utils/io/input_source.hpp"
 #include "genesis/utils/io/input_reader.hpp"
 
+#include <algorithm>
 #include <assert.h>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -69,6 +73,11 @@ namespace utils {
  * position. The member function current() furthermore provides a checked version of the
  * dereference operator.
  *
+ * If the input source offers its data as one contiguous block of memory (see
+ * BaseInputSource::is_mapped(), e.g., for an MmapInputSource), the stream works directly on that
+ * memory. In that case, no buffer blocks are allocated, no data is copied, and no asynchronous
+ * reading is needed. This also lifts the line length limit of get_line().
+ *
  * Implementation details inspired by
  * [fast-cpp-csv-parser](https://github.com/ben-strasser/fast-cpp-csv-parser) by Ben Strasser,
  * see also @link supplement_acknowledgements_code_reuse_input_stream Acknowledgements@endlink.
@@ -82,11 +91,12 @@ public:
     // -------------------------------------------------------------
 
     /**
-     * @brief Block length for internal buffering.
+     * @brief Default block length for internal buffering.
      *
-     * The buffer uses three blocks of this size (16MB each).
-     * This is also the maximum line length that can be read at a time with get_line().
-     * If this is too short, change the BlockLength.
+     * The buffer uses two blocks of this size (16MB each) for the current data, plus one or more
+     * blocks for reading ahead, see the constructor. The block length is also the maximum line
+     * length that can be read at a time with get_line(), unless the input source is mapped.
+     * If this is too short, use a larger block length in the constructor.
      */
     static const size_t BlockLength = 1 << 24;
 
@@ -99,7 +109,11 @@ public:
 
     InputStream()
         : source_name_( "invalid source" )
+        , block_length_( BlockLength )
+        , read_ahead_(   1 )
         , buffer_(   nullptr )
+        , ahead_buffer_( nullptr )
+        , ahead_next_( 0 )
         , data_pos_( 0 )
         , data_end_( 0 )
         , current_( '\0' )
@@ -107,17 +121,49 @@ public:
         , column_(   0 )
     {}
 
-    explicit InputStream( std::unique_ptr<BaseInputSource> input_source )
-        : line_(   1 )
+    /**
+     * @brief Construct the stream from an @link BaseInputSource InputSource@endlink.
+     *
+     * The `block_length` is the size of the buffer blocks, and hence also the maximum line length
+     * for get_line(). Small values save memory for small inputs, large values reduce overhead for
+     * large inputs. The `read_ahead` is the number of blocks that are requested from the input
+     * reader in advance. Values larger than one allow the reader to keep slow storage busy while
+     * the parser works on the current data. Both are ignored if the input source is mapped.
+     *
+     * The read-ahead blocks are only allocated if the input is longer than two blocks.
+     */
+    explicit InputStream(
+        std::unique_ptr<BaseInputSource> input_source,
+        size_t block_length = BlockLength,
+        size_t read_ahead   = 1
+    )
+        : block_length_( block_length )
+        , read_ahead_(   read_ahead )
+        , ahead_buffer_( nullptr )
+        , ahead_next_( 0 )
+        , line_(   1 )
         , column_( 1 )
     {
+        if( block_length_ == 0 || read_ahead_ == 0 ) {
+            throw std::invalid_argument(
+                "InputStream needs a block length and read ahead of at least one."
+            );
+        }
         init_( std::move( input_source ));
     }
 
     ~InputStream()
     {
-        delete[] buffer_;
-        buffer_ = nullptr;
+        // Make sure that the reader does not write into our blocks any more before freeing them.
+        input_reader_.reset();
+
+        // In mapped mode, the buffer belongs to the input source.
+        if( ! mapped_source_ ) {
+            delete[] buffer_;
+        }
+        delete[] ahead_buffer_;
+        buffer_       = nullptr;
+        ahead_buffer_ = nullptr;
     }
 
     InputStream(self_type const&) = delete;
@@ -242,16 +288,12 @@ public:
         update_blocks_();
 
         // Find the end of the line.
-        size_t line_end = data_pos_;
-        while( line_end != data_end_       &&
-               buffer_[ line_end ] != '\n' &&
-               buffer_[ line_end ] != '\r'
-        ) {
-            ++line_end;
-        }
+        size_t line_end = find_first_of(
+            buffer_ + data_pos_, buffer_ + data_end_, '\n', '\r'
+        ) - buffer_;
 
-        // If the line is too long, throw.
-        if( line_end - data_pos_ + 1 > BlockLength ) {
+        // If the line is too long, throw. In mapped mode, there is no such limit.
+        if( ! mapped_source_ && line_end - data_pos_ + 1 > block_length_ ) {
             throw std::runtime_error( "Input line too long in " + source_name() + " at " + at() );
         }
 
@@ -291,6 +333,223 @@ public:
         return { ret_ptr, ret_len };
     }
 
+    // -------------------------------------------------------------
+    //     Bulk Operations
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Advance the stream while its current char equals `criterion`.
+     *
+     * This is the fast version of the scanner function
+     * @link utils::skip_while( InputStream&, char ) skip_while()@endlink. Instead of advancing
+     * char by char, it searches the current buffer block for the end of the run (using SIMD
+     * instructions if available, see find_first_not_of()), and updates the line and column
+     * counters in bulk. The resulting state of the stream is the same as for advancing char by
+     * char. The same holds for the other bulk operations.
+     */
+    void skip_while( char criterion )
+    {
+        scan_(
+            [criterion]( char const* begin, char const* end ) {
+                return find_first_not_of( begin, end, criterion );
+            },
+            [criterion]( char c ) {
+                return c != criterion;
+            },
+            nullptr,
+            criterion == '\r'
+        );
+    }
+
+    /**
+     * @brief Advance the stream while its current char fulfills the `criterion`.
+     */
+    void skip_while( std::function<bool (char)> const& criterion )
+    {
+        scan_(
+            [&criterion]( char const* begin, char const* end ) {
+                while( begin != end && *begin != '\r' && criterion( *begin )) {
+                    ++begin;
+                }
+                return begin;
+            },
+            [&criterion]( char c ) {
+                return ! criterion( c );
+            },
+            nullptr,
+            false
+        );
+    }
+
+    /**
+     * @brief Advance the stream until its current char equals `criterion`.
+     */
+    void skip_until( char criterion )
+    {
+        scan_(
+            [criterion]( char const* begin, char const* end ) {
+                return find_first_of( begin, end, criterion, '\r' );
+            },
+            [criterion]( char c ) {
+                return c == criterion;
+            },
+            nullptr,
+            criterion == '\r'
+        );
+    }
+
+    /**
+     * @brief Advance the stream until its current char fulfills the `criterion`.
+     */
+    void skip_until( std::function<bool (char)> const& criterion )
+    {
+        scan_(
+            [&criterion]( char const* begin, char const* end ) {
+                while( begin != end && *begin != '\r' && ! criterion( *begin )) {
+                    ++begin;
+                }
+                return begin;
+            },
+            [&criterion]( char c ) {
+                return criterion( c );
+            },
+            nullptr,
+            false
+        );
+    }
+
+    /**
+     * @brief Read from the stream while its current char equals `criterion`, and append the
+     * read chars to `target`.
+     */
+    void read_while( char criterion, std::string& target )
+    {
+        scan_(
+            [criterion]( char const* begin, char const* end ) {
+                return find_first_not_of( begin, end, criterion );
+            },
+            [criterion]( char c ) {
+                return c != criterion;
+            },
+            &target,
+            criterion == '\r'
+        );
+    }
+
+    /**
+     * @brief Read from the stream while its current char fulfills the `criterion`, and append
+     * the read chars to `target`.
+     */
+    void read_while( std::function<bool (char)> const& criterion, std::string& target )
+    {
+        scan_(
+            [&criterion]( char const* begin, char const* end ) {
+                while( begin != end && *begin != '\r' && criterion( *begin )) {
+                    ++begin;
+                }
+                return begin;
+            },
+            [&criterion]( char c ) {
+                return ! criterion( c );
+            },
+            &target,
+            false
+        );
+    }
+
+    /**
+     * @brief Read from the stream until its current char equals `criterion`, and append the
+     * read chars to `target`.
+     */
+    void read_until( char criterion, std::string& target )
+    {
+        scan_(
+            [criterion]( char const* begin, char const* end ) {
+                return find_first_of( begin, end, criterion, '\r' );
+            },
+            [criterion]( char c ) {
+                return c == criterion;
+            },
+            &target,
+            criterion == '\r'
+        );
+    }
+
+    /**
+     * @brief Read from the stream until its current char fulfills the `criterion`, and append
+     * the read chars to `target`.
+     */
+    void read_until( std::function<bool (char)> const& criterion, std::string& target )
+    {
+        scan_(
+            [&criterion]( char const* begin, char const* end ) {
+                while( begin != end && *begin != '\r' && ! criterion( *begin )) {
+                    ++begin;
+                }
+                return begin;
+            },
+            [&criterion]( char c ) {
+                return criterion( c );
+            },
+            &target,
+            false
+        );
+    }
+
+    // -------------------------------------------------------------
+    //     Buffer Access
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Direct access to the buffered data, starting at the current char.
+     *
+     * Returns a pointer to the current char and the number of chars that are available in the
+     * buffer from there on. This allows parsers to work on the raw chars directly, for example
+     * to parse a number, and then to move forward via jump_unchecked().
+     *
+     * The chars are the raw input, that is, new line chars are not yet converted (see the class
+     * description). Also, the available chars are not necessarily the rest of the input;
+     * further data might follow once the stream advanced. The pointer is only valid until the
+     * stream is moved. If the stream is at its end, `{ nullptr, 0 }` is returned.
+     */
+    std::pair< char const*, size_t > buffer()
+    {
+        if( data_pos_ >= data_end_ ) {
+            return { nullptr, 0 };
+        }
+        update_blocks_();
+        return { buffer_ + data_pos_, data_end_ - data_pos_ };
+    }
+
+    /**
+     * @brief Move forward in the stream by `n` chars, which were obtained via buffer().
+     *
+     * The counters are updated accordingly. This is meant for skipping chars that were processed
+     * via the buffer(). Hence, `n` must not exceed the number of available chars, and the skipped
+     * chars must not contain `\r` chars (other than the current char), which is for example the
+     * case for numbers. This is not checked.
+     */
+    void jump_unchecked( size_t n )
+    {
+        assert( data_pos_ + n <= data_end_ );
+
+        // Move in steps that keep the block invariants, see bulk_limit_().
+        while( n > 0 ) {
+            update_blocks_();
+            auto const limit = bulk_limit_();
+            if( data_pos_ + n <= limit ) {
+                move_to_( data_pos_ + n );
+                return;
+            }
+            if( data_pos_ < limit ) {
+                n -= limit - data_pos_;
+                move_to_( limit );
+            }
+            advance();
+            --n;
+        }
+    }
+
     // -------------------------------------------------------------
     //     State
     // -------------------------------------------------------------
@@ -366,6 +625,25 @@ public:
         return source_name_;
     }
 
+    /**
+     * @brief Return the length of the buffer blocks, which is also the maximum line length
+     * for get_line() if the input source is not mapped.
+     */
+    size_t block_length() const
+    {
+        return block_length_;
+    }
+
+    /**
+     * @brief Return whether the stream directly works on the memory of a mapped input source.
+     *
+     * See BaseInputSource::is_mapped() for details.
+     */
+    bool is_mapped() const
+    {
+        return mapped_source_ != nullptr;
+    }
+
     // -------------------------------------------------------------
     //     Internal Members
     // -------------------------------------------------------------
@@ -392,25 +670,118 @@ private:
         // from somewhere else.
         assert( data_pos_ <  data_end_ );
 
+        // In mapped mode, all data is already there.
+        if( mapped_source_ ) {
+            return;
+        }
+
         // If this assertion breaks, someone tempered with our internal invariants.
-        assert( data_end_ <= BlockLength * 2 );
+        assert( data_end_ <= block_length_ * 2 );
 
         // If we are past the first block, we need to load more data into the blocks.
-        if( data_pos_ >= BlockLength ) {
+        if( data_pos_ >= block_length_ ) {
 
             // Move the second to the first block.
-            std::memcpy( buffer_, buffer_ + BlockLength, BlockLength );
-            data_pos_ -= BlockLength;
-            data_end_ -= BlockLength;
+            std::memcpy( buffer_, buffer_ + block_length_, block_length_ );
+            data_pos_ -= block_length_;
+            data_end_ -= block_length_;
 
-            // If we are not yet at the end of the data, start the reader again:
-            // Copy the third block to the second, and read into the third one.
+            // If we are not yet at the end of the data, get the next block of the read-ahead
+            // ring into the second block, and start the reader again to refill that ring slot.
             if( input_reader_.valid() ) {
-                data_end_ += input_reader_.finish_reading();
-                std::memcpy( buffer_ + BlockLength, buffer_ + 2 * BlockLength, BlockLength );
-                input_reader_.start_reading( buffer_ + 2 * BlockLength, BlockLength );
+                auto const slot = ahead_buffer_ + ahead_next_ * block_length_;
+                auto const got  = input_reader_.finish_reading();
+                std::memcpy( buffer_ + block_length_, slot, got );
+                data_end_ += got;
+
+                input_reader_.start_reading( slot, block_length_ );
+                ahead_next_ = ( ahead_next_ + 1 ) % read_ahead_;
+            }
+        }
+    }
+
+    /**
+     * @brief Advance the stream until the current char is a stop char, working on whole
+     * buffer blocks at a time.
+     *
+     * The `find` functor gets a range of the buffer, and returns the first position in it that is
+     * either a stop char or a `\r` (which needs the line break treatment of set_current_char_()).
+     * The `is_stop` functor tells whether a char is a stop char. If `target` is given, the
+     * chars that are skipped are appended to it. If `scalar` is set, the chars are processed one
+     * at a time, which is needed for criteria that involve the `\r` char itself.
+     */
+    template< class Finder, class StopPredicate >
+    void scan_( Finder find, StopPredicate is_stop, std::string* target, bool scalar )
+    {
+        while( data_pos_ < data_end_ && ! is_stop( current_ )) {
+            update_blocks_();
+
+            // Positions beyond the limit are reached by advancing one char at a time.
+            // The same goes for scalar criteria.
+            auto const limit = bulk_limit_();
+            if( scalar || data_pos_ + 1 >= limit ) {
+                if( target ) {
+                    target->push_back( current_ );
+                }
+                advance();
+                continue;
+            }
+
+            // The current char is not a stop char, so we can start searching after it.
+            char const* begin = buffer_ + data_pos_;
+            char const* found = find( begin + 1, buffer_ + limit );
+            if( target ) {
+                target->append( begin, found );
+            }
+            move_to_( static_cast< size_t >( found - buffer_ ));
+        }
+    }
+
+    /**
+     * @brief Return the last position in the buffer that bulk operations can move to directly.
+     *
+     * We never move beyond the first block, so that the block invariants of update_blocks_()
+     * hold, and never beyond the last char of the data, as that might need a new line char
+     * appended in set_current_char_(). Needs to be called after update_blocks_().
+     */
+    size_t bulk_limit_() const
+    {
+        assert( data_pos_ < data_end_ );
+        size_t limit = data_end_ - 1;
+        if( ! mapped_source_ ) {
+            limit = std::min( limit, block_length_ );
+        }
+        return limit;
+    }
+
+    /**
+     * @brief Move forward to the given position in the buffer, and update the counters and the
+     * current char accordingly.
+     *
+     * The range up to that position must not contain `\r` chars (besides the current char,
+     * which was already turned into `\n` by set_current_char_()), so that we only have to count
+     * `\n` chars for the line counter.
+     */
+    void move_to_( size_t pos )
+    {
+        assert( data_pos_ <= pos && pos < data_end_ );
+
+        auto const begin = buffer_ + data_pos_;
+        auto const end   = buffer_ + pos;
+        auto const lines = count_chars( begin, end, '\n' );
+        if( lines == 0 ) {
+            column_ += pos - data_pos_;
+        } else {
+            auto last = end;
+            while( *( last - 1 ) != '\n' ) {
+                --last;
             }
+            line_  += lines;
+            column_ = static_cast< size_t >( end - last ) + 1;
         }
+
+        data_pos_ = pos;
+        set_current_char_();
     }
 
     /**
@@ -448,6 +819,30 @@ private:
         current_ = buffer_[ data_pos_ ];
     }
 
+    /**
+     * @brief Skip the UTF-8 BOM at the beginning of the data, if present, and set the first char.
+     */
+    void skip_bom_and_set_current_char_()
+    {
+        // Skip UTF-8 BOM, if found.
+        if( data_end_  >= 3      &&
+            buffer_[0] == '\xEF' &&
+            buffer_[1] == '\xBB' &&
+            buffer_[2] == '\xBF'
+        ) {
+            data_pos_ = 3;
+        }
+
+        // If there was no data, set to "empty" values.
+        if( data_pos_ == data_end_ ) {
+            reset_();
+
+        // If there is data, set char value.
+        } else {
+            set_current_char_();
+        }
+    }
+
     /**
      * @brief Init the buffers and the state of this object.
      */
@@ -467,11 +862,26 @@ private:
             return;
         }
 
-        // We use three buffer blocks: one and two for the current line. The max line length is
-        // one buffer length, so the beginning of the line is always in the first block, while its
-        // end can reach into the second block, but never exeed it.
-        // The third block is for the async reading.
-        buffer_ = new char[ 3 * BlockLength ];
+        // If the source is mapped, we can directly work on its memory, and are done here.
+        if( input_source->is_mapped() ) {
+            source_name_ = input_source->source_name();
+
+            auto const data = input_source->mapped_data();
+            buffer_   = data.first;
+            data_pos_ = 0;
+            data_end_ = data.second;
+            mapped_source_ = std::move( input_source );
+
+            skip_bom_and_set_current_char_();
+            return;
+        }
+
+        // We use two buffer blocks for the current line. The max line length is one buffer
+        // length, so the beginning of the line is always in the first block, while its end can
+        // reach into the second block, but never exeed it. We need one extra byte at the end,
+        // so that a line feed or null char can be added after the last char of the data.
+        // Furthermore, there is a ring of read-ahead blocks for the (async) reading.
+        buffer_ = new char[ 2 * block_length_ + 1 ];
 
         try {
             // Set source name.
@@ -479,35 +889,26 @@ private:
 
             // Read up to two blocks.
             data_pos_ = 0;
-            data_end_ = input_source->read( buffer_, 2 * BlockLength );
-
-            // Skip UTF-8 BOM, if found.
-            if( data_end_  >= 3      &&
-                buffer_[0] == '\xEF' &&
-                buffer_[1] == '\xBB' &&
-                buffer_[2] == '\xBF'
-            ) {
-                data_pos_ = 3;
-            }
-
-            // If there was no data, set to "empty" values.
-            if( data_pos_ == data_end_ ) {
-                reset_();
-
-            // If there is data, set char value.
-            } else {
-                set_current_char_();
-            }
+            data_end_ = input_source->read( buffer_, 2 * block_length_ );
+            skip_bom_and_set_current_char_();
 
             // If there is more data after the two blocks that we just read, start the
-            // reading process (possibly async, if pthreads is available).
-            if( data_end_ == 2 * BlockLength ) {
+            // reading process (possibly async, if pthreads is available), and request
+            // all read-ahead blocks right away.
+            if( data_end_ == 2 * block_length_ ) {
+                ahead_buffer_ = new char[ read_ahead_ * block_length_ ];
                 input_reader_.init( std::move( input_source ));
-                input_reader_.start_reading( buffer_ + 2 * BlockLength, BlockLength );
+                for( size_t i = 0; i < read_ahead_; ++i ) {
+                    input_reader_.start_reading( ahead_buffer_ + i * block_length_, block_length_ );
+                }
             }
 
         } catch( ... ) {
+            input_reader_.reset();
             delete[] buffer_;
+            delete[] ahead_buffer_;
+            buffer_       = nullptr;
+            ahead_buffer_ = nullptr;
             throw;
         }
     }
@@ -522,8 +923,18 @@ private:
     InputReader input_reader_;
     std::string source_name_;
 
-    // ...and is buffered here.
+    // In mapped mode, we keep the source here, and directly use its memory as our buffer.
+    std::unique_ptr<BaseInputSource> mapped_source_;
+
+    // Size of the buffer blocks, and number of read-ahead blocks.
+    size_t block_length_;
+    size_t read_ahead_;
+
+    // ...and is buffered here. The read-ahead blocks form a ring, with the next block to be
+    // consumed at index `ahead_next_`.
     char*  buffer_;
+    char*  ahead_buffer_;
+    size_t ahead_next_;
     size_t data_pos_;
     size_t data_end_;
 
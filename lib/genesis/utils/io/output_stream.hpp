@@ -33,11 +33,20 @@
 
 #include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/core/options.hpp"
+#include "genesis/utils/io/output_target.hpp"
+#include "genesis/utils/io/output_writer.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <memory>
+#include <ostream>
 #include <sstream>
 #include <stdexcept>
+#include <streambuf>
 #include <string>
+#include <vector>
 
 namespace genesis {
 namespace utils {
@@ -82,6 +91,299 @@ inline void file_output_stream(
     }
 }
 
+// =================================================================================================
+//     Output Stream Buffer
+// =================================================================================================
+
+/**
+ * @brief Stream buffer that collects data in large blocks and hands them to an OutputWriter.
+ *
+ * This is the internal buffer of OutputStream. It keeps a ring of blocks: While one block is being
+ * filled, the others are written to the @link BaseOutputTarget OutputTarget@endlink in the
+ * background. Exceptions that occur while writing are stored, and re-thrown by close().
+ */
+class OutputStreamBuffer : public std::streambuf
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    OutputStreamBuffer(
+        std::unique_ptr< BaseOutputTarget > output_target,
+        size_t block_length,
+        size_t block_count
+    )
+        : blocks_( block_count, std::vector< char >( block_length ))
+    {
+        if( block_length == 0 || block_count < 2 ) {
+            throw std::invalid_argument(
+                "OutputStream needs a block length > 0 and at least two blocks."
+            );
+        }
+
+        writer_.init( std::move( output_target ));
+        setp( blocks_[0].data(), blocks_[0].data() + block_length );
+    }
+
+    OutputStreamBuffer( OutputStreamBuffer const& ) = delete;
+    OutputStreamBuffer( OutputStreamBuffer&& )      = delete;
+
+    OutputStreamBuffer& operator= ( OutputStreamBuffer const& ) = delete;
+    OutputStreamBuffer& operator= ( OutputStreamBuffer&& )      = delete;
+
+    ~OutputStreamBuffer()
+    {
+        // Stop the writer before the blocks are freed.
+        writer_.reset();
+    }
+
+    // -------------------------------------------------------------
+    //     Members
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Write all remaining data, finish the target, and re-throw any exception that
+     * occurred while writing. Does nothing if already closed.
+     */
+    void close()
+    {
+        if( ! writer_.valid() ) {
+            return;
+        }
+
+        try {
+            if( ! except_ptr_ ) {
+                submit_block_();
+                writer_.finish();
+            }
+        } catch( ... ) {
+            except_ptr_ = std::current_exception();
+        }
+        writer_.reset();
+        setp( nullptr, nullptr );
+
+        if( except_ptr_ ) {
+            auto const except_ptr = except_ptr_;
+            except_ptr_ = nullptr;
+            std::rethrow_exception( except_ptr );
+        }
+    }
+
+    bool is_open() const
+    {
+        return writer_.valid();
+    }
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+protected:
+
+    int_type overflow( int_type c ) override
+    {
+        if( ! writer_.valid() || except_ptr_ ) {
+            return traits_type::eof();
+        }
+        try {
+            submit_block_();
+        } catch( ... ) {
+            except_ptr_ = std::current_exception();
+            return traits_type::eof();
+        }
+
+        if( ! traits_type::eq_int_type( c, traits_type::eof() )) {
+            *pptr() = traits_type::to_char_type( c );
+            pbump( 1 );
+        }
+        return traits_type::not_eof( c );
+    }
+
+    std::streamsize xsputn( char const* s, std::streamsize n ) override
+    {
+        // Copy as much as fits into the current block, and hand over full blocks.
+        std::streamsize done = 0;
+        while( done < n ) {
+            auto const eof = traits_type::eof();
+            if( pptr() == epptr() && traits_type::eq_int_type( overflow( eof ), eof )) {
+                break;
+            }
+            auto const chunk = std::min< std::streamsize >( n - done, epptr() - pptr() );
+            std::memcpy( pptr(), s + done, chunk );
+            pbump( static_cast< int >( chunk ));
+            done += chunk;
+        }
+        return done;
+    }
+
+    int sync() override
+    {
+        if( ! writer_.valid() ) {
+            return 0;
+        }
+        if( except_ptr_ ) {
+            return -1;
+        }
+        try {
+            submit_block_();
+            writer_.flush();
+        } catch( ... ) {
+            except_ptr_ = std::current_exception();
+            return -1;
+        }
+        return 0;
+    }
+
+    // -------------------------------------------------------------
+    //     Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Hand the current block over to the writer, if it contains data, and continue
+     * with the next block, waiting for it to be written first if needed.
+     */
+    void submit_block_()
+    {
+        auto const size = static_cast< size_t >( pptr() - pbase() );
+        if( size == 0 ) {
+            return;
+        }
+        writer_.start_writing( pbase(), size );
+
+        // The next block of the ring is still in use if all blocks are pending.
+        current_ = ( current_ + 1 ) % blocks_.size();
+        while( writer_.pending() >= blocks_.size() ) {
+            writer_.finish_writing();
+        }
+        auto& block = blocks_[ current_ ];
+        setp( block.data(), block.data() + block.size() );
+    }
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    std::vector< std::vector< char >> blocks_;
+    size_t current_ = 0;
+
+    OutputWriter       writer_;
+    std::exception_ptr except_ptr_;
+};
+
+// =================================================================================================
+//     Output Stream
+// =================================================================================================
+
+/**
+ * @brief Output stream that writes to an @link BaseOutputTarget OutputTarget@endlink in the
+ * background.
+ *
+ * This is the counterpart of InputStream for writing. It is a `std::ostream`, so that all
+ * functions that write to streams can use it. Data is collected in large blocks, which are
+ * written to the target by an @link utils::OutputWriter OutputWriter@endlink, that is,
+ * asynchronously if threading is available. Writing thus overlaps with producing the data, and,
+ * when writing to a GzipOutputTarget or ZstdOutputTarget, with compressing it.
+ *
+ * Use it for example as
+ *
+ *     utils::OutputStream os( utils::to_file( "path/to/file.gz", utils::CompressionFormat::kGzip ));
+ *     os << "some data\n";
+ *     os.close();
+ *
+ * As errors of the background writing cannot be reported immediately, they set the `badbit` of
+ * the stream, and are re-thrown by close(). The destructor closes the stream as well, but has to
+ * swallow errors, so an explicit call of close() is recommended.
+ */
+class OutputStream : public std::ostream
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constants
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Default size of the blocks that are handed to the writer, in bytes.
+     */
+    static const size_t BlockLength = 1 << 22;
+
+    /**
+     * @brief Default number of blocks, that is, one that is filled, and one that is written.
+     */
+    static const size_t BlockCount = 2;
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Create a stream writing to the given output target.
+     *
+     * The `block_length` is the size of the blocks handed to the target, and `block_count` the
+     * number of blocks that are used in turn. With more than two blocks, slow targets can lag
+     * behind longer before the stream has to wait for them.
+     */
+    explicit OutputStream(
+        std::unique_ptr< BaseOutputTarget > output_target,
+        size_t block_length = BlockLength,
+        size_t block_count  = BlockCount
+    )
+        : std::ostream( nullptr )
+        , buffer_( std::move( output_target ), block_length, block_count )
+    {
+        rdbuf( &buffer_ );
+    }
+
+    OutputStream( OutputStream const& ) = delete;
+    OutputStream( OutputStream&& )      = delete;
+
+    OutputStream& operator= ( OutputStream const& ) = delete;
+    OutputStream& operator= ( OutputStream&& )      = delete;
+
+    ~OutputStream()
+    {
+        try {
+            buffer_.close();
+        } catch( ... ) {}
+    }
+
+    // -------------------------------------------------------------
+    //     Members
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Write all remaining data and finish the target.
+     *
+     * Throws if writing failed at any point. Afterwards, no more data can be written.
+     */
+    void close()
+    {
+        try {
+            buffer_.close();
+        } catch( ... ) {
+            setstate( std::ios_base::badbit );
+            throw;
+        }
+    }
+
+    bool is_open() const
+    {
+        return buffer_.is_open();
+    }
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+private:
+
+    OutputStreamBuffer buffer_;
+};
+
 } // namespace utils
 } // namespace genesis
 
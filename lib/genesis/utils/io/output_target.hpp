@@ -0,0 +1,376 @@
+#ifndef GENESIS_UTILS_IO_OUTPUT_TARGET_H_
+#define GENESIS_UTILS_IO_OUTPUT_TARGET_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/core/options.hpp"
+
+#include <cstdio>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Base Output Target
+// =================================================================================================
+
+/**
+ * @brief Abstract base class for writing byte data to output targets.
+ *
+ * It offers to write() a certain amount of bytes from a char buffer, to flush() the written data
+ * to the underlying medium, and to finish() the output. This is the counterpart of
+ * BaseInputSource for writing. See OutputStream for a `std::ostream` that writes to such a target
+ * in the background.
+ */
+class BaseOutputTarget
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    BaseOutputTarget() = default;
+
+    BaseOutputTarget( BaseOutputTarget const& ) = default;
+    BaseOutputTarget( BaseOutputTarget&& )      = default;
+
+    BaseOutputTarget& operator= ( BaseOutputTarget const& ) = default;
+    BaseOutputTarget& operator= ( BaseOutputTarget&& )      = default;
+
+    virtual ~BaseOutputTarget()
+    {}
+
+    // -------------------------------------------------------------
+    //     Members
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Write `size` many bytes from the char `buffer`. Throws on failure.
+     */
+    void write( char const* buffer, size_t size )
+    {
+        // Non-virtual interface.
+        write_( buffer, size );
+    }
+
+    /**
+     * @brief Flush all data written so far to the underlying medium.
+     */
+    void flush()
+    {
+        // Non-virtual interface.
+        flush_();
+    }
+
+    /**
+     * @brief Finish the output, that is, flush all data and write any trailing data that the
+     * format needs (e.g., the footer of compressed data). No more data can be written afterwards.
+     *
+     * Targets also finish themselves when being destroyed, but errors are then swallowed.
+     * Hence, call this function explicitly to be informed about errors.
+     */
+    void finish()
+    {
+        // Non-virtual interface.
+        finish_();
+    }
+
+    /**
+     * @brief Get a name of the output target. Mainly interesting for user output.
+     */
+    std::string target_name() const
+    {
+        // Non-virtual interface.
+        return target_name_();
+    }
+
+    // -------------------------------------------------------------
+    //     Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    virtual void write_( char const* buffer, size_t size ) = 0;
+
+    virtual void flush_() = 0;
+
+    virtual void finish_()
+    {
+        flush_();
+    }
+
+    virtual std::string target_name_() const = 0;
+
+};
+
+// =================================================================================================
+//     String Output Target
+// =================================================================================================
+
+/**
+ * @brief Output target for writing byte data to a string.
+ *
+ * The string is provided via the constructor. It is not owned by this class, thus the owner must
+ * keep it alive as long as writing to it is required. Data is appended to the string.
+ */
+class StringOutputTarget : public BaseOutputTarget
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct the output target from a `std::string` to append to.
+     */
+    explicit StringOutputTarget( std::string& target )
+        : target_( target )
+    {}
+
+    StringOutputTarget( StringOutputTarget const& ) = default;
+    StringOutputTarget( StringOutputTarget&& )      = default;
+
+    StringOutputTarget& operator= ( StringOutputTarget const& ) = delete;
+    StringOutputTarget& operator= ( StringOutputTarget&& )      = delete;
+
+    ~StringOutputTarget()
+    {}
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    void write_( char const* buffer, size_t size ) override
+    {
+        target_.append( buffer, size );
+    }
+
+    void flush_() override
+    {}
+
+    /**
+     * @brief Override of the target name funtion. Returns "output string".
+     */
+    std::string target_name_() const override
+    {
+        return "output string";
+    }
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    std::string& target_;
+};
+
+// =================================================================================================
+//     Stream Output Target
+// =================================================================================================
+
+/**
+ * @brief Output target for writing byte data to an ostream.
+ *
+ * The output stream is provided via the constructor. It is not owned by this class, thus
+ * the owner must keep it alive as long as writing to it is required.
+ */
+class StreamOutputTarget : public BaseOutputTarget
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct the output target from an `std::ostream`.
+     */
+    explicit StreamOutputTarget( std::ostream& out )
+        : out_( out )
+    {}
+
+    StreamOutputTarget( StreamOutputTarget const& ) = default;
+    StreamOutputTarget( StreamOutputTarget&& )      = default;
+
+    StreamOutputTarget& operator= ( StreamOutputTarget const& ) = delete;
+    StreamOutputTarget& operator= ( StreamOutputTarget&& )      = delete;
+
+    ~StreamOutputTarget()
+    {}
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    void write_( char const* buffer, size_t size ) override
+    {
+        out_.write( buffer, size );
+        if( out_.fail() ) {
+            throw std::runtime_error( "Cannot write to output stream." );
+        }
+    }
+
+    void flush_() override
+    {
+        out_.flush();
+    }
+
+    /**
+     * @brief Override of the target name funtion. Returns "output stream".
+     */
+    std::string target_name_() const override
+    {
+        return "output stream";
+    }
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    std::ostream& out_;
+};
+
+// =================================================================================================
+//     File Output Target
+// =================================================================================================
+
+/**
+ * @brief Output target for writing byte data to a file.
+ *
+ * The file is opened in the constructor. As with
+ * @link utils::file_output_stream() file_output_stream()@endlink, the constructor throws if the
+ * file already exists, unless @link Options::allow_file_overwriting( bool )
+ * Options::allow_file_overwriting()@endlink is activated.
+ */
+class FileOutputTarget : public BaseOutputTarget
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Construct the output target by opening the file with the given name.
+     */
+    explicit FileOutputTarget( std::string const& file_name )
+        : file_name_( file_name )
+    {
+        if( ! Options::get().allow_file_overwriting() && file_exists( file_name ) ) {
+            throw std::runtime_error(
+                "File '" + file_name + "' already exists. If you want to allow overwriting of "
+                "existing files, activate Options::allow_file_overwriting() first."
+            );
+        }
+
+        file_ = std::fopen( file_name.c_str(), "wb" );
+        if( file_ == nullptr ) {
+            throw std::runtime_error( "Cannot write to file '" + file_name + "'." );
+        }
+
+        // We do our own buffering.
+        std::setvbuf( file_, 0, _IONBF, 0 );
+    }
+
+    FileOutputTarget( FileOutputTarget const& ) = delete;
+    FileOutputTarget( FileOutputTarget&& )      = delete;
+
+    FileOutputTarget& operator= ( FileOutputTarget const& ) = delete;
+    FileOutputTarget& operator= ( FileOutputTarget&& )      = delete;
+
+    ~FileOutputTarget()
+    {
+        if( file_ != nullptr ) {
+            std::fclose( file_ );
+        }
+    }
+
+    // -------------------------------------------------------------
+    //     Overloaded Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    void write_( char const* buffer, size_t size ) override
+    {
+        if( file_ == nullptr || std::fwrite( buffer, 1, size, file_ ) != size ) {
+            throw std::runtime_error( "Cannot write to file '" + file_name_ + "'." );
+        }
+    }
+
+    void flush_() override
+    {
+        if( file_ != nullptr && std::fflush( file_ ) != 0 ) {
+            throw std::runtime_error( "Cannot write to file '" + file_name_ + "'." );
+        }
+    }
+
+    void finish_() override
+    {
+        // Close the file, so that errors on closing are reported as well.
+        if( file_ != nullptr ) {
+            auto const res = std::fclose( file_ );
+            file_ = nullptr;
+            if( res != 0 ) {
+                throw std::runtime_error( "Cannot write to file '" + file_name_ + "'." );
+            }
+        }
+    }
+
+    /**
+     * @brief Override of the target name funtion. Returns "output file <file_name>".
+     */
+    std::string target_name_() const override
+    {
+        return "output file " + file_name_;
+    }
+
+    // -------------------------------------------------------------
+    //     Member Variables
+    // -------------------------------------------------------------
+
+    FILE*       file_ = nullptr;
+    std::string file_name_;
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
@@ -0,0 +1,456 @@
+#ifndef GENESIS_UTILS_IO_OUTPUT_WRITER_H_
+#define GENESIS_UTILS_IO_OUTPUT_WRITER_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/io/output_target.hpp"
+
+#include <cassert>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+
+#ifdef GENESIS_PTHREADS
+#    include "genesis/utils/io/input_reader.hpp"
+
+#    include <condition_variable>
+#    include <exception>
+#    include <mutex>
+#endif
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Output Writer
+// =================================================================================================
+
+#ifdef GENESIS_PTHREADS
+
+    class AsynchronousWriter;
+
+    /**
+     * @brief Alias for the either AsynchronousWriter or SynchronousWriter, depending on the
+     * threading setting.
+     *
+     * This typedef is an alias for AsynchronousWriter, if threading is available, that is,
+     * if the `GENESIS_PTHREADS` macro definition is set.
+     * If not, it is an alias for SynchronousWriter. See @link utils::InputReader InputReader@endlink
+     * for the counterpart used for reading.
+     */
+    using OutputWriter = AsynchronousWriter;
+
+#else
+
+    class SynchronousWriter;
+
+    /**
+     * @brief Alias for the either AsynchronousWriter or SynchronousWriter, depending on the
+     * threading setting.
+     *
+     * This typedef is an alias for AsynchronousWriter, if threading is available, that is,
+     * if the `GENESIS_PTHREADS` macro definition is set.
+     * If not, it is an alias for SynchronousWriter. See @link utils::InputReader InputReader@endlink
+     * for the counterpart used for reading.
+     */
+    using OutputWriter = SynchronousWriter;
+
+#endif
+
+// =================================================================================================
+//     Asynchronous Writer
+// =================================================================================================
+
+#ifdef GENESIS_PTHREADS
+
+/**
+ * @brief Write bytes from a `char buffer` to an @link BaseOutputTarget OutputTarget@endlink.
+ *
+ * The writing is done asynchronously, that is, in a different thread. This is the counterpart of
+ * the AsynchronousReader: Writes are requested via start_writing(), processed in the background
+ * in the order in which they were made, and collected via finish_writing(). The caller can thus
+ * keep producing data while earlier data is written (and, for compressing targets, compressed).
+ *
+ * The writes are run on the same process-wide thread pool that is used for reading, see
+ * AsynchronousReader::thread_pool(), so that @link Options::io_threads( unsigned int )
+ * Options::get().io_threads()@endlink bounds all background I/O. The writes of a single writer
+ * are never run concurrently.
+ *
+ * This class is only available if threading is available, that is, if the `GENESIS_PTHREADS` macro
+ * definition is set.
+ */
+class AsynchronousWriter
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    AsynchronousWriter() = default;
+
+    AsynchronousWriter( AsynchronousWriter const& ) = delete;
+    AsynchronousWriter( AsynchronousWriter&& )      = delete;
+
+    AsynchronousWriter& operator= ( AsynchronousWriter const& ) = delete;
+    AsynchronousWriter& operator= ( AsynchronousWriter&& )      = delete;
+
+    ~AsynchronousWriter()
+    {
+        reset();
+    }
+
+    // -------------------------------------------------------------
+    //     Init and General Members
+    // -------------------------------------------------------------
+
+    void init( std::unique_ptr< BaseOutputTarget > output_target )
+    {
+        // Make sure that the pool exists before we use it, see AsynchronousReader::init().
+        AsynchronousReader::thread_pool();
+
+        std::unique_lock< std::mutex > guard( lock_ );
+        output_target_    = std::move( output_target );
+        requests_.clear();
+        next_request_     = 0;
+        task_active_      = false;
+        stop_requested_   = false;
+        write_except_ptr_ = nullptr;
+    }
+
+    /**
+     * @brief Stop the writing process, discard all pending requests, and release the target.
+     *
+     * If a write is currently running, this waits for it to finish. Data of pending requests
+     * is lost. Use finish() before in order to write all data.
+     */
+    void reset()
+    {
+        if( output_target_ == nullptr ) {
+            return;
+        }
+
+        // Stop processing further requests, and wait for the current write to finish.
+        std::unique_lock< std::mutex > guard( lock_ );
+        stop_requested_ = true;
+        cond_write_finished_.wait( guard, [&]{
+            return ! task_active_;
+        });
+
+        output_target_.reset();
+        requests_.clear();
+        write_except_ptr_ = nullptr;
+    }
+
+    bool valid() const
+    {
+        return output_target_ != nullptr;
+    }
+
+    BaseOutputTarget const* output_target() const
+    {
+        return output_target_.get();
+    }
+
+    std::string class_name() const
+    {
+        return "AsynchronousWriter";
+    }
+
+    // -------------------------------------------------------------
+    //     Writing
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Request to write `size` bytes from the `buffer`.
+     *
+     * The buffer has to stay valid and unchanged until the corresponding finish_writing()
+     * call returns.
+     */
+    void start_writing( char const* buffer, size_t size )
+    {
+        std::unique_lock< std::mutex > guard( lock_ );
+        requests_.push_back({ buffer, size, false });
+        schedule_();
+    }
+
+    /**
+     * @brief Wait for the oldest pending write request to finish. Re-throws any exception that
+     * occurred while writing.
+     */
+    void finish_writing()
+    {
+        std::unique_lock< std::mutex > guard( lock_ );
+        assert( ! requests_.empty() );
+        cond_write_finished_.wait(
+            guard,
+            [&]{
+                return requests_.front().finished || write_except_ptr_;
+            }
+        );
+        if( write_except_ptr_ ) {
+            std::rethrow_exception( write_except_ptr_ );
+        }
+
+        requests_.pop_front();
+        --next_request_;
+    }
+
+    /**
+     * @brief Return the number of write requests that were started, but not yet finished.
+     */
+    size_t pending() const
+    {
+        std::unique_lock< std::mutex > guard( lock_ );
+        return requests_.size();
+    }
+
+    /**
+     * @brief Wait for all pending writes, and flush the output target.
+     */
+    void flush()
+    {
+        while( pending() > 0 ) {
+            finish_writing();
+        }
+        output_target_->flush();
+    }
+
+    /**
+     * @brief Wait for all pending writes, and finish the output target.
+     */
+    void finish()
+    {
+        while( pending() > 0 ) {
+            finish_writing();
+        }
+        output_target_->finish();
+    }
+
+    // -------------------------------------------------------------
+    //     Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Submit a task to the thread pool if there is an unprocessed request and no task
+     * for this writer is currently active. Needs to be called with the lock held.
+     */
+    void schedule_()
+    {
+        if( task_active_ || stop_requested_ || write_except_ptr_ ) {
+            return;
+        }
+        if( next_request_ >= requests_.size() ) {
+            return;
+        }
+
+        task_active_ = true;
+        AsynchronousReader::thread_pool().enqueue( [this] {
+            process_request_();
+        });
+    }
+
+    /**
+     * @brief Process the next unprocessed request. Runs in the thread pool.
+     */
+    void process_request_()
+    {
+        std::unique_lock< std::mutex > guard( lock_ );
+        try {
+            if( ! stop_requested_ ) {
+
+                // Write without holding the lock, see AsynchronousReader::process_request_().
+                auto& request = requests_[ next_request_ ];
+                guard.unlock();
+                output_target_->write( request.buffer, request.size );
+                guard.lock();
+
+                request.finished = true;
+                ++next_request_;
+            }
+
+        // Store any exception, so that we can re-throw from main thread.
+        } catch( ... ) {
+            if( ! guard.owns_lock() ) {
+                guard.lock();
+            }
+            write_except_ptr_ = std::current_exception();
+        }
+
+        // We are done with this task. Schedule the next one, if needed.
+        task_active_ = false;
+        schedule_();
+
+        // Notify while holding the lock, so that the writer cannot be destroyed in between.
+        cond_write_finished_.notify_all();
+    }
+
+    struct WriteRequest
+    {
+        char const* buffer;
+        size_t      size;
+        bool        finished;
+    };
+
+    std::unique_ptr< BaseOutputTarget > output_target_;
+
+    // Requests in the order in which they were made, and the index of the first one
+    // that was not yet processed.
+    std::deque< WriteRequest > requests_;
+    size_t next_request_;
+
+    bool task_active_;
+    bool stop_requested_;
+    std::exception_ptr write_except_ptr_;
+
+    mutable std::mutex lock_;
+    std::condition_variable cond_write_finished_;
+};
+
+#endif
+
+// =================================================================================================
+//     Synchronous Writer
+// =================================================================================================
+
+/**
+ * @brief Write bytes from a `char buffer` to an @link BaseOutputTarget OutputTarget@endlink.
+ *
+ * The writing is done synchronously: Requests made via start_writing() are queued, and executed
+ * in order by finish_writing(). This class is always available. If threading is not available
+ * (that is, if the `GENESIS_PTHREADS` macro definition is not set), the
+ * @link utils::OutputWriter OutputWriter@endlink typedef is an alias for this class.
+ */
+class SynchronousWriter
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    SynchronousWriter()  = default;
+    ~SynchronousWriter() = default;
+
+    SynchronousWriter( SynchronousWriter const& ) = delete;
+    SynchronousWriter( SynchronousWriter&& )      = default;
+
+    SynchronousWriter& operator= ( SynchronousWriter const& ) = delete;
+    SynchronousWriter& operator= ( SynchronousWriter&& )      = default;
+
+    // -------------------------------------------------------------
+    //     Init and General Members
+    // -------------------------------------------------------------
+
+    void init( std::unique_ptr< BaseOutputTarget > output_target )
+    {
+        output_target_ = std::move( output_target );
+        requests_.clear();
+    }
+
+    void reset()
+    {
+        output_target_.reset();
+        requests_.clear();
+    }
+
+    bool valid() const
+    {
+        return output_target_ != nullptr;
+    }
+
+    BaseOutputTarget const* output_target() const
+    {
+        return output_target_.get();
+    }
+
+    std::string class_name() const
+    {
+        return "SynchronousWriter";
+    }
+
+    // -------------------------------------------------------------
+    //     Writing
+    // -------------------------------------------------------------
+
+    void start_writing( char const* buffer, size_t size )
+    {
+        requests_.push_back({ buffer, size });
+    }
+
+    void finish_writing()
+    {
+        assert( ! requests_.empty() );
+        auto const request = requests_.front();
+        requests_.pop_front();
+        output_target_->write( request.first, request.second );
+    }
+
+    size_t pending() const
+    {
+        return requests_.size();
+    }
+
+    void flush()
+    {
+        while( pending() > 0 ) {
+            finish_writing();
+        }
+        output_target_->flush();
+    }
+
+    void finish()
+    {
+        while( pending() > 0 ) {
+            finish_writing();
+        }
+        output_target_->finish();
+    }
+
+    // -------------------------------------------------------------
+    //     Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    std::unique_ptr< BaseOutputTarget > output_target_;
+
+    // Buffers and sizes of the requests, in the order in which they were made.
+    std::deque< std::pair< char const*, size_t >> requests_;
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
@@ -0,0 +1,173 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/io/parallel_chunk_reader.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Record Boundaries
+// =================================================================================================
+
+size_t fasta_record_boundary( char const* data, size_t size )
+{
+    // Search backwards for the last '>' at the beginning of a line. The first char is
+    // the beginning of the first record, and hence not a boundary.
+    for( size_t pos = size; pos > 1; --pos ) {
+        if( data[ pos - 1 ] == '>' && data[ pos - 2 ] == '\n' ) {
+            return pos - 1;
+        }
+    }
+    return 0;
+}
+
+size_t newick_record_boundary( char const* data, size_t size )
+{
+    // We need to scan forward, as quotes and comments can only be recognized from their start.
+    // This mirrors the lexing of the NewickReader: Quoted strings and comments are read
+    // until their closing char, without any escaping.
+    size_t result  = 0;
+    char   closing = '\0';
+    for( size_t pos = 0; pos < size; ++pos ) {
+        char const c = data[ pos ];
+        if( closing != '\0' ) {
+            if( c == closing ) {
+                closing = '\0';
+            }
+        } else if( c == ';' ) {
+            result = pos + 1;
+        } else if( c == '\'' || c == '"' ) {
+            closing = c;
+        } else if( c == '[' ) {
+            closing = ']';
+        }
+    }
+    return result;
+}
+
+std::function< size_t( char const*, size_t ) > csv_record_boundary(
+    std::string const& quotation_chars,
+    std::string const& separator_chars,
+    std::string const& comment_chars,
+    bool use_escapes
+) {
+    // Prepare lookups of the chars that can change the state of the scanning.
+    enum : unsigned char { kNone, kQuote, kSeparator, kNewLine, kEscape };
+    std::array< unsigned char, 256 > kind;
+    std::array< bool, 256 > comment;
+    kind.fill( kNone );
+    comment.fill( false );
+    for( auto c : comment_chars ) {
+        comment[ static_cast< unsigned char >( c ) ] = true;
+    }
+    for( auto c : separator_chars ) {
+        kind[ static_cast< unsigned char >( c ) ] = kSeparator;
+    }
+    for( auto c : quotation_chars ) {
+        kind[ static_cast< unsigned char >( c ) ] = kQuote;
+    }
+    kind[ static_cast< unsigned char >( '\n' ) ] = kNewLine;
+    if( use_escapes ) {
+        kind[ static_cast< unsigned char >( '\\' ) ] = kEscape;
+    }
+
+    // This mirrors the parsing of the CsvReader: Quoted strings can occur anywhere in a field,
+    // and can contain new line chars. With escapes, any char after a backslash is taken literally.
+    // Comments are recognized at the start of fields, and skipped until the end of the line.
+    // If they do not start at the beginning of a row, the row continues in the next line.
+    return [ kind, comment ]( char const* data, size_t size ){
+        size_t result      = 0;
+        char   closing     = '\0';
+        bool   field_start = true;
+        bool   row_start   = true;
+
+        for( size_t pos = 0; pos < size; ++pos ) {
+            char const c = data[ pos ];
+            auto const k = kind[ static_cast< unsigned char >( c ) ];
+
+            // Inside of quotes, only the closing char and escapes are of interest.
+            if( closing != '\0' ) {
+                if( k == kEscape ) {
+                    ++pos;
+                } else if( c == closing ) {
+                    closing = '\0';
+                }
+                continue;
+            }
+
+            // Comment chars can also be part of other sets, so we check them first.
+            if( field_start && comment[ static_cast< unsigned char >( c ) ] ) {
+                auto const nl = std::find( data + pos, data + size, '\n' );
+                if( nl == data + size ) {
+                    break;
+                }
+                pos = static_cast< size_t >( nl - data );
+                if( row_start ) {
+                    result = pos + 1;
+                }
+                continue;
+            }
+
+            switch( k ) {
+                case kNewLine:
+                    result      = pos + 1;
+                    field_start = true;
+                    row_start   = true;
+                    break;
+                case kSeparator:
+                    field_start = true;
+                    row_start   = false;
+                    break;
+                case kQuote:
+                    closing     = c;
+                    field_start = false;
+                    row_start   = false;
+                    break;
+                case kEscape:
+                    ++pos;
+                    field_start = false;
+                    row_start   = false;
+                    break;
+                default:
+                    field_start = false;
+                    row_start   = false;
+                    break;
+            }
+        }
+        return result;
+    };
+}
+
+} // namespace utils
+} // namespace genesis
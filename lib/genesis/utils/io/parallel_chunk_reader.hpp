@@ -0,0 +1,422 @@
+#ifndef GENESIS_UTILS_IO_PARALLEL_CHUNK_READER_H_
+#define GENESIS_UTILS_IO_PARALLEL_CHUNK_READER_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/char_search.hpp"
+#include "genesis/utils/io/input_source.hpp"
+#include "genesis/utils/io/input_stream.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef GENESIS_PTHREADS
+#    include "genesis/utils/core/options.hpp"
+#    include "genesis/utils/core/thread_pool.hpp"
+
+#    include <deque>
+#    include <future>
+#endif
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Record Boundaries
+// =================================================================================================
+
+/**
+ * @brief Record boundary function for Fasta data: Records start with a `>` at the beginning
+ * of a line.
+ *
+ * See ParallelChunkReader::boundary_function for details.
+ */
+size_t fasta_record_boundary( char const* data, size_t size );
+
+/**
+ * @brief Record boundary function for lists of Newick trees: Records end after a `;` that is
+ * neither part of a quoted string (`'...'` or `"..."`) nor of a comment (`[...]`).
+ *
+ * See ParallelChunkReader::boundary_function for details.
+ */
+size_t newick_record_boundary( char const* data, size_t size );
+
+/**
+ * @brief Return a record boundary function for CSV data: Records end after a new line char that
+ * is not part of a quoted string.
+ *
+ * The chars and the `use_escapes` setting need to be the settings of the CsvReader that is used
+ * for parsing the data, so that quoted strings and comments are recognized in the same way.
+ * See ParallelChunkReader::boundary_function for details.
+ */
+std::function< size_t( char const*, size_t ) > csv_record_boundary(
+    std::string const& quotation_chars = "\"",
+    std::string const& separator_chars = ",",
+    std::string const& comment_chars   = "",
+    bool               use_escapes     = false
+);
+
+// =================================================================================================
+//     Parallel Chunk Reader
+// =================================================================================================
+
+/**
+ * @brief Read an input in large chunks that are parsed in parallel, while the results are
+ * processed in input order.
+ *
+ * Many formats consist of a list of independent records (e.g., Fasta sequences, Newick trees,
+ * or lines of CSV data). This class reads such an input in chunks of about chunk_size() bytes.
+ * Each chunk is cut at the last record boundary within it, as found by the boundary_function,
+ * so that every chunk only contains complete records. The rest is carried over to the next
+ * chunk. The chunks are then parsed on the threads of the thread_pool(), each with its own
+ * InputStream, while the calling thread continues reading. Finally, the results of parsing the
+ * chunks are handed to a consumer function in the order of the input.
+ *
+ * Exemplary usage, for reading Fasta sequences:
+ *
+ *     ParallelChunkReader reader( fasta_record_boundary );
+ *     reader.read<SequenceSet>(
+ *         utils::from_file( file_name ),
+ *         [&]( InputStream& it ) {
+ *             return FastaReader().parse_document( it );
+ *         },
+ *         [&]( SequenceSet& chunk ) {
+ *             // Use the sequences of the chunk.
+ *         }
+ *     );
+ *
+ * Errors in the parse function are thrown by read(), in input order. Their InputStream positions
+ * are relative to the start of the chunk, whose first line is given in the source name.
+ *
+ * If threading is not available (that is, if the `GENESIS_PTHREADS` macro definition is not set),
+ * the chunks are parsed one after another by the calling thread.
+ */
+class ParallelChunkReader
+{
+public:
+
+    // -------------------------------------------------------------
+    //     Member Types
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Function type that finds the last record boundary in a chunk of data.
+     *
+     * The function is called with data that starts at the beginning of a record. It has to return
+     * the position directly after the last complete record in the data, that is, where the next
+     * record starts. If there is no such position after the first record, it has to return `0`;
+     * the chunk is then extended until a boundary is found.
+     */
+    using boundary_function = std::function< size_t( char const* data, size_t size ) >;
+
+    /**
+     * @brief Default size of the chunks, 16MB.
+     */
+    static const size_t ChunkSize = 1 << 24;
+
+    // -------------------------------------------------------------
+    //     Constructors and Rule of Five
+    // -------------------------------------------------------------
+
+    explicit ParallelChunkReader( boundary_function boundary, size_t chunk_size = ChunkSize )
+        : boundary_( boundary )
+        , chunk_size_( chunk_size )
+    {
+        if( ! boundary_ || chunk_size_ == 0 ) {
+            throw std::invalid_argument(
+                "ParallelChunkReader needs a boundary function and a chunk size of at least one."
+            );
+        }
+    }
+
+    ~ParallelChunkReader() = default;
+
+    ParallelChunkReader( ParallelChunkReader const& ) = default;
+    ParallelChunkReader( ParallelChunkReader&& )      = default;
+
+    ParallelChunkReader& operator= ( ParallelChunkReader const& ) = default;
+    ParallelChunkReader& operator= ( ParallelChunkReader&& )      = default;
+
+    // -------------------------------------------------------------
+    //     Settings
+    // -------------------------------------------------------------
+
+    size_t chunk_size() const
+    {
+        return chunk_size_;
+    }
+
+    ParallelChunkReader& chunk_size( size_t value )
+    {
+        if( value == 0 ) {
+            throw std::invalid_argument(
+                "ParallelChunkReader needs a chunk size of at least one."
+            );
+        }
+        chunk_size_ = value;
+        return *this;
+    }
+
+#ifdef GENESIS_PTHREADS
+
+    /**
+     * @brief Return the thread pool that is used for parsing the chunks.
+     *
+     * This is the process-wide @link Options::thread_pool() Options::get().thread_pool()@endlink,
+     * with @link Options::number_of_threads() Options::get().number_of_threads()@endlink many
+     * threads.
+     */
+    static ThreadPool& thread_pool()
+    {
+        return Options::get().thread_pool();
+    }
+
+#endif
+
+    // -------------------------------------------------------------
+    //     Reading
+    // -------------------------------------------------------------
+
+    /**
+     * @brief Read the input source in chunks, parse them with `parse`, and call `consume` with
+     * the results, in the order of the input.
+     *
+     * The `parse` function is called concurrently for different chunks, and hence must not
+     * modify shared state without synchronization. The `consume` function is only called by the
+     * calling thread.
+     */
+    template< class T >
+    void read(
+        std::unique_ptr< BaseInputSource > input_source,
+        std::function< T( InputStream& ) > const& parse,
+        std::function< void( T& ) > const& consume
+    ) const {
+        if( ! input_source ) {
+            throw std::invalid_argument( "ParallelChunkReader needs an input source." );
+        }
+
+        #ifdef GENESIS_PTHREADS
+
+        // If we are run by a task of the pool ourselves, waiting for other tasks of the pool
+        // could dead-lock it. Parse in this thread instead.
+        if( ! thread_pool().is_worker_thread() ) {
+
+            // Keep enough chunks in flight to keep all threads busy,
+            // while the oldest ones are waiting to be consumed.
+            auto& pool = thread_pool();
+            size_t const max_pending = 2 * pool.size();
+            std::deque< std::future< T >> pending;
+
+            auto consume_front = [&](){
+                auto result = pending.front().get();
+                pending.pop_front();
+                consume( result );
+            };
+
+            try {
+                split_( *input_source, [&]( std::shared_ptr< Chunk > chunk ){
+                    if( pending.size() >= max_pending ) {
+                        consume_front();
+                    }
+                    pending.push_back( pool.enqueue( [chunk, &parse](){
+                        auto source = utils::make_unique< ChunkInputSource >( std::move( *chunk ));
+                        InputStream it( std::move( source ));
+                        return parse( it );
+                    }));
+                });
+                while( ! pending.empty() ) {
+                    consume_front();
+                }
+            } catch( ... ) {
+                // The tasks use the parse function, so we have to wait for them before leaving.
+                for( auto& future : pending ) {
+                    if( future.valid() ) {
+                        future.wait();
+                    }
+                }
+                throw;
+            }
+            return;
+        }
+
+        #endif
+
+        split_( *input_source, [&]( std::shared_ptr< Chunk > chunk ){
+            InputStream it( utils::make_unique< ChunkInputSource >( std::move( *chunk )));
+            auto result = parse( it );
+            consume( result );
+        });
+    }
+
+    // -------------------------------------------------------------
+    //     Internal Members
+    // -------------------------------------------------------------
+
+private:
+
+    /**
+     * @brief Data of one chunk, with one more byte than needed for the records, so that
+     * an InputStream can directly work on it, see BaseInputSource::mapped_data().
+     */
+    struct Chunk
+    {
+        std::unique_ptr< char[] > data;
+        size_t                    size;
+        std::string               name;
+    };
+
+    /**
+     * @brief Input source that offers the data of a Chunk to an InputStream, without copying.
+     */
+    class ChunkInputSource : public BaseInputSource
+    {
+    public:
+
+        explicit ChunkInputSource( Chunk&& chunk )
+            : chunk_( std::move( chunk ))
+            , pos_( 0 )
+        {}
+
+    private:
+
+        size_t read_( char* buffer, size_t size ) override
+        {
+            size = std::min( size, chunk_.size - pos_ );
+            std::memcpy( buffer, chunk_.data.get() + pos_, size );
+            pos_ += size;
+            return size;
+        }
+
+        std::string source_name_() const override
+        {
+            return chunk_.name;
+        }
+
+        bool is_mapped_() const override
+        {
+            return true;
+        }
+
+        std::pair< char*, size_t > mapped_data_() override
+        {
+            return { chunk_.data.get(), chunk_.size };
+        }
+
+        Chunk  chunk_;
+        size_t pos_;
+    };
+
+    /**
+     * @brief Read from the source until `size` bytes are read or the source is exhausted.
+     */
+    static size_t read_fully_( BaseInputSource& source, char* buffer, size_t size )
+    {
+        size_t done = 0;
+        while( done < size ) {
+            auto const got = source.read( buffer + done, size - done );
+            if( got == 0 ) {
+                break;
+            }
+            done += got;
+        }
+        return done;
+    }
+
+    /**
+     * @brief Split the input into chunks that end at record boundaries, and hand them to the
+     * `dispatch` function in input order.
+     */
+    template< class Dispatch >
+    void split_( BaseInputSource& source, Dispatch dispatch ) const
+    {
+        auto const source_name = source.source_name();
+        std::string carry;
+        size_t line = 1;
+
+        while( true ) {
+
+            // Usually, we read one chunk size of data. If the previous chunk did not contain
+            // a boundary, we double the size instead, to avoid quadratic effort for long records.
+            size_t const carry_size = carry.size();
+            size_t const read_size  = std::max( chunk_size_, carry_size );
+            std::unique_ptr< char[] > data( new char[ carry_size + read_size + 1 ] );
+            std::memcpy( data.get(), carry.data(), carry_size );
+            auto const got  = read_fully_( source, data.get() + carry_size, read_size );
+            auto const size = carry_size + got;
+            bool const end  = got < read_size;
+
+            // Find the end of the last complete record. If there is none, read more.
+            size_t cut = size;
+            if( ! end ) {
+                cut = boundary_( data.get(), size );
+                if( cut == 0 ) {
+                    carry.assign( data.get(), size );
+                    continue;
+                }
+                if( cut > size ) {
+                    throw std::runtime_error( "Invalid record boundary in ParallelChunkReader." );
+                }
+            }
+            carry.assign( data.get() + cut, size - cut );
+
+            if( cut > 0 ) {
+                auto chunk = std::make_shared< Chunk >();
+                chunk->name  = source_name;
+                chunk->name += " (chunk starting at line " + std::to_string( line ) + ")";
+                line += count_chars( data.get(), data.get() + cut, '\n' );
+                chunk->data = std::move( data );
+                chunk->size = cut;
+                dispatch( std::move( chunk ));
+            }
+            if( end ) {
+                break;
+            }
+        }
+    }
+
+    // -------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------
+
+    boundary_function boundary_;
+    size_t            chunk_size_;
+};
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
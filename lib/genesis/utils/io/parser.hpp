@@ -37,6 +37,8 @@
 #include <cctype>
 #include <limits>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
 
 namespace genesis {
 namespace utils {
@@ -136,10 +138,59 @@ T parse_integer( utils::InputStream& source )
     return parse_signed_integer<T>(source);
 }
 
+// =================================================================================================
+//     General Number String
+// =================================================================================================
+
+/**
+ * @brief Read a general number string from an input stream.
+ *
+ * The function reads from the input as long as it is a valid number of the format
+ *
+ *     [+-][123][.456][eE[+-]789]
+ *
+ * and returns this string. This is useful for intermediately parsing a number and then checking
+ * whether it is valid. Use parse_float() to turn such a number string into an actual float/double.
+ */
+std::string parse_number_string(
+    utils::InputStream& source
+);
+
 // =================================================================================================
 //     Float
 // =================================================================================================
 
+/**
+ * @brief Parse a floating point number from a range of chars.
+ *
+ * The number is expected to be in the following format, starting at `first`:
+ *
+ *     [+-][123][.456][eE[+-]789]
+ *
+ * with at least one digit before the exponential part, and at least one digit after the
+ * decimal dot, if present. The parsing stops at the first char that does not fit, or at `last`.
+ * The function returns a pointer to that char, and stores the parsed number in `value`.
+ * If there is no valid number at `first`, the function returns `first`, and `value` is not
+ * changed. If the exponent (the part after the 'E') does not fit into the value range of `int`,
+ * an `std::overflow_error` or `underflow_error` is thrown.
+ *
+ * The conversion does not depend on the locale, and is correctly rounded, that is, it yields the
+ * closest representable value (ties to even), just as `std::strtod()` in the "C" locale does.
+ * Exponents that are too large or too small yield infinity or zero, respectively. The parsing uses
+ * the algorithm by Clinger for simple cases, and the Eisel-Lemire algorithm otherwise, see
+ *
+ * > D. Lemire, "Number Parsing at a Gigabyte per Second",
+ * > Software: Practice and Experience 51 (8), 2021.
+ *
+ * The rare cases that these cannot decide are handed to the standard library.
+ */
+char const* parse_float( char const* first, char const* last, double& value );
+
+/**
+ * @copydoc parse_float( char const*, char const*, double& )
+ */
+char const* parse_float( char const* first, char const* last, float& value );
+
 /**
  * @brief Read a floating point number from a stream and return it.
  *
@@ -147,122 +198,51 @@ T parse_integer( utils::InputStream& source )
  *
  *     [+-][123][.456][eE[+-]789]
  *
- * The function stops reading at the first non-fitting digit.
- * It throws an `std::overflow_error` or `underflow_error` in case that the exponent (the part
- * after the 'E') does not fit into integer value range.
+ * The function stops reading at the first non-fitting char. If there is no valid number at the
+ * current position of the stream, it throws an `std::runtime_error`. It throws an
+ * `std::overflow_error` or `underflow_error` in case that the exponent (the part after the 'E')
+ * does not fit into integer value range.
+ *
+ * The number is parsed directly from the buffer of the stream, using
+ * @link parse_float( char const*, char const*, double& ) parse_float()@endlink for char ranges.
+ * It is thus correctly rounded and locale-independent. Types other than `float` are parsed as
+ * `double`.
  */
 template<class T>
 T parse_float( utils::InputStream& source )
 {
-    T x = 0.0;
-
     if( !source ) {
         throw std::runtime_error(
             "Expecting float number in " + source.source_name() + " at " + source.at() + "."
         );
     }
 
-    // Sign
-    bool is_neg = false;
-    if( *source == '-' ){
-        is_neg = true;
-        ++source;
-    } else if( *source == '+' ) {
-        ++source;
-    }
-
-    // Integer Part
-    bool found_mantisse = false;
-    while( source && isdigit( *source )) {
-        int y = *source - '0';
-        x *= 10;
-        x += y;
-        ++source;
-        found_mantisse = true;
-    }
-
-    // Decimal part
-    if( source && *source == '.' ) {
-        ++source;
-
-        if( ! source || ! isdigit( *source ) ) {
-            throw std::runtime_error(
-                "Invalid float number in " + source.source_name() + " at " + source.at() + "."
-            );
-        }
-
-        T pos = 1.0;
-        while( source && isdigit( *source )) {
-            pos /= 10.0;
-            int y = *source - '0';
-            x += y * pos;
-            ++source;
-            found_mantisse = true;
-        }
+    using ParseType = typename std::conditional<
+        std::is_same< T, float >::value, float, double
+    >::type;
+    ParseType value;
+
+    // Parse directly from the buffer, and move past the number.
+    auto const view = source.buffer();
+    auto const end  = view.first + view.second;
+    auto const pos  = parse_float( view.first, end, value );
+    if( pos != view.first && pos != end ) {
+        source.jump_unchecked( static_cast< size_t >( pos - view.first ));
+        return static_cast< T >( value );
     }
 
-    // We need to have some digits before the exponential part.
-    if( ! found_mantisse ) {
+    // If the number is invalid, or might continue beyond the buffered data, we take the slow
+    // route of reading it char by char first.
+    auto const str     = parse_number_string( source );
+    auto const str_end = str.data() + str.size();
+    if( str.empty() || parse_float( str.data(), str_end, value ) != str_end ) {
         throw std::runtime_error(
             "Invalid float number in " + source.source_name() + " at " + source.at() + "."
         );
     }
-
-    // Exponential part
-    if( source && tolower(*source) == 'e' ) {
-        ++source;
-
-        // Read the exp. If there are no digits, this throws.
-        int e = parse_signed_integer<int>( source );
-
-        if( e != 0 ) {
-            T base;
-            if( e < 0 ) {
-                base = 0.1;
-                e = -e;
-            } else {
-                base = 10;
-            }
-
-            while( e != 1 ) {
-                if( ( e & 1 ) == 0 ) {
-                    base = base * base;
-                    e >>= 1;
-                } else {
-                    x *= base;
-                    --e;
-                }
-            }
-            x *= base;
-        }
-    }
-
-    // Sign
-    if (is_neg) {
-        x = -x;
-    }
-
-    return x;
+    return static_cast< T >( value );
 }
 
-// =================================================================================================
-//     General Number String
-// =================================================================================================
-
-/**
- * @brief Read a general number string from an input stream.
- *
- * The function reads from the input as long as it is a valid number of the format
- *
- *     [+-][123][.456][eE[+-]789]
- *
- * and returns this string. This is useful for intermediately parsing a number and then checking
- * whether it is valid. Use parse_float() to turn such a number string into an actual float/double.
- */
-std::string parse_number_string(
-    utils::InputStream& source
-);
-
 // =================================================================================================
 //     String
 // =================================================================================================
@@ -31,10 +31,13 @@
  * @ingroup utils
  */
 
+#include "genesis/utils/io/input_stream.hpp"
+
 #include <assert.h>
 #include <cctype>
 #include <functional>
 #include <stdexcept>
+#include <string>
 
 namespace genesis {
 namespace utils {
@@ -278,6 +281,135 @@ inline std::string read_until(
     return target;
 }
 
+// -------------------------------------------------------------------------
+//     InputStream overloads
+// -------------------------------------------------------------------------
+
+/*
+ * The following overloads are chosen instead of the generic functions above when scanning
+ * an InputStream. They use the bulk operations of the stream, which search whole buffer blocks
+ * at a time, instead of advancing char by char. The results are the same.
+ */
+
+/**
+ * @brief Lexing function that advances the stream to the end of the line, i.e., to the new line
+ * char. Overload for InputStream that uses its bulk scanning.
+ */
+inline void skip_to_end_of_line(
+    InputStream&            source
+) {
+    source.skip_until( '\n' );
+}
+
+/**
+ * @brief Lexing function that reads until the end of the line (i.e., to the new line char),
+ * and returns the read chars (excluding the new line char). Overload for InputStream that uses
+ * its bulk scanning.
+ */
+inline std::string read_to_end_of_line(
+    InputStream&            source
+) {
+    std::string target;
+    source.read_until( '\n', target );
+    return target;
+}
+
+/**
+ * @brief Lexing function that advances the stream while its current char equals the provided one.
+ * Overload for InputStream that uses its bulk scanning.
+ */
+inline void skip_while(
+    InputStream&            source,
+    char                    criterion
+) {
+    source.skip_while( criterion );
+}
+
+/**
+ * @brief Lexing function that advances the stream while its current char fulfills the provided
+ * criterion. Overload for InputStream that uses its bulk scanning.
+ */
+inline void skip_while(
+    InputStream&               source,
+    std::function<bool (char)> criterion
+) {
+    source.skip_while( criterion );
+}
+
+/**
+ * @brief Lexing function that advances the stream until its current char equals the provided one.
+ * Overload for InputStream that uses its bulk scanning.
+ */
+inline void skip_until(
+    InputStream&            source,
+    char                    criterion
+) {
+    source.skip_until( criterion );
+}
+
+/**
+ * @brief Lexing function that advances the stream until its current char fulfills the provided
+ * criterion. Overload for InputStream that uses its bulk scanning.
+ */
+inline void skip_until(
+    InputStream&               source,
+    std::function<bool (char)> criterion
+) {
+    source.skip_until( criterion );
+}
+
+/**
+ * @brief Lexing function that reads from the stream while its current char equals the provided one.
+ * The read chars are returned. Overload for InputStream that uses its bulk scanning.
+ */
+inline std::string read_while(
+    InputStream&            source,
+    char                    criterion
+) {
+    std::string target;
+    source.read_while( criterion, target );
+    return target;
+}
+
+/**
+ * @brief Lexing function that reads from the stream while its current char fulfills the provided
+ * criterion. The read chars are returned. Overload for InputStream that uses its bulk scanning.
+ */
+inline std::string read_while(
+    InputStream&               source,
+    std::function<bool (char)> criterion
+) {
+    std::string target;
+    source.read_while( criterion, target );
+    return target;
+}
+
+/**
+ * @brief Lexing function that reads from the stream until its current char equals the provided one.
+ * The read chars are returned. Overload for InputStream that uses its bulk scanning.
+ */
+inline std::string read_until(
+    InputStream&            source,
+    char                    criterion
+) {
+    std::string target;
+    source.read_until( criterion, target );
+    return target;
+}
+
+/**
+ * @brief Lexing function that reads from the stream until its current char fulfills the provided
+ * criterion. The read chars are returned. Overload for InputStream that uses its bulk scanning.
+ */
+inline std::string read_until(
+    InputStream&               source,
+    std::function<bool (char)> criterion
+) {
+    std::string target;
+    source.read_until( criterion, target );
+    return target;
+}
+
 // -------------------------------------------------------------------------
 //     read char
 // -------------------------------------------------------------------------
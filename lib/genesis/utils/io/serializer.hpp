@@ -31,18 +31,24 @@
  * @ingroup utils
  */
 
+#include "genesis/utils/core/options.hpp"
 #include "genesis/utils/core/std.hpp"
 #include "genesis/utils/io/input_buffer.hpp"
-#include "genesis/utils/io/input_reader.hpp"
 #include "genesis/utils/io/input_source.hpp"
-#include "genesis/utils/io/output_stream.hpp"
+#include "genesis/utils/io/output_target.hpp"
+#include "genesis/utils/math/matrix.hpp"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
-#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace genesis {
 namespace utils {
@@ -52,58 +58,122 @@ namespace utils {
 // =================================================================================================
 
 /**
- * @brief
+ * @brief Write binary data to an @link BaseOutputTarget OutputTarget@endlink, which can later be
+ * read by a Deserializer.
+ *
+ * All data is collected in an internal buffer, and only handed to the target in large chunks.
+ * Call close() (or destroy the object) to write the remaining data; only close() reports errors.
+ *
+ * Numbers are stored in a machine-independent format: Integers and floating point numbers (IEEE
+ * 754) are stored in little endian byte order. Furthermore, put_varint() stores integers in a
+ * compact variable length encoding, where small numbers only take one byte. Arrays of numbers
+ * are stored contiguously by put_array(), aligned to the size of their elements, relative to the
+ * start of the output. This allows a Deserializer on a memory mapped file to directly hand out
+ * pointers to the data, see Deserializer::get_array_view().
  */
 class Serializer
 {
 public:
 
+    // -------------------------------------------------------------------------
+    //     Member Types
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Size of the internal buffer.
+     */
+    static const size_t BufferSize = 1 << 16;
+
     // -------------------------------------------------------------------------
     //     Constructor and Destructor
     // -------------------------------------------------------------------------
 
-    Serializer (const std::string& filename) :
-        outstream (outfile)
-    {
-        utils::file_output_stream( filename, outfile, std::ofstream::out | std::ofstream::binary );
-    };
+    /**
+     * @brief Construct a Serializer that writes to a file.
+     *
+     * As with FileOutputTarget, this throws if the file already exists, unless
+     * @link Options::allow_file_overwriting( bool ) Options::allow_file_overwriting()@endlink
+     * is activated.
+     */
+    explicit Serializer( std::string const& file_name )
+        : Serializer( utils::make_unique< FileOutputTarget >( file_name ))
+    {}
 
-    Serializer (std::ostream& outstream) :
-        outstream (outstream)
-    {};
+    /**
+     * @brief Construct a Serializer that writes to an output stream.
+     */
+    explicit Serializer( std::ostream& outstream )
+        : Serializer( utils::make_unique< StreamOutputTarget >( outstream ))
+    {}
+
+    /**
+     * @brief Construct a Serializer that writes to an
+     * @link BaseOutputTarget OutputTarget@endlink, for example a GzipOutputTarget.
+     */
+    explicit Serializer( std::unique_ptr< BaseOutputTarget > target )
+        : target_( std::move( target ))
+        , buffer_( BufferSize )
+        , buffer_pos_( 0 )
+        , written_( 0 )
+    {
+        if( ! target_ ) {
+            throw std::invalid_argument( "Creating Serializer without output target." );
+        }
+    }
 
     ~Serializer()
     {
-        outfile.close();
+        try {
+            close();
+        } catch( ... ) {
+            // Destructors must not throw. Use close() to be informed about errors.
+        }
     }
 
+    Serializer( Serializer const& ) = delete;
+    Serializer( Serializer&& )      = delete;
+
+    Serializer& operator= ( Serializer const& ) = delete;
+    Serializer& operator= ( Serializer&& )      = delete;
+
     // -------------------------------------------------------------------------
     //     Stream Status
     // -------------------------------------------------------------------------
 
+    // Errors while writing are reported via exceptions. Hence, the status only tells whether
+    // the Serializer is still open for writing.
+
     inline operator bool() const
     {
-        return !outstream.fail();
+        return target_ != nullptr;
     }
 
     inline bool good() const
     {
-        return outstream.good();
+        return target_ != nullptr;
     }
 
     inline bool eof() const
     {
-        return outstream.eof();
+        return false;
     }
 
     inline bool fail() const
     {
-        return outstream.fail();
+        return target_ == nullptr;
     }
 
     inline bool bad() const
     {
-        return outstream.bad();
+        return target_ == nullptr;
+    }
+
+    /**
+     * @brief Return the number of bytes written so far, including those that are still buffered.
+     */
+    inline size_t bytes_written() const
+    {
+        return written_;
     }
 
     // -------------------------------------------------------------------------
@@ -112,17 +182,33 @@ public:
 
     inline bool is_open() const
     {
-        return outfile.is_open();
+        return target_ != nullptr;
     }
 
+    /**
+     * @brief Write all buffered data to the output target, and flush the target.
+     */
     inline void flush()
     {
-        outfile.flush();
+        write_buffer_();
+        target_->flush();
     }
 
+    /**
+     * @brief Write all buffered data, and finish the output target. Throws on errors.
+     *
+     * Afterwards, no more data can be written. Calling this function again has no effect.
+     */
     inline void close()
     {
-        outfile.close();
+        if( ! target_ ) {
+            return;
+        }
+        write_buffer_();
+
+        // Release the target first, so that we are closed even if finishing throws.
+        auto target = std::move( target_ );
+        target->finish();
     }
 
     // -------------------------------------------------------------------------
@@ -134,10 +220,12 @@ public:
      */
     void put_null (const size_t n)
     {
-        char* buffer = new char[n];
-        std::fill(buffer, buffer+n, '\0');
-        outstream.write (buffer, n);
-        delete[] buffer;
+        size_t rest = n;
+        while( rest > 0 ) {
+            size_t const len = rest < BufferSize ? rest : BufferSize;
+            std::memset( reserve_( len ), 0, len );
+            rest -= len;
+        }
     }
 
     /**
@@ -145,7 +233,14 @@ public:
      */
     void put_raw( char const* data, size_t n )
     {
-        outstream.write (data, n);
+        // Small data is collected in the buffer, large data is directly written to the target.
+        if( n <= BufferSize ) {
+            std::memcpy( reserve_( n ), data, n );
+        } else {
+            write_buffer_();
+            target_->write( data, n );
+            written_ += n;
+        }
     }
 
     /**
@@ -153,7 +248,7 @@ public:
      */
     void put_raw_string (const std::string& v)
     {
-        outstream.write (v.c_str(), v.length());
+        put_raw( v.c_str(), v.length() );
     }
 
     /**
@@ -168,44 +263,217 @@ public:
 
     /**
      * @brief Write plain data to the stream, by casting it to a char array.
+     *
+     * This writes the bytes as they are in memory, and is hence not machine-independent.
+     * Use put_int() and put_float() for numbers instead.
      */
     template<typename T>
     void put_plain (const T v)
     {
-        outstream.write((char*)(&v), sizeof(v));
+        put_raw( reinterpret_cast< char const* >( &v ), sizeof(v) );
     }
 
     /**
-     * @brief Write an integer number to the stream.
-     *
-     * Currently, this simply uses put_plain(), but future versions might change this behaviour and
-     * use specific conversions (litte/big endianness, signed/unsigned) before writing.
+     * @brief Write an integer number to the stream, using `sizeof(T)` bytes in little endian order.
      */
     template<typename T>
     void put_int (const T v)
     {
-        put_plain(v);
+        static_assert( std::is_integral<T>::value, "Serializer::put_int() needs an integer type." );
+        using U = typename std::make_unsigned<T>::type;
+        store_little_endian_( reserve_( sizeof(T) ), static_cast<U>( v ));
     }
 
     /**
-     * @brief Write a floating point number to the stream.
-     *
-     * Currently, this simply uses put_plain(), but future versions might change this behaviour and
-     * convert it to some machine-independent format.
+     * @brief Write a floating point number to the stream, using its IEEE 754 representation
+     * in little endian order.
      */
     template<typename T>
     void put_float (const T v)
     {
-        put_plain(v);
+        using U = typename float_bits_<T>::type;
+        U bits;
+        std::memcpy( &bits, &v, sizeof(T) );
+        store_little_endian_( reserve_( sizeof(T) ), bits );
+    }
+
+    /**
+     * @brief Write an integer number to the stream, using a variable length encoding.
+     *
+     * Each byte stores seven bits of the number, starting with the least significant ones,
+     * and uses its highest bit to indicate whether more bytes follow (LEB128). Negative numbers
+     * are first mapped to positive ones (zig-zag encoding), so that numbers close to zero take
+     * few bytes, independently of their sign. Use get_varint() with the same type to read it.
+     */
+    template<typename T>
+    void put_varint (const T v)
+    {
+        static_assert(
+            std::is_integral<T>::value && sizeof(T) <= 8,
+            "Serializer::put_varint() needs an integer type of up to 64 bits."
+        );
+        auto value = zigzag_encode_( v );
+
+        // Make sure that the longest possible encoding fits into the buffer,
+        // and only count the bytes that we actually used.
+        auto const ptr = reserve_( 10 );
+        size_t len = 0;
+        while( value >= 0x80 ) {
+            ptr[ len++ ] = static_cast<char>( static_cast<unsigned char>( value | 0x80 ));
+            value >>= 7;
+        }
+        ptr[ len++ ] = static_cast<char>( static_cast<unsigned char>( value ));
+        buffer_pos_ -= 10 - len;
+        written_    -= 10 - len;
+    }
+
+    /**
+     * @brief Write a vector of numbers to the stream, as one contiguous block.
+     *
+     * The size is written as a varint, followed by zero bytes for aligning the numbers to their
+     * size (relative to the start of the output), followed by the numbers in little endian order.
+     * Use Deserializer::get_array() or Deserializer::get_array_view() to read it.
+     */
+    template<typename T>
+    void put_array( std::vector<T> const& v )
+    {
+        put_varint( v.size() );
+        put_array_data_( v.data(), v.size() );
+    }
+
+    /**
+     * @brief Write a Matrix of numbers to the stream, as one contiguous block.
+     *
+     * The number of rows and columns are written as varints, followed by the data as in
+     * put_array() for vectors.
+     */
+    template<typename T>
+    void put_array( Matrix<T> const& m )
+    {
+        put_varint( m.rows() );
+        put_varint( m.cols() );
+        put_array_data_( m.size() > 0 ? &*m.begin() : nullptr, m.size() );
+    }
+
+    // -------------------------------------------------------------------------
+    //     Internal Helpers
+    // -------------------------------------------------------------------------
+
+private:
+
+    template<typename T>
+    struct float_bits_
+    {
+        static_assert(
+            std::is_floating_point<T>::value && std::numeric_limits<T>::is_iec559 &&
+            ( sizeof(T) == 4 || sizeof(T) == 8 ),
+            "Serializer::put_float() needs an IEEE 754 float or double."
+        );
+        using type = typename std::conditional< sizeof(T) == 4, uint32_t, uint64_t >::type;
+    };
+
+    template<typename U>
+    static void store_little_endian_( char* target, U value )
+    {
+        // Compilers turn this into a single store on little endian systems.
+        for( size_t i = 0; i < sizeof(U); ++i ) {
+            target[i] = static_cast<char>( static_cast<unsigned char>( value >> ( 8 * i )));
+        }
+    }
+
+    template<typename T>
+    static typename std::enable_if< std::is_signed<T>::value, uint64_t >::type
+    zigzag_encode_( T v )
+    {
+        auto const u = static_cast<uint64_t>( static_cast<int64_t>( v ));
+        return ( u << 1 ) ^ ( v < 0 ? ~static_cast<uint64_t>( 0 ) : 0 );
+    }
+
+    template<typename T>
+    static typename std::enable_if< ! std::is_signed<T>::value, uint64_t >::type
+    zigzag_encode_( T v )
+    {
+        return static_cast<uint64_t>( v );
+    }
+
+    template<typename T>
+    typename std::enable_if< std::is_floating_point<T>::value >::type
+    put_value_( T v )
+    {
+        put_float( v );
+    }
+
+    template<typename T>
+    typename std::enable_if< std::is_integral<T>::value >::type
+    put_value_( T v )
+    {
+        put_int( v );
+    }
+
+    template<typename T>
+    void put_array_data_( T const* data, size_t size )
+    {
+        static_assert(
+            std::is_arithmetic<T>::value && ! std::is_same<T, bool>::value,
+            "Serializer::put_array() needs a number type."
+        );
+
+        // Align the data to the size of the elements, so that a mapped Deserializer can directly
+        // use it. On little endian systems, the data is already in the correct byte order.
+        auto const misalign = written_ % sizeof(T);
+        if( misalign > 0 ) {
+            put_null( sizeof(T) - misalign );
+        }
+        if( Options::is_little_endian() ) {
+            put_raw( reinterpret_cast< char const* >( data ), size * sizeof(T) );
+        } else {
+            for( size_t i = 0; i < size; ++i ) {
+                put_value_( data[i] );
+            }
+        }
+    }
+
+    /**
+     * @brief Return a pointer to `n` bytes of buffer space, with `n <= BufferSize`, and account
+     * for them as written.
+     */
+    char* reserve_( size_t n )
+    {
+        if( buffer_pos_ + n > BufferSize ) {
+            write_buffer_();
+        } else if( ! target_ ) {
+            throw std::runtime_error( "Cannot write to closed Serializer." );
+        }
+
+        auto const ptr = buffer_.data() + buffer_pos_;
+        buffer_pos_ += n;
+        written_    += n;
+        return ptr;
+    }
+
+    /**
+     * @brief Hand the buffered data to the output target.
+     */
+    void write_buffer_()
+    {
+        if( ! target_ ) {
+            throw std::runtime_error( "Cannot write to closed Serializer." );
+        }
+        if( buffer_pos_ > 0 ) {
+            target_->write( buffer_.data(), buffer_pos_ );
+            buffer_pos_ = 0;
+        }
     }
 
     // -------------------------------------------------------------------------
     //     Data Members
     // -------------------------------------------------------------------------
 
-protected:
-    std::ofstream outfile;
-    std::ostream& outstream;
+    std::unique_ptr< BaseOutputTarget > target_;
+
+    std::vector<char> buffer_;
+    size_t            buffer_pos_;
+    size_t            written_;
 };
 
 // =================================================================================================
@@ -213,7 +481,17 @@ protected:
 // =================================================================================================
 
 /**
- * @brief
+ * @brief Read binary data that was written by a Serializer.
+ *
+ * The data is read from an @link BaseInputSource InputSource@endlink. If the source is memory
+ * mapped, for example when using an MmapInputSource, arrays that were written with
+ * Serializer::put_array() can be accessed without copying via get_array_view() and
+ * get_matrix_view():
+ *
+ *     Deserializer des( utils::make_unique< MmapInputSource >( file_name ));
+ *     auto const view = des.get_array_view<double>();
+ *
+ * The memory of such views belongs to the Deserializer, and stays valid as long as it exists.
  */
 class Deserializer
 {
@@ -225,6 +503,7 @@ public:
 
     Deserializer( std::string const& file_name )
         : buffer_( utils::make_unique< FileInputSource >( file_name ) )
+        , pos_( 0 )
     {
         if( ! buffer_ ) {
             throw std::runtime_error("Creating Deserializer from file failed.");
@@ -233,12 +512,22 @@ public:
 
     Deserializer( std::istream& instream )
         : buffer_( utils::make_unique< StreamInputSource >( instream ) )
+        , pos_( 0 )
     {
         if( ! buffer_ ) {
             throw std::runtime_error("Creating Deserializer from stream failed.");
         }
     }
 
+    explicit Deserializer( std::unique_ptr< BaseInputSource > input_source )
+        : buffer_( std::move( input_source ))
+        , pos_( 0 )
+    {
+        if( ! buffer_ ) {
+            throw std::runtime_error("Creating Deserializer from input source failed.");
+        }
+    }
+
     // -------------------------------------------------------------------------
     //     Stream Status
     // -------------------------------------------------------------------------
@@ -278,6 +567,22 @@ public:
         return ! buffer_;
     }
 
+    /**
+     * @brief Return whether the input is memory mapped, so that get_array_view() can be used.
+     */
+    inline bool is_mapped() const
+    {
+        return buffer_.is_mapped();
+    }
+
+    /**
+     * @brief Return the number of bytes read so far.
+     */
+    inline size_t bytes_read() const
+    {
+        return pos_;
+    }
+
     // -------------------------------------------------------------------------
     //     File Status
     // -------------------------------------------------------------------------
@@ -304,6 +609,7 @@ public:
     void get_raw(char* buffer, size_t n)
     {
         size_t const got = buffer_.read(buffer, n);
+        pos_ += got;
         if( got != n ) {
             throw std::runtime_error(
                 "Could only read " + std::to_string(got)  + " bytes instead of n=" +
@@ -317,15 +623,16 @@ public:
      */
     bool get_null (size_t n)
     {
-        char* buffer = new char[n];
-        get_raw( buffer, n );
-
+        char buffer[ 256 ];
         bool ret = true;
-        for (size_t i = 0; i < n; ++i) {
-            ret &= (buffer[i] == '\0');
+        while( n > 0 ) {
+            size_t const len = std::min( n, sizeof( buffer ));
+            get_raw( buffer, len );
+            for (size_t i = 0; i < len; ++i) {
+                ret &= (buffer[i] == '\0');
+            }
+            n -= len;
         }
-
-        delete[] buffer;
         return ret;
     }
 
@@ -334,11 +641,10 @@ public:
      */
     std::string get_raw_string(size_t n)
     {
-        char* buffer = new char[n];
-        get_raw( buffer, n );
-
-        std::string str (buffer, n);
-        delete[] buffer;
+        std::string str( n, '\0' );
+        if( n > 0 ) {
+            get_raw( &str[0], n );
+        }
         return str;
     }
 
@@ -381,7 +687,13 @@ public:
     template<typename T>
     T get_int ()
     {
-        return get_plain<T>();
+        static_assert(
+            std::is_integral<T>::value, "Deserializer::get_int() needs an integer type."
+        );
+        using U = typename std::make_unsigned<T>::type;
+        char bytes[ sizeof(T) ];
+        get_raw( bytes, sizeof(T) );
+        return static_cast<T>( load_little_endian_<U>( bytes ));
     }
 
     /**
@@ -390,7 +702,7 @@ public:
     template<typename T>
     void get_int (T& res)
     {
-        res = get_plain<T>();
+        res = get_int<T>();
     }
 
     /**
@@ -399,7 +711,19 @@ public:
     template<typename T>
     T get_float ()
     {
-        return get_plain<T>();
+        static_assert(
+            std::is_floating_point<T>::value && std::numeric_limits<T>::is_iec559 &&
+            ( sizeof(T) == 4 || sizeof(T) == 8 ),
+            "Deserializer::get_float() needs an IEEE 754 float or double."
+        );
+        using U = typename std::conditional< sizeof(T) == 4, uint32_t, uint64_t >::type;
+        char bytes[ sizeof(T) ];
+        get_raw( bytes, sizeof(T) );
+        auto const bits = load_little_endian_<U>( bytes );
+
+        T res;
+        std::memcpy( &res, &bits, sizeof(T) );
+        return res;
     }
 
     /**
@@ -408,16 +732,262 @@ public:
     template<typename T>
     void get_float (T& res)
     {
-        res = get_plain<T>();
+        res = get_float<T>();
+    }
+
+    /**
+     * @brief Read an integer number that was written by Serializer::put_varint() and return it.
+     *
+     * Throws if the number does not fit into the type `T`.
+     */
+    template<typename T>
+    T get_varint ()
+    {
+        static_assert(
+            std::is_integral<T>::value && sizeof(T) <= 8,
+            "Deserializer::get_varint() needs an integer type of up to 64 bits."
+        );
+
+        uint64_t value = 0;
+        size_t   shift = 0;
+        while( true ) {
+            char byte;
+            get_raw( &byte, 1 );
+            auto const bits = static_cast<uint64_t>( static_cast<unsigned char>( byte ));
+
+            if( shift == 63 && bits > 1 ) {
+                throw std::overflow_error( "Deserializer: Varint does not fit into 64 bits." );
+            }
+            value |= ( bits & 0x7F ) << shift;
+            if(( bits & 0x80 ) == 0 ) {
+                break;
+            }
+            shift += 7;
+        }
+        return zigzag_decode_<T>( value );
+    }
+
+    /**
+     * @brief Read an integer number that was written by Serializer::put_varint() and store it
+     * in the result.
+     */
+    template<typename T>
+    void get_varint (T& res)
+    {
+        res = get_varint<T>();
+    }
+
+    /**
+     * @brief Read a vector of numbers that was written by Serializer::put_array() and return it.
+     */
+    template<typename T>
+    std::vector<T> get_array ()
+    {
+        std::vector<T> res;
+        get_array( res );
+        return res;
+    }
+
+    /**
+     * @brief Read a vector of numbers that was written by Serializer::put_array() and store it
+     * in the result.
+     */
+    template<typename T>
+    void get_array( std::vector<T>& res )
+    {
+        auto const size = get_varint<size_t>();
+        check_array_size_<T>( size );
+        res.resize( size );
+        get_array_data_( res.data(), size );
+    }
+
+    /**
+     * @brief Read a Matrix of numbers that was written by Serializer::put_array() and store it
+     * in the result.
+     */
+    template<typename T>
+    void get_array( Matrix<T>& res )
+    {
+        auto const rows = get_varint<size_t>();
+        auto const cols = get_varint<size_t>();
+        if( cols > 0 && rows > std::numeric_limits<size_t>::max() / cols ) {
+            throw std::runtime_error( "Deserializer: Invalid Matrix size." );
+        }
+        check_array_size_<T>( rows * cols );
+        res = Matrix<T>( rows, cols );
+        get_array_data_( rows * cols > 0 ? &*res.begin() : nullptr, rows * cols );
+    }
+
+    /**
+     * @brief Return a pointer to a vector of numbers that was written by Serializer::put_array(),
+     * and its size, without copying the data.
+     *
+     * This is only possible if the input is memory mapped, see is_mapped(), and if the system
+     * uses little endian byte order. Otherwise, this function throws; use get_array() instead.
+     */
+    template<typename T>
+    std::pair< T const*, size_t > get_array_view()
+    {
+        check_view_<T>();
+        auto const size = get_varint<size_t>();
+        check_array_size_<T>( size );
+        return { get_array_view_data_<T>( size ), size };
+    }
+
+    /**
+     * @brief Return a pointer to the data of a Matrix that was written by
+     * Serializer::put_array(), without copying it, and store its dimensions in `rows` and `cols`.
+     *
+     * The data is stored in row-major order. See get_array_view() for the requirements.
+     */
+    template<typename T>
+    T const* get_matrix_view( size_t& rows, size_t& cols )
+    {
+        check_view_<T>();
+        rows = get_varint<size_t>();
+        cols = get_varint<size_t>();
+        if( cols > 0 && rows > std::numeric_limits<size_t>::max() / cols ) {
+            throw std::runtime_error( "Deserializer: Invalid Matrix size." );
+        }
+        check_array_size_<T>( rows * cols );
+        return get_array_view_data_<T>( rows * cols );
     }
 
     // -------------------------------------------------------------------------
-    //     Data Members
+    //     Internal Helpers
     // -------------------------------------------------------------------------
 
 private:
 
+    template<typename U>
+    static U load_little_endian_( char const* source )
+    {
+        // Compilers turn this into a single load on little endian systems.
+        U value = 0;
+        for( size_t i = 0; i < sizeof(U); ++i ) {
+            value |= static_cast<U>( static_cast<unsigned char>( source[i] )) << ( 8 * i );
+        }
+        return value;
+    }
+
+    template<typename T>
+    static typename std::enable_if< std::is_signed<T>::value, T >::type
+    zigzag_decode_( uint64_t value )
+    {
+        auto const magnitude = value >> 1;
+        int64_t res;
+        if( value & 1 ) {
+            if( magnitude > static_cast<uint64_t>( -( std::numeric_limits<T>::min() + 1 ))) {
+                throw std::overflow_error( "Deserializer: Varint does not fit into type." );
+            }
+            res = -static_cast<int64_t>( magnitude ) - 1;
+        } else {
+            if( magnitude > static_cast<uint64_t>( std::numeric_limits<T>::max() )) {
+                throw std::overflow_error( "Deserializer: Varint does not fit into type." );
+            }
+            res = static_cast<int64_t>( magnitude );
+        }
+        return static_cast<T>( res );
+    }
+
+    template<typename T>
+    static typename std::enable_if< ! std::is_signed<T>::value, T >::type
+    zigzag_decode_( uint64_t value )
+    {
+        if( value > static_cast<uint64_t>( std::numeric_limits<T>::max() )) {
+            throw std::overflow_error( "Deserializer: Varint does not fit into type." );
+        }
+        return static_cast<T>( value );
+    }
+
+    template<typename T>
+    typename std::enable_if< std::is_floating_point<T>::value, T >::type
+    get_value_()
+    {
+        return get_float<T>();
+    }
+
+    template<typename T>
+    typename std::enable_if< std::is_integral<T>::value, T >::type
+    get_value_()
+    {
+        return get_int<T>();
+    }
+
+    template<typename T>
+    void check_array_size_( size_t size ) const
+    {
+        static_assert(
+            std::is_arithmetic<T>::value && ! std::is_same<T, bool>::value,
+            "Deserializer::get_array() needs a number type."
+        );
+
+        // Avoid huge allocations for corrupt input.
+        if( size > std::numeric_limits<size_t>::max() / sizeof(T) ) {
+            throw std::runtime_error( "Deserializer: Invalid array size." );
+        }
+    }
+
+    /**
+     * @brief Skip the zero bytes that Serializer::put_array() uses to align its data.
+     */
+    template<typename T>
+    void skip_alignment_()
+    {
+        auto const misalign = pos_ % sizeof(T);
+        if( misalign > 0 && ! get_null( sizeof(T) - misalign )) {
+            throw std::runtime_error( "Deserializer: Invalid array alignment." );
+        }
+    }
+
+    template<typename T>
+    void get_array_data_( T* data, size_t size )
+    {
+        skip_alignment_<T>();
+        if( Options::is_little_endian() ) {
+            get_raw( reinterpret_cast< char* >( data ), size * sizeof(T) );
+        } else {
+            for( size_t i = 0; i < size; ++i ) {
+                data[i] = get_value_<T>();
+            }
+        }
+    }
+
+    template<typename T>
+    void check_view_() const
+    {
+        if( ! buffer_.is_mapped() || ! Options::is_little_endian() ) {
+            throw std::runtime_error(
+                "Deserializer: Array views need a memory mapped input on a little endian system."
+            );
+        }
+    }
+
+    template<typename T>
+    T const* get_array_view_data_( size_t size )
+    {
+        skip_alignment_<T>();
+        auto const bytes = size * sizeof(T);
+        auto const view  = buffer_.get_view( bytes );
+        pos_ += view.second;
+        if( view.second != bytes ) {
+            throw std::runtime_error(
+                "Could only read " + std::to_string( view.second )  + " bytes instead of n=" +
+                std::to_string( bytes ) + " bytes from Deserializer input."
+            );
+        }
+        if( reinterpret_cast< uintptr_t >( view.first ) % alignof(T) != 0 ) {
+            throw std::runtime_error( "Deserializer: Array view is not aligned in memory." );
+        }
+        return reinterpret_cast< T const* >( view.first );
+    }
+
+    // -------------------------------------------------------------------------
+    //     Data Members
+    // -------------------------------------------------------------------------
+
     InputBuffer buffer_;
+    size_t      pos_;
 
 };
 
@@ -0,0 +1,409 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include "genesis/utils/text/float_format.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Helpers
+// =================================================================================================
+
+/**
+ * @brief Smallest and largest decimal exponent `k` for which Schubfach needs a power of ten.
+ */
+static const int shortest_min_k_ = -324;
+static const int shortest_max_k_ = 292;
+
+static const uint64_t shortest_mask_63_ = ( uint64_t( 1 ) << 63 ) - 1;
+
+/**
+ * @brief Return `floor( q * log10( 2 ))`, for `|q| <= 5000`.
+ */
+static inline int shortest_floor_log10_pow2_( int q )
+{
+    return static_cast<int>(( static_cast<int64_t>( q ) * 661971961083LL ) >> 41 );
+}
+
+/**
+ * @brief Return `floor( q * log10( 3/4 * 2 ))`, for `|q| <= 5000`.
+ */
+static inline int shortest_floor_log10_three_quarters_pow2_( int q )
+{
+    return static_cast<int>(
+        ( static_cast<int64_t>( q ) * 661971961083LL - 274743187321LL ) >> 41
+    );
+}
+
+/**
+ * @brief Return `floor( e * log2( 10 ))`, for `|e| <= 1600`.
+ */
+static inline int shortest_floor_log2_pow10_( int e )
+{
+    return static_cast<int>(( static_cast<int64_t>( e ) * 913124641741LL ) >> 38 );
+}
+
+/**
+ * @brief Return the upper 64 bits of the 128 bit product of two 64 bit numbers.
+ */
+static inline uint64_t shortest_multiply_high_( uint64_t a, uint64_t b )
+{
+    #ifdef __SIZEOF_INT128__
+        __extension__ typedef unsigned __int128 uint128_type;
+        return static_cast< uint64_t >(( static_cast< uint128_type >( a ) * b ) >> 64 );
+    #else
+        uint64_t const a_lo = a & 0xFFFFFFFF;
+        uint64_t const a_hi = a >> 32;
+        uint64_t const b_lo = b & 0xFFFFFFFF;
+        uint64_t const b_hi = b >> 32;
+        uint64_t const p0 = a_lo * b_lo;
+        uint64_t const p1 = a_lo * b_hi;
+        uint64_t const p2 = a_hi * b_lo;
+        uint64_t const p3 = a_hi * b_hi;
+        uint64_t const mid = ( p0 >> 32 ) + ( p1 & 0xFFFFFFFF ) + ( p2 & 0xFFFFFFFF );
+        return p3 + ( p1 >> 32 ) + ( p2 >> 32 ) + ( mid >> 32 );
+    #endif
+}
+
+/**
+ * @brief Compute the table of 126 bit approximations `g` of the powers of ten used by Schubfach.
+ *
+ * For each `k`, the entry is `g = floor( 10^(-k) * 2^(125 - floor( -k log2( 10 )))) + 1`,
+ * which lies in `[ 2^125, 2^126 )`, stored as two 63 bit halves `g1` and `g0`.
+ * Instead of shipping a 10 kB table of constants, we compute it once with a simple
+ * arbitrary precision integer, which takes well below a millisecond.
+ */
+static std::vector< uint64_t > shortest_build_table_()
+{
+    // Little endian arbitrary precision unsigned integer with a few in-place operations.
+    using BigInt = std::vector< uint32_t >;
+    auto multiply_small = []( BigInt& n, uint32_t factor ){
+        uint64_t carry = 0;
+        for( auto& limb : n ) {
+            uint64_t const v = static_cast< uint64_t >( limb ) * factor + carry;
+            limb  = static_cast< uint32_t >( v );
+            carry = v >> 32;
+        }
+        if( carry ) {
+            n.push_back( static_cast< uint32_t >( carry ));
+        }
+    };
+    auto divide_small = []( BigInt& n, uint32_t divisor ){
+        uint64_t rem = 0;
+        for( size_t i = n.size(); i > 0; --i ) {
+            uint64_t const v = ( rem << 32 ) | n[ i - 1 ];
+            n[ i - 1 ] = static_cast< uint32_t >( v / divisor );
+            rem = v % divisor;
+        }
+        while( n.size() > 1 && n.back() == 0 ) {
+            n.pop_back();
+        }
+    };
+    auto shift = []( BigInt& n, int bits ){
+        BigInt result;
+        if( bits >= 0 ) {
+            size_t const limbs = bits / 32;
+            int const rest = bits % 32;
+            result.assign( limbs + n.size() + 1, 0 );
+            for( size_t i = 0; i < n.size(); ++i ) {
+                uint64_t const v = static_cast< uint64_t >( n[i] ) << rest;
+                result[ i + limbs ]     |= static_cast< uint32_t >( v );
+                result[ i + limbs + 1 ] |= static_cast< uint32_t >( v >> 32 );
+            }
+        } else {
+            size_t const limbs = ( -bits ) / 32;
+            int const rest = ( -bits ) % 32;
+            result.assign( 1, 0 );
+            if( limbs < n.size() ) {
+                result.assign( n.size() - limbs, 0 );
+                for( size_t i = limbs; i < n.size(); ++i ) {
+                    uint64_t v = n[i];
+                    if( i + 1 < n.size() ) {
+                        v |= static_cast< uint64_t >( n[ i + 1 ] ) << 32;
+                    }
+                    result[ i - limbs ] = static_cast< uint32_t >( v >> rest );
+                }
+            }
+        }
+        n = std::move( result );
+    };
+
+    std::vector< uint64_t > table;
+    table.reserve( 2 * ( shortest_max_k_ - shortest_min_k_ + 1 ));
+    for( int k = shortest_min_k_; k <= shortest_max_k_; ++k ) {
+        int const exponent = 125 - shortest_floor_log2_pow10_( -k );
+
+        // Compute the floor of 10^(-k) * 2^exponent, where exactly one of both factors
+        // is a fraction. Repeated flooring division by ten yields the floor of the whole quotient.
+        BigInt n( 1, 1 );
+        if( k <= 0 ) {
+            for( int i = 0; i < -k; ++i ) {
+                multiply_small( n, 10 );
+            }
+            shift( n, exponent );
+        } else {
+            shift( n, exponent );
+            for( int i = 0; i < k; ++i ) {
+                divide_small( n, 10 );
+            }
+        }
+        n.resize( 4, 0 );
+
+        // Add one, and split the 126 bits into two 63 bit halves.
+        uint64_t lo = static_cast< uint64_t >( n[0] ) | ( static_cast< uint64_t >( n[1] ) << 32 );
+        uint64_t hi = static_cast< uint64_t >( n[2] ) | ( static_cast< uint64_t >( n[3] ) << 32 );
+        ++lo;
+        if( lo == 0 ) {
+            ++hi;
+        }
+        assert( ( hi >> 61 ) == 1 );
+        table.push_back(( hi << 1 ) | ( lo >> 63 ));
+        table.push_back( lo & shortest_mask_63_ );
+    }
+    return table;
+}
+
+/**
+ * @brief Return the table of powers of ten, computing it on first use.
+ */
+static inline uint64_t const* shortest_table_()
+{
+    // Thread safe initialization, guaranteed since C++11.
+    static const std::vector< uint64_t > table = shortest_build_table_();
+    return table.data();
+}
+
+/**
+ * @brief Compute the rounded-to-odd value of `cp * g * 2^(-127)`, see figure 8 of the paper.
+ */
+static inline uint64_t shortest_round_to_odd_( uint64_t g1, uint64_t g0, uint64_t cp )
+{
+    uint64_t const x1  = shortest_multiply_high_( g0, cp );
+    uint64_t const y0  = g1 * cp;
+    uint64_t const y1  = shortest_multiply_high_( g1, cp );
+    uint64_t const z   = ( y0 >> 1 ) + x1;
+    uint64_t const vbp = y1 + ( z >> 63 );
+    return vbp | ((( z & shortest_mask_63_ ) + shortest_mask_63_ ) >> 63 );
+}
+
+/**
+ * @brief Compute the shortest decimal `digits * 10^exponent` that rounds to `c * 2^q`,
+ * following figure 7 of the paper.
+ */
+static void shortest_to_decimal_( int q, uint64_t c, int dk, uint64_t& digits, int& exponent )
+{
+    uint64_t const c_min = uint64_t( 1 ) << 52;
+    int const q_min = -1074;
+
+    uint64_t const out = c & 1;
+    uint64_t const cb  = c << 2;
+    uint64_t const cbr = cb + 2;
+    uint64_t cbl;
+    int k;
+    if( c != c_min || q == q_min ) {
+        cbl = cb - 2;
+        k = shortest_floor_log10_pow2_( q );
+    } else {
+        cbl = cb - 1;
+        k = shortest_floor_log10_three_quarters_pow2_( q );
+    }
+    int const h = q + shortest_floor_log2_pow10_( -k ) + 2;
+    assert( shortest_min_k_ <= k && k <= shortest_max_k_ );
+    assert( 2 <= h && h <= 5 );
+
+    auto const table = shortest_table_();
+    uint64_t const g1 = table[ 2 * ( k - shortest_min_k_ ) ];
+    uint64_t const g0 = table[ 2 * ( k - shortest_min_k_ ) + 1 ];
+
+    uint64_t const vb  = shortest_round_to_odd_( g1, g0, cb  << h );
+    uint64_t const vbl = shortest_round_to_odd_( g1, g0, cbl << h );
+    uint64_t const vbr = shortest_round_to_odd_( g1, g0, cbr << h );
+
+    // Try one digit less first: s' = floor( s / 10 ), computed via multiplication.
+    // The paper only does this for s >= 100, as Java wants at least two digits. We also do it
+    // for the two digit results of subnormals, so that we get the truly shortest output there.
+    uint64_t const s = vb >> 2;
+    if( s >= 10 ) {
+        uint64_t const sp10 = 10 * shortest_multiply_high_( s, 115292150460684698ULL << 4 );
+        uint64_t const tp10 = sp10 + 10;
+        bool const upin = vbl + out <= ( sp10 << 2 );
+        bool const wpin = ( tp10 << 2 ) + out <= vbr;
+        if( upin != wpin ) {
+            digits   = upin ? sp10 : tp10;
+            exponent = k + dk;
+            return;
+        }
+    }
+
+    // Otherwise, use s or t = s + 1, whichever is in the rounding interval, or closer to v.
+    uint64_t const t = s + 1;
+    bool const uin = vbl + out <= ( s << 2 );
+    bool const win = ( t << 2 ) + out <= vbr;
+    exponent = k + dk;
+    if( uin != win ) {
+        digits = uin ? s : t;
+        return;
+    }
+    int64_t const cmp = static_cast< int64_t >( vb - (( s + t ) << 1 ));
+    digits = ( cmp < 0 || ( cmp == 0 && ( s & 1 ) == 0 )) ? s : t;
+}
+
+/**
+ * @brief Write `digits * 10^exponent` to the buffer, in plain or scientific notation.
+ */
+static char* shortest_write_decimal_( char* buffer, uint64_t digits, int exponent )
+{
+    assert( digits > 0 );
+    while( digits % 10 == 0 ) {
+        digits /= 10;
+        ++exponent;
+    }
+
+    // Produce the digit chars.
+    char text[ 20 ];
+    int n = 0;
+    while( digits > 0 ) {
+        text[ 19 - n ] = static_cast< char >( '0' + digits % 10 );
+        digits /= 10;
+        ++n;
+    }
+    char const* const first = text + 20 - n;
+
+    // Decimal exponent of the first digit.
+    int const sci = n + exponent - 1;
+    if( -5 <= sci && sci <= 16 ) {
+        if( exponent >= 0 ) {
+            std::memcpy( buffer, first, n );
+            buffer += n;
+            std::memset( buffer, '0', exponent );
+            buffer += exponent;
+        } else if( sci >= 0 ) {
+            std::memcpy( buffer, first, sci + 1 );
+            buffer += sci + 1;
+            *buffer++ = '.';
+            std::memcpy( buffer, first + sci + 1, n - sci - 1 );
+            buffer += n - sci - 1;
+        } else {
+            *buffer++ = '0';
+            *buffer++ = '.';
+            std::memset( buffer, '0', -sci - 1 );
+            buffer += -sci - 1;
+            std::memcpy( buffer, first, n );
+            buffer += n;
+        }
+        return buffer;
+    }
+
+    *buffer++ = first[0];
+    if( n > 1 ) {
+        *buffer++ = '.';
+        std::memcpy( buffer, first + 1, n - 1 );
+        buffer += n - 1;
+    }
+    *buffer++ = 'e';
+    *buffer++ = ( sci < 0 ? '-' : '+' );
+    int const abs_sci = sci < 0 ? -sci : sci;
+    if( abs_sci >= 100 ) {
+        *buffer++ = static_cast< char >( '0' + abs_sci / 100 );
+    }
+    if( abs_sci >= 10 ) {
+        *buffer++ = static_cast< char >( '0' + ( abs_sci / 10 ) % 10 );
+    }
+    *buffer++ = static_cast< char >( '0' + abs_sci % 10 );
+    return buffer;
+}
+
+// =================================================================================================
+//     Shortest Float Formatting
+// =================================================================================================
+
+char* format_float_shortest( char* buffer, double value )
+{
+    uint64_t bits;
+    static_assert( sizeof( bits ) == sizeof( value ), "Unexpected size of double." );
+    std::memcpy( &bits, &value, sizeof( bits ));
+
+    uint64_t const fraction = bits & (( uint64_t( 1 ) << 52 ) - 1 );
+    int const biased_exponent = static_cast< int >(( bits >> 52 ) & 0x7FF );
+
+    // Special values.
+    if( biased_exponent == 0x7FF ) {
+        if( fraction != 0 ) {
+            std::memcpy( buffer, "nan", 3 );
+            return buffer + 3;
+        }
+        if( bits >> 63 ) {
+            *buffer++ = '-';
+        }
+        std::memcpy( buffer, "inf", 3 );
+        return buffer + 3;
+    }
+    if( bits >> 63 ) {
+        *buffer++ = '-';
+    }
+    if( biased_exponent == 0 && fraction == 0 ) {
+        *buffer++ = '0';
+        return buffer;
+    }
+
+    uint64_t digits;
+    int exponent;
+    if( biased_exponent != 0 ) {
+        // Normal values. Small integers are exact, and can be written directly.
+        int const mq = 1075 - biased_exponent;
+        uint64_t const c = ( uint64_t( 1 ) << 52 ) | fraction;
+        if( 0 < mq && mq < 53 && (( c >> mq ) << mq ) == c ) {
+            return shortest_write_decimal_( buffer, c >> mq, 0 );
+        }
+        shortest_to_decimal_( -mq, c, 0, digits, exponent );
+    } else if( fraction < 3 ) {
+        // Tiny subnormals need an extra digit of precision to be computed correctly.
+        shortest_to_decimal_( -1074, 10 * fraction, -1, digits, exponent );
+    } else {
+        shortest_to_decimal_( -1074, fraction, 0, digits, exponent );
+    }
+    return shortest_write_decimal_( buffer, digits, exponent );
+}
+
+std::string to_string_shortest( double value )
+{
+    char buffer[ FloatFormatBufferSize ];
+    auto const end = format_float_shortest( buffer, value );
+    return std::string( buffer, end );
+}
+
+} // namespace utils
+} // namespace genesis
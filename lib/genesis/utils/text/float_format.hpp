@@ -0,0 +1,80 @@
+#ifndef GENESIS_UTILS_TEXT_FLOAT_FORMAT_H_
+#define GENESIS_UTILS_TEXT_FLOAT_FORMAT_H_
+
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup utils
+ */
+
+#include <cstddef>
+#include <string>
+
+namespace genesis {
+namespace utils {
+
+// =================================================================================================
+//     Shortest Float Formatting
+// =================================================================================================
+
+/**
+ * @brief Minimum size of the buffer that format_float_shortest() writes to.
+ */
+constexpr size_t FloatFormatBufferSize = 32;
+
+/**
+ * @brief Write the shortest decimal representation of a `double` that reads back to exactly
+ * the same value.
+ *
+ * The digits are computed with the Schubfach algorithm (Giulietti, "The Schubfach way to render
+ * doubles"), which, like Ryu, only needs integer arithmetic on a table of 128 bit powers of ten.
+ * The result is the shortest digit string that round-trips; of several such strings, the one
+ * closest to the exact binary value is used. This is considerably faster than printing
+ * with `%.17g`, and yields `0.1` instead of `0.10000000000000001`.
+ *
+ * Values whose decimal exponent is within `[-5, 16]` are written in plain notation (`0.00123`,
+ * `12345.6`, `42`), all others in scientific notation (`1.5e-7`, `2e+300`). Integral values
+ * are written without a decimal point. Infinity and NaN are written as `inf`, `-inf` and `nan`.
+ *
+ * The function writes to @p buffer, which needs to have space for at least
+ * ::FloatFormatBufferSize chars, and returns a pointer to the char past the last written one.
+ * No terminating null char is written.
+ */
+char* format_float_shortest( char* buffer, double value );
+
+/**
+ * @brief Return the shortest decimal representation of a `double` that reads back to exactly
+ * the same value.
+ *
+ * See format_float_shortest() for details.
+ */
+std::string to_string_shortest( double value );
+
+} // namespace utils
+} // namespace genesis
+
+#endif // include guard
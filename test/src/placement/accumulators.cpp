@@ -0,0 +1,198 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup test
+ */
+
+#include "src/common.hpp"
+
+#include "genesis/placement/formats/jplace_reader.hpp"
+#include "genesis/placement/function/accumulators.hpp"
+#include "genesis/placement/function/emd.hpp"
+#include "genesis/placement/function/functions.hpp"
+#include "genesis/placement/function/helper.hpp"
+#include "genesis/placement/sample.hpp"
+#include "genesis/tree/mass_tree/emd.hpp"
+#include "genesis/tree/mass_tree/tree.hpp"
+#include "genesis/utils/math/histogram.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace genesis;
+using namespace genesis::placement;
+
+/**
+ * @brief Accumulator that records the calls it gets, for testing the order of the Pqueries.
+ */
+class RecordingAccumulator : public BasePqueryAccumulator
+{
+public:
+
+    size_t                   begins   = 0;
+    size_t                   finishes = 0;
+    size_t                   edges    = 0;
+    std::vector<std::string> names;
+
+protected:
+
+    void begin_( PlacementTree const& tree ) override
+    {
+        ++begins;
+        edges = tree.edge_count();
+        names.clear();
+    }
+
+    void accumulate_( Pquery const& pquery ) override
+    {
+        EXPECT_EQ( 0, finishes );
+        names.push_back( pquery.name_at(0).name );
+    }
+
+    void finish_() override
+    {
+        ++finishes;
+    }
+};
+
+TEST( Accumulators, Edges )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile = environment->data_dir + "placement/test_a.jplace";
+    Sample const smp = JplaceReader().from_file( infile );
+
+    EdgeAccumulator streamed;
+    JplaceReader().from_file( infile, streamed );
+    EdgeAccumulator in_memory;
+    accumulate_sample( smp, in_memory );
+
+    for( auto const* acc : { &streamed, &in_memory } ) {
+        EXPECT_EQ( smp.size(), acc->pquery_count() );
+        EXPECT_EQ( placement_count_per_edge( smp ), acc->placement_counts() );
+        EXPECT_DOUBLE_EQ( total_placement_mass_with_multiplicities( smp ), acc->total_mass() );
+
+        auto const weights = placement_weight_per_edge( smp );
+        ASSERT_EQ( weights.size(), acc->placement_weights().size() );
+        ASSERT_EQ( weights.size(), acc->placement_masses().size() );
+        for( size_t i = 0; i < weights.size(); ++i ) {
+            EXPECT_DOUBLE_EQ( weights[i], acc->placement_weights()[i] );
+        }
+    }
+}
+
+TEST( Accumulators, MassTree )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile = environment->data_dir + "placement/test_a.jplace";
+    Sample const smp = JplaceReader().from_file( infile );
+    auto const expected = convert_to_mass_tree( smp );
+
+    MassTreeAccumulator acc;
+    JplaceReader().from_file( infile, acc );
+
+    EXPECT_EQ( expected.first.edge_count(), acc.mass_tree().edge_count() );
+    EXPECT_NEAR( expected.second, acc.pendant_work(), 1e-10 );
+    EXPECT_NEAR( 0.0, tree::earth_movers_distance( expected.first, acc.mass_tree() ), 1e-10 );
+}
+
+TEST( Accumulators, Histogram )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile = environment->data_dir + "placement/test_a.jplace";
+    Sample const smp = JplaceReader().from_file( infile );
+
+    auto const pendant = []( PqueryPlacement const& place ){
+        return place.pendant_length;
+    };
+    PlacementHistogramAccumulator counted( utils::Histogram( 10, 0.0, 2.0 ), pendant, false );
+    PlacementHistogramAccumulator weighted( utils::Histogram( 10, 0.0, 2.0 ), pendant );
+    JplaceReader().from_file( infile, counted );
+    accumulate_sample( smp, weighted );
+
+    double count  = 0.0;
+    double weight = 0.0;
+    for( size_t i = 0; i < counted.histogram().bins(); ++i ) {
+        count  += counted.histogram()[i];
+        weight += weighted.histogram()[i];
+    }
+    EXPECT_DOUBLE_EQ( static_cast<double>( total_placement_count( smp )), count );
+    EXPECT_NEAR( total_placement_mass_with_multiplicities( smp ), weight, 1e-10 );
+}
+
+TEST( Accumulators, KeyOrder )
+{
+    std::string const tree = R"("tree": "((A:2{0},B:2{1})C:2{2},D:2{3})R;")";
+    std::string const placements = R"("placements": [
+        { "p": [ [ 1, -10.5, 0.75 ], [ 3, -11, 0.25 ] ], "n": [ "a", "b" ] },
+        { "p": [ [ 2, -20, 1 ] ], "nm": [ [ "c", 2.5 ] ] },
+        { "p": [ [ 0, -15, 1 ] ], "n": [ "d" ] }
+    ])";
+    std::string const fields = R"("fields": [ "edge_num", "likelihood", "like_weight_ratio" ])";
+    std::string const meta = R"("version": 3)";
+
+    // The Pqueries are handed over in the order of the document, no matter whether they have
+    // to wait for the tree and fields, and the returned accumulator is always started.
+    std::vector<std::string> const expected = { "a", "c", "d" };
+    for( auto const& doc : {
+        "{" + placements + ", " + meta + ", " + fields + ", " + tree + "}",
+        "{" + tree + ", " + fields + ", " + placements + ", " + meta + "}"
+    }) {
+        RecordingAccumulator rec;
+        JplaceReader().from_string( doc, rec );
+        EXPECT_EQ( 1, rec.begins );
+        EXPECT_EQ( 1, rec.finishes );
+        EXPECT_EQ( 4, rec.edges );
+        EXPECT_EQ( expected, rec.names );
+
+        EdgeAccumulator edges;
+        JplaceReader().from_string( doc, edges );
+        EXPECT_EQ( std::vector<size_t>({ 1, 1, 1, 1 }), edges.placement_counts() );
+        EXPECT_DOUBLE_EQ( 5.5, edges.total_mass() );
+    }
+
+    // Without any pquery.
+    RecordingAccumulator empty;
+    JplaceReader().from_string(
+        "{" + tree + ", " + fields + R"(, "placements": [], )" + meta + "}", empty
+    );
+    EXPECT_EQ( 1, empty.begins );
+    EXPECT_EQ( 1, empty.finishes );
+    EXPECT_TRUE( empty.names.empty() );
+
+    // Errors are still found.
+    RecordingAccumulator broken;
+    EXPECT_THROW(
+        JplaceReader().from_string( "{" + placements + ", " + meta + ", " + tree + "}", broken ),
+        std::runtime_error
+    );
+}
@@ -160,6 +160,61 @@ TEST( SampleFunctions, FilterPqueryNameSets )
     EXPECT_EQ(  2, total_placement_count( sample_4 ));
 }
 
+TEST( SampleFunctions, PqueryNameIndex )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Read file.
+    std::string infile = environment->data_dir + "placement/duplicates_b.jplace";
+    Sample smp = JplaceReader().from_file(infile);
+
+    // Same results as the linear search.
+    PqueryNameIndex index( smp );
+    std::unordered_set<std::string> names;
+    for( auto const& pqry : smp ) {
+        for( auto const& name : pqry.names() ) {
+            EXPECT_TRUE( index.has_name( name.name ));
+            EXPECT_EQ( find_pquery( smp, name.name ), index.find_pquery( name.name ));
+            names.insert( name.name );
+        }
+    }
+    auto const name_count = names.size();
+    EXPECT_EQ( name_count, index.size() );
+    EXPECT_FALSE( index.has_name( "not a name" ));
+    EXPECT_EQ( nullptr, index.find_pquery( "not a name" ));
+    EXPECT_EQ( smp.size(), index.pquery_index( "not a name" ));
+
+    // Add many Pqueries, with each name twice, so that the table grows.
+    for( size_t i = 0; i < 1000; ++i ) {
+        smp.add().add_name( "n" + std::to_string( i % 500 ));
+    }
+    index.update();
+    EXPECT_EQ( name_count + 500, index.size() );
+    EXPECT_EQ( smp.size() - 1000, index.pquery_index( "n0" ));
+    EXPECT_EQ( smp.size() - 501, index.pquery_index( "n499" ));
+    EXPECT_EQ( find_pquery( smp, "n123" ), index.find_pquery( "n123" ));
+
+    // After removing Pqueries, the index is built anew.
+    smp.remove( size_t( 0 ));
+    index.update();
+    names.clear();
+    for( auto const& pqry : smp ) {
+        for( auto const& name : pqry.names() ) {
+            names.insert( name.name );
+        }
+    }
+    EXPECT_EQ( names.size(), index.size() );
+    EXPECT_EQ( find_pquery( smp, "n0" ), index.find_pquery( "n0" ));
+
+    // Filter using the names of another Sample.
+    Sample other = JplaceReader().from_file(infile);
+    filter_pqueries_keeping_names( smp, PqueryNameIndex( other ));
+    EXPECT_EQ( other.size() - 1, smp.size() );
+    filter_pqueries_removing_names( other, PqueryNameIndex( smp ));
+    EXPECT_EQ( 0, other.size() );
+}
+
 TEST( SampleFunctions, ConvertFromDefaultTree )
 {
     // Skip test if no data availabe.
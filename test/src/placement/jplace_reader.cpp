@@ -30,12 +30,25 @@
 
 #include "src/common.hpp"
 
+#include <cstdlib>
+#include <stdexcept>
 #include <string>
+#include <vector>
+
+#ifdef GENESIS_PTHREADS
+#    include "genesis/utils/core/thread_pool.hpp"
+
+#    include <thread>
+#endif
 
 #include "genesis/placement/formats/jplace_reader.hpp"
 #include "genesis/placement/function/helper.hpp"
 #include "genesis/placement/function/functions.hpp"
+#include "genesis/placement/sample_set.hpp"
 #include "genesis/placement/sample.hpp"
+#include "genesis/utils/core/options.hpp"
+#include "genesis/utils/formats/json/document.hpp"
+#include "genesis/utils/formats/json/reader.hpp"
 
 using namespace genesis;
 using namespace genesis::placement;
@@ -53,6 +66,192 @@ TEST( JplaceReader, FromFile )
     EXPECT_TRUE( has_correct_edge_nums(smp.tree()) );
 }
 
+static void compare_jplace_samples( Sample const& exp, Sample const& act )
+{
+    ASSERT_EQ( exp.size(), act.size() );
+    EXPECT_EQ( exp.metadata, act.metadata );
+    for( size_t i = 0; i < exp.size(); ++i ) {
+        auto const& exp_pqry = exp.at(i);
+        auto const& act_pqry = act.at(i);
+
+        ASSERT_EQ( exp_pqry.placement_size(), act_pqry.placement_size() );
+        for( size_t j = 0; j < exp_pqry.placement_size(); ++j ) {
+            auto const& exp_place = exp_pqry.placement_at(j);
+            auto const& act_place = act_pqry.placement_at(j);
+            EXPECT_EQ( exp_place.edge_num(),        act_place.edge_num() );
+            EXPECT_EQ( exp_place.likelihood,        act_place.likelihood );
+            EXPECT_EQ( exp_place.like_weight_ratio, act_place.like_weight_ratio );
+            EXPECT_EQ( exp_place.proximal_length,   act_place.proximal_length );
+            EXPECT_EQ( exp_place.pendant_length,    act_place.pendant_length );
+        }
+
+        ASSERT_EQ( exp_pqry.name_size(), act_pqry.name_size() );
+        for( size_t j = 0; j < exp_pqry.name_size(); ++j ) {
+            EXPECT_EQ( exp_pqry.name_at(j).name,         act_pqry.name_at(j).name );
+            EXPECT_EQ( exp_pqry.name_at(j).multiplicity, act_pqry.name_at(j).multiplicity );
+        }
+    }
+}
+
+TEST( JplaceReader, StreamingEqualsDocument )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    for( auto const& name : { "test_a", "test_b", "test_c", "duplicates_a", "duplicates_b" } ) {
+        std::string infile = environment->data_dir + "placement/" + name + ".jplace";
+        SCOPED_TRACE( infile );
+
+        auto doc = utils::JsonReader().from_file( infile );
+        Sample const exp = JplaceReader().from_document( doc );
+        Sample const act = JplaceReader().from_file( infile );
+        compare_jplace_samples( exp, act );
+    }
+}
+
+TEST( JplaceReader, KeyOrder )
+{
+    // Placements before the tree and fields, as for example written by pplacer,
+    // and fields in a different order, including an unknown one.
+    std::string const tree = R"("tree": "((A:2{0},B:2{1})C:2{2},D:2{3})R;")";
+    std::string const placements = R"("placements": [
+        { "p": [ [ 0.5, 1, -10.5, 0.25, 7, 0.75 ], [ 0.5, 3, -11, 1.0, 8, 0.25 ] ],
+          "n": [ "a", "b" ], "other": { "k": [ 1, 2 ] } },
+        { "p": [ [ 0.1, 2, -20, 0.5, 0, 1 ] ], "nm": [ [ "c", 2.5 ] ] }
+    ])";
+    std::string const fields = R"("fields": [ "pendant_length", "edge_num", "likelihood",)"
+        R"( "distal_length", "other", "like_weight_ratio" ])";
+    std::string const meta = R"("version": 3, "metadata": { "invocation": "test", "n": 5 })";
+
+    Sample const first  = JplaceReader().from_string(
+        "{" + placements + ", " + meta + ", " + fields + ", " + tree + "}"
+    );
+    Sample const second = JplaceReader().from_string(
+        "{" + tree + ", " + fields + ", " + placements + ", " + meta + "}"
+    );
+
+    ASSERT_EQ( 2, first.size() );
+    ASSERT_EQ( 2, first.at(0).placement_size() );
+    EXPECT_EQ( 3, first.at(0).placement_at(1).edge_num() );
+    EXPECT_EQ( -11.0, first.at(0).placement_at(1).likelihood );
+    EXPECT_EQ( 1.75, first.at(0).placement_at(0).proximal_length );
+    EXPECT_EQ( 0.5, first.at(0).placement_at(0).pendant_length );
+    EXPECT_EQ( 2.5, first.at(1).name_at(0).multiplicity );
+    EXPECT_EQ( "test", first.metadata.at( "invocation" ));
+    EXPECT_EQ( 0, first.metadata.count( "n" ));
+    compare_jplace_samples( first, second );
+}
+
+TEST( JplaceReader, Invalid )
+{
+    auto const read = []( std::string const& placements ){
+        return JplaceReader().from_string(
+            R"({ "tree": "((A:2{0},B:2{1})C:2{2},D:2{3})R;", "version": 3, )"
+            R"("fields": [ "edge_num", "likelihood" ], "placements": )" + placements + " }"
+        );
+    };
+
+    EXPECT_NO_THROW( read( R"([ { "p": [ [ 1, -5 ] ], "n": [ "a" ] } ])" ));
+    EXPECT_THROW( read( R"([ { "p": [ [ 1 ] ], "n": [ "a" ] } ])" ), std::runtime_error );
+    EXPECT_THROW( read( R"([ { "p": [ [ 7, -5 ] ], "n": [ "a" ] } ])" ), std::runtime_error );
+    EXPECT_THROW( read( R"([ { "p": [ [ 1.5, -5 ] ], "n": [ "a" ] } ])" ), std::runtime_error );
+    EXPECT_THROW( read( R"([ { "p": [ [ -1, -5 ] ], "n": [ "a" ] } ])" ), std::runtime_error );
+    EXPECT_THROW( read( R"([ { "p": [ [ -0.5, -5 ] ], "n": [ "a" ] } ])" ), std::runtime_error );
+    EXPECT_THROW( read( R"([ { "p": [ [ 1e300, -5 ] ], "n": [ "a" ] } ])" ), std::runtime_error );
+    EXPECT_THROW(
+        read( R"([ { "p": [ [ 18446744073709551616, -5 ] ], "n": [ "a" ] } ])" ),
+        std::runtime_error
+    );
+    EXPECT_THROW( read( R"([ { "p": [ [ 1, "x" ] ], "n": [ "a" ] } ])" ), std::runtime_error );
+    EXPECT_THROW( read( R"([ { "p": [ [ 1, -5 ] ] } ])" ), std::runtime_error );
+    EXPECT_THROW( read( R"([ { "p": [ [ 1, -5 ] ], "n": [ "a" ], "nm": [] } ])" ), std::runtime_error );
+    EXPECT_THROW( read( R"([ { "p": [ [ 1, -5 ] ], "nm": [ [ "a" ] ] } ])" ), std::runtime_error );
+    EXPECT_THROW( read( R"([ { "p": [ [ 1, -5 ] ], "nm": [ [ 1, "a" ] ] } ])" ), std::runtime_error );
+    EXPECT_THROW( read( R"([ { "n": [ "a" ] } ])" ), std::runtime_error );
+    EXPECT_THROW( read( R"({})" ), std::runtime_error );
+    EXPECT_THROW( JplaceReader().from_string( "[]" ), std::runtime_error );
+
+    // Known fields must not occur twice, unknown ones may.
+    auto const read_fields = []( std::string const& fields ){
+        return JplaceReader().from_string(
+            R"({ "tree": "((A:2{0},B:2{1})C:2{2},D:2{3})R;", "version": 3, "fields": )" + fields
+            + R"(, "placements": [ { "p": [ [ 1, -5, 0 ] ], "n": [ "a" ] } ] })"
+        );
+    };
+    EXPECT_NO_THROW( read_fields( R"([ "edge_num", "other", "other" ])" ));
+    EXPECT_THROW( read_fields( R"([ "edge_num", "likelihood", "edge_num" ])" ), std::runtime_error );
+    EXPECT_THROW( read_fields( R"([ "edge_num", "likelihood", "likelihood" ])" ), std::runtime_error );
+    EXPECT_THROW(
+        JplaceReader().from_string( R"({ "tree": "((A:2{0},B:2{1})C:2{2},D:2{3})R;" })" ),
+        std::runtime_error
+    );
+}
+
+TEST( JplaceReader, FromFiles )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    auto const dir = environment->data_dir + "placement/";
+    std::vector<std::string> files;
+    for( size_t i = 0; i < 6; ++i ) {
+        files.push_back( dir + "test_a.jplace" );
+        files.push_back( dir + "test_b.jplace" );
+        files.push_back( dir + "test_c.jplace" );
+    }
+    files[4] = dir + "does_not_exist.jplace";
+    files[9] = dir + "../tree/simple_topology.newick";
+
+    // Results in input order, with failed files reported, for different numbers in flight.
+    Sample const smp_a = JplaceReader().from_file( dir + "test_a.jplace" );
+    for( size_t in_flight : { 0, 1, 3 } ) {
+        SampleSet set;
+        std::vector<JplaceReader::FileError> errors;
+        JplaceReader().files_in_flight( in_flight ).from_files( files, set, errors );
+
+        ASSERT_EQ( 16, set.size() );
+        ASSERT_EQ( 2, errors.size() );
+        EXPECT_EQ( 4, errors[0].index );
+        EXPECT_EQ( files[4], errors[0].file_name );
+        EXPECT_EQ( 9, errors[1].index );
+        EXPECT_FALSE( errors[1].message.empty() );
+
+        EXPECT_EQ( "test_a", set[0].name );
+        EXPECT_EQ( "test_c", set[2].name );
+        EXPECT_EQ( "test_c", set[4].name );
+        EXPECT_EQ( "test_a", set[5].name );
+        EXPECT_EQ( "test_c", set[15].name );
+        compare_jplace_samples( smp_a, set[13].sample );
+    }
+
+    // Without the error list, the function throws after reading all other files.
+    SampleSet set;
+    EXPECT_THROW( JplaceReader().from_files( files, set ), std::runtime_error );
+    EXPECT_EQ( 16, set.size() );
+
+    // Files with the same reference tree share it.
+    auto const same = JplaceReader().from_files(
+        std::vector<std::string>( 3, dir + "test_a.jplace" )
+    );
+    ASSERT_EQ( 3, same.size() );
+    EXPECT_EQ( &same[0].sample.tree(), &same[2].sample.tree() );
+    compare_jplace_samples( smp_a, same[2].sample );
+}
+
+#ifdef GENESIS_PTHREADS
+
+TEST( JplaceReader, ThreadPool )
+{
+    // Files are read in parallel on the shared pool, which uses all cores, unless the user
+    // restricted the number of threads, for example via OpenMP.
+    EXPECT_EQ( &utils::Options::get().thread_pool(), &JplaceReader::thread_pool() );
+    if( std::thread::hardware_concurrency() > 1 && ! std::getenv( "OMP_NUM_THREADS" )) {
+        EXPECT_LT( 1, JplaceReader::thread_pool().size() );
+    }
+}
+
+#endif
+
 // TEST( JplaceReader, Speed )
 // {
 //     std::string inputfile = "/home/lucas/Projects/data/for_testing/jplace/sample_0_all_big.jplace";
@@ -0,0 +1,121 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief Testing JplaceWriter class.
+ *
+ * @file
+ * @ingroup test
+ */
+
+#include "src/common.hpp"
+
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "genesis/placement/formats/jplace_reader.hpp"
+#include "genesis/placement/formats/jplace_writer.hpp"
+#include "genesis/placement/function/functions.hpp"
+#include "genesis/placement/function/helper.hpp"
+#include "genesis/placement/sample.hpp"
+
+using namespace genesis;
+using namespace genesis::placement;
+
+TEST( JplaceWriter, RoundTrip )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile = environment->data_dir + "placement/test_a.jplace";
+    Sample smp = JplaceReader().from_file( infile );
+    ASSERT_LT( 1, smp.size() );
+
+    // Names that need escaping, and values that need all digits.
+    smp.at(0).name_at(0).name = "tab\tquote\"backslash\\";
+    smp.at(0).placement_at(0).likelihood = 0.1 + 0.2;
+    smp.at(1).name_at(0).multiplicity = 2.5;
+
+    auto const jplace = JplaceWriter().to_string( smp );
+    Sample const read = JplaceReader().from_string( jplace );
+    EXPECT_TRUE( validate( read, true, false ));
+    ASSERT_EQ( smp.size(), read.size() );
+
+    for( size_t i = 0; i < smp.size(); ++i ) {
+        auto const& exp_pqry = smp.at(i);
+        auto const& act_pqry = read.at(i);
+
+        ASSERT_EQ( exp_pqry.placement_size(), act_pqry.placement_size() );
+        for( size_t j = 0; j < exp_pqry.placement_size(); ++j ) {
+            auto const& exp = exp_pqry.placement_at(j);
+            auto const& act = act_pqry.placement_at(j);
+            EXPECT_EQ( exp.edge_num(),        act.edge_num() );
+            EXPECT_EQ( exp.likelihood,        act.likelihood );
+            EXPECT_EQ( exp.like_weight_ratio, act.like_weight_ratio );
+            EXPECT_EQ( exp.pendant_length,    act.pendant_length );
+            EXPECT_DOUBLE_EQ( exp.proximal_length, act.proximal_length );
+        }
+
+        ASSERT_EQ( exp_pqry.name_size(), act_pqry.name_size() );
+        for( size_t j = 0; j < exp_pqry.name_size(); ++j ) {
+            EXPECT_EQ( exp_pqry.name_at(j).name,         act_pqry.name_at(j).name );
+            EXPECT_EQ( exp_pqry.name_at(j).multiplicity, act_pqry.name_at(j).multiplicity );
+        }
+    }
+
+    // Writing again yields the same text.
+    EXPECT_EQ( jplace, JplaceWriter().to_string( read ));
+}
+
+TEST( JplaceWriter, NonFinite )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile = environment->data_dir + "placement/test_a.jplace";
+    Sample smp = JplaceReader().from_file( infile );
+    ASSERT_LT( 1, smp.size() );
+
+    // Json cannot store non-finite numbers. Instead of writing a file that cannot be read again,
+    // writing fails, and nothing is written.
+    auto const likelihood = smp.at(1).placement_at(0).likelihood;
+    smp.at(1).placement_at(0).likelihood = -std::numeric_limits<double>::infinity();
+    std::ostringstream oss;
+    EXPECT_THROW( JplaceWriter().to_stream( smp, oss ), std::invalid_argument );
+    EXPECT_TRUE( oss.str().empty() );
+
+    smp.at(1).placement_at(0).likelihood = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_THROW( JplaceWriter().to_string( smp ), std::invalid_argument );
+
+    // The lowest finite value can be written and read again.
+    smp.at(1).placement_at(0).likelihood = std::numeric_limits<double>::lowest();
+    Sample const read = JplaceReader().from_string( JplaceWriter().to_string( smp ));
+    ASSERT_EQ( smp.size(), read.size() );
+    EXPECT_EQ( std::numeric_limits<double>::lowest(), read.at(1).placement_at(0).likelihood );
+
+    // Once the value is fixed, the Sample round-trips again.
+    smp.at(1).placement_at(0).likelihood = likelihood;
+    Sample const fixed = JplaceReader().from_string( JplaceWriter().to_string( smp ));
+    EXPECT_EQ( likelihood, fixed.at(1).placement_at(0).likelihood );
+}
@@ -35,10 +35,14 @@
 #include "genesis/placement/formats/jplace_reader.hpp"
 #include "genesis/placement/function/cog.hpp"
 #include "genesis/placement/function/emd.hpp"
+#include "genesis/placement/function/functions.hpp"
+#include "genesis/placement/function/helper.hpp"
 #include "genesis/placement/function/measures.hpp"
 #include "genesis/placement/function/nhd.hpp"
 #include "genesis/placement/sample.hpp"
 #include "genesis/placement/sample_set.hpp"
+#include "genesis/placement/pquery/plain.hpp"
+#include "genesis/tree/default/distances.hpp"
 #include "genesis/utils/math/matrix.hpp"
 
 using namespace genesis;
@@ -129,3 +133,88 @@ TEST( SampleMeasures, NodeHistogramDistance )
     EXPECT_FLOAT_EQ( 0.0, node_histogram_distance( smp_lhs, smp_lhs ));
     EXPECT_FLOAT_EQ( 0.0, node_histogram_distance( smp_rhs, smp_rhs ));
 }
+
+TEST( SampleMeasures, PairwiseDistanceAndVariance )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Read files.
+    std::string infile_lhs = environment->data_dir + "placement/test_a.jplace";
+    std::string infile_rhs = environment->data_dir + "placement/test_b.jplace";
+    Sample smp_lhs = JplaceReader().from_file( infile_lhs );
+    Sample smp_rhs = JplaceReader().from_file( infile_rhs );
+
+    // Naive quadratic versions of the measures to compare against.
+    auto const node_dists = tree::node_branch_length_distance_matrix( smp_lhs.tree() );
+    auto naive_pairwise = [&]( Sample const& smp_a, Sample const& smp_b, bool pendant ){
+        double sum = 0.0;
+        for( auto const& pqry_a : plain_queries( smp_a )) {
+            for( auto const& pqry_b : plain_queries( smp_b )) {
+                sum += pquery_distance( pqry_a, pqry_b, node_dists, pendant );
+            }
+        }
+        return sum / total_placement_mass( smp_a ) / total_placement_mass( smp_b );
+    };
+    auto naive_variance = [&]( Sample const& smp, bool pendant ){
+        auto const pqrys = plain_queries( smp );
+        double sum = 0.0;
+        for( size_t i = 0; i < pqrys.size(); ++i ) {
+            for( size_t j = i + 1; j < pqrys.size(); ++j ) {
+                auto const dist = pquery_distance( pqrys[i], pqrys[j], node_dists, pendant );
+                sum += dist * dist;
+            }
+        }
+        return sum / total_placement_mass( smp ) / total_placement_mass( smp );
+    };
+
+    // Multiple placements per pquery, and with only the most likely placement.
+    for( size_t round = 0; round < 2; ++round ) {
+        if( round == 1 ) {
+            filter_n_max_weight_placements( smp_lhs, 1 );
+            filter_n_max_weight_placements( smp_rhs, 1 );
+        }
+
+        for( bool pendant : { false, true }) {
+            auto const exp_pairwise = naive_pairwise( smp_lhs, smp_rhs, pendant );
+            EXPECT_NEAR( exp_pairwise, pairwise_distance( smp_lhs, smp_rhs, pendant ), 1e-9 * exp_pairwise );
+            EXPECT_NEAR( exp_pairwise, pairwise_distance( smp_rhs, smp_lhs, pendant ), 1e-9 * exp_pairwise );
+
+            auto const exp_variance = naive_variance( smp_lhs, pendant );
+            EXPECT_NEAR( exp_variance, variance( smp_lhs, pendant ), 1e-9 * exp_variance );
+        }
+    }
+}
+
+TEST( SampleMeasures, PairwiseDistanceBranchLengths )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Read files.
+    std::string infile_lhs = environment->data_dir + "placement/test_a.jplace";
+    std::string infile_rhs = environment->data_dir + "placement/test_b.jplace";
+    Sample const smp_lhs = JplaceReader().from_file( infile_lhs );
+    Sample const smp_rhs = JplaceReader().from_file( infile_rhs );
+
+    // Change the branch lengths of the second sample, and keep its placements at the same
+    // relative position on their edges.
+    Sample scaled = smp_rhs;
+    auto& tree = scaled.tree();
+    for( size_t i = 0; i < tree.edge_count(); ++i ) {
+        tree.edge_at(i).data<PlacementEdgeData>().branch_length *= 1.0 + static_cast<double>( i % 3 );
+    }
+    for( auto& pqry : scaled.pqueries() ) {
+        for( auto& place : pqry.placements() ) {
+            place.proximal_length *= 1.0 + static_cast<double>( place.edge().index() % 3 );
+        }
+    }
+    EXPECT_TRUE( validate( scaled, true, false ));
+
+    // Distances are measured on the branch lengths of the first sample, so that the placements of
+    // the second one are at the same positions as without the changed branch lengths.
+    for( bool pendant : { false, true }) {
+        auto const exp = pairwise_distance( smp_lhs, smp_rhs, pendant );
+        EXPECT_NEAR( exp, pairwise_distance( smp_lhs, scaled, pendant ), 1e-9 * exp );
+    }
+}
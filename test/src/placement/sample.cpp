@@ -37,7 +37,9 @@
 #include "genesis/placement/function/functions.hpp"
 #include "genesis/placement/function/helper.hpp"
 #include "genesis/placement/function/operators.hpp"
+#include "genesis/placement/function/sample_set.hpp"
 #include "genesis/placement/sample.hpp"
+#include "genesis/placement/sample_set.hpp"
 #include "genesis/tree/formats/newick/reader.hpp"
 
 using namespace genesis;
@@ -54,6 +56,96 @@ TEST(Sample, WithTree)
     EXPECT_TRUE (validate(smp, true, false));
 }
 
+TEST(Sample, SharedTree)
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile = environment->data_dir + "placement/test_a.jplace";
+    Sample const smp = JplaceReader().from_file(infile);
+    auto const& smp_tree = smp.tree();
+
+    // Copies get their own tree.
+    Sample copy = smp;
+    EXPECT_NE( &smp_tree, &static_cast<Sample const&>( copy ).tree() );
+    EXPECT_TRUE( identical_trees( smp.tree(), copy.tree() ));
+    EXPECT_TRUE( validate( copy, true, false ));
+
+    // Explicitly shared trees are copied once they are changed.
+    copy.share_tree( smp.shared_tree() );
+    EXPECT_EQ( &smp_tree, &static_cast<Sample const&>( copy ).tree() );
+    EXPECT_TRUE( compatible_trees( smp, copy ));
+    copy.tree().edge_at(0).data<PlacementEdgeData>().branch_length += 1.0;
+    EXPECT_NE( &smp_tree, &static_cast<Sample const&>( copy ).tree() );
+    EXPECT_EQ( &smp_tree, &smp.tree() );
+    EXPECT_TRUE( validate( smp, true, false ));
+    EXPECT_TRUE( validate( copy, true, false ));
+    EXPECT_FALSE( identical_trees( smp.tree(), copy.tree() ));
+    EXPECT_TRUE( compatible_trees( smp, copy ));
+
+    // Explicitly share the tree of another Sample.
+    Sample other = JplaceReader().from_file(infile);
+    EXPECT_TRUE( identical_trees( smp.tree(), other.tree() ));
+    other.share_tree( smp.shared_tree() );
+    EXPECT_EQ( &smp_tree, &static_cast<Sample const&>( other ).tree() );
+    EXPECT_TRUE( validate( other, true, false ));
+    EXPECT_EQ( total_placement_count( smp ), total_placement_count( other ));
+
+    // A Sample constructed from a shared tree uses it as well.
+    Sample const empty( smp.shared_tree() );
+    EXPECT_EQ( &smp_tree, &empty.tree() );
+
+    // Incompatible trees cannot be shared.
+    auto const small = std::make_shared<PlacementTree const>(
+        PlacementTreeNewickReader().from_string( "(A:1.0{0},B:1.0{1})R:1.0{2};" )
+    );
+    EXPECT_THROW( other.share_tree( small ), std::runtime_error );
+
+    // Share the trees of a whole set.
+    SampleSet set;
+    set.add( JplaceReader().from_file(infile) );
+    set.add( copy );
+    set.add( JplaceReader().from_file(infile) );
+    EXPECT_EQ( 2, share_identical_trees( set ));
+    SampleSet const& const_set = set;
+    EXPECT_EQ( &const_set[0].sample.tree(), &const_set[2].sample.tree() );
+    EXPECT_TRUE( validate( const_set[2].sample, true, false ));
+}
+
+TEST(Sample, ShareTreeIncompatible)
+{
+    // Two trees with the same number of edges, but with permuted edge nums.
+    auto const tree_a = PlacementTreeNewickReader().from_string(
+        "((A:1.0{0},B:2.0{1})C:3.0{2},D:4.0{3})R;"
+    );
+    auto tree_b = std::make_shared<PlacementTree const>( PlacementTreeNewickReader().from_string(
+        "((A:1.0{0},B:2.0{1})C:3.0{3},D:4.0{2})R;"
+    ));
+    ASSERT_EQ( tree_a.edge_count(), tree_b->edge_count() );
+
+    Sample smp( tree_a );
+    auto& pqry = smp.add();
+    pqry.add_name( "q" );
+    for( size_t i = 0; i < smp.tree().edge_count(); ++i ) {
+        auto& place = pqry.add_placement( smp.tree().edge_at( i ));
+        place.proximal_length = 0.5;
+        place.like_weight_ratio = 0.25;
+    }
+    auto const& smp_tree = static_cast<Sample const&>( smp ).tree();
+
+    // Sharing fails, and leaves the Sample unchanged. The other tree is released afterwards,
+    // so that placements that still pointed to it would be dangling.
+    EXPECT_THROW( smp.share_tree( tree_b ), std::runtime_error );
+    tree_b.reset();
+    EXPECT_EQ( &smp_tree, &static_cast<Sample const&>( smp ).tree() );
+    EXPECT_TRUE( validate( smp, true, false ));
+    for( auto const& place : smp.at( 0 ).placements() ) {
+        EXPECT_EQ( &smp_tree.edge_at( place.edge().index() ), &place.edge() );
+        EXPECT_EQ( place.edge().data<PlacementEdgeData>().edge_num(), place.edge_num() );
+        EXPECT_DOUBLE_EQ( 0.5, place.proximal_length );
+    }
+}
+
 // =================================================================================================
 //     Merging Duplicates
 // =================================================================================================
@@ -113,3 +205,49 @@ TEST(Sample, MergeDuplicatesTransitive)
     // Check after merging.
     test_sample_stats(smp, 1, 4, 4);
 }
+
+TEST(Sample, MergeDuplicatesOrder)
+{
+    auto tree = PlacementTreeNewickReader().from_string(
+        "((B:2.0{0},(D:2.0{1},E:2.0{2})C:2.0{3})A:2.0{4},F:2.0{5},(H:2.0{6},I:2.0{7})G:2.0{8})R:2.0{9};"
+    );
+    Sample smp( tree );
+    auto add_pquery = [&]( std::vector<std::string> const& names, size_t edge_index ){
+        auto& pqry = smp.add();
+        for( auto const& name : names ) {
+            pqry.add_name( name );
+        }
+        pqry.add_placement( smp.tree().edge_at( edge_index ));
+    };
+    add_pquery( { "x" },      3 );
+    add_pquery( { "a" },      2 );
+    add_pquery( { "b" },      0 );
+    add_pquery( { "c", "b" }, 1 );
+    add_pquery( { "a", "c" }, 2 );
+    add_pquery( { "y" },      4 );
+
+    // The group (a, b, c) is collected in the first of its Pqueries, in the order of the Pqueries.
+    collect_duplicate_pqueries( smp );
+    ASSERT_EQ( 3, smp.size() );
+    EXPECT_EQ( "x", smp.at(0).name_at(0).name );
+    EXPECT_EQ( "y", smp.at(2).name_at(0).name );
+    ASSERT_EQ( 4, smp.at(1).placement_size() );
+    EXPECT_EQ( 2, smp.at(1).placement_at(0).edge().index() );
+    EXPECT_EQ( 0, smp.at(1).placement_at(1).edge().index() );
+    EXPECT_EQ( 1, smp.at(1).placement_at(2).edge().index() );
+    EXPECT_EQ( 6, smp.at(1).name_size() );
+
+    // Names and placements are merged in the order of their first occurrence.
+    merge_duplicate_names( smp );
+    merge_duplicate_placements( smp );
+    ASSERT_EQ( 3, smp.at(1).name_size() );
+    EXPECT_EQ( "a", smp.at(1).name_at(0).name );
+    EXPECT_EQ( "b", smp.at(1).name_at(1).name );
+    EXPECT_EQ( "c", smp.at(1).name_at(2).name );
+    EXPECT_EQ( 2.0, smp.at(1).name_at(0).multiplicity );
+    ASSERT_EQ( 3, smp.at(1).placement_size() );
+    EXPECT_EQ( 2, smp.at(1).placement_at(0).edge().index() );
+    EXPECT_EQ( 0, smp.at(1).placement_at(1).edge().index() );
+    EXPECT_EQ( 1, smp.at(1).placement_at(2).edge().index() );
+    EXPECT_TRUE( validate( smp, true, false ));
+}
@@ -0,0 +1,124 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup test
+ */
+
+#include "src/common.hpp"
+
+#include "genesis/placement/formats/jplace_reader.hpp"
+#include "genesis/placement/function/emd.hpp"
+#include "genesis/placement/function/functions.hpp"
+#include "genesis/placement/function/helper.hpp"
+#include "genesis/placement/function/measures.hpp"
+#include "genesis/placement/sample.hpp"
+#include "genesis/placement/sample_columns.hpp"
+#include "genesis/tree/default/distances.hpp"
+#include "genesis/tree/mass_tree/emd.hpp"
+#include "genesis/tree/mass_tree/tree.hpp"
+#include "genesis/utils/math/matrix.hpp"
+
+using namespace genesis;
+using namespace genesis::placement;
+
+TEST( SampleColumns, Views )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile = environment->data_dir + "placement/duplicates_b.jplace";
+    Sample smp = JplaceReader().from_file( infile );
+    SampleColumns const columns( smp );
+
+    ASSERT_EQ( smp.size(), columns.size() );
+    EXPECT_EQ( total_placement_count( smp ), columns.placement_size() );
+    EXPECT_EQ( smp.tree().edge_count(), columns.edge_count() );
+    EXPECT_EQ( smp.tree().node_count(), columns.node_count() );
+    EXPECT_EQ( columns.size() + 1, columns.placement_offsets().size() );
+
+    size_t pqry_idx = 0;
+    for( auto const view : columns ) {
+        auto const& pqry = smp.at( pqry_idx );
+        EXPECT_EQ( pqry_idx, view.index() );
+        EXPECT_EQ( total_multiplicity( pqry ), view.multiplicity() );
+        ASSERT_EQ( pqry.placement_size(), view.placement_size() );
+
+        size_t place_idx = 0;
+        for( auto const place : view ) {
+            auto const& orig = pqry.placement_at( place_idx );
+            EXPECT_EQ( orig.edge().index(),   place.edge_index );
+            EXPECT_EQ( orig.likelihood,        place.likelihood );
+            EXPECT_EQ( orig.like_weight_ratio, place.like_weight_ratio );
+            EXPECT_EQ( orig.proximal_length,   place.proximal_length );
+            EXPECT_EQ( orig.pendant_length,    place.pendant_length );
+            EXPECT_EQ( orig.pendant_length,    view.placement_at( place_idx ).pendant_length );
+            ++place_idx;
+        }
+        EXPECT_EQ( pqry.placement_size(), place_idx );
+        ++pqry_idx;
+    }
+    EXPECT_EQ( smp.size(), pqry_idx );
+
+    // Empty columns still have a valid offset column.
+    SampleColumns const empty;
+    EXPECT_TRUE( empty.empty() );
+    EXPECT_EQ( 1, empty.placement_offsets().size() );
+    EXPECT_TRUE( empty.begin() == empty.end() );
+}
+
+TEST( SampleColumns, Kernels )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile = environment->data_dir + "placement/test_a.jplace";
+    Sample smp = JplaceReader().from_file( infile );
+    SampleColumns const columns( smp );
+
+    // Per edge counts and weights.
+    EXPECT_EQ( placement_count_per_edge( smp ), placement_count_per_edge( columns ));
+    auto const weights_smp = placement_weight_per_edge( smp );
+    auto const weights_col = placement_weight_per_edge( columns );
+    ASSERT_EQ( weights_smp.size(), weights_col.size() );
+    for( size_t i = 0; i < weights_smp.size(); ++i ) {
+        EXPECT_DOUBLE_EQ( weights_smp[i], weights_col[i] );
+    }
+
+    // Mass tree conversion.
+    auto const mass_smp = convert_to_mass_tree( smp );
+    auto const mass_col = convert_to_mass_tree( smp.tree(), columns );
+    EXPECT_DOUBLE_EQ( mass_smp.second, mass_col.second );
+    EXPECT_NEAR( 0.0, tree::earth_movers_distance( mass_smp.first, mass_col.first ), 1e-10 );
+
+    // EDPL, using the per pquery version as reference.
+    auto const node_dists = node_branch_length_distance_matrix( smp.tree() );
+    auto const edpl_col = edpl( columns, node_dists );
+    ASSERT_EQ( smp.size(), edpl_col.size() );
+    for( size_t i = 0; i < smp.size(); ++i ) {
+        EXPECT_DOUBLE_EQ( edpl( smp, smp.at(i) ), edpl_col[i] );
+    }
+}
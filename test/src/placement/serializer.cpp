@@ -33,12 +33,25 @@
 #include <cstdio>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "genesis/placement/formats/jplace_reader.hpp"
+#include "genesis/placement/formats/mapped_sample.hpp"
+#include "genesis/placement/formats/mapped_sample_set.hpp"
+#include "genesis/placement/formats/newick_reader.hpp"
+#include "genesis/placement/formats/sample_set_serializer.hpp"
 #include "genesis/placement/formats/serializer.hpp"
 #include "genesis/placement/function/functions.hpp"
 #include "genesis/placement/function/helper.hpp"
+#include "genesis/placement/function/operators.hpp"
 #include "genesis/placement/sample.hpp"
+#include "genesis/placement/sample_set.hpp"
+#include "genesis/tree/function/operators.hpp"
+#include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/input_source.hpp"
+#include "genesis/utils/io/output_target.hpp"
+#include "genesis/utils/io/serializer.hpp"
 
 using namespace genesis;
 using namespace genesis::placement;
@@ -70,3 +83,272 @@ TEST(SampleSerializer, SaveAndLoad)
     // Make sure the file is deleted.
     ASSERT_EQ (0, std::remove(tmpfile.c_str()));
 }
+
+static void compare_serialized_pqueries( Pquery const& exp, Pquery const& act )
+{
+    ASSERT_EQ( exp.placement_size(), act.placement_size() );
+    for( size_t j = 0; j < exp.placement_size(); ++j ) {
+        auto const& exp_place = exp.placement_at(j);
+        auto const& act_place = act.placement_at(j);
+        EXPECT_EQ( exp_place.edge().index(),    act_place.edge().index() );
+        EXPECT_EQ( exp_place.edge_num(),        act_place.edge_num() );
+        EXPECT_EQ( exp_place.likelihood,        act_place.likelihood );
+        EXPECT_EQ( exp_place.like_weight_ratio, act_place.like_weight_ratio );
+        EXPECT_EQ( exp_place.proximal_length,   act_place.proximal_length );
+        EXPECT_EQ( exp_place.pendant_length,    act_place.pendant_length );
+        EXPECT_EQ( exp_place.parsimony,         act_place.parsimony );
+    }
+
+    ASSERT_EQ( exp.name_size(), act.name_size() );
+    for( size_t j = 0; j < exp.name_size(); ++j ) {
+        EXPECT_EQ( exp.name_at(j).name,         act.name_at(j).name );
+        EXPECT_EQ( exp.name_at(j).multiplicity, act.name_at(j).multiplicity );
+    }
+}
+
+TEST(SampleSerializer, Open)
+{
+    // Skip test if no data directory availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile  = environment->data_dir + "placement/duplicates_b.jplace";
+    std::string tmpfile = environment->data_dir + "placement/duplicates_b.bplace";
+
+    // Prepare a Sample with some names and multiplicities.
+    Sample smp = JplaceReader().from_file(infile);
+    smp.at(0).add_name( "extra", 2.5 );
+    smp.at(1).clear_names();
+    SampleSerializer::save( smp, tmpfile );
+
+    {
+        auto mapped = SampleSerializer::open( tmpfile );
+        ASSERT_EQ( smp.size(), mapped.size() );
+        EXPECT_EQ( total_placement_count( smp ), mapped.placement_size() );
+        EXPECT_TRUE( tree::identical_topology( smp.tree(), mapped.tree() ));
+        EXPECT_TRUE( tree::validate_topology( mapped.tree() ));
+
+        // Random access, back to front.
+        for( size_t i = smp.size(); i > 0; --i ) {
+            compare_serialized_pqueries( smp.at( i - 1 ), mapped.pquery_at( i - 1 ));
+        }
+        EXPECT_THROW( mapped.pquery_at( smp.size() ), std::out_of_range );
+
+        // Whole sample, and copying single pqueries to a sample.
+        auto const loaded = mapped.to_sample();
+        ASSERT_EQ( smp.size(), loaded.size() );
+        for( size_t i = 0; i < smp.size(); ++i ) {
+            compare_serialized_pqueries( smp.at(i), loaded.at(i) );
+        }
+
+        Sample partial( smp.tree() );
+        partial.add( mapped.pquery_at( 3 ));
+        compare_serialized_pqueries( smp.at(3), partial.at(0) );
+    }
+
+    // Loading uses the same format.
+    auto const loaded = SampleSerializer::load( tmpfile );
+    ASSERT_EQ( smp.size(), loaded.size() );
+    for( size_t i = 0; i < smp.size(); ++i ) {
+        compare_serialized_pqueries( smp.at(i), loaded.at(i) );
+    }
+
+    // Make sure the file is deleted.
+    ASSERT_EQ (0, std::remove(tmpfile.c_str()));
+}
+
+TEST(SampleSerializer, InvalidTree)
+{
+    auto const tree = PlacementTreeNewickReader().from_string(
+        "((A:1{0},B:1{1})C:1{2},D:1{3})R;"
+    );
+
+    // The arrays of the tree, in the same layout as SampleSerializer::write_tree() uses.
+    std::vector<uint64_t> link_next, link_outer, link_node, link_edge;
+    for( auto const& link : tree.links() ) {
+        link_next.push_back(  link->next().index() );
+        link_outer.push_back( link->outer().index() );
+        link_node.push_back(  link->node().index() );
+        link_edge.push_back(  link->edge().index() );
+    }
+    std::vector<uint64_t> node_link;
+    std::vector<uint64_t> name_offsets( 1, 0 );
+    std::vector<char>     name_chars;
+    for( auto const& node : tree.nodes() ) {
+        node_link.push_back( node->link().index() );
+        auto const& name = node->data<PlacementNodeData>().name;
+        name_chars.insert( name_chars.end(), name.begin(), name.end() );
+        name_offsets.push_back( name_chars.size() );
+    }
+    std::vector<uint64_t> edge_primary, edge_secondary;
+    std::vector<double>   branch_lengths;
+    std::vector<int32_t>  edge_nums;
+    for( auto const& edge : tree.edges() ) {
+        edge_primary.push_back(   edge->primary_link().index() );
+        edge_secondary.push_back( edge->secondary_link().index() );
+        branch_lengths.push_back( edge->data<PlacementEdgeData>().branch_length );
+        edge_nums.push_back(      edge->data<PlacementEdgeData>().edge_num() );
+    }
+
+    auto const read = [&](){
+        std::string buffer;
+        {
+            utils::Serializer ser( utils::make_unique< utils::StringOutputTarget >( buffer ));
+            ser.put_varint( tree.link_count() );
+            ser.put_varint( tree.node_count() );
+            ser.put_varint( tree.edge_count() );
+            ser.put_varint( tree.root_link().index() );
+            ser.put_array( link_next );
+            ser.put_array( link_outer );
+            ser.put_array( link_node );
+            ser.put_array( link_edge );
+            ser.put_array( node_link );
+            ser.put_array( edge_primary );
+            ser.put_array( edge_secondary );
+            ser.put_array( branch_lengths );
+            ser.put_array( edge_nums );
+            ser.put_array( name_offsets );
+            ser.put_array( name_chars );
+        }
+        utils::Deserializer des( utils::make_unique< utils::StringInputSource >( buffer ));
+        return SampleSerializer::read_tree( des );
+    };
+
+    // The unchanged arrays give the same tree.
+    auto const copy = read();
+    EXPECT_TRUE( tree::identical_topology( tree, copy ));
+    EXPECT_TRUE( tree::validate_topology( copy ));
+
+    // A name offset past the end of the names.
+    auto const offset = name_offsets[1];
+    name_offsets[1] = name_chars.size() + 100;
+    EXPECT_THROW( read(), std::invalid_argument );
+    name_offsets[1] = offset;
+
+    // Next links that do not form cycles.
+    auto const next = link_next[0];
+    link_next[0] = link_next[1];
+    EXPECT_THROW( read(), std::invalid_argument );
+    link_next[0] = next;
+
+    // Indices in range, but outer links that do not match.
+    std::swap( link_outer[0], link_outer[1] );
+    EXPECT_THROW( read(), std::invalid_argument );
+    std::swap( link_outer[0], link_outer[1] );
+
+    EXPECT_NO_THROW( read() );
+}
+
+TEST(SampleSetSerializer, SaveAndLoad)
+{
+    // Skip test if no data directory availabe.
+    NEEDS_TEST_DATA;
+
+    std::string infile  = environment->data_dir + "placement/duplicates_b.jplace";
+    std::string tmpfile = environment->data_dir + "placement/duplicates_b.bplset";
+
+    // Prepare a set of samples with the same tree, but different branch lengths and pqueries.
+    Sample const smp = JplaceReader().from_file(infile);
+    SampleSet set;
+    for( size_t i = 0; i < 4; ++i ) {
+        Sample copy = smp;
+        copy.tree().edge_at(i).data<PlacementEdgeData>().branch_length += 1.0;
+        for( size_t j = 0; j < i; ++j ) {
+            copy.remove( size_t( 0 ));
+        }
+        set.add( std::move( copy ), "sample_" + std::to_string( i ));
+    }
+
+    auto compare_sets = [&]( SampleSet const& exp, SampleSet const& act ){
+        ASSERT_EQ( exp.size(), act.size() );
+        for( size_t i = 0; i < exp.size(); ++i ) {
+            EXPECT_EQ( exp[i].name, act[i].name );
+            auto const& exp_smp = exp[i].sample;
+            auto const& act_smp = act[i].sample;
+            EXPECT_TRUE( tree::identical_topology( exp_smp.tree(), act_smp.tree() ));
+            for( size_t e = 0; e < exp_smp.tree().edge_count(); ++e ) {
+                EXPECT_EQ(
+                    exp_smp.tree().edge_at(e).data<PlacementEdgeData>().branch_length,
+                    act_smp.tree().edge_at(e).data<PlacementEdgeData>().branch_length
+                );
+            }
+            ASSERT_EQ( exp_smp.size(), act_smp.size() );
+            for( size_t j = 0; j < exp_smp.size(); ++j ) {
+                compare_serialized_pqueries( exp_smp.at(j), act_smp.at(j) );
+            }
+        }
+    };
+
+    auto formats = std::vector< utils::CompressionFormat >{ utils::CompressionFormat::kNone };
+    if( utils::compression_format_available( utils::CompressionFormat::kGzip )) {
+        formats.push_back( utils::CompressionFormat::kGzip );
+    }
+    for( auto const format : formats ) {
+        SampleSetSerializer::save( set, tmpfile, format );
+
+        auto const names = SampleSetSerializer::sample_names( tmpfile );
+        auto const exp_names = std::vector<std::string>{
+            "sample_0", "sample_1", "sample_2", "sample_3"
+        };
+        EXPECT_EQ( exp_names, names );
+
+        // All samples.
+        compare_sets( set, SampleSetSerializer::load( tmpfile ));
+
+        // Some samples, by name.
+        SampleSet subset;
+        subset.add( set[2].sample, set[2].name );
+        subset.add( set[0].sample, set[0].name );
+        compare_sets( subset, SampleSetSerializer::load( tmpfile, { "sample_2", "sample_0" } ));
+
+        auto const single = SampleSetSerializer::load_sample( tmpfile, "sample_3" );
+        EXPECT_EQ( set[3].sample.size(), single.size() );
+        EXPECT_THROW( SampleSetSerializer::load_sample( tmpfile, "nope" ), std::invalid_argument );
+
+        // Lazy loading from an opened file.
+        {
+            auto mapped = SampleSetSerializer::open( tmpfile );
+            EXPECT_EQ( exp_names, mapped.names() );
+            EXPECT_TRUE( mapped.has_sample( "sample_1" ));
+            EXPECT_FALSE( mapped.has_sample( "nope" ));
+            EXPECT_TRUE( compatible_trees( set[0].sample.tree(), mapped.tree() ));
+            auto const lazy_a = mapped.load_sample( "sample_1" );
+            auto const lazy_b = mapped.load_sample( "sample_1" );
+            auto const lazy_c = mapped.sample_at( 2 );
+            EXPECT_TRUE( validate( lazy_a, true, false ));
+            EXPECT_EQ( set[1].sample.size(), lazy_a.size() );
+            EXPECT_EQ( set[2].sample.size(), lazy_c.size() );
+
+            // Samples with the same branch lengths share their tree, others do not.
+            EXPECT_EQ( &lazy_a.tree(), &lazy_b.tree() );
+            EXPECT_NE( &lazy_a.tree(), &lazy_c.tree() );
+            auto const& lazy_edge = lazy_a.at(0).placement_at(0).edge();
+            EXPECT_EQ( &lazy_a.tree().edge_at( lazy_edge.index() ), &lazy_edge );
+            EXPECT_THROW( mapped.load_sample( "nope" ), std::invalid_argument );
+            EXPECT_THROW( mapped.sample_at( 4 ), std::out_of_range );
+            compare_sets( subset, mapped.load_samples({ "sample_2", "sample_0" }));
+            compare_sets( set, mapped.to_sample_set() );
+        }
+
+        // Trees of Samples that no longer exist are not kept.
+        {
+            auto mapped = SampleSetSerializer::open( tmpfile );
+            for( size_t i = 0; i < mapped.size(); ++i ) {
+                auto const lazy = mapped.sample_at( i );
+                EXPECT_EQ( set[i].sample.size(), lazy.size() );
+                EXPECT_EQ( 1, mapped.cached_tree_count() );
+            }
+            auto const lazy_a = mapped.sample_at( 0 );
+            auto const lazy_b = mapped.sample_at( 1 );
+            EXPECT_EQ( 2, mapped.cached_tree_count() );
+        }
+
+        ASSERT_EQ (0, std::remove(tmpfile.c_str()));
+    }
+
+    // Different trees cannot be stored together.
+    SampleSet other = set;
+    Sample renamed = smp;
+    renamed.tree().node_at(0).data<PlacementNodeData>().name = "renamed";
+    other.add( std::move( renamed ));
+    EXPECT_THROW( SampleSetSerializer::save( other, tmpfile ), std::invalid_argument );
+}
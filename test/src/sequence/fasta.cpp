@@ -37,6 +37,7 @@
 #include "genesis/sequence/sequence_set.hpp"
 
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
 #include "genesis/utils/io/input_stream.hpp"
 
 #include <fstream>
@@ -65,6 +66,27 @@ TEST( Sequence, FastaReaderValidating )
     EXPECT_EQ( "TCGAAACCTGC------CTA", sset[0].sites().substr( 0, 20 ) );
 }
 
+TEST( Sequence, FastaReaderGzip )
+{
+    // Skip test if no data availabe, or if we cannot read gzip files.
+    NEEDS_TEST_DATA;
+    if( ! utils::compression_format_available( utils::CompressionFormat::kGzip )) {
+        return;
+    }
+
+    // Load the same sequences from the plain and the compressed file.
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+    auto const plain = FastaReader().from_file( infile );
+    auto const gzip  = FastaReader().from_file( infile + ".gz" );
+
+    // Check data.
+    ASSERT_EQ( 10, gzip.size() );
+    for( size_t i = 0; i < plain.size(); ++i ) {
+        EXPECT_EQ( plain[i].label(), gzip[i].label() );
+        EXPECT_EQ( plain[i].sites(), gzip[i].sites() );
+    }
+}
+
 TEST( FastaInputIterator, ReadingLoop )
 {
     // Skip test if no data availabe.
@@ -32,6 +32,7 @@
 
 #include <string>
 
+#include "genesis/tree/default/distance_oracle.hpp"
 #include "genesis/tree/default/distances.hpp"
 #include "genesis/tree/default/newick_reader.hpp"
 #include "genesis/tree/function/distances.hpp"
@@ -77,3 +78,29 @@ TEST(DefaultTree, Distances)
     EXPECT_TRUE( exp == edge_branch_length_distance_matrix(tree) );
     EXPECT_EQ(   exp,   edge_branch_length_distance_matrix(tree) );
 }
+
+TEST(DefaultTree, DistanceOracle)
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Read and process tree.
+    std::string infile = environment->data_dir + "tree/distances.newick";
+    Tree tree =  DefaultTreeNewickReader().from_file( infile );
+
+    // The oracle has to yield the same distances and LCAs as the full matrices.
+    auto const oracle = NodeDistanceOracle( tree );
+    auto const dists  = node_branch_length_distance_matrix( tree );
+    auto const lcas   = lowest_common_ancestors( tree );
+    ASSERT_EQ( tree.node_count(), oracle.node_count() );
+
+    for( size_t r = 0; r < tree.node_count(); ++r ) {
+        EXPECT_DOUBLE_EQ( dists( tree.root_node().index(), r ), oracle.root_distance( r ));
+
+        for( size_t c = 0; c < tree.node_count(); ++c ) {
+            EXPECT_DOUBLE_EQ( dists( r, c ), oracle( r, c ));
+            EXPECT_DOUBLE_EQ( dists( r, c ), oracle.distance( tree.node_at(r), tree.node_at(c) ));
+            EXPECT_EQ( lcas( r, c ), oracle.lowest_common_ancestor( r, c ));
+        }
+    }
+}
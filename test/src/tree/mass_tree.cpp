@@ -30,7 +30,14 @@
 
 #include "src/common.hpp"
 
+#include "genesis/placement/formats/jplace_reader.hpp"
+#include "genesis/placement/function/emd.hpp"
+#include "genesis/placement/sample.hpp"
+#include "genesis/tree/mass_tree/columns.hpp"
+#include "genesis/tree/mass_tree/emd.hpp"
 #include "genesis/tree/mass_tree/functions.hpp"
+#include "genesis/tree/mass_tree/tree.hpp"
+#include "genesis/utils/math/matrix.hpp"
 #include "genesis/utils/math/common.hpp"
 
 #include <vector>
@@ -71,3 +78,53 @@ TEST( MassTree, Binify )
         // LOG_DBG << "i = " << i << "\tpos = " << pos << " \tbin = " << bin;
     }
 }
+
+TEST( MassTree, Columns )
+{
+    // Skip test if no data availabe.
+    NEEDS_TEST_DATA;
+
+    // Read files and convert them to mass trees.
+    std::string infile_lhs = environment->data_dir + "placement/test_a.jplace";
+    std::string infile_rhs = environment->data_dir + "placement/test_b.jplace";
+    auto const lhs = placement::convert_to_mass_tree(
+        placement::JplaceReader().from_file( infile_lhs )
+    ).first;
+    auto const rhs = placement::convert_to_mass_tree(
+        placement::JplaceReader().from_file( infile_rhs )
+    ).first;
+
+    // Check the flat layout.
+    auto const lhs_cols = MassTreeColumns( lhs );
+    auto const rhs_cols = MassTreeColumns( rhs );
+    ASSERT_EQ( lhs.edge_count(), lhs_cols.edge_count() );
+    ASSERT_EQ( lhs.edge_count() + 1, lhs_cols.mass_offsets().size() );
+    EXPECT_EQ( lhs_cols.mass_size(), lhs_cols.mass_offsets().back() );
+    EXPECT_EQ( lhs.edge_count(), lhs_cols.postorder_edge_indices().size() );
+    EXPECT_EQ( mass_tree_mass_per_edge( lhs ), mass_tree_mass_per_edge( lhs_cols ));
+    EXPECT_DOUBLE_EQ( mass_tree_sum_of_masses( lhs ), mass_tree_sum_of_masses( lhs_cols ));
+    for( size_t e = 0; e < lhs_cols.edge_count(); ++e ) {
+        auto const& positions = lhs_cols.mass_positions();
+        for( size_t i = lhs_cols.mass_offsets()[e] + 1; i < lhs_cols.mass_offsets()[e + 1]; ++i ) {
+            EXPECT_LT( positions[ i - 1 ], positions[ i ] );
+        }
+    }
+
+    // The two-tree EMD walks both mass arrays in parallel, while the one-tree EMD uses the merged
+    // tree with opposite signs. Both have to agree.
+    auto const merged = mass_tree_merge_trees( lhs, rhs, 1.0, -1.0 );
+    for( double p : { 1.0, 2.0 } ) {
+        auto const merged_emd = earth_movers_distance( merged, p );
+        EXPECT_NEAR( 0.0, merged_emd.second, 1e-9 );
+
+        auto const emd = earth_movers_distance( lhs_cols, rhs_cols, p );
+        EXPECT_NEAR( merged_emd.first, emd, 1e-9 );
+        EXPECT_NEAR( merged_emd.first, earth_movers_distance( rhs, lhs, p ), 1e-9 );
+        EXPECT_DOUBLE_EQ( emd, earth_movers_distance( lhs, rhs, p ));
+
+        auto const matrix = earth_movers_distance( std::vector<MassTree>{ lhs, rhs, lhs }, p );
+        EXPECT_DOUBLE_EQ( emd, matrix( 0, 1 ));
+        EXPECT_DOUBLE_EQ( emd, matrix( 2, 1 ));
+        EXPECT_DOUBLE_EQ( 0.0, matrix( 0, 2 ));
+    }
+}
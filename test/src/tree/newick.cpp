@@ -31,12 +31,15 @@
 #include "src/common.hpp"
 
 #include <string>
+#include <vector>
 
 #include "genesis/tree/default/newick_reader.hpp"
+#include "genesis/tree/default/tree.hpp"
 #include "genesis/tree/default/newick_writer.hpp"
 #include "genesis/tree/function/functions.hpp"
 #include "genesis/tree/function/operators.hpp"
 #include "genesis/tree/formats/newick/color_writer_plugin.hpp"
+#include "genesis/tree/formats/newick/element.hpp"
 #include "genesis/tree/formats/newick/input_iterator.hpp"
 #include "genesis/tree/formats/newick/reader.hpp"
 #include "genesis/tree/formats/newick/writer.hpp"
@@ -133,6 +136,47 @@ TEST(Newick, NewickVariants)
     EXPECT_TRUE( validate_topology(tree) );
 }
 
+TEST(Newick, BranchLengths)
+{
+    // Return the branch lengths of the edges leading to A, B and C.
+    auto const read = []( std::string const& newick ){
+        auto const tree = DefaultTreeNewickReader().from_string( newick );
+        std::vector<double> result( 3, -1.0 );
+        for( auto const& edge : tree.edges() ) {
+            auto const& name = edge->secondary_node().data<DefaultNodeData>().name;
+            result.at( name[0] - 'A' ) = edge->data<DefaultEdgeData>().branch_length;
+        }
+        return result;
+    };
+
+    // Usual values, in different notations.
+    EXPECT_EQ( std::vector<double>({ 0.1, 20.0, 3e-5 }), read( "(A:0.1,B:2e1,C:+3E-5);" ));
+    EXPECT_EQ( std::vector<double>({ 0.0, 0.0, 1.0 }), read( "(A:0,B:-0.0,C);" ));
+
+    // Values that std::stod() accepts as well, as used by earlier versions of the reader.
+    EXPECT_EQ( std::vector<double>({ 1.0, 0.5, 2.0 }), read( "(A:1.,B:.5,C:2.e0);" ));
+    EXPECT_EQ( std::vector<double>({ 1e-5, 100.0, 7.0 }), read( "(A:1e-5,B:1E+2,C:7);" ));
+
+    // The Newick lexer does not yield surrounding whitespace, but values set otherwise may have it.
+    auto const value_to_branch_length = []( std::string const& value ){
+        NewickBrokerElement element;
+        element.values.push_back( value );
+        TreeEdge edge;
+        edge.reset_data( DefaultEdgeData::create() );
+        DefaultTreeNewickReaderPlugin().element_to_edge( element, edge );
+        return edge.data<DefaultEdgeData>().branch_length;
+    };
+    EXPECT_EQ( 1.5, value_to_branch_length( " 1.5" ));
+    EXPECT_EQ( 2.0, value_to_branch_length( "\t2. " ));
+    EXPECT_EQ( 4.0, value_to_branch_length( "0x4" ));
+
+    // Invalid values.
+    EXPECT_THROW( value_to_branch_length( "" ), std::invalid_argument );
+    EXPECT_THROW( value_to_branch_length( " " ), std::invalid_argument );
+    EXPECT_THROW( value_to_branch_length( "." ), std::invalid_argument );
+    EXPECT_THROW( value_to_branch_length( "x" ), std::invalid_argument );
+}
+
 TEST(Newick, ColorPlugin)
 {
     std::string input = "((A,(B,C)D)E,((F,(G,H)I)J,K)L)R;";
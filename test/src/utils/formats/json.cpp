@@ -32,15 +32,27 @@
 
 #include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/core/std.hpp"
+#include "genesis/utils/formats/json/compact_document.hpp"
+#include "genesis/utils/formats/json/compact_reader.hpp"
 #include "genesis/utils/formats/json/document.hpp"
 #include "genesis/utils/formats/json/iterator.hpp"
+#include "genesis/utils/formats/json/on_demand.hpp"
 #include "genesis/utils/formats/json/reader.hpp"
+#include "genesis/utils/formats/json/sax_reader.hpp"
+#include "genesis/utils/formats/json/stream_writer.hpp"
 #include "genesis/utils/formats/json/writer.hpp"
 #include "genesis/utils/io/input_stream.hpp"
 #include "genesis/utils/text/string.hpp"
 
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace genesis;
@@ -144,6 +156,377 @@ TEST( Json, ParsingPasses )
     }
 }
 
+// -------------------------------------------------------------------------
+//     Json Sax Reader
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Handler that records all events, optionally with the path at which they occur.
+ */
+class JsonTestSaxHandler : public JsonSaxHandler
+{
+public:
+
+    explicit JsonTestSaxHandler( JsonSaxPath const* path = nullptr )
+        : path_( path )
+    {}
+
+    void start_object() override { add_( "{" ); }
+    void end_object() override { add_( "}" ); }
+    void start_array() override { add_( "[" ); }
+    void end_array() override { add_( "]" ); }
+    void key( std::string& key ) override { add_( "k:" + key ); }
+    void string_value( std::string& value ) override { add_( "s:" + std::move( value )); }
+    void number_unsigned( std::uint64_t value ) override { add_( "u:" + std::to_string( value )); }
+    void number_signed( std::int64_t value ) override { add_( "i:" + std::to_string( value )); }
+    void number_float( double value ) override { add_( "f:" + std::to_string( value )); }
+    void boolean( bool value ) override { add_( value ? "true" : "false" ); }
+    void null() override { add_( "null" ); }
+
+    std::vector<std::string> events;
+
+private:
+
+    void add_( std::string const& event )
+    {
+        events.push_back( path_ ? path_->to_string() + "=" + event : event );
+    }
+
+    JsonSaxPath const* path_;
+};
+
+TEST( Json, SaxEvents )
+{
+    auto const json = std::string(
+        R"({ "a": [ 1, -2, 3.5, true, null, [] ], )"
+        R"("b": { "c": "x", "d": {} }, "e": FALSE })"
+    );
+
+    JsonTestSaxHandler handler;
+    JsonSaxReader().from_string( json, handler );
+    auto const expected = std::vector<std::string>{
+        "{", "k:a", "[", "u:1", "i:-2", "f:3.500000", "true", "null", "[", "]", "]",
+        "k:b", "{", "k:c", "s:x", "k:d", "{", "}", "}", "k:e", "false", "}"
+    };
+    EXPECT_EQ( expected, handler.events );
+
+    // Top level values and empty input.
+    JsonTestSaxHandler scalar;
+    JsonSaxReader().from_string( "  \"x\"  ", scalar );
+    JsonSaxReader().from_string( "", scalar );
+    JsonSaxReader().from_string( "42", scalar );
+    EXPECT_EQ( std::vector<std::string>({ "s:x", "u:42" }), scalar.events );
+}
+
+TEST( Json, SaxPath )
+{
+    auto const json = R"({ "a": [ 1, { "b/~": [ 2, 3 ] } ], "c": [ [ 4 ] ] })";
+
+    JsonSaxPath path;
+    JsonTestSaxHandler handler( &path );
+    JsonSaxReader().from_string( json, handler, &path );
+    auto const expected = std::vector<std::string>{
+        "={", "/a=k:a", "/a=[", "/a/0=u:1", "/a/1={", "/a/1/b~1~0=k:b/~", "/a/1/b~1~0=[",
+        "/a/1/b~1~0/0=u:2", "/a/1/b~1~0/1=u:3", "/a/1/b~1~0=]", "/a/1=}", "/a=]",
+        "/c=k:c", "/c=[", "/c/0=[", "/c/0/0=u:4", "/c/0=]", "/c=]", "=}"
+    };
+    EXPECT_EQ( expected, handler.events );
+    EXPECT_TRUE( path.empty() );
+}
+
+TEST( Json, SaxStringsAndNumbers )
+{
+    auto const json = std::string(
+        R"([ "q\"b\\s\/n\nt\tu\u00e9\u20ac\ud83d\ude00", 18446744073709551615, )"
+        R"(18446744073709551616, -9223372036854775808, -9223372036854775809, 1e3 ])"
+    );
+
+    JsonTestSaxHandler handler;
+    JsonSaxReader().from_string( json, handler );
+    ASSERT_EQ( 8, handler.events.size() );
+    EXPECT_EQ( "s:q\"b\\s/n\nt\tu\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80", handler.events[1] );
+    EXPECT_EQ( "u:18446744073709551615", handler.events[2] );
+    EXPECT_EQ( "f:" + std::to_string( 18446744073709551616.0 ), handler.events[3] );
+    EXPECT_EQ( "i:-9223372036854775808", handler.events[4] );
+    EXPECT_EQ( "f:" + std::to_string( -9223372036854775809.0 ), handler.events[5] );
+    EXPECT_EQ( "f:1000.000000", handler.events[6] );
+
+    // Long strings and numbers that span several blocks of the input buffer.
+    auto const long_str = std::string( 5 * 1024 * 1024, 'x' );
+    auto const long_json = "[\"" + long_str + "\", " + std::string( 10, '0' ) + "1 ]";
+    JsonTestSaxHandler long_handler;
+    JsonSaxReader().from_string( long_json, long_handler );
+    ASSERT_EQ( 4, long_handler.events.size() );
+    EXPECT_EQ( "s:" + long_str, long_handler.events[1] );
+    EXPECT_EQ( "u:1", long_handler.events[2] );
+}
+
+TEST( Json, SaxParsing )
+{
+    NEEDS_TEST_DATA;
+
+    auto reader = JsonSaxReader();
+    std::string data_dir = environment->data_dir + "utils/json/";
+    JsonSaxHandler handler;
+
+    auto fail_files = dir_list_files( data_dir, "fail.*.jtest" );
+    ASSERT_EQ( 24, fail_files.size() );
+    for( auto const& fail_file : fail_files ) {
+        EXPECT_ANY_THROW( reader.from_file( data_dir + fail_file, handler ));
+    }
+
+    auto pass_files = dir_list_files( data_dir, "pass.*.jtest" );
+    ASSERT_EQ( 3, pass_files.size() );
+    for( auto const& pass_file : pass_files ) {
+        EXPECT_NO_THROW( reader.from_file( data_dir + pass_file, handler ));
+    }
+
+    // Some more invalid inputs.
+    for( auto const& json : std::vector<std::string>{
+        "[1, 2", "{\"a\" 1}", "{\"a\": 1,}", "[1 2]", "[1}", "\"abc", "\"\\x\"", "\"\\ud800\"",
+        "nul", "[-]", "1 2"
+    }) {
+        EXPECT_ANY_THROW( reader.from_string( json, handler )) << json;
+    }
+}
+
+// -------------------------------------------------------------------------
+//     Json Compact Document
+// -------------------------------------------------------------------------
+
+TEST( Json, CompactAccess )
+{
+    auto const json = std::string(
+        R"({ "b": [ 1, -2, 3.5, "x", true, null, [] ], "a": { "c": "y" }, )"
+        R"("list": [ { "n": 1 }, { "n": 2 } ] })"
+    );
+    auto const doc = JsonCompactReader().from_string( json );
+    EXPECT_EQ( 22, doc.entry_count() );
+
+    // Type and element access, mirroring the JsonDocument.
+    ASSERT_TRUE( doc.is_object() );
+    EXPECT_EQ( 3, doc.size() );
+    auto const b = doc[ "b" ];
+    ASSERT_TRUE( b.is_array() );
+    ASSERT_EQ( 7, b.size() );
+    EXPECT_EQ( 1, b[0].get_number_unsigned() );
+    EXPECT_EQ( -2, b[1].get_number_signed() );
+    EXPECT_EQ( 3.5, b.at(2).get_number_float() );
+    EXPECT_EQ( -2.0, b[1].get_number<double>() );
+    EXPECT_EQ( "x", b[3].get_string() );
+    EXPECT_TRUE( b[4].get_boolean() );
+    EXPECT_TRUE( b[5].is_null() );
+    EXPECT_TRUE( b[6].empty() );
+    EXPECT_EQ( "y", doc.at( "a" ).at( "c" ).get_string() );
+    EXPECT_ANY_THROW( b.at( 7 ));
+    EXPECT_ANY_THROW( b[0].get_string() );
+    EXPECT_ANY_THROW( doc.at( "x" ));
+
+    // Lookup and iterators. Object members are in input order.
+    EXPECT_EQ( 1, doc.count( "a" ));
+    EXPECT_EQ( 0, doc.count( "x" ));
+    EXPECT_TRUE( doc.find( "x" ) == doc.end() );
+    EXPECT_EQ( "y", doc.find( "a" )->at( "c" ).get_string() );
+    std::vector<std::string> keys;
+    for( auto it = doc.begin(); it != doc.end(); ++it ) {
+        keys.push_back( it.key() );
+    }
+    EXPECT_EQ( std::vector<std::string>({ "b", "a", "list" }), keys );
+    size_t sum = 0;
+    for( auto const& elem : doc[ "list" ] ) {
+        sum += elem[ "n" ].get_number_unsigned();
+    }
+    EXPECT_EQ( 3, sum );
+    EXPECT_EQ( 7, doc[ "b" ].end() - doc[ "b" ].begin() );
+
+    // Conversion.
+    EXPECT_EQ( JsonReader().from_string( json ), doc.to_document() );
+
+    // Primitive and empty documents.
+    auto const num = JsonCompactReader().from_string( "42" );
+    EXPECT_EQ( 42, num.root().get_number_unsigned() );
+    EXPECT_EQ( 1, num.size() );
+    EXPECT_TRUE( JsonCompactReader().from_string( "" ).is_null() );
+    auto const null_doc = JsonCompactDocument();
+    EXPECT_TRUE( null_doc.begin() == null_doc.end() );
+
+    // Views stay valid when the document is moved, also with a short string pool.
+    auto small = JsonCompactReader().from_string( R"({ "k": "v" })" );
+    auto const value = small[ "k" ];
+    auto const moved = std::move( small );
+    EXPECT_EQ( "v", value.get_string() );
+    EXPECT_EQ( "v", moved[ "k" ].get_string() );
+    EXPECT_EQ( moved[ "k" ].string_data(), value.string_data() );
+}
+
+TEST( Json, CompactFiles )
+{
+    NEEDS_TEST_DATA;
+
+    std::string data_dir = environment->data_dir + "utils/json/";
+    auto pass_files = dir_list_files( data_dir, "pass.*.jtest" );
+    ASSERT_EQ( 3, pass_files.size() );
+    for( auto const& pass_file : pass_files ) {
+        auto const compact = JsonCompactReader().from_file( data_dir + pass_file );
+
+        // The JsonReader does not resolve unicode escape sequences, which the first file contains.
+        if( pass_file != "pass1.jtest" ) {
+            auto const dom = JsonReader().from_file( data_dir + pass_file );
+            EXPECT_EQ( dom, compact.to_document() ) << pass_file;
+        }
+    }
+
+    auto fail_files = dir_list_files( data_dir, "fail.*.jtest" );
+    for( auto const& fail_file : fail_files ) {
+        EXPECT_ANY_THROW( JsonCompactReader().from_file( data_dir + fail_file ));
+    }
+}
+
+// -------------------------------------------------------------------------
+//     Json On Demand
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Simple char by char implementation of the structural index, for comparison.
+ */
+std::vector<std::uint32_t> json_test_structural_index( std::string const& json )
+{
+    std::vector<std::uint32_t> result;
+    bool in_string = false;
+    bool in_scalar = false;
+    for( size_t i = 0; i < json.size(); ++i ) {
+        auto const c = json[i];
+        if( in_string ) {
+            if( c == '\\' ) {
+                ++i;
+            } else if( c == '"' ) {
+                in_string = false;
+            }
+            continue;
+        }
+        auto const is_op = ( std::string( "{}[]:," ).find( c ) != std::string::npos );
+        auto const is_space = ( c == ' ' || c == '\t' || c == '\n' || c == '\r' );
+        if( c == '"' ) {
+            result.push_back( i );
+            in_string = true;
+        } else if( is_op ) {
+            result.push_back( i );
+        } else if( !is_space && !in_scalar ) {
+            result.push_back( i );
+        }
+        in_scalar = !is_op && !is_space && c != '"';
+    }
+    result.push_back( json.size() );
+    return result;
+}
+
+TEST( Json, OnDemandStructuralIndex )
+{
+    // Strings with escape sequences at all positions relative to the 64 char blocks.
+    for( size_t shift = 0; shift < 70; ++shift ) {
+        auto const json = std::string(
+            "[" + std::string( shift, ' ' ) + R"("a\\", "b\"c\\\"", {"x":-1.5e3,"y":[true,null]},)"
+            R"( "\\\\\"", 12345, "[{:,}]", "\\", false ])"
+        );
+        EXPECT_EQ(
+            json_test_structural_index( json ), json_structural_index( json.data(), json.size() )
+        );
+    }
+
+    EXPECT_EQ(
+        std::vector<std::uint32_t>({ 0 }), json_structural_index( "", 0 )
+    );
+    EXPECT_ANY_THROW( json_structural_index( "[\"abc]", 6 ));
+}
+
+TEST( Json, OnDemandAccess )
+{
+    auto const json = std::string(
+        R"({ "b": [ 1, -2, 3.5, "x\ty", true, NULL, [] ], "a": { "c": "y" }, "skip": )"
+        R"({ "deep": [ [ [ "]}" ] ], { "k": {} } ] }, "list": [ { "n": 1 }, { "n": 2 } ] })"
+    );
+    auto const doc = JsonOnDemandReader().from_string( json );
+
+    // Type and element access, mirroring the JsonDocument.
+    ASSERT_TRUE( doc.is_object() );
+    EXPECT_EQ( 4, doc.size() );
+    auto const b = doc[ "b" ];
+    ASSERT_TRUE( b.is_array() );
+    ASSERT_EQ( 7, b.size() );
+    EXPECT_EQ( 1, b[0].get_number_unsigned() );
+    EXPECT_EQ( -2, b[1].get_number_signed() );
+    EXPECT_EQ( 3.5, b.at(2).get_number_float() );
+    EXPECT_EQ( -2.0, b[1].get_number<double>() );
+    EXPECT_EQ( "x\ty", b[3].get_string() );
+    EXPECT_TRUE( b[4].get_boolean() );
+    EXPECT_TRUE( b[5].is_null() );
+    EXPECT_TRUE( b[6].empty() );
+    EXPECT_EQ( "y", doc.at( "a" ).at( "c" ).get_string() );
+    EXPECT_EQ( R"({ "c": "y" })", doc[ "a" ].raw_json() );
+    EXPECT_EQ( R"("x\ty")", b[3].raw_json() );
+    EXPECT_ANY_THROW( b.at( 7 ));
+    EXPECT_ANY_THROW( b[0].get_string() );
+    EXPECT_ANY_THROW( doc.at( "x" ));
+
+    // Lookup and iterators. Object members are in input order.
+    EXPECT_EQ( 1, doc.count( "a" ));
+    EXPECT_EQ( 0, doc.count( "x" ));
+    EXPECT_TRUE( doc.find( "x" ) == doc.end() );
+    EXPECT_EQ( "y", doc.find( "a" )->at( "c" ).get_string() );
+    std::vector<std::string> keys;
+    for( auto it = doc.begin(); it != doc.end(); ++it ) {
+        keys.push_back( it.key() );
+    }
+    EXPECT_EQ( std::vector<std::string>({ "b", "a", "skip", "list" }), keys );
+    size_t sum = 0;
+    for( auto const& elem : doc[ "list" ] ) {
+        sum += elem[ "n" ].get_number_unsigned();
+    }
+    EXPECT_EQ( 3, sum );
+
+    // Conversion.
+    EXPECT_EQ( JsonReader().from_string( json ), doc.to_document() );
+
+    // Primitive and empty documents.
+    auto const num = JsonOnDemandReader().from_string( " 42 " );
+    EXPECT_EQ( 42, num.root().get_number_unsigned() );
+    EXPECT_EQ( "42", num.root().raw_json() );
+    EXPECT_EQ( 1, num.size() );
+    EXPECT_TRUE( JsonOnDemandReader().from_string( "  " ).is_null() );
+    auto const null_doc = JsonOnDemandDocument();
+    EXPECT_TRUE( null_doc.begin() == null_doc.end() );
+
+    // Errors are found once the invalid part is accessed. Skipped values are not validated.
+    auto const invalid = JsonOnDemandReader().from_string( R"({ "a": [ 1 2 ], "b" 1 })" );
+    EXPECT_TRUE( invalid[ "a" ].is_array() );
+    EXPECT_ANY_THROW( invalid[ "a" ].size() );
+    EXPECT_ANY_THROW( invalid[ "b" ] );
+    EXPECT_ANY_THROW( JsonOnDemandReader().from_string( "[ 1, [ 2 ]" ).size() );
+
+    // Literals in any case, and invalid ones that only start like a literal.
+    auto const literals = JsonOnDemandReader().from_string( "[ False, TRUE, nul, nulls, truex ]" );
+    EXPECT_TRUE( literals[0].is_boolean() );
+    EXPECT_FALSE( literals[0].get_boolean() );
+    EXPECT_TRUE( literals[1].get_boolean() );
+    EXPECT_ANY_THROW( literals[2].type() );
+    EXPECT_ANY_THROW( literals[3].is_null() );
+    EXPECT_ANY_THROW( literals[4].is_boolean() );
+}
+
+TEST( Json, OnDemandFiles )
+{
+    NEEDS_TEST_DATA;
+
+    std::string data_dir = environment->data_dir + "utils/json/";
+    auto pass_files = dir_list_files( data_dir, "pass.*.jtest" );
+    ASSERT_EQ( 3, pass_files.size() );
+    for( auto const& pass_file : pass_files ) {
+        auto const on_demand = JsonOnDemandReader().from_file( data_dir + pass_file );
+        auto const compact   = JsonCompactReader().from_file( data_dir + pass_file );
+        EXPECT_EQ( compact.to_document(), on_demand.to_document() ) << pass_file;
+    }
+}
+
 // TEST( Json, Speed )
 // {
 //     std::string inputfile = "/home/lucas/Projects/data/for_testing/jplace/sample_0_all_big.jplace";
@@ -153,3 +536,89 @@ TEST( Json, ParsingPasses )
 //     auto json = reader.parse_value( is );
 //     LOG_DBG << "size  " << json.size();
 // }
+
+TEST( Json, StreamWriter )
+{
+    // Compact output.
+    std::ostringstream compact;
+    JsonStreamWriter writer( compact );
+    writer.begin_object();
+    writer.key( "s" ).value( "a\"b\\c\n\x01" );
+    writer.key( "n" ).begin_array();
+    writer.value( 42 ).value( -7 ).value( uint64_t( 18446744073709551615ULL ));
+    writer.value( std::numeric_limits<int64_t>::min() );
+    writer.value( 0.1 ).value( 3.0 ).value( 1e-7 ).value( -1.5e300 );
+    EXPECT_THROW( writer.value( std::numeric_limits<double>::infinity() ), std::invalid_argument );
+    EXPECT_THROW( writer.value( std::numeric_limits<double>::quiet_NaN() ), std::invalid_argument );
+    writer.end_array();
+    writer.key( "o" ).begin_object().end_object();
+    writer.key( "b" ).value( true );
+    writer.key( "z" ).value( nullptr );
+    writer.end_object();
+    writer.finish();
+    EXPECT_EQ(
+        R"({"s":"a\"b\\c\n\u0001","n":[42,-7,18446744073709551615,-9223372036854775808,)"
+        R"(0.1,3.0,1e-7,-1.5e+300],"o":{},"b":true,"z":null})",
+        compact.str()
+    );
+
+    // Indented output, with single line arrays.
+    std::ostringstream indented;
+    JsonStreamWriter pretty( indented );
+    pretty.indent( 2 );
+    pretty.begin_object();
+    pretty.key( "a" ).begin_array( true ).value( 1 ).begin_array().value( 2 ).end_array().end_array();
+    pretty.key( "b" ).begin_array().value( "x" ).begin_array().end_array().end_array();
+    pretty.end_object();
+    pretty.finish();
+    EXPECT_EQ( "{\n  \"a\": [ 1, [ 2 ] ],\n  \"b\": [\n    \"x\",\n    []\n  ]\n}", indented.str() );
+
+    // Invalid orders of calls.
+    std::ostringstream dummy;
+    JsonStreamWriter invalid( dummy );
+    EXPECT_THROW( invalid.finish(), std::logic_error );
+    EXPECT_THROW( invalid.key( "k" ), std::logic_error );
+    EXPECT_THROW( invalid.end_array(), std::logic_error );
+    invalid.begin_object();
+    EXPECT_THROW( invalid.value( 1 ), std::logic_error );
+    EXPECT_THROW( invalid.end_array(), std::logic_error );
+    invalid.key( "k" );
+    EXPECT_THROW( invalid.key( "l" ), std::logic_error );
+    EXPECT_THROW( invalid.end_object(), std::logic_error );
+    invalid.begin_array();
+    EXPECT_THROW( invalid.finish(), std::logic_error );
+    invalid.end_array().end_object();
+    EXPECT_THROW( invalid.value( 1 ), std::logic_error );
+    EXPECT_NO_THROW( invalid.finish() );
+}
+
+TEST( Json, StreamWriterRoundTrip )
+{
+    // Doubles are written with as few digits as possible, but read back exactly.
+    std::mt19937_64 engine( 42 );
+    std::vector<double> values;
+    while( values.size() < 10000 ) {
+        uint64_t const bits = engine();
+        double value;
+        std::memcpy( &value, &bits, sizeof( value ));
+        if( std::isfinite( value )) {
+            values.push_back( value );
+        }
+    }
+
+    std::ostringstream out;
+    JsonStreamWriter writer( out );
+    writer.begin_array();
+    for( auto const value : values ) {
+        writer.value( value );
+    }
+    writer.end_array();
+    writer.finish();
+
+    auto const doc = JsonCompactReader().from_string( out.str() );
+    ASSERT_EQ( values.size(), doc.size() );
+    for( size_t i = 0; i < values.size(); ++i ) {
+        ASSERT_TRUE( doc[i].is_number_float() );
+        EXPECT_EQ( values[i], doc[i].get_number_float() );
+    }
+}
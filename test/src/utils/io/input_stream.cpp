@@ -30,14 +30,23 @@
 
 #include "src/common.hpp"
 
+#include "genesis/utils/io/char_search.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
+#include "genesis/utils/io/input_buffer.hpp"
 #include "genesis/utils/io/input_stream.hpp"
+#include "genesis/utils/core/fs.hpp"
 #include "genesis/utils/core/std.hpp"
 
 #include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
 #include <iterator>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <sstream>
+#include <vector>
 
 using namespace genesis;
 using namespace genesis::utils;
@@ -86,6 +95,233 @@ TEST(InputStream, LargeFile)
     test_input_specs( instr, 110, 51 );
 }
 
+TEST(InputStream, ReadAhead)
+{
+    NEEDS_TEST_DATA;
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+
+    // Use tiny blocks, so that the read-ahead ring is cycled through many times.
+    for( size_t block_length : { 64, 100, 4096 } ) {
+        for( size_t read_ahead : { 1, 2, 5 } ) {
+            InputStream instr(
+                utils::make_unique< FileInputSource >( infile ), block_length, read_ahead
+            );
+            EXPECT_EQ( block_length, instr.block_length() );
+            test_input_specs( instr, 110, 51 );
+        }
+    }
+
+    // Invalid settings.
+    EXPECT_ANY_THROW( InputStream( utils::make_unique< FileInputSource >( infile ), 0, 1 ));
+    EXPECT_ANY_THROW( InputStream( utils::make_unique< FileInputSource >( infile ), 64, 0 ));
+}
+
+TEST(InputStream, ManyStreams)
+{
+    NEEDS_TEST_DATA;
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+
+    // Open many streams at the same time, which all share the reader thread pool,
+    // and read them in an interleaved fashion.
+    std::vector< std::unique_ptr< InputStream >> streams;
+    for( size_t i = 0; i < 200; ++i ) {
+        streams.emplace_back( utils::make_unique< InputStream >(
+            utils::make_unique< FileInputSource >( infile ), 64, 1 + i % 4
+        ));
+    }
+    std::vector< size_t > lines( streams.size(), 0 );
+    bool any_good = true;
+    while( any_good ) {
+        any_good = false;
+        for( size_t i = 0; i < streams.size(); ++i ) {
+            auto& instr = *streams[i];
+            if( ! instr ) {
+                continue;
+            }
+            any_good = true;
+            instr.get_line();
+            ++lines[i];
+        }
+    }
+    for( auto l : lines ) {
+        EXPECT_EQ( 110, l );
+    }
+
+    // Streams that are destroyed before being fully read must not cause trouble.
+    for( size_t i = 0; i < 50; ++i ) {
+        InputStream instr( utils::make_unique< FileInputSource >( infile ), 64, 3 );
+        instr.get_line();
+    }
+}
+
+TEST(InputBuffer, ReadAhead)
+{
+    NEEDS_TEST_DATA;
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+    auto const content = file_read( infile );
+
+    for( size_t block_length : { 64, 100, 4096 } ) {
+        for( size_t read_ahead : { 1, 3 } ) {
+            InputBuffer buffer(
+                utils::make_unique< FileInputSource >( infile ), block_length, read_ahead
+            );
+
+            // Read in chunks that are larger than a block, to exercise all paths.
+            std::string result;
+            std::string chunk( 150, '\0' );
+            while( buffer ) {
+                auto const got = buffer.read( &chunk[0], chunk.size() );
+                result.append( chunk.data(), got );
+            }
+            EXPECT_EQ( content, result );
+        }
+    }
+}
+
+TEST(InputStream, MmapFile)
+{
+    NEEDS_TEST_DATA;
+    SCOPED_TRACE("InputStream.MmapFile");
+
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+    InputStream instr( utils::make_unique< MmapInputSource >( infile ));
+
+    EXPECT_TRUE( instr.is_mapped() );
+    test_input_specs( instr, 110, 51 );
+}
+
+TEST(InputStream, MmapLines)
+{
+    NEEDS_TEST_DATA;
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+
+    // Read all lines from a normal file source and from a mapped one, and compare.
+    InputStream file_instr( utils::make_unique< FileInputSource >( infile ));
+    InputStream mmap_instr( utils::make_unique< MmapInputSource >( infile ));
+    EXPECT_FALSE( file_instr.is_mapped() );
+    EXPECT_TRUE(  mmap_instr.is_mapped() );
+
+    size_t cnt = 0;
+    while( file_instr ) {
+        ASSERT_TRUE( static_cast< bool >( mmap_instr ));
+        auto const fl = file_instr.get_line();
+        auto const ml = mmap_instr.get_line();
+        EXPECT_EQ( std::string( fl.first, fl.second ), std::string( ml.first, ml.second ));
+        ++cnt;
+    }
+    EXPECT_FALSE( static_cast< bool >( mmap_instr ));
+    EXPECT_EQ( 110, cnt );
+}
+
+TEST(InputStream, MmapPageSize)
+{
+    NEEDS_TEST_DATA;
+    std::string tmpfile = environment->data_dir + "utils/mmap_page_size.txt";
+
+    // Write a file whose size is a multiple of the page size, without a final new line.
+    // The stream has to append one past the end of the mapped file content.
+    std::string content( 4096, 'x' );
+    content[ 100 ] = '\n';
+    file_write( content, tmpfile );
+
+    {
+        InputStream instr( utils::make_unique< MmapInputSource >( tmpfile ));
+        auto const l1 = instr.get_line();
+        auto const l2 = instr.get_line();
+        EXPECT_EQ( 100,  l1.second );
+        EXPECT_EQ( 3995, l2.second );
+        EXPECT_FALSE( static_cast< bool >( instr ));
+    }
+    {
+        InputStream instr( utils::make_unique< MmapInputSource >( tmpfile ));
+        test_input_specs( instr, 2, 3996 );
+    }
+
+    // Make sure the file is deleted.
+    ASSERT_EQ( 0, std::remove( tmpfile.c_str() ));
+}
+
+TEST(InputBuffer, MmapView)
+{
+    NEEDS_TEST_DATA;
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+    auto const content = file_read( infile );
+
+    InputBuffer mmap_buffer( utils::make_unique< MmapInputSource >( infile ));
+    InputBuffer file_buffer( utils::make_unique< FileInputSource >( infile ));
+    EXPECT_TRUE(  mmap_buffer.is_mapped() );
+    EXPECT_FALSE( file_buffer.is_mapped() );
+
+    // Views of the whole content, in odd sized chunks.
+    std::string mmap_result;
+    std::string file_result;
+    while( mmap_buffer ) {
+        auto const view = mmap_buffer.get_view( 37 );
+        mmap_result.append( view.first, view.second );
+    }
+    while( file_buffer ) {
+        auto const view = file_buffer.get_view( 37 );
+        file_result.append( view.first, view.second );
+    }
+    EXPECT_EQ( content, mmap_result );
+    EXPECT_EQ( content, file_result );
+}
+
+TEST(InputStream, GzipFile)
+{
+    NEEDS_TEST_DATA;
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta.gz";
+
+    EXPECT_EQ( CompressionFormat::kGzip, compression_format( infile ));
+    EXPECT_EQ( CompressionFormat::kNone, compression_format( infile.substr( 0, infile.size() - 3 )));
+    if( ! compression_format_available( CompressionFormat::kGzip )) {
+        EXPECT_ANY_THROW( from_file( infile ));
+        return;
+    }
+
+    InputStream instr( from_file( infile ));
+    test_input_specs( instr, 110, 51 );
+}
+
+TEST(InputStream, GzipConcatenated)
+{
+    NEEDS_TEST_DATA;
+    if( ! compression_format_available( CompressionFormat::kGzip )) {
+        return;
+    }
+
+    // Two concatenated gzip members are read as one continuous input.
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+    auto const plain   = file_read( infile );
+    auto const gzipped = file_read( infile + ".gz" );
+    auto const doubled = gzipped + gzipped;
+
+    InputBuffer buffer(
+        utils::make_unique< GzipInputSource >( utils::make_unique< StringInputSource >( doubled ))
+    );
+    std::string result( 2 * plain.size() + 10, '\0' );
+    result.resize( buffer.read( &result[0], result.size() ));
+    EXPECT_EQ( plain + plain, result );
+
+    // Trailing data that is not another member is ignored.
+    for( auto const& trailing : { std::string( 3, '\0' ), std::string( "garbage\n" )} ) {
+        InputBuffer padded( utils::make_unique< GzipInputSource >(
+            utils::make_unique< StringInputSource >( gzipped + trailing )
+        ));
+        std::string padded_result( plain.size() + 10, '\0' );
+        padded_result.resize( padded.read( &padded_result[0], padded_result.size() ));
+        EXPECT_EQ( plain, padded_result );
+    }
+
+    // Truncated input throws.
+    auto const truncated = gzipped.substr( 0, gzipped.size() / 2 );
+    EXPECT_ANY_THROW(
+        InputBuffer( utils::make_unique< GzipInputSource >(
+            utils::make_unique< StringInputSource >( truncated )
+        ))
+    );
+}
+
 TEST(InputStream, NewLines)
 {
     // Just \n.
@@ -103,3 +339,131 @@ TEST(InputStream, NewLines)
     // Go crazy.
     test_string( "\r\r\n\r\n\n", 4, 1);
 }
+
+// =================================================================================================
+//     Bulk Scanning
+// =================================================================================================
+
+TEST(InputStream, CharSearch)
+{
+    // Test all offsets and lengths around the vector widths.
+    for( size_t len = 0; len < 80; ++len ) {
+        for( size_t pos = 0; pos <= len; ++pos ) {
+            std::string str( len, 'a' );
+            if( pos < len ) {
+                str[pos] = 'x';
+            }
+            auto const b = str.data();
+            auto const e = str.data() + str.size();
+
+            EXPECT_EQ( b + pos, find_first_of( b, e, 'x' ));
+            EXPECT_EQ( b + pos, find_first_of( b, e, 'y', 'x' ));
+            EXPECT_EQ( b + pos, find_first_of( b, e, 'y', 'z', 'x' ));
+            EXPECT_EQ( b + pos, find_first_not_of( b, e, 'a' ));
+            EXPECT_EQ( pos < len ? len - 1 : len, count_chars( b, e, 'a' ));
+        }
+    }
+}
+
+static void test_bulk_scanning( std::string const& content, size_t block_length )
+{
+    // Scan the content once with the bulk operations, and once char by char,
+    // and check that both arrive at the same positions with the same results.
+    InputStream bulk( utils::make_unique< StringInputSource >( content ), block_length );
+    InputStream scal( utils::make_unique< StringInputSource >( content ), block_length );
+
+    auto const check = [&](){
+        ASSERT_EQ( scal.good(),   bulk.good() );
+        ASSERT_EQ( *scal,         *bulk );
+        ASSERT_EQ( scal.line(),   bulk.line() );
+        ASSERT_EQ( scal.column(), bulk.column() );
+    };
+
+    size_t round = 0;
+    while( scal ) {
+        std::string exp;
+        std::string act;
+        switch( round % 6 ) {
+            case 0: {
+                bulk.skip_until( ';' );
+                while( scal && *scal != ';' ) {
+                    ++scal;
+                }
+                break;
+            }
+            case 1: {
+                bulk.read_while( ';', act );
+                while( scal && *scal == ';' ) {
+                    exp += *scal;
+                    ++scal;
+                }
+                break;
+            }
+            case 2: {
+                bulk.read_until( '\n', act );
+                while( scal && *scal != '\n' ) {
+                    exp += *scal;
+                    ++scal;
+                }
+                break;
+            }
+            case 3: {
+                bulk.skip_while( isspace );
+                while( scal && isspace( *scal )) {
+                    ++scal;
+                }
+                break;
+            }
+            case 4: {
+                bulk.read_until( isdigit, act );
+                while( scal && ! isdigit( *scal )) {
+                    exp += *scal;
+                    ++scal;
+                }
+                break;
+            }
+            case 5: {
+                bulk.read_while( isdigit, act );
+                while( scal && isdigit( *scal )) {
+                    exp += *scal;
+                    ++scal;
+                }
+                break;
+            }
+        }
+        ASSERT_EQ( exp, act );
+        check();
+
+        // Make sure that we progress.
+        ++scal;
+        ++bulk;
+        check();
+        ++round;
+    }
+}
+
+TEST(InputStream, BulkScanning)
+{
+    // Build some content with all kinds of line breaks, and long runs of chars.
+    std::string content;
+    std::uint_fast32_t seed = 42;
+    auto const rand = [&](){
+        seed = seed * 1103515245 + 12345;
+        return ( seed >> 16 ) & 0x7FFF;
+    };
+    std::string const parts[] = {
+        "abc", ";", ";;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;", "\n", "\r\n", "\r", " \t ",
+        "0123456789", "some longer text without any special chars in it at all"
+    };
+    for( size_t i = 0; i < 2000; ++i ) {
+        content += parts[ rand() % 9 ];
+    }
+
+    test_bulk_scanning( content, 1 << 20 );
+    test_bulk_scanning( content, 64 );
+    test_bulk_scanning( content, 7 );
+    test_bulk_scanning( content + "x", 64 );
+    test_bulk_scanning( "", 64 );
+    test_bulk_scanning( "a", 64 );
+    test_bulk_scanning( "\r", 64 );
+}
@@ -36,10 +36,12 @@
 #include "genesis/utils/io/input_stream.hpp"
 
 #include <algorithm>
+#include <cstdlib>
 #include <iterator>
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <vector>
 
 using namespace genesis;
 using namespace genesis::utils;
@@ -213,6 +215,61 @@ TEST(Parser, Float)
     EXPECT_THROW( test_float( "1.0e-123456789101121314151617181920", 0, 0 ), std::underflow_error);
 }
 
+TEST(Parser, FloatCorrectRounding)
+{
+    // Cases that are hard to round correctly: halfway points, subnormals, the largest values,
+    // and mantissas with more than 19 significant digits. The C library is our reference.
+    std::vector<std::string> const cases = {
+        "9007199254740993",
+        "9007199254740992.999999999999999999999999",
+        "2.2250738585072011e-308",
+        "2.2250738585072014e-308",
+        "4.9406564584124654e-324",
+        "2.4703282292062327e-324",
+        "2.4703282292062328e-324",
+        "1.7976931348623157e308",
+        "1.7976931348623158e308",
+        "0.1000000000000000055511151231257827021181583404541015625",
+        "3.14159265358979323846264338327950288419716939937510",
+        "123456789012345678901234567890e-20",
+        "7.0e-10",
+        "1e23",
+        "8.98846567431158e307",
+        "0.000000000000000000000000000000000000000000001",
+        "-0.0"
+    };
+    for( auto const& str : cases ) {
+        double value;
+        auto const end = parse_float( str.data(), str.data() + str.size(), value );
+        EXPECT_EQ( str.data() + str.size(), end ) << "Input string: '" << str << "'";
+        EXPECT_EQ( std::strtod( str.c_str(), nullptr ), value ) << "Input string: '" << str << "'";
+
+        float fvalue;
+        parse_float( str.data(), str.data() + str.size(), fvalue );
+        EXPECT_EQ( std::strtof( str.c_str(), nullptr ), fvalue ) << "Input string: '" << str << "'";
+    }
+
+    // Invalid input leaves the position untouched.
+    double value = 1.0;
+    std::string const invalid = "-e5";
+    EXPECT_EQ( invalid.data(), parse_float( invalid.data(), invalid.data() + 3, value ));
+
+    // Numbers crossing the boundaries of small stream blocks.
+    std::string input;
+    std::vector<double> expected;
+    for( size_t i = 0; i < 200; ++i ) {
+        auto const num = std::to_string( i ) + ".0625e-" + std::to_string( i % 17 );
+        expected.push_back( std::strtod( num.c_str(), nullptr ));
+        input += num + ",";
+    }
+    InputStream it( utils::make_unique< StringInputSource >( input ), 16 );
+    for( auto const exp : expected ) {
+        EXPECT_EQ( exp, parse_float<double>( it ));
+        EXPECT_EQ( ',', *it );
+        ++it;
+    }
+}
+
 // -------------------------------------------------------------------------
 //     Number String
 // -------------------------------------------------------------------------
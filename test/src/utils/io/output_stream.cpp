@@ -0,0 +1,191 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup test
+ */
+
+#include "src/common.hpp"
+
+#include "genesis/sequence/formats/fasta_reader.hpp"
+#include "genesis/sequence/formats/fasta_writer.hpp"
+#include "genesis/sequence/sequence_set.hpp"
+#include "genesis/utils/core/fs.hpp"
+#include "genesis/utils/core/std.hpp"
+#include "genesis/utils/io/compressed_input_source.hpp"
+#include "genesis/utils/io/compressed_output_target.hpp"
+#include "genesis/utils/io/input_buffer.hpp"
+#include "genesis/utils/io/output_stream.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+using namespace genesis;
+using namespace genesis::utils;
+
+static std::string make_test_content( size_t lines )
+{
+    std::string content;
+    for( size_t i = 0; i < lines; ++i ) {
+        content += "line " + std::to_string( i ) + " with some more text\n";
+    }
+    return content;
+}
+
+static std::string read_all( std::unique_ptr< BaseInputSource > source )
+{
+    InputBuffer buffer( std::move( source ));
+    std::string result;
+    char chunk[ 4096 ];
+    size_t got;
+    while(( got = buffer.read( chunk, sizeof( chunk ))) > 0 ) {
+        result.append( chunk, got );
+    }
+    return result;
+}
+
+TEST(OutputStream, String)
+{
+    auto const content = make_test_content( 1000 );
+
+    // Small blocks, so that many of them are written in the background.
+    std::string target;
+    {
+        OutputStream os( utils::make_unique< StringOutputTarget >( target ), 64, 3 );
+        for( size_t i = 0; i < content.size(); i += 7 ) {
+            os << content.substr( i, 7 );
+        }
+        os.close();
+        EXPECT_FALSE( os.is_open() );
+    }
+    EXPECT_EQ( content, target );
+
+    // Closing via the destructor writes everything as well.
+    std::string target2;
+    {
+        OutputStream os( utils::make_unique< StringOutputTarget >( target2 ), 100 );
+        os << content;
+    }
+    EXPECT_EQ( content, target2 );
+
+    // Invalid block settings.
+    EXPECT_ANY_THROW( OutputStream( utils::make_unique< StringOutputTarget >( target ), 0 ));
+    EXPECT_ANY_THROW( OutputStream( utils::make_unique< StringOutputTarget >( target ), 64, 1 ));
+}
+
+TEST(OutputStream, Flush)
+{
+    std::string target;
+    OutputStream os( utils::make_unique< StringOutputTarget >( target ), 1024 );
+    os << "some text";
+    EXPECT_EQ( "", target );
+    os.flush();
+    EXPECT_EQ( "some text", target );
+    os << " and more";
+    os.close();
+    EXPECT_EQ( "some text and more", target );
+}
+
+TEST(OutputStream, GzipRoundtrip)
+{
+    NEEDS_TEST_DATA;
+    if( ! compression_format_available( CompressionFormat::kGzip )) {
+        std::string target;
+        EXPECT_ANY_THROW( GzipOutputTarget( utils::make_unique< StringOutputTarget >( target )));
+        return;
+    }
+
+    auto const content = make_test_content( 100000 );
+
+    // Compress into a string, and decompress again.
+    std::string compressed;
+    {
+        OutputStream os( utils::make_unique< GzipOutputTarget >(
+            utils::make_unique< StringOutputTarget >( compressed )
+        ), 1 << 16 );
+        os << content;
+        os.close();
+    }
+    EXPECT_EQ( CompressionFormat::kGzip, compression_format( compressed.data(), compressed.size() ));
+    EXPECT_LT( compressed.size(), content.size() );
+    EXPECT_EQ( content, read_all( utils::make_unique< GzipInputSource >(
+        utils::make_unique< StringInputSource >( compressed )
+    )));
+
+    // Write to a compressed file, and read back.
+    std::string tmpfile = environment->data_dir + "utils/output_stream.txt.gz";
+    {
+        OutputStream os( utils::to_file( tmpfile, CompressionFormat::kGzip ));
+        os << content;
+        os.close();
+    }
+    EXPECT_EQ( CompressionFormat::kGzip, compression_format( tmpfile ));
+    EXPECT_EQ( content, read_all( utils::from_file( tmpfile )));
+    ASSERT_EQ( 0, std::remove( tmpfile.c_str() ));
+
+    // The compression is not inferred from the file name.
+    {
+        OutputStream os( utils::to_file( tmpfile ));
+        os << content;
+        os.close();
+    }
+    EXPECT_EQ( CompressionFormat::kNone, compression_format( tmpfile ));
+    EXPECT_EQ( content, read_all( utils::from_file( tmpfile )));
+    ASSERT_EQ( 0, std::remove( tmpfile.c_str() ));
+}
+
+TEST(OutputStream, FastaWriterGzip)
+{
+    NEEDS_TEST_DATA;
+    if( ! compression_format_available( CompressionFormat::kGzip )) {
+        return;
+    }
+
+    // Write a fasta file compressed, and check that reading it back yields the same sequences.
+    std::string infile  = environment->data_dir + "sequence/dna_10.fasta";
+    std::string tmpfile = environment->data_dir + "sequence/dna_10_out.fasta.gz";
+    auto const sset = sequence::FastaReader().from_file( infile );
+    sequence::FastaWriter().to_file( sset, tmpfile, CompressionFormat::kGzip );
+
+    EXPECT_EQ( CompressionFormat::kGzip, compression_format( tmpfile ));
+    auto const sset2 = sequence::FastaReader().from_file( tmpfile );
+    ASSERT_EQ( sset.size(), sset2.size() );
+    for( size_t i = 0; i < sset.size(); ++i ) {
+        EXPECT_EQ( sset[i].label(), sset2[i].label() );
+        EXPECT_EQ( sset[i].sites(), sset2[i].sites() );
+    }
+    ASSERT_EQ( 0, std::remove( tmpfile.c_str() ));
+}
+
+TEST(OutputStream, FileOverwriting)
+{
+    NEEDS_TEST_DATA;
+
+    // Existing files are not overwritten by default.
+    std::string infile = environment->data_dir + "sequence/dna_10.fasta";
+    EXPECT_ANY_THROW( OutputStream( utils::to_file( infile )));
+}
@@ -0,0 +1,251 @@
+/*
+    Genesis - A toolkit for working with phylogenetic data.
+    Copyright (C) 2014-2017 Lucas Czech
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact:
+    Lucas Czech <lucas.czech@h-its.org>
+    Exelixis Lab, Heidelberg Institute for Theoretical Studies
+    Schloss-Wolfsbrunnenweg 35, D-69118 Heidelberg, Germany
+*/
+
+/**
+ * @brief
+ *
+ * @file
+ * @ingroup test
+ */
+
+#include "src/common.hpp"
+
+#include "genesis/sequence/formats/fasta_reader.hpp"
+#include "genesis/sequence/sequence_set.hpp"
+#include "genesis/tree/default/newick_reader.hpp"
+#include "genesis/tree/formats/newick/reader.hpp"
+#include "genesis/tree/tree_set.hpp"
+#include "genesis/utils/core/options.hpp"
+#include "genesis/utils/core/std.hpp"
+#include "genesis/utils/formats/csv/reader.hpp"
+#include "genesis/utils/io/input_source.hpp"
+#include "genesis/utils/io/input_stream.hpp"
+#include "genesis/utils/io/parallel_chunk_reader.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef GENESIS_PTHREADS
+#    include "genesis/utils/core/thread_pool.hpp"
+
+#    include <future>
+#    include <thread>
+#endif
+
+using namespace genesis;
+using namespace genesis::utils;
+
+TEST( ParallelChunkReader, RecordBoundaries )
+{
+    // Fasta: Last '>' at the start of a line, but not the first record.
+    std::string const fasta = ">a\nAC>GT\n>b\nACGT\n>c\nAC";
+    EXPECT_EQ( 17, fasta_record_boundary( fasta.data(), fasta.size() ));
+    EXPECT_EQ( 9,  fasta_record_boundary( fasta.data(), 10 ));
+    EXPECT_EQ( 0,  fasta_record_boundary( fasta.data(), 9 ));
+
+    // Newick: Semicolons in quotes and comments do not count.
+    std::string const newick = "(a,b);\n('x;y',[;]c);\n(d,e)[;";
+    EXPECT_EQ( 20, newick_record_boundary( newick.data(), newick.size() ));
+    EXPECT_EQ( 6,  newick_record_boundary( newick.data(), 19 ));
+    EXPECT_EQ( 0,  newick_record_boundary( newick.data(), 5 ));
+
+    // Csv: New lines in quotes and escaped new lines do not count.
+    std::string const csv = "a,\"b\nc\",d\ne,f\\\ng\nh,\"i";
+    auto const csv_default = csv_record_boundary();
+    EXPECT_EQ( 17, csv_default( csv.data(), csv.size() ));
+    EXPECT_EQ( 0,  csv_default( csv.data(), 9 ));
+    auto const csv_escapes = csv_record_boundary( "\"", ",", "", true );
+    EXPECT_EQ( 15, csv_default( csv.data(), 16 ));
+    EXPECT_EQ( 10, csv_escapes( csv.data(), 16 ));
+
+    // Csv: Comment lines can contain quotes.
+    std::string const comments = "#it's\na,b\n#\"\nc,d";
+    auto const csv_comments = csv_record_boundary( "\"'", ",", "#", false );
+    EXPECT_EQ( 13, csv_comments( comments.data(), comments.size() ));
+}
+
+TEST( ParallelChunkReader, InputOrder )
+{
+    // Many small records, with a chunk size that cuts through them at odd places.
+    std::string input;
+    for( size_t i = 0; i < 2000; ++i ) {
+        input += "line " + std::to_string( i ) + "\n";
+    }
+    auto const boundary = csv_record_boundary();
+
+    for( size_t chunk_size : { 1, 7, 64, 1000, 100000 } ) {
+        std::vector< std::string > lines;
+        size_t chunks = 0;
+        ParallelChunkReader( boundary, chunk_size ).read< std::vector< std::string >>(
+            utils::make_unique< StringInputSource >( input ),
+            []( InputStream& it ){
+                std::vector< std::string > result;
+                while( it ) {
+                    auto const line = it.get_line();
+                    result.emplace_back( line.first, line.second );
+                }
+                return result;
+            },
+            [&]( std::vector< std::string >& chunk ){
+                lines.insert( lines.end(), chunk.begin(), chunk.end() );
+                ++chunks;
+            }
+        );
+
+        ASSERT_EQ( 2000, lines.size() ) << "chunk size " << chunk_size;
+        for( size_t i = 0; i < lines.size(); ++i ) {
+            EXPECT_EQ( "line " + std::to_string( i ), lines[i] );
+        }
+        EXPECT_LE( 1, chunks );
+    }
+}
+
+#ifdef GENESIS_PTHREADS
+
+TEST( ParallelChunkReader, ThreadPool )
+{
+    // All parallel parsing uses the one shared pool, which uses all cores, unless the user
+    // restricted the number of threads.
+    auto& pool = ParallelChunkReader::thread_pool();
+    EXPECT_EQ( &Options::get().thread_pool(), &pool );
+    EXPECT_FALSE( pool.is_worker_thread() );
+    if( std::thread::hardware_concurrency() > 1 && ! std::getenv( "OMP_NUM_THREADS" )) {
+        EXPECT_LT( 1, pool.size() );
+    }
+
+    // Reading from within a task of the pool itself does not dead-lock it, even if all workers
+    // are busy with such tasks.
+    std::string input;
+    for( size_t i = 0; i < 100; ++i ) {
+        input += "line " + std::to_string( i ) + "\n";
+    }
+    std::vector< std::future< size_t >> results;
+    for( size_t t = 0; t < 2 * pool.size(); ++t ) {
+        results.push_back( pool.enqueue( [&](){
+            EXPECT_TRUE( pool.is_worker_thread() );
+            size_t count = 0;
+            ParallelChunkReader( csv_record_boundary(), 16 ).read< size_t >(
+                utils::make_unique< StringInputSource >( input ),
+                []( InputStream& it ){
+                    size_t result = 0;
+                    while( it ) {
+                        it.get_line();
+                        ++result;
+                    }
+                    return result;
+                },
+                [&]( size_t& chunk ){
+                    count += chunk;
+                }
+            );
+            return count;
+        }));
+    }
+    for( auto& result : results ) {
+        EXPECT_EQ( 100, result.get() );
+    }
+}
+
+#endif
+
+TEST( ParallelChunkReader, Errors )
+{
+    std::string input;
+    for( size_t i = 0; i < 100; ++i ) {
+        input += ( i == 50 ? "bad\n" : "good\n" );
+    }
+
+    size_t consumed = 0;
+    EXPECT_THROW(
+        ParallelChunkReader( csv_record_boundary(), 16 ).read< int >(
+            utils::make_unique< StringInputSource >( input ),
+            []( InputStream& it ){
+                while( it ) {
+                    if( *it == 'b' ) {
+                        throw std::runtime_error( "bad line in " + it.source_name() );
+                    }
+                    it.get_line();
+                }
+                return 0;
+            },
+            [&]( int& ){
+                ++consumed;
+            }
+        ),
+        std::runtime_error
+    );
+
+    // All chunks before the error were consumed in order.
+    EXPECT_LT( 0, consumed );
+    EXPECT_GT( 50, consumed );
+}
+
+TEST( ParallelChunkReader, Readers )
+{
+    // Fasta
+    std::string fasta;
+    for( size_t i = 0; i < 300; ++i ) {
+        fasta += ">seq_" + std::to_string( i ) + " meta\nACGT\n";
+        fasta += "AC" + std::string( i % 7, 'T' ) + "\n";
+    }
+    auto const fasta_plain    = sequence::FastaReader().from_string( fasta );
+    auto const fasta_parallel = sequence::FastaReader()
+        .parallel_parsing( true )
+        .from_string( fasta );
+    ASSERT_EQ( 300, fasta_parallel.size() );
+    for( size_t i = 0; i < fasta_plain.size(); ++i ) {
+        EXPECT_EQ( fasta_plain[i].label(),    fasta_parallel[i].label() );
+        EXPECT_EQ( fasta_plain[i].metadata(), fasta_parallel[i].metadata() );
+        EXPECT_EQ( fasta_plain[i].sites(),    fasta_parallel[i].sites() );
+    }
+
+    // Csv
+    std::string csv;
+    for( size_t i = 0; i < 300; ++i ) {
+        csv += std::to_string( i ) + ",\"quoted\nfield\"," + std::to_string( i * i ) + "\n";
+    }
+    auto const csv_plain    = CsvReader().from_string( csv );
+    auto const csv_parallel = CsvReader().parallel_parsing( true ).from_string( csv );
+    EXPECT_EQ( 300, csv_parallel.size() );
+    EXPECT_EQ( csv_plain, csv_parallel );
+
+    // Newick
+    std::string newick;
+    for( size_t i = 0; i < 300; ++i ) {
+        newick += ( i % 2 ? "'t;" + std::to_string( i ) + "'=" : "" );
+        newick += "((A,B)[c;],C,D" + std::to_string( i ) + ");\n";
+    }
+    tree::TreeSet newick_plain;
+    tree::TreeSet newick_parallel;
+    tree::DefaultTreeNewickReader().from_string( newick, newick_plain, "tree_" );
+    auto reader = tree::DefaultTreeNewickReader();
+    reader.parallel_parsing( true );
+    reader.from_string( newick, newick_parallel, "tree_" );
+    ASSERT_EQ( 300, newick_parallel.size() );
+    for( size_t i = 0; i < newick_plain.size(); ++i ) {
+        EXPECT_EQ( newick_plain[i].name, newick_parallel[i].name );
+        EXPECT_EQ( newick_plain[i].tree.node_count(), newick_parallel[i].tree.node_count() );
+    }
+}
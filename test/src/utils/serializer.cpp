@@ -30,10 +30,15 @@
 
 #include "src/common.hpp"
 
+#include <cstdint>
 #include <cstdio>
+#include <limits>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "genesis/utils/io/serializer.hpp"
+#include "genesis/utils/math/matrix.hpp"
 
 using namespace genesis;
 using namespace utils;
@@ -115,6 +120,7 @@ TEST(Serializer, ToAndFromStream)
     SerializerTestData input;
     init_test_data(input);
     apply_serializer(serial, input);
+    serial.flush();
 
     std::istringstream in(out.str());
     Deserializer deser (in);
@@ -160,3 +166,154 @@ TEST(Serializer, ToAndFromFile)
     // Make sure file is deleted.
     ASSERT_EQ (0, std::remove(file_name.c_str()));
 }
+
+TEST(Serializer, ByteOrder)
+{
+    // Numbers are stored in little endian order, independent of the system.
+    std::string out;
+    {
+        Serializer serial( utils::make_unique< StringOutputTarget >( out ));
+        serial.put_int<uint32_t>( 0x01020304 );
+        serial.put_int<int16_t>( -2 );
+        serial.put_float( 1.0 );
+    }
+    EXPECT_EQ( std::string( "\x04\x03\x02\x01\xFE\xFF", 6 ), out.substr( 0, 6 ));
+    EXPECT_EQ( std::string( "\x00\x00\x00\x00\x00\x00\xF0\x3F", 8 ), out.substr( 6 ));
+}
+
+TEST(Serializer, Varint)
+{
+    std::vector<uint64_t> const uvals = {
+        0, 1, 127, 128, 300, 16383, 16384, 0xFFFFFFFF, std::numeric_limits<uint64_t>::max()
+    };
+    std::vector<int64_t> const svals = {
+        0, 1, -1, 63, -64, 64, -65, std::numeric_limits<int64_t>::max(),
+        std::numeric_limits<int64_t>::min()
+    };
+
+    std::string out;
+    {
+        Serializer serial( utils::make_unique< StringOutputTarget >( out ));
+        for( auto v : uvals ) {
+            serial.put_varint( v );
+        }
+        for( auto v : svals ) {
+            serial.put_varint( v );
+        }
+        serial.put_varint<int>( -3 );
+        serial.put_varint<size_t>( 1000 );
+        serial.put_varint<int>( 1000 );
+    }
+
+    // Small numbers take one byte, and the sign does not matter much.
+    EXPECT_EQ( '\x00', out[0] );
+    EXPECT_EQ( '\x01', out[1] );
+    EXPECT_EQ( '\x7F', out[2] );
+    EXPECT_EQ( std::string( "\x80\x01", 2 ), out.substr( 3, 2 ));
+
+    std::istringstream in( out );
+    Deserializer deser( in );
+    for( auto v : uvals ) {
+        EXPECT_EQ( v, deser.get_varint<uint64_t>() );
+    }
+    for( auto v : svals ) {
+        EXPECT_EQ( v, deser.get_varint<int64_t>() );
+    }
+    EXPECT_EQ( -3, deser.get_varint<int>() );
+
+    // Reading into a type that is too small throws.
+    EXPECT_THROW( deser.get_varint<uint8_t>(), std::overflow_error );
+    EXPECT_THROW( deser.get_varint<int8_t>(), std::overflow_error );
+    EXPECT_TRUE( deser.finished() );
+}
+
+TEST(Serializer, Arrays)
+{
+    std::vector<double> const vec = { 1.5, -2.25, 1e300, 0.0, 3.14159 };
+    std::vector<double> const empty;
+    auto const mat = Matrix<int>( 2, 3, { 1, 2, 3, -4, -5, -6 });
+
+    // Larger than the internal buffer, and not aligned.
+    std::vector<uint32_t> big( 50000 );
+    for( size_t i = 0; i < big.size(); ++i ) {
+        big[i] = static_cast<uint32_t>( i * 7919 );
+    }
+
+    std::string out;
+    {
+        Serializer serial( utils::make_unique< StringOutputTarget >( out ));
+        serial.put_int<unsigned char>( 1 );
+        serial.put_array( vec );
+        serial.put_array( empty );
+        serial.put_int<unsigned char>( 2 );
+        serial.put_array( mat );
+        serial.put_string( "x" );
+        serial.put_array( big );
+        serial.close();
+        EXPECT_FALSE( serial.is_open() );
+        EXPECT_ANY_THROW( serial.put_int( 3 ));
+    }
+
+    std::istringstream in( out );
+    Deserializer deser( in );
+    EXPECT_EQ( 1, deser.get_int<unsigned char>() );
+    EXPECT_EQ( vec, deser.get_array<double>() );
+    EXPECT_EQ( empty, deser.get_array<double>() );
+    EXPECT_EQ( 2, deser.get_int<unsigned char>() );
+    Matrix<int> mat_in;
+    deser.get_array( mat_in );
+    EXPECT_EQ( mat, mat_in );
+    EXPECT_EQ( "x", deser.get_string() );
+    EXPECT_EQ( big, deser.get_array<uint32_t>() );
+    EXPECT_TRUE( deser.finished() );
+
+    // Array views need a memory mapped input.
+    std::istringstream in2( out );
+    Deserializer deser2( in2 );
+    deser2.get_int<unsigned char>();
+    EXPECT_ANY_THROW( deser2.get_array_view<double>() );
+}
+
+TEST(Serializer, MmapViews)
+{
+    // Skip test if no data directory availabe.
+    NEEDS_TEST_DATA;
+
+    std::string file_name = environment->data_dir + "Serializer.MmapViews.bin";
+    std::vector<double> const vec = { 1.5, -2.25, 1e300, 0.0, 3.14159 };
+    auto const mat = Matrix<double>( 2, 2, { 0.1, 0.2, 0.3, 0.4 });
+    {
+        Serializer serial( file_name );
+        serial.put_string( "abc" );
+        serial.put_array( vec );
+        serial.put_varint( 5 );
+        serial.put_array( mat );
+        serial.close();
+    }
+
+    {
+        Deserializer deser( utils::make_unique< MmapInputSource >( file_name ));
+        ASSERT_TRUE( deser.is_mapped() );
+        EXPECT_EQ( "abc", deser.get_string() );
+
+        auto const view = deser.get_array_view<double>();
+        ASSERT_EQ( vec.size(), view.second );
+        EXPECT_EQ( 0, reinterpret_cast< uintptr_t >( view.first ) % alignof( double ));
+        EXPECT_EQ( vec, std::vector<double>( view.first, view.first + view.second ));
+
+        EXPECT_EQ( 5, deser.get_varint<int>() );
+        size_t rows = 0;
+        size_t cols = 0;
+        auto const data = deser.get_matrix_view<double>( rows, cols );
+        EXPECT_EQ( 2, rows );
+        EXPECT_EQ( 2, cols );
+        EXPECT_EQ( 0.4, data[3] );
+        EXPECT_TRUE( deser.finished() );
+
+        // The first view is still valid.
+        EXPECT_EQ( 1e300, view.first[2] );
+    }
+
+    // Make sure file is deleted.
+    ASSERT_EQ (0, std::remove(file_name.c_str()));
+}
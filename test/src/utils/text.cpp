@@ -30,10 +30,18 @@
 
 #include "src/common.hpp"
 
+#include "genesis/utils/text/float_format.hpp"
 #include "genesis/utils/text/string.hpp"
 #include "genesis/utils/text/style.hpp"
 #include "genesis/utils/text/table.hpp"
 
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
 #include <sstream>
 
 using namespace genesis::utils;
@@ -181,3 +189,54 @@ TEST( Text, ToString )
     EXPECT_EQ( "42.4",    to_string_rounded( zeros, 1 ) );
     EXPECT_EQ( "42.42",   to_string_rounded( zeros, 4 ) );
 }
+
+TEST( Text, ToStringShortest )
+{
+    EXPECT_EQ( "0",        to_string_shortest( 0.0 ));
+    EXPECT_EQ( "-0",       to_string_shortest( -0.0 ));
+    EXPECT_EQ( "0.1",      to_string_shortest( 0.1 ));
+    EXPECT_EQ( "0.3",      to_string_shortest( 0.3 ));
+    EXPECT_EQ( "42",       to_string_shortest( 42.0 ));
+    EXPECT_EQ( "-2.5",     to_string_shortest( -2.5 ));
+    EXPECT_EQ( "0.00001",  to_string_shortest( 1e-5 ));
+    EXPECT_EQ( "1.5e-7",   to_string_shortest( 1.5e-7 ));
+    EXPECT_EQ( "1e+17",    to_string_shortest( 1e17 ));
+    EXPECT_EQ( "1e+23",    to_string_shortest( 1e23 ));
+    EXPECT_EQ( "5e-324",   to_string_shortest( std::numeric_limits<double>::denorm_min() ));
+    EXPECT_EQ( "inf",      to_string_shortest( std::numeric_limits<double>::infinity() ));
+    EXPECT_EQ( "nan",      to_string_shortest( std::numeric_limits<double>::quiet_NaN() ));
+    EXPECT_EQ( "0.30000000000000004",     to_string_shortest( 0.1 + 0.2 ));
+    EXPECT_EQ( "1.7976931348623157e+308", to_string_shortest( std::numeric_limits<double>::max() ));
+
+    // Random bit patterns need to read back exactly, and must not be longer than what
+    // printf needs with the smallest sufficient precision.
+    std::mt19937_64 engine( 42 );
+    for( size_t i = 0; i < 20000; ++i ) {
+        uint64_t const bits = engine();
+        double value;
+        std::memcpy( &value, &bits, sizeof( value ));
+        if( ! std::isfinite( value )) {
+            continue;
+        }
+
+        auto const text = to_string_shortest( value );
+        EXPECT_EQ( value, std::strtod( text.c_str(), nullptr )) << text;
+
+        // Count the significant digits, without leading and trailing zeros.
+        std::string digits;
+        for( auto c : text.substr( 0, text.find( 'e' ))) {
+            if( isdigit( c ) && ( c != '0' || ! digits.empty() )) {
+                digits += c;
+            }
+        }
+        digits.erase( digits.find_last_not_of( '0' ) + 1 );
+        char buffer[ 32 ];
+        for( int precision = 0; precision < 17; ++precision ) {
+            std::snprintf( buffer, sizeof( buffer ), "%.*e", precision, value );
+            if( std::strtod( buffer, nullptr ) == value ) {
+                EXPECT_LE( digits.size(), static_cast<size_t>( precision + 1 )) << text;
+                break;
+            }
+        }
+    }
+}